@@ -11,6 +11,10 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 TARGET = Circuito
 TEMPLATE = app
 
+# O nucleo do simulador (bool3S, Port, Circuito, ...), compartilhado com as
+# ferramentas de linha de comando (ver ferramentas.pro)
+include(nucleo.pri)
+
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked as deprecated (the exact warnings
 # depend on your compiler). Please consult the documentation of the
@@ -24,21 +28,25 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 
 SOURCES += main.cpp\
-    bool3S.cpp \
-    circuito.cpp \
     maincircuito.cpp \
     modificarporta.cpp \
     newcircuito.cpp \
     modificarsaida.cpp \
-    port.cpp
+    modelotabela.cpp \
+    geradortabela.cpp \
+    modelocircuito.cpp \
+    leitorcircuito.cpp \
+    esquematico.cpp
 
 HEADERS  += maincircuito.h \
-    bool3S.h \
-    circuito.h \
     modificarporta.h \
     newcircuito.h \
     modificarsaida.h \
-    port.h
+    modelotabela.h \
+    geradortabela.h \
+    modelocircuito.h \
+    leitorcircuito.h \
+    esquematico.h
 
 FORMS    += maincircuito.ui \
     modificarporta.ui \
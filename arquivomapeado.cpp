@@ -0,0 +1,188 @@
+#include "arquivomapeado.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+///
+/// CLASSE ARQUIVOMAPEADO
+///
+
+#ifdef _WIN32
+
+ArquivoMapeado::ArquivoMapeado():
+  ptr(nullptr), tam(0), escrita(false), hArq(INVALID_HANDLE_VALUE), hMap(nullptr)
+{
+}
+
+// Funcao auxiliar que mapeia o arquivo jah aberto em hArq
+static bool mapear(void* hArq, uint64_t tam, bool escrita, void*& hMap, uint8_t*& ptr)
+{
+  hMap = CreateFileMappingA(hArq, nullptr, escrita ? PAGE_READWRITE : PAGE_READONLY,
+                            DWORD(tam>>32), DWORD(tam & 0xFFFFFFFF), nullptr);
+  if (hMap==nullptr) return false;
+  ptr = (uint8_t*)MapViewOfFile(hMap, escrita ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+  return (ptr!=nullptr);
+}
+
+bool ArquivoMapeado::abrir(const std::string& arq, bool Escrita)
+{
+  fechar();
+  hArq = CreateFileA(arq.c_str(), Escrita ? (GENERIC_READ|GENERIC_WRITE) : GENERIC_READ,
+                     FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hArq==INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER t;
+  if (!GetFileSizeEx(hArq, &t)) {fechar(); return false;}
+  tam = uint64_t(t.QuadPart);
+  escrita = Escrita;
+  // Um arquivo vazio nao pode ser mapeado, mas eh aberto normalmente
+  if (tam>0 && !mapear(hArq, tam, escrita, hMap, ptr)) {fechar(); return false;}
+  return true;
+}
+
+bool ArquivoMapeado::criar(const std::string& arq, uint64_t Tamanho)
+{
+  fechar();
+  hArq = CreateFileA(arq.c_str(), GENERIC_READ|GENERIC_WRITE, 0, nullptr,
+                     CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hArq==INVALID_HANDLE_VALUE) return false;
+  // Um arquivo que nao eh esparso tem todo o espaco alocado por SetEndOfFile, que
+  // falha (ERROR_DISK_FULL) se o disco nao tiver espaco
+  LARGE_INTEGER t;
+  t.QuadPart = LONGLONG(Tamanho);
+  tam = Tamanho;
+  escrita = true;
+  if (!SetFilePointerEx(hArq, t, nullptr, FILE_BEGIN) || !SetEndOfFile(hArq) ||
+      (tam>0 && !mapear(hArq, tam, escrita, hMap, ptr)))
+  {
+    fechar();
+    DeleteFileA(arq.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ArquivoMapeado::sincronizar()
+{
+  if (ptr==nullptr) return aberto();
+  return FlushViewOfFile(ptr, 0) && FlushFileBuffers(hArq);
+}
+
+void ArquivoMapeado::fechar()
+{
+  if (ptr!=nullptr) UnmapViewOfFile(ptr);
+  if (hMap!=nullptr) CloseHandle(hMap);
+  if (hArq!=INVALID_HANDLE_VALUE) CloseHandle(hArq);
+  ptr = nullptr;
+  hMap = nullptr;
+  hArq = INVALID_HANDLE_VALUE;
+  tam = 0;
+  escrita = false;
+}
+
+bool ArquivoMapeado::aberto() const
+{
+  return (hArq!=INVALID_HANDLE_VALUE);
+}
+
+#else
+
+ArquivoMapeado::ArquivoMapeado():
+  ptr(nullptr), tam(0), escrita(false), fd(-1)
+{
+}
+
+bool ArquivoMapeado::abrir(const std::string& arq, bool Escrita)
+{
+  fechar();
+  fd = ::open(arq.c_str(), Escrita ? O_RDWR : O_RDONLY);
+  if (fd<0) return false;
+  struct stat st;
+  if (fstat(fd, &st)!=0) {fechar(); return false;}
+  tam = uint64_t(st.st_size);
+  escrita = Escrita;
+  // Um arquivo vazio nao pode ser mapeado, mas eh aberto normalmente
+  if (tam>0)
+  {
+    void* p = mmap(nullptr, tam, escrita ? (PROT_READ|PROT_WRITE) : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    if (p==MAP_FAILED) {fechar(); return false;}
+    ptr = (uint8_t*)p;
+  }
+  return true;
+}
+
+bool ArquivoMapeado::criar(const std::string& arq, uint64_t Tamanho)
+{
+  fechar();
+  fd = ::open(arq.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+  if (fd<0) return false;
+  tam = Tamanho;
+  escrita = true;
+  if (tam>0)
+  {
+    // Os blocos sao alocados agora (ftruncate criaria um arquivo esparso, e a falta de
+    // espaco so apareceria na escrita das paginas, como SIGBUS)
+    void* p = MAP_FAILED;
+    if (posix_fallocate(fd, 0, off_t(tam))==0)
+    {
+      p = mmap(nullptr, tam, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (p==MAP_FAILED)
+    {
+      fechar();
+      ::unlink(arq.c_str());
+      return false;
+    }
+    ptr = (uint8_t*)p;
+  }
+  return true;
+}
+
+bool ArquivoMapeado::sincronizar()
+{
+  if (ptr==nullptr) return aberto();
+  return (msync(ptr, tam, MS_SYNC)==0);
+}
+
+void ArquivoMapeado::fechar()
+{
+  if (ptr!=nullptr) munmap(ptr, tam);
+  if (fd>=0) ::close(fd);
+  ptr = nullptr;
+  fd = -1;
+  tam = 0;
+  escrita = false;
+}
+
+bool ArquivoMapeado::aberto() const
+{
+  return (fd>=0);
+}
+
+#endif
+
+ArquivoMapeado::~ArquivoMapeado()
+{
+  fechar();
+}
+
+uint64_t ArquivoMapeado::tamanho() const
+{
+  return tam;
+}
+
+const uint8_t* ArquivoMapeado::dados() const
+{
+  return ptr;
+}
+
+uint8_t* ArquivoMapeado::dadosEscrita()
+{
+  return (escrita ? ptr : nullptr);
+}
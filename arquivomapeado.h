@@ -0,0 +1,67 @@
+#ifndef _ARQUIVOMAPEADO_H_
+#define _ARQUIVOMAPEADO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+///
+/// CLASSE ARQUIVOMAPEADO
+///
+
+// Um arquivo mapeado em memoria (mmap no POSIX, MapViewOfFile no Windows)
+// Permite acessar qualquer posicao do arquivo diretamente, sem ler o arquivo
+// inteiro para a memoria: o sistema operacional carrega apenas as paginas
+// que forem efetivamente acessadas
+class ArquivoMapeado {
+private:
+  // Inicio da area mapeada (nullptr se nao houver arquivo aberto)
+  uint8_t* ptr;
+  // Tamanho em bytes da area mapeada
+  uint64_t tam;
+  // Se o mapeamento permite escrita
+  bool escrita;
+#ifdef _WIN32
+  void* hArq;
+  void* hMap;
+#else
+  int fd;
+#endif
+
+public:
+  ArquivoMapeado();
+  // Destrutor: apenas chama a funcao fechar()
+  ~ArquivoMapeado();
+
+  // Nao pode ser copiado (o mapeamento pertence a um unico objeto)
+  ArquivoMapeado(const ArquivoMapeado&) = delete;
+  void operator=(const ArquivoMapeado&) = delete;
+
+  // Abre um arquivo existente e mapeia todo o seu conteudo
+  // Retorna true se deu tudo OK; false se deu erro
+  bool abrir(const std::string& arq, bool Escrita=false);
+
+  // Cria (ou trunca) um arquivo com Tamanho bytes, todos nulos, e o mapeia para escrita
+  // O espaco em disco eh reservado aqui: sem isso, um disco cheio so apareceria ao
+  // escrever nas paginas mapeadas, e o processo morreria (SIGBUS) em vez de receber
+  // um erro
+  // Retorna true se deu tudo OK; false se deu erro (inclusive falta de espaco), e nesse
+  // caso o arquivo eh apagado
+  bool criar(const std::string& arq, uint64_t Tamanho);
+
+  // Grava no disco as paginas alteradas (msync, FlushViewOfFile)
+  // Retorna true se deu tudo OK; false se deu erro de escrita
+  bool sincronizar();
+
+  // Desfaz o mapeamento e fecha o arquivo
+  void fechar();
+
+  // Consultas
+  bool aberto() const;
+  uint64_t tamanho() const;
+  const uint8_t* dados() const;
+  // Soh deve ser usada se o arquivo foi aberto para escrita (retorna nullptr caso contrario)
+  uint8_t* dadosEscrita();
+};
+
+#endif // _ARQUIVOMAPEADO_H_
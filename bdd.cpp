@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include "bdd.h"
+#include "circuito.h"
+#include "circuitoplano.h"
+#include "rastro.h"
+
+// Os tamanhos iniciais da tabela unica e da tabela de resultados e o tamanho maximo da
+// tabela de resultados (em entradas de 16 bytes)
+static const size_t TAM_INICIAL_TABELAS = size_t(1)<<12;
+static const size_t TAM_MAXIMO_CACHE = size_t(1)<<20;
+
+// Mistura tres numeros em um hash (para a tabela unica e a tabela de resultados)
+static inline uint64_t misturar(uint64_t A, uint64_t B, uint64_t C)
+{
+  uint64_t h = A*0x9E3779B97F4A7C15ULL ^ B*0xC2B2AE3D27D4EB4FULL ^ C*0x165667B19E3779F9ULL;
+  return h ^ (h>>31);
+}
+
+///
+/// CLASSE BDD
+///
+
+const BDD::No BDD::FALSO;
+const BDD::No BDD::VERDADEIRO;
+const size_t BDD::MAX_NOS_PADRAO;
+
+BDD::BDD(unsigned NumVars, size_t MaxNos):
+  Nvars(0), maxNos(0), nos(), tabelaUnica(), cache(), estourado(false)
+{
+  clear(NumVars, MaxNos);
+}
+
+void BDD::clear(unsigned NumVars, size_t MaxNos)
+{
+  Nvars = NumVars;
+  // Os nos sao numerados com 32 bits
+  maxNos = std::min<size_t>(std::max<size_t>(MaxNos, 2), UINT32_MAX);
+  nos.clear();
+  nos.push_back(NoBDD{Nvars, FALSO, FALSO, FALSO});
+  nos.push_back(NoBDD{Nvars, VERDADEIRO, VERDADEIRO, FALSO});
+  tabelaUnica.assign(TAM_INICIAL_TABELAS, FALSO);
+  cache.assign(TAM_INICIAL_TABELAS, ResultadoIte{FALSO, FALSO, FALSO, FALSO});
+  estourado = false;
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+unsigned BDD::getNumVars() const
+{
+  return Nvars;
+}
+
+size_t BDD::getNumNos() const
+{
+  return nos.size();
+}
+
+bool BDD::getEstourado() const
+{
+  return estourado;
+}
+
+unsigned BDD::variavelNo(No f) const
+{
+  return nos[f].var;
+}
+
+BDD::No BDD::baixo(No f) const
+{
+  return nos[f].baixo;
+}
+
+BDD::No BDD::alto(No f) const
+{
+  return nos[f].alto;
+}
+
+size_t BDD::tamanho(No f) const
+{
+  return tamanho(std::vector<No>(1, f));
+}
+
+size_t BDD::tamanho(const std::vector<No>& raizes) const
+{
+  std::vector<bool> visitado(nos.size(), false);
+  std::vector<No> pilha(raizes);
+  size_t N = 0;
+  while (!pilha.empty())
+  {
+    No f = pilha.back();
+    pilha.pop_back();
+    if (visitado[f]) continue;
+    visitado[f] = true;
+    N++;
+    if (f>VERDADEIRO)
+    {
+      pilha.push_back(nos[f].baixo);
+      pilha.push_back(nos[f].alto);
+    }
+  }
+  return N;
+}
+
+// Numero de atribuicoes das variaveis de B.variavelNo(f) em diante em que f eh
+// verdadeira (memo: os nos jah contados)
+static double contarAbaixo(const BDD& B, BDD::No f, std::unordered_map<BDD::No,double>& memo)
+{
+  if (f<=BDD::VERDADEIRO) return double(f);
+  auto it = memo.find(f);
+  if (it!=memo.end()) return it->second;
+  // Cada filho conta as suas variaveis; as que ficam entre o no e o filho sao livres
+  unsigned v = B.variavelNo(f);
+  BDD::No b = B.baixo(f), a = B.alto(f);
+  double N = std::ldexp(contarAbaixo(B, b, memo), int(B.variavelNo(b)-v-1)) +
+             std::ldexp(contarAbaixo(B, a, memo), int(B.variavelNo(a)-v-1));
+  memo[f] = N;
+  return N;
+}
+
+double BDD::contarModelos(No f) const
+{
+  std::unordered_map<No,double> memo;
+  return std::ldexp(contarAbaixo(*this, f, memo), int(nos[f].var));
+}
+
+bool BDD::exemplo(No f, std::vector<bool>& valores) const
+{
+  valores.assign(Nvars, false);
+  if (f==FALSO) return false;
+  // Em um BDD reduzido, todo no diferente de FALSO tem alguma atribuicao verdadeira
+  while (f!=VERDADEIRO)
+  {
+    if (nos[f].baixo!=FALSO) f = nos[f].baixo;
+    else
+    {
+      valores[nos[f].var] = true;
+      f = nos[f].alto;
+    }
+  }
+  return true;
+}
+
+bool BDD::avaliar(No f, const std::vector<bool>& valores) const
+{
+  while (f>VERDADEIRO) f = (valores[nos[f].var] ? nos[f].alto : nos[f].baixo);
+  return f==VERDADEIRO;
+}
+
+/// ***********************
+/// Operacoes
+/// ***********************
+
+BDD::No BDD::criar(uint32_t Var, No Baixo, No Alto)
+{
+  // Um teste cujos dois lados sao iguais eh desnecessario
+  if (Baixo==Alto) return Baixo;
+  size_t b = size_t(misturar(Var, Baixo, Alto)) & (tabelaUnica.size()-1);
+  for (No n=tabelaUnica[b]; n!=FALSO; n=nos[n].proximo)
+  {
+    if (nos[n].var==Var && nos[n].baixo==Baixo && nos[n].alto==Alto) return n;
+  }
+  if (estourado || nos.size()>=maxNos)
+  {
+    estourado = true;
+    return FALSO;
+  }
+  No n = No(nos.size());
+  nos.push_back(NoBDD{Var, Baixo, Alto, tabelaUnica[b]});
+  tabelaUnica[b] = n;
+  if (nos.size()>tabelaUnica.size()) crescerTabelas();
+  return n;
+}
+
+void BDD::crescerTabelas()
+{
+  tabelaUnica.assign(2*tabelaUnica.size(), FALSO);
+  size_t mascara = tabelaUnica.size()-1;
+  for (No n=2; n<nos.size(); n++)
+  {
+    size_t b = size_t(misturar(nos[n].var, nos[n].baixo, nos[n].alto)) & mascara;
+    nos[n].proximo = tabelaUnica[b];
+    tabelaUnica[b] = n;
+  }
+  // Os resultados guardados se perdem (a tabela de resultados eh soh uma cache)
+  if (cache.size()<TAM_MAXIMO_CACHE)
+  {
+    cache.assign(2*cache.size(), ResultadoIte{FALSO, FALSO, FALSO, FALSO});
+  }
+}
+
+BDD::No BDD::variavel(unsigned V)
+{
+  if (V>=Nvars) return FALSO;
+  return criar(V, FALSO, VERDADEIRO);
+}
+
+BDD::No BDD::ite(No F, No G, No H)
+{
+  // Os casos terminais (nunca vao para a tabela de resultados, entao uma entrada
+  // vazia, toda FALSO, nunca eh encontrada)
+  if (F==VERDADEIRO) return G;
+  if (F==FALSO) return H;
+  if (G==F) G = VERDADEIRO;
+  if (H==F) H = FALSO;
+  if (G==H) return G;
+  if (G==VERDADEIRO && H==FALSO) return F;
+
+  size_t c = size_t(misturar(F, G, H));
+  const ResultadoIte& R = cache[c & (cache.size()-1)];
+  if (R.f==F && R.g==G && R.h==H) return R.r;
+
+  // Expansao de Shannon na primeira variavel testada por F, G ou H
+  uint32_t v = std::min(nos[F].var, std::min(nos[G].var, nos[H].var));
+  No F0 = F, F1 = F, G0 = G, G1 = G, H0 = H, H1 = H;
+  if (nos[F].var==v) {F0 = nos[F].baixo; F1 = nos[F].alto;}
+  if (nos[G].var==v) {G0 = nos[G].baixo; G1 = nos[G].alto;}
+  if (nos[H].var==v) {H0 = nos[H].baixo; H1 = nos[H].alto;}
+  No B = ite(F0, G0, H0);
+  No A = ite(F1, G1, H1);
+  No r = criar(v, B, A);
+
+  // A tabela de resultados pode ter crescido nas chamadas acima
+  if (!estourado) cache[c & (cache.size()-1)] = ResultadoIte{F, G, H, r};
+  return r;
+}
+
+BDD::No BDD::negar(No F)
+{
+  return ite(F, FALSO, VERDADEIRO);
+}
+
+BDD::No BDD::e(No F, No G)
+{
+  return ite(F, G, FALSO);
+}
+
+BDD::No BDD::ou(No F, No G)
+{
+  return ite(F, VERDADEIRO, G);
+}
+
+BDD::No BDD::xou(No F, No G)
+{
+  return ite(F, negar(G), G);
+}
+
+// Os dois trilhos de um sinal: os BDDs de "o sinal vale T" e de "o sinal vale F"
+struct TrilhosBDD {
+  BDD::No t;
+  BDD::No f;
+};
+
+// Os operadores de bool3S nos dois trilhos (as mesmas regras de SimuladorLote, com
+// operacoes de BDDs no lugar das operacoes bit a bit), para avaliarPorta
+struct OperacoesBDD {
+  BDD& bdd;
+
+  TrilhosBDD nao(const TrilhosBDD& A) const {return TrilhosBDD{A.f, A.t};}
+  TrilhosBDD e(const TrilhosBDD& A, const TrilhosBDD& B) const
+  {
+    return TrilhosBDD{bdd.e(A.t, B.t), bdd.ou(A.f, B.f)};
+  }
+  TrilhosBDD ou(const TrilhosBDD& A, const TrilhosBDD& B) const
+  {
+    return TrilhosBDD{bdd.ou(A.t, B.t), bdd.e(A.f, B.f)};
+  }
+  TrilhosBDD xou(const TrilhosBDD& A, const TrilhosBDD& B) const
+  {
+    return TrilhosBDD{bdd.ou(bdd.e(A.t, B.f), bdd.e(A.f, B.t)),
+                      bdd.ou(bdd.e(A.t, B.t), bdd.e(A.f, B.f))};
+  }
+  TrilhosBDD indefinido() const {return TrilhosBDD{BDD::FALSO, BDD::FALSO};}
+};
+
+///
+/// CLASSE BDDCIRCUITO
+///
+
+// Calcula em ordem as entradas (0 a NumInputs-1) de C na ordem da heuristica H
+static void ordenarEntradas(const Circuito& C, OrdemBDD H, std::vector<unsigned>& ordem)
+{
+  unsigned Nin = C.getNumInputs();
+  ordem.clear();
+  std::vector<bool> usada(Nin, false);
+  if (H==OrdemBDD::PROFUNDIDADE)
+  {
+    std::vector<unsigned> nivel;
+    C.calcularNiveis(nivel);
+    auto nivelId = [&nivel](int id) {return (id<0 ? 0u : nivel[id-1]);};
+    // Busca em profundidade (em pre-ordem) com uma pilha explicita: um circuito
+    // profundo estouraria a pilha de chamadas. Uma porta eh marcada quando sai da
+    // pilha, e as suas origens entram em ordem inversa, para sair na ordem da busca
+    std::vector<bool> visitada(C.getNumPorts(), false);
+    std::vector<int> pilha, origens;
+    for (unsigned k=C.getNumOutputs(); k>0; k--) pilha.push_back(C.getIdOutput(int(k)));
+    while (!pilha.empty())
+    {
+      int id = pilha.back();
+      pilha.pop_back();
+      if (id<0)
+      {
+        if (!usada[-id-1]) ordem.push_back(unsigned(-id-1));
+        usada[-id-1] = true;
+        continue;
+      }
+      if (visitada[id-1]) continue;
+      visitada[id-1] = true;
+      origens.clear();
+      for (unsigned j=0; j<C.getNumInputsPort(id); j++) origens.push_back(C.getId_inPort(id, j));
+      std::stable_sort(origens.begin(), origens.end(),
+                       [&nivelId](int a, int b) {return nivelId(a)>nivelId(b);});
+      pilha.insert(pilha.end(), origens.rbegin(), origens.rend());
+    }
+  }
+  // As entradas que nao apareceram (todas, com NATURAL), na ordem das ids
+  for (unsigned j=0; j<Nin; j++) if (!usada[j]) ordem.push_back(j);
+}
+
+BDDCircuito::BDDCircuito():
+  bdd(), Nin(0), tresValores(false), ordem(), posicao(), canonicas(BDD::VERDADEIRO)
+{
+}
+
+void BDDCircuito::preparar(const Circuito& C, OrdemBDD H, bool TresValores, size_t MaxNos)
+{
+  Nin = C.getNumInputs();
+  tresValores = TresValores;
+  ordenarEntradas(C, H, ordem);
+  posicao.resize(Nin);
+  for (unsigned k=0; k<Nin; k++) posicao[ordem[k]] = k;
+  bdd.clear(tresValores ? 2*Nin : Nin, MaxNos);
+  canonicas = BDD::VERDADEIRO;
+  if (tresValores)
+  {
+    for (unsigned k=Nin; k>0; k--)
+    {
+      BDD::No definida = bdd.variavel(2*(k-1)), valor = bdd.variavel(2*(k-1)+1);
+      canonicas = bdd.e(bdd.ou(definida, bdd.negar(valor)), canonicas);
+    }
+  }
+}
+
+bool BDDCircuito::construir(const Circuito& C, std::vector<BDD::No>& saidasT,
+                            std::vector<BDD::No>& saidasF)
+{
+  CircuitoPlano P;
+  if (C.getNumInputs()!=Nin || !P.montar(C)) return false;
+  RASTRO("construir BDDs", int64_t(P.Nports));
+  // Os trilhos de cada sinal
+  std::vector<TrilhosBDD> V(Nin+P.Nports, TrilhosBDD{BDD::FALSO, BDD::FALSO});
+  for (unsigned j=0; j<Nin; j++)
+  {
+    if (tresValores)
+    {
+      BDD::No definida = bdd.variavel(2*posicao[j]), valor = bdd.variavel(2*posicao[j]+1);
+      V[j].t = bdd.e(definida, valor);
+      V[j].f = bdd.e(definida, bdd.negar(valor));
+    }
+    else
+    {
+      V[j].t = bdd.variavel(posicao[j]);
+      V[j].f = bdd.negar(V[j].t);
+    }
+  }
+
+  // As portas em ordem de nivel: sem lacos, uma passada basta; com lacos, passadas
+  // ateh que nenhum no mude (os trilhos soh crescem: os valores soh passam de UNDEF
+  // para F ou T)
+  OperacoesBDD Op{bdd};
+  bool mudou;
+  do
+  {
+    mudou = false;
+    for (unsigned k=0; k<P.Nports; k++)
+    {
+      const unsigned* O = P.origens.data()+P.inicioOrigens[k];
+      const TrilhosBDD* E = V.data();
+      TrilhosBDD S = avaliarPorta<TrilhosBDD>(P.tipos[k], P.inicioOrigens[k+1]-P.inicioOrigens[k],
+                                              [O, E](unsigned j) {return E[O[j]];}, Op);
+      if (bdd.getEstourado()) return false;
+      TrilhosBDD& D = V[P.sinais[k]];
+      if (S.t!=D.t || S.f!=D.f)
+      {
+        D = S;
+        mudou = true;
+      }
+    }
+  }
+  while (!P.semLacos && mudou);
+
+  saidasT.resize(P.saidas.size());
+  saidasF.resize(P.saidas.size());
+  for (unsigned i=0; i<P.saidas.size(); i++)
+  {
+    saidasT[i] = V[P.saidas[i]].t;
+    saidasF[i] = V[P.saidas[i]].f;
+  }
+  return true;
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+BDD& BDDCircuito::getBDD()
+{
+  return bdd;
+}
+
+const BDD& BDDCircuito::getBDD() const
+{
+  return bdd;
+}
+
+unsigned BDDCircuito::getNumInputs() const
+{
+  return Nin;
+}
+
+bool BDDCircuito::getTresValores() const
+{
+  return tresValores;
+}
+
+const std::vector<unsigned>& BDDCircuito::getOrdem() const
+{
+  return ordem;
+}
+
+double BDDCircuito::contarEntradas(BDD::No f)
+{
+  // Com tresValores, uma entrada UNDEF corresponde a duas atribuicoes (o valor eh livre):
+  // soh a que tem o valor falso eh contada
+  return bdd.contarModelos(tresValores ? bdd.e(f, canonicas) : f);
+}
+
+bool BDDCircuito::exemploEntradas(BDD::No f, std::vector<bool3S>& in_circ) const
+{
+  std::vector<bool> valores;
+  bool existe = bdd.exemplo(f, valores);
+  in_circ.assign(Nin, bool3S::UNDEF);
+  for (unsigned j=0; j<Nin; j++)
+  {
+    unsigned k = posicao[j];
+    if (tresValores && !valores[2*k]) continue;
+    in_circ[j] = (valores[tresValores ? 2*k+1 : k] ? bool3S::TRUE : bool3S::FALSE);
+  }
+  return existe;
+}
+
+bool3S BDDCircuito::avaliar(BDD::No T, BDD::No F, const bool3S* in_circ) const
+{
+  std::vector<bool> valores(bdd.getNumVars(), false);
+  for (unsigned j=0; j<Nin; j++)
+  {
+    unsigned k = posicao[j];
+    if (tresValores)
+    {
+      valores[2*k] = (in_circ[j]!=bool3S::UNDEF);
+      valores[2*k+1] = (in_circ[j]==bool3S::TRUE);
+    }
+    else valores[k] = (in_circ[j]==bool3S::TRUE);
+  }
+  if (bdd.avaliar(T, valores)) return bool3S::TRUE;
+  if (bdd.avaliar(F, valores)) return bool3S::FALSE;
+  return bool3S::UNDEF;
+}
@@ -0,0 +1,194 @@
+#ifndef _BDD_H_
+#define _BDD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+
+class Circuito;
+
+///
+/// CLASSE BDD
+///
+
+// Diagramas de decisao binaria reduzidos e ordenados (ROBDD) das funcoes booleanas das
+// variaveis 0 a NumVars-1, testadas nessa ordem (a variavel 0 no topo).
+// Cada funcao tem um unico no (a forma eh canonica): duas funcoes sao iguais se e
+// somente se tem o mesmo no, e as consultas (satisfazibilidade, contagem de modelos,
+// um exemplo) custam tempo proporcional ao tamanho do BDD, e nao a 2^NumVars.
+// Os nos ficam em um vetor (um no eh o seu indice; FALSO e VERDADEIRO sao os nos 0 e
+// 1) e soh sao liberados por clear. A tabela unica (hash de variavel, baixo e alto)
+// garante que nao existam dois nos iguais; a tabela de resultados (uma cache de
+// substituicao direta) guarda os resultados recentes de ite, do qual dependem todas as
+// outras operacoes.
+// O numero de nos eh limitado (maxNos): uma operacao que passaria do limite marca o BDD
+// como estourado e, a partir dai, os resultados nao valem mais (ateh clear).
+class BDD {
+public:
+  typedef uint32_t No;
+  static const No FALSO = 0;
+  static const No VERDADEIRO = 1;
+  // O limite padrao do numero de nos (cada no ocupa 16 bytes, mais a tabela unica)
+  static const size_t MAX_NOS_PADRAO = size_t(1)<<22;
+
+private:
+  struct NoBDD {
+    // A variavel testada (NumVars nas constantes), os filhos para a variavel F e T e o
+    // proximo no do mesmo balde da tabela unica
+    uint32_t var;
+    No baixo;
+    No alto;
+    No proximo;
+  };
+  struct ResultadoIte {
+    No f, g, h, r;
+  };
+
+  unsigned Nvars;
+  size_t maxNos;
+  std::vector<NoBDD> nos;
+  // Os baldes da tabela unica (o primeiro no de cada um, ou FALSO se vazio) e a tabela
+  // de resultados, ambos com tamanho potencia de 2
+  std::vector<No> tabelaUnica;
+  std::vector<ResultadoIte> cache;
+  bool estourado;
+
+  // O no (Var, Baixo, Alto), criado se ainda nao existir
+  No criar(uint32_t Var, No Baixo, No Alto);
+  // Dobra a tabela unica (e a tabela de resultados, ateh um limite)
+  void crescerTabelas();
+
+public:
+  explicit BDD(unsigned NumVars=0, size_t MaxNos=MAX_NOS_PADRAO);
+
+  // Libera todos os nos e passa a usar NumVars variaveis
+  void clear(unsigned NumVars, size_t MaxNos=MAX_NOS_PADRAO);
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  unsigned getNumVars() const;
+  // Numero de nos criados (incluindo as duas constantes)
+  size_t getNumNos() const;
+  // Retorna true se alguma operacao passou do limite de nos
+  bool getEstourado() const;
+
+  // A variavel testada por um no e os seus dois filhos (F e T)
+  // (nas constantes, a variavel eh NumVars e os filhos sao a propria constante)
+  unsigned variavelNo(No f) const;
+  No baixo(No f) const;
+  No alto(No f) const;
+
+  // Numero de nos alcancaveis a partir de f (ou de todas as raizes), com as constantes
+  size_t tamanho(No f) const;
+  size_t tamanho(const std::vector<No>& raizes) const;
+
+  // Numero de atribuicoes das NumVars variaveis em que f eh verdadeira
+  // (exato ateh 2^53, aproximado acima disso)
+  double contarModelos(No f) const;
+
+  // Uma atribuicao em que f eh verdadeira, em valores (NumVars valores): as variaveis
+  // livres ficam falsas
+  // Retorna false se f for FALSO (insatisfazivel)
+  bool exemplo(No f, std::vector<bool>& valores) const;
+
+  // O valor de f para a atribuicao valores (NumVars valores)
+  bool avaliar(No f, const std::vector<bool>& valores) const;
+
+  /// ***********************
+  /// Operacoes
+  /// ***********************
+
+  // A funcao que vale a variavel V (V<NumVars)
+  No variavel(unsigned V);
+
+  // Se F entao G senao H: a operacao basica, da qual derivam as demais
+  No ite(No F, No G, No H);
+
+  No negar(No F);
+  No e(No F, No G);
+  No ou(No F, No G);
+  No xou(No F, No G);
+};
+
+///
+/// BDDS DAS SAIDAS DE UM CIRCUITO
+///
+
+// As heuristicas de ordem das entradas nas variaveis (a ordem pode mudar o tamanho
+// dos BDDs de linear para exponencial no numero de entradas, por exemplo em um
+// somador: os bits de mesmo peso dos dois operandos devem ficar juntos)
+enum class OrdemBDD {
+  // Na ordem das ids: -1, -2, ...
+  NATURAL,
+  // Na ordem em que as entradas aparecem em uma busca em profundidade a partir das
+  // saidas, visitando primeiro as origens de maior nivel: as entradas que se combinam
+  // nas mesmas portas ficam proximas
+  PROFUNDIDADE
+};
+
+///
+/// CLASSE BDDCIRCUITO
+///
+
+// Os BDDs das saidas de circuitos com as mesmas entradas, em um mesmo BDD (as funcoes
+// de dois circuitos podem ser comparadas pelos nos).
+// Cada sinal eh representado por dois BDDs, como os dois trilhos de SimuladorLote:
+// o sinal vale T e o sinal vale F (nenhum dos dois: UNDEF). As portas calculam os
+// trilhos com as mesmas regras de bool3S; os lacos sao calculados por passadas a partir
+// de UNDEF ateh que nenhum no mude, o mesmo ponto fixo de Circuito::simular, e os
+// flip-flops (DF) valem sempre UNDEF.
+// Com entradas soh F e T, cada entrada eh uma variavel. Com tresValores, as entradas
+// tambem podem ser UNDEF e cada uma usa duas variaveis seguidas: definida e valor.
+class BDDCircuito {
+private:
+  BDD bdd;
+  unsigned Nin;
+  bool tresValores;
+  // A entrada (0 a NumInputs-1) em cada posicao da ordem e a posicao de cada entrada
+  std::vector<unsigned> ordem;
+  std::vector<unsigned> posicao;
+  // Com tresValores, a restricao "valor falso quando a entrada nao eh definida", que
+  // deixa uma unica atribuicao das variaveis para cada combinacao de entradas
+  BDD::No canonicas;
+
+public:
+  BDDCircuito();
+
+  // Esvazia o BDD e prepara para circuitos com as entradas de C, na ordem H
+  void preparar(const Circuito& C, OrdemBDD H=OrdemBDD::PROFUNDIDADE,
+                bool TresValores=false, size_t MaxNos=BDD::MAX_NOS_PADRAO);
+
+  // Calcula os trilhos T e F de cada saida de C (saidasT[IdOutput-1] ...)
+  // Retorna false se C nao for valido, se o numero de entradas for diferente do
+  // preparado ou se o limite de nos foi excedido
+  bool construir(const Circuito& C, std::vector<BDD::No>& saidasT,
+                 std::vector<BDD::No>& saidasF);
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  BDD& getBDD();
+  const BDD& getBDD() const;
+  unsigned getNumInputs() const;
+  bool getTresValores() const;
+  // As entradas (0 a NumInputs-1) na ordem das variaveis
+  const std::vector<unsigned>& getOrdem() const;
+
+  // Numero de combinacoes de entradas (2^NI, ou 3^NI com tresValores) em que f eh
+  // verdadeira (exato ateh 2^53)
+  double contarEntradas(BDD::No f);
+
+  // Uma combinacao de entradas (NumInputs valores) em que f eh verdadeira
+  // Retorna false se nao houver nenhuma
+  bool exemploEntradas(BDD::No f, std::vector<bool3S>& in_circ) const;
+
+  // O valor do sinal de trilhos T e F para as entradas in_circ (NumInputs valores;
+  // sem tresValores, uma entrada UNDEF conta como F)
+  bool3S avaliar(BDD::No T, BDD::No F, const bool3S* in_circ) const;
+};
+
+#endif // _BDD_H_
@@ -0,0 +1,394 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include "cachetabelas.h"
+#include "circuito.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Primeira linha do arquivo de indice (identificacao e versao)
+static const char CABECALHO_INDICE[] = "CACHE_TVD 1";
+
+// Tamanho de um arquivo em bytes (0 se nao existir)
+static uint64_t tamanhoArquivo(const std::string& nome)
+{
+  std::ifstream arq(nome, std::ios::binary | std::ios::ate);
+  if (!arq.is_open()) return 0;
+  std::streamoff t = arq.tellg();
+  return (t>0 ? uint64_t(t) : 0);
+}
+
+// Um nome de arquivo temporario para nome, diferente em cada chamada, em cada thread e
+// em cada processo (varias instancias podem gravar o mesmo arquivo ao mesmo tempo)
+static std::string nomeTemporario(const std::string& nome)
+{
+  static std::atomic<unsigned> contador(0);
+#ifdef _WIN32
+  unsigned long processo = GetCurrentProcessId();
+#else
+  unsigned long processo = (unsigned long)getpid();
+#endif
+  return nome+"."+std::to_string(processo)+"."+std::to_string(contador++)+".tmp";
+}
+
+// Substitui o arquivo destino pelo arquivo temporario tmp (rename substitui o destino
+// de uma vez: quem abrir destino encontra o arquivo antigo ou o novo)
+static bool substituirArquivo(const std::string& tmp, const std::string& destino)
+{
+#ifdef _WIN32
+  // No Windows, rename falha se o destino jah existir
+  std::remove(destino.c_str());
+#endif
+  if (std::rename(tmp.c_str(), destino.c_str())!=0)
+  {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Copia o arquivo origem para o arquivo (novo) destino
+static bool gravarCopia(const std::string& origem, const std::string& destino)
+{
+  std::ifstream in(origem, std::ios::binary);
+  if (!in.is_open()) return false;
+  std::ofstream out(destino, std::ios::binary);
+  if (!out.is_open()) return false;
+  out << in.rdbuf();
+  out.close();
+  if (in.bad() || out.fail())
+  {
+    std::remove(destino.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Copia o arquivo origem para destino (atraves de um arquivo temporario, para que
+// destino nunca fique pela metade)
+static bool copiarArquivo(const std::string& origem, const std::string& destino)
+{
+  std::string tmp = nomeTemporario(destino);
+  return gravarCopia(origem, tmp) && substituirArquivo(tmp, destino);
+}
+
+///
+/// TRAVA DO INDICE
+///
+
+// O mutex das threads do processo: a trava de arquivo nao basta, porque no POSIX as
+// travas de fcntl pertencem ao processo, e nao a thread
+static std::mutex mutexIndice;
+
+// Exclusao mutua no indice de um diretorio de cache, do construtor ao destrutor: entre
+// as threads do processo (mutexIndice) e entre processos (uma trava no arquivo
+// "indice.trava" do diretorio). Cada leitura-alteracao-gravacao do indice fica inteira
+// dentro de uma trava, para que uma instancia nao grave por cima das alteracoes de
+// outra. Se a trava de arquivo nao puder ser obtida (diretorio inexistente ou sem
+// permissao), fica soh a exclusao entre as threads
+class TravaIndice {
+private:
+  std::lock_guard<std::mutex> guarda;
+#ifdef _WIN32
+  HANDLE hArq;
+#else
+  int fd;
+#endif
+
+public:
+  explicit TravaIndice(const std::string& dir);
+  ~TravaIndice();
+  TravaIndice(const TravaIndice&) = delete;
+  TravaIndice& operator=(const TravaIndice&) = delete;
+};
+
+#ifdef _WIN32
+
+TravaIndice::TravaIndice(const std::string& dir):
+  guarda(mutexIndice), hArq(INVALID_HANDLE_VALUE)
+{
+  hArq = CreateFileA((dir+"indice.trava").c_str(), GENERIC_READ|GENERIC_WRITE,
+                     FILE_SHARE_READ|FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS,
+                     FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hArq==INVALID_HANDLE_VALUE) return;
+  OVERLAPPED ov = {};
+  if (!LockFileEx(hArq, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &ov))
+  {
+    CloseHandle(hArq);
+    hArq = INVALID_HANDLE_VALUE;
+  }
+}
+
+TravaIndice::~TravaIndice()
+{
+  if (hArq==INVALID_HANDLE_VALUE) return;
+  OVERLAPPED ov = {};
+  UnlockFileEx(hArq, 0, 1, 0, &ov);
+  CloseHandle(hArq);
+}
+
+#else
+
+TravaIndice::TravaIndice(const std::string& dir):
+  guarda(mutexIndice), fd(-1)
+{
+  fd = open((dir+"indice.trava").c_str(), O_RDWR|O_CREAT, 0666);
+  if (fd<0) return;
+  struct flock trava = {};
+  trava.l_type = F_WRLCK;
+  trava.l_whence = SEEK_SET;
+  // Espera a trava (uma interrupcao por sinal repete a espera)
+  while (fcntl(fd, F_SETLKW, &trava)!=0)
+  {
+    if (errno!=EINTR)
+    {
+      close(fd);
+      fd = -1;
+      return;
+    }
+  }
+}
+
+TravaIndice::~TravaIndice()
+{
+  // Fechar o arquivo libera a trava
+  if (fd>=0) close(fd);
+}
+
+#endif
+
+///
+/// CLASSE CACHETABELAS
+///
+
+const uint64_t CacheTabelas::TAMANHO_PADRAO = uint64_t(256)<<20;
+
+CacheTabelas::CacheTabelas(const std::string& Dir, uint64_t MaxBytes):
+  dir(Dir), maxBytes(MaxBytes), entradas(), total(0)
+{
+  if (!dir.empty() && dir.back()!='/' && dir.back()!='\\') dir += '/';
+}
+
+std::string CacheTabelas::nomeArquivo(const std::string& chave) const
+{
+  return dir+chave+".tvd";
+}
+
+void CacheTabelas::lerIndice()
+{
+  entradas.clear();
+  total = 0;
+  std::ifstream arq(dir+"indice");
+  std::string linha;
+  if (!std::getline(arq, linha) || linha!=CABECALHO_INDICE) return;
+  Entrada E;
+  while (arq >> E.chave >> E.tamanho)
+  {
+    // Uma chave repetida (indice corrompido) eh considerada apenas na ultima posicao
+    int i = procurar(E.chave);
+    if (i>=0)
+    {
+      total -= entradas[i].tamanho;
+      entradas.erase(entradas.begin()+i);
+    }
+    entradas.push_back(E);
+    total += E.tamanho;
+  }
+}
+
+bool CacheTabelas::salvarIndice() const
+{
+  std::string tmp = nomeTemporario(dir+"indice");
+  std::ofstream arq(tmp);
+  if (!arq.is_open()) return false;
+  arq << CABECALHO_INDICE << '\n';
+  for (unsigned i=0; i<entradas.size(); i++)
+  {
+    arq << entradas[i].chave << ' ' << entradas[i].tamanho << '\n';
+  }
+  arq.close();
+  if (arq.fail())
+  {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return substituirArquivo(tmp, dir+"indice");
+}
+
+int CacheTabelas::procurar(const std::string& chave) const
+{
+  for (unsigned i=0; i<entradas.size(); i++) if (entradas[i].chave==chave) return int(i);
+  return -1;
+}
+
+void CacheTabelas::usar(unsigned I)
+{
+  Entrada E = entradas[I];
+  entradas.erase(entradas.begin()+I);
+  entradas.push_back(E);
+}
+
+void CacheTabelas::acrescentar(const std::string& chave, uint64_t tamanho)
+{
+  int i = procurar(chave);
+  if (i>=0)
+  {
+    total -= entradas[i].tamanho;
+    entradas.erase(entradas.begin()+i);
+  }
+  Entrada E;
+  E.chave = chave;
+  E.tamanho = tamanho;
+  entradas.push_back(E);
+  total += tamanho;
+  // Apaga as tabelas usadas ha mais tempo ateh caber no limite
+  // (a tabela recem-gravada, a ultima, nunca eh apagada aqui)
+  while (total>maxBytes && entradas.size()>1)
+  {
+    std::remove(nomeArquivo(entradas.front().chave).c_str());
+    total -= entradas.front().tamanho;
+    entradas.erase(entradas.begin());
+  }
+  salvarIndice();
+}
+
+bool CacheTabelas::buscar(const std::string& chave, TabelaVerdade& T)
+{
+  T.clear();
+  if (chave.empty()) return false;
+  TravaIndice trava(dir);
+  lerIndice();
+  int i = procurar(chave);
+  if (i<0) return false;
+  if (!lerTabela(nomeArquivo(chave), T))
+  {
+    // O arquivo foi apagado ou estah corrompido: sai do indice
+    T.clear();
+    std::remove(nomeArquivo(chave).c_str());
+    total -= entradas[i].tamanho;
+    entradas.erase(entradas.begin()+i);
+    salvarIndice();
+    return false;
+  }
+  usar(unsigned(i));
+  salvarIndice();
+  return true;
+}
+
+bool CacheTabelas::buscarArquivo(const std::string& chave, const std::string& destino)
+{
+  if (chave.empty()) return false;
+  TravaIndice trava(dir);
+  lerIndice();
+  int i = procurar(chave);
+  if (i<0) return false;
+  // Confere o arquivo do cache antes de copia-lo
+  TabelaMapeada M;
+  bool ok = M.abrir(nomeArquivo(chave));
+  M.fechar();
+  if (!ok)
+  {
+    std::remove(nomeArquivo(chave).c_str());
+    total -= entradas[i].tamanho;
+    entradas.erase(entradas.begin()+i);
+    salvarIndice();
+    return false;
+  }
+  if (!copiarArquivo(nomeArquivo(chave), destino)) return false;
+  usar(unsigned(i));
+  salvarIndice();
+  return true;
+}
+
+bool CacheTabelas::guardar(const std::string& chave, const TabelaVerdade& T,
+                           const std::atomic<bool>* cancelado)
+{
+  if (chave.empty() || !T.completa()) return false;
+  uint64_t tamanho = tamanhoArquivoTabela(T.getNumInputs(), T.getNumOutputs());
+  if (tamanho>maxBytes) return false;
+  // A gravacao (demorada) fica fora da trava; soh a substituicao e o indice ficam dentro
+  std::string tmp = nomeTemporario(nomeArquivo(chave));
+  if (!salvarTabela(T, tmp, cancelado)) return false;
+  TravaIndice trava(dir);
+  lerIndice();
+  if (!substituirArquivo(tmp, nomeArquivo(chave))) return false;
+  acrescentar(chave, tamanho);
+  return true;
+}
+
+bool CacheTabelas::guardarArquivo(const std::string& chave, const std::string& origem)
+{
+  if (chave.empty()) return false;
+  uint64_t tamanho = tamanhoArquivo(origem);
+  if (tamanho==0 || tamanho>maxBytes) return false;
+  std::string tmp = nomeTemporario(nomeArquivo(chave));
+  if (!gravarCopia(origem, tmp)) return false;
+  TravaIndice trava(dir);
+  lerIndice();
+  if (!substituirArquivo(tmp, nomeArquivo(chave))) return false;
+  acrescentar(chave, tamanho);
+  return true;
+}
+
+void CacheTabelas::limpar()
+{
+  TravaIndice trava(dir);
+  lerIndice();
+  for (unsigned i=0; i<entradas.size(); i++) std::remove(nomeArquivo(entradas[i].chave).c_str());
+  entradas.clear();
+  total = 0;
+  salvarIndice();
+}
+
+const std::string& CacheTabelas::getDiretorio() const
+{
+  return dir;
+}
+
+uint64_t CacheTabelas::getMaxBytes() const
+{
+  return maxBytes;
+}
+
+uint64_t CacheTabelas::getTamanho()
+{
+  TravaIndice trava(dir);
+  lerIndice();
+  return total;
+}
+
+unsigned CacheTabelas::getNumTabelas()
+{
+  TravaIndice trava(dir);
+  lerIndice();
+  return unsigned(entradas.size());
+}
+
+bool gerarTabela(Circuito& C, TabelaVerdade& T, CacheTabelas& cache)
+{
+  std::string chave = C.impressaoDigital();
+  if (chave.empty()) return false;
+  if (cache.buscar(chave, T) &&
+      T.getNumInputs()==C.getNumInputs() && T.getNumOutputs()==C.getNumOutputs()) return true;
+  if (!gerarTabela(C, T)) return false;
+  cache.guardar(chave, T);
+  return true;
+}
+
+bool gerarTabelaArquivo(Circuito& C, const std::string& nome, CacheTabelas& cache,
+                        ProgressoTabela* P)
+{
+  std::string chave = C.impressaoDigital();
+  if (chave.empty()) return false;
+  if (cache.buscarArquivo(chave, nome)) return true;
+  if (!gerarTabelaArquivo(C, nome, P)) return false;
+  cache.guardarArquivo(chave, nome);
+  return true;
+}
@@ -0,0 +1,94 @@
+#ifndef _CACHETABELAS_H_
+#define _CACHETABELAS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "tabelaverdade.h"
+
+class Circuito;
+
+///
+/// CLASSE CACHETABELAS
+///
+
+// Um cache em disco de tabelas verdade jah geradas, indexado pela impressao digital do
+// circuito (Circuito::impressaoDigital): gerar de novo a tabela de um circuito que jah
+// foi simulado (mesmo que lido de outro arquivo) se reduz a ler o arquivo do cache.
+// Cada tabela eh um arquivo <chave>.tvd (formato da TabelaMapeada) no diretorio do cache,
+// que deve existir. O arquivo "indice" do diretorio lista as tabelas, da usada ha mais
+// tempo para a usada mais recentemente, com os seus tamanhos; quando o total passa do
+// limite, as tabelas usadas ha mais tempo sao apagadas (LRU).
+// Varias instancias (em threads ou processos diferentes) podem usar o mesmo diretorio:
+// cada operacao rele e altera o indice sob uma trava (um mutex e o arquivo
+// "indice.trava"), e os arquivos sao gravados com nomes temporarios unicos e depois
+// renomeados.
+// O cache eh apenas uma otimizacao: qualquer erro (diretorio inexistente, arquivo
+// apagado ou corrompido) eh tratado como ausencia da tabela no cache.
+class CacheTabelas {
+private:
+  struct Entrada {
+    std::string chave;
+    uint64_t tamanho;
+  };
+
+  std::string dir;
+  uint64_t maxBytes;
+  // As tabelas do cache, da usada ha mais tempo para a mais recente
+  std::vector<Entrada> entradas;
+  uint64_t total;
+
+  // O indice eh relido a cada operacao, dentro da trava do indice (outra instancia pode
+  // ter alterado o cache)
+  void lerIndice();
+  bool salvarIndice() const;
+  std::string nomeArquivo(const std::string& chave) const;
+  // Posicao da chave em entradas, ou -1 se ausente
+  int procurar(const std::string& chave) const;
+  // Move a entrada I para o final da lista (a usada mais recentemente)
+  void usar(unsigned I);
+  // Registra uma tabela recem-gravada e apaga as mais antigas, se passar do limite
+  void acrescentar(const std::string& chave, uint64_t tamanho);
+
+public:
+  // Limite padrao do tamanho total das tabelas do cache
+  static const uint64_t TAMANHO_PADRAO;
+
+  // Dir: diretorio do cache (deve existir)
+  explicit CacheTabelas(const std::string& Dir, uint64_t MaxBytes=TAMANHO_PADRAO);
+
+  // Procura no cache a tabela do circuito de impressao digital chave e a leh para T
+  // Retorna true se encontrou; false caso contrario (T fica vazia)
+  bool buscar(const std::string& chave, TabelaVerdade& T);
+
+  // Procura no cache a tabela e a copia para o arquivo destino
+  // Retorna true se encontrou e copiou; false caso contrario
+  bool buscarArquivo(const std::string& chave, const std::string& destino);
+
+  // Guarda no cache a tabela T (completa), ou o arquivo de tabela origem
+  // Tabelas maiores que o limite do cache nao sao guardadas
+  // Retorna true se deu tudo OK; false se nao guardou
+  // A gravacao de T pode ser interrompida de outra thread por cancelado (ver salvarTabela)
+  bool guardar(const std::string& chave, const TabelaVerdade& T,
+               const std::atomic<bool>* cancelado=nullptr);
+  bool guardarArquivo(const std::string& chave, const std::string& origem);
+
+  // Apaga todas as tabelas do cache
+  void limpar();
+
+  // Consultas
+  const std::string& getDiretorio() const;
+  uint64_t getMaxBytes() const;
+  // Tamanho total e numero de tabelas no cache (segundo o indice)
+  uint64_t getTamanho();
+  unsigned getNumTabelas();
+};
+
+// Versoes de gerarTabela e gerarTabelaArquivo que consultam o cache antes de simular e
+// guardam nele a tabela gerada
+bool gerarTabela(Circuito& C, TabelaVerdade& T, CacheTabelas& cache);
+bool gerarTabelaArquivo(Circuito& C, const std::string& nome, CacheTabelas& cache,
+                        ProgressoTabela* P=nullptr);
+
+#endif // _CACHETABELAS_H_
@@ -0,0 +1,150 @@
+// circbdd: consultas simbolicas sobre as saidas de um circuito, com BDDs
+//
+// Uso: circbdd [opcoes] CIRCUITO
+// Constroi os BDDs das saidas do circuito (ver bdd.h) e, para cada saida, informa o
+// tamanho do BDD e em quantas combinacoes de entradas ela vale T, F e ?, sem simular as
+// combinacoes: responde, em circuitos com entradas demais para a tabela verdade, se uma
+// saida pode valer T e em quantos casos.
+//
+// Opcoes:
+//   -3           as entradas tambem podem valer ? (3^NI combinacoes, em vez de 2^NI)
+//   -n           ordem natural das entradas nas variaveis (padrao: busca em
+//                profundidade a partir das saidas)
+//   -s I         soh a saida I
+//   -e           mostra, para cada valor possivel da saida, uma combinacao de entradas
+//   -l N         numero maximo de nos (padrao: 2^22)
+//
+// Codigos de retorno: 0 = OK, 1 = parametros invalidos, 2 = erro de leitura,
+// 5 = limite de nos excedido
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bdd.h"
+#include "circuito.h"
+
+using namespace std;
+
+static void uso()
+{
+  cerr << "Uso: circbdd [opcoes] CIRCUITO\n"
+          "  -3      entradas F, T e ? (padrao: soh F e T)\n"
+          "  -n      ordem natural das entradas (padrao: busca em profundidade)\n"
+          "  -s I    soh a saida I\n"
+          "  -e      mostra uma combinacao de entradas para cada valor da saida\n"
+          "  -l N    maximo de nos dos BDDs (padrao: 2^22)\n";
+}
+
+// Le um numero inteiro sem sinal de 64 bits
+// Retorna false se o texto nao for um numero valido
+static bool lerNumero(const char* texto, uint64_t& N)
+{
+  char* fim;
+  N = strtoull(texto, &fim, 10);
+  return (*texto!='\0' && *fim=='\0');
+}
+
+// Escreve uma contagem de combinacoes: exata ateh 2^53, em notacao cientifica acima
+static void escreverContagem(double N)
+{
+  if (N<9007199254740992.0) cout << uint64_t(N);
+  else cout << scientific << N << defaultfloat;
+}
+
+int main(int argc, char *argv[])
+{
+  bool tresValores = false, exemplos = false;
+  OrdemBDD H = OrdemBDD::PROFUNDIDADE;
+  uint64_t saida = 0, maxNos = BDD::MAX_NOS_PADRAO;
+  string arq;
+
+  for (int a=1; a<argc; a++)
+  {
+    string op = argv[a];
+    bool temValor = (a+1<argc);
+    bool ok = true;
+    if (op=="-3") tresValores = true;
+    else if (op=="-n") H = OrdemBDD::NATURAL;
+    else if (op=="-e") exemplos = true;
+    else if (op=="-s" && temValor) ok = lerNumero(argv[++a], saida) && saida>0;
+    else if (op=="-l" && temValor) ok = lerNumero(argv[++a], maxNos) && maxNos<=UINT32_MAX;
+    else if (op=="-h" || op=="--help")
+    {
+      uso();
+      return 0;
+    }
+    else if (op.size()>1 && op[0]=='-') ok = false;
+    else if (arq.empty()) arq = op;
+    else ok = false;
+    if (!ok)
+    {
+      cerr << "circbdd: parametro invalido: " << op << '\n';
+      uso();
+      return 1;
+    }
+  }
+  if (arq.empty())
+  {
+    uso();
+    return 1;
+  }
+
+  Circuito C;
+  ResultadoLeitura R;
+  if (!C.ler(arq, R))
+  {
+    for (unsigned k=0; k<R.erros.size(); k++) cerr << arq << ':' << R.erros[k] << '\n';
+    return 2;
+  }
+  if (!C.valid())
+  {
+    cerr << arq << ": circuito incompleto\n";
+    return 2;
+  }
+  if (saida>C.getNumOutputs())
+  {
+    cerr << "circbdd: o circuito tem " << C.getNumOutputs() << " saidas\n";
+    return 1;
+  }
+
+  BDDCircuito B;
+  vector<BDD::No> saidasT, saidasF;
+  B.preparar(C, H, tresValores, size_t(maxNos));
+  if (!B.construir(C, saidasT, saidasF))
+  {
+    cerr << "circbdd: limite de nos excedido (" << maxNos << ", ver -l)\n";
+    return 5;
+  }
+  BDD& D = B.getBDD();
+  cout << C.getNumInputs() << " entradas, " << C.getNumOutputs() << " saidas, ordem "
+       << (H==OrdemBDD::NATURAL ? "natural" : "profundidade") << ", " << D.getNumNos()
+       << " nos\n";
+
+  double total = pow(tresValores ? 3.0 : 2.0, double(C.getNumInputs()));
+  vector<bool3S> in_circ;
+  for (unsigned i=0; i<saidasT.size(); i++)
+  {
+    if (saida>0 && i+1!=saida) continue;
+    BDD::No T = saidasT[i], F = saidasF[i], U = D.negar(D.ou(T, F));
+    double numT = B.contarEntradas(T), numF = B.contarEntradas(F);
+    cout << "saida " << i+1 << ": " << D.tamanho(vector<BDD::No>{T, F}) << " nos";
+    const char* nomes[3] = {"T", "F", "?"};
+    BDD::No funcoes[3] = {T, F, U};
+    double contagens[3] = {numT, numF, total-numT-numF};
+    for (unsigned v=0; v<3; v++)
+    {
+      cout << (v==0 ? "; " : ", ") << nomes[v] << ": ";
+      escreverContagem(contagens[v]);
+      if (exemplos && B.exemploEntradas(funcoes[v], in_circ))
+      {
+        cout << " (";
+        for (unsigned j=0; j<in_circ.size(); j++) cout << in_circ[j];
+        cout << ')';
+      }
+    }
+    cout << '\n';
+  }
+  return (D.getEstourado() ? 5 : 0);
+}
@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# circbdd: consultas simbolicas sobre as saidas de um circuito, com BDDs
+#
+#-------------------------------------------------
+
+TARGET = circbdd
+
+include(../ferramenta.pri)
+
+SOURCES += circbdd.cpp
@@ -0,0 +1,376 @@
+// circbench: medidas de desempenho do nucleo do simulador (sem interface grafica)
+//
+// Uso: circbench [opcoes]
+//   -n N,N,...     numeros de portas dos circuitos (padrao: 10,100,1000,10000,100000,1000000)
+//   -d D,D,...     profundidades (niveis logicos) dos circuitos (padrao: 2,10,100,1000)
+//   -s S           tempo minimo de cada medida, em segundos (padrao: 0.5), dividido
+//                  entre as repeticoes
+//   -k K           numero de repeticoes de cada medida (padrao: 5)
+//   -r             rapido: circuitos de ateh 10000 portas e 0.1 s por medida
+//   -o ARQ         escreve o resultado em ARQ, em vez da saida padrao
+//   -b ARQ         compara com o resultado de uma execucao anterior (a base)
+//   -p P           queda maxima aceita em relacao aa base, em % (padrao: 10)
+//   -f ARQ         arquivo temporario das medidas de leitura e escrita
+//                  (padrao: circbench.tmp, no diretorio atual)
+//
+// Para cada combinacao de numero de portas e profundidade (com profundidade <= portas),
+// gera um circuito sintetico (gerarCircuito, sempre o mesmo para os mesmos parametros)
+// com 16 entradas e ateh 16 saidas e mede:
+// - simular: vetores/s de Circuito::simular (o caminho escalar)
+// - incremental: vetores/s de SimuladorIncremental::simular (circuito plano, em ordem
+//   de nivel)
+// - linhas: vetores/s de simularLinhas (as linhas da tabela verdade, com as entradas
+//   geradas a partir do numero da linha e simuladas com SimuladorLote)
+// - simularLote: vetores/s de SimuladorLote::simularLote (64 vetores por palavra)
+// - ler: MB/s de Circuito::ler
+// - salvar: MB/s de Circuito::salvar
+// Todas as medidas sao "quanto maior, melhor".
+// Cada medida comeca com uma repeticao de aquecimento, descartada (caches, paginas de
+// memoria, frequencia do processador), seguida de K repeticoes; o valor informado (e
+// comparado com a base) eh o da melhor repeticao: as interferencias (outros processos,
+// interrupcoes) soh deixam uma repeticao mais lenta, e a melhor eh a menos afetada.
+//
+// O resultado eh JSON, com um objeto por linha em "resultados"; o arquivo da base eh o
+// resultado de uma execucao anterior (soh as medidas presentes nas duas sao comparadas).
+// Cada medida abaixo da base menos a tolerancia eh listada na saida de erro.
+//
+// Codigos de retorno: 0 = OK, 1 = parametros invalidos, 2 = erro de leitura (base)
+// ou de geracao dos circuitos, 3 = erro de escrita, 4 = alguma medida abaixo da base
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "circuito.h"
+#include "gerador.h"
+#include "simuladorincremental.h"
+#include "simuladorlote.h"
+#include "tabelaverdade.h"
+
+using namespace std;
+
+// Dimensoes fixas dos circuitos gerados
+static const unsigned NUM_ENTRADAS = 16;
+static const unsigned MAX_SAIDAS = 16;
+// Numero de vetores de entrada diferentes usados nas medidas de simulacao
+static const unsigned NUM_VETORES = 256;
+
+static void uso()
+{
+  cerr << "Uso: circbench [opcoes]\n"
+          "  -n N,N,...  numeros de portas (padrao: 10,100,1000,10000,100000,1000000)\n"
+          "  -d D,D,...  profundidades (padrao: 2,10,100,1000)\n"
+          "  -s S        tempo minimo de cada medida, em segundos (padrao: 0.5)\n"
+          "  -k K        repeticoes de cada medida (padrao: 5; vale a melhor)\n"
+          "  -r          rapido: ateh 10000 portas e 0.1 s por medida\n"
+          "  -o ARQ      escreve o resultado (JSON) em ARQ, em vez da saida padrao\n"
+          "  -b ARQ      compara com o resultado de uma execucao anterior\n"
+          "  -p P        queda maxima aceita em relacao aa base, em % (padrao: 10)\n"
+          "  -f ARQ      arquivo temporario (padrao: circbench.tmp)\n";
+}
+
+// Le uma lista de numeros separados por virgulas
+// Retorna false se a lista for invalida
+static bool lerLista(const string& texto, vector<unsigned>& lista)
+{
+  lista.clear();
+  istringstream I(texto);
+  string item;
+  while (getline(I, item, ','))
+  {
+    char* fim;
+    unsigned long v = strtoul(item.c_str(), &fim, 10);
+    if (item.empty() || *fim!='\0' || v==0 || v>100000000UL) return false;
+    lista.push_back(unsigned(v));
+  }
+  return !lista.empty();
+}
+
+// Numero de repeticoes de cada medida (opcao -k)
+static unsigned repeticoes = 5;
+
+// Executa f repetidamente ateh passar o tempo minimo (pelo menos uma vez)
+// Retorna o numero de execucoes por segundo
+template <class Funcao>
+static double taxa(double tempoMin, Funcao& f)
+{
+  typedef chrono::steady_clock relogio;
+  relogio::time_point ini = relogio::now();
+  unsigned long n = 0;
+  double dt;
+  do
+  {
+    f();
+    n++;
+    dt = chrono::duration<double>(relogio::now()-ini).count();
+  }
+  while (dt<tempoMin);
+  return n/dt;
+}
+
+// Mede o numero de execucoes de f por segundo: uma repeticao de aquecimento
+// (descartada) e mais repeticoes, com o tempo minimo dividido entre elas
+// Retorna a taxa da melhor repeticao
+template <class Funcao>
+static double porSegundo(double tempoMin, Funcao f)
+{
+  double t = tempoMin/repeticoes;
+  taxa(t, f);
+  double melhor = 0.0;
+  for (unsigned r=0; r<repeticoes; r++) melhor = max(melhor, taxa(t, f));
+  return melhor;
+}
+
+// Tamanho de um arquivo, em bytes (0 se nao existir)
+static double tamanhoArquivo(const string& arq)
+{
+  ifstream I(arq, ios::binary | ios::ate);
+  return (I.is_open() ? double(I.tellg()) : 0.0);
+}
+
+// Uma medida: a chave de comparacao com a base eh "medida portas profundidade"
+struct Medida {
+  string nome;
+  unsigned portas, profundidade;
+  double valor;
+  const char* unidade;
+
+  string chave() const
+  {
+    return nome + ' ' + to_string(portas) + ' ' + to_string(profundidade);
+  }
+};
+
+// Valor do campo "nome" de uma linha de resultado (texto vazio se nao existir)
+static string campo(const string& linha, const string& nome)
+{
+  size_t p = linha.find('"' + nome + "\":");
+  if (p==string::npos) return string();
+  p = linha.find_first_not_of(' ', p+nome.size()+3);
+  if (p==string::npos) return string();
+  if (linha[p]=='"')
+  {
+    size_t q = linha.find('"', p+1);
+    return (q==string::npos ? string() : linha.substr(p+1, q-p-1));
+  }
+  size_t q = linha.find_first_of(",}", p);
+  return linha.substr(p, q==string::npos ? string::npos : q-p);
+}
+
+// Le as medidas de um resultado anterior
+// Retorna false se o arquivo nao puder ser lido ou nao tiver nenhuma medida
+static bool lerBase(const string& arq, map<string, double>& base)
+{
+  ifstream I(arq);
+  if (!I.is_open()) return false;
+  string linha;
+  while (getline(I, linha))
+  {
+    Medida M;
+    M.nome = campo(linha, "medida");
+    if (M.nome.empty()) continue;
+    M.portas = unsigned(atol(campo(linha, "portas").c_str()));
+    M.profundidade = unsigned(atol(campo(linha, "profundidade").c_str()));
+    base[M.chave()] = atof(campo(linha, "valor").c_str());
+  }
+  return !base.empty();
+}
+
+// Mede o desempenho com o circuito C; as medidas sao acrescentadas em medidas
+// Retorna false se deu erro na leitura ou escrita do arquivo temporario
+static bool medir(Circuito& C, unsigned portas, unsigned profundidade, double tempoMin,
+                  const string& arqTemp, vector<Medida>& medidas)
+{
+  unsigned NI = C.getNumInputs();
+  Medida M;
+  M.portas = portas;
+  M.profundidade = profundidade;
+
+  // Vetores de entrada (sempre os mesmos)
+  GeradorAleatorio G(portas*31u + profundidade);
+  vector<vector<bool3S> > vetores(NUM_VETORES, vector<bool3S>(NI));
+  for (unsigned k=0; k<NUM_VETORES; k++)
+  {
+    for (unsigned j=0; j<NI; j++) vetores[k][j] = (G.sortear(2)==0 ? bool3S::FALSE : bool3S::TRUE);
+  }
+
+  unsigned k = 0;
+  M.nome = "simular";
+  M.unidade = "vetores/s";
+  M.valor = porSegundo(tempoMin, [&]() {C.simular(vetores[k++ % NUM_VETORES]);});
+  medidas.push_back(M);
+
+  SimuladorIncremental S;
+  S.montar(C);
+  M.nome = "incremental";
+  M.valor = porSegundo(tempoMin, [&]() {S.simular(vetores[k++ % NUM_VETORES]);});
+  medidas.push_back(M);
+
+  SimuladorLote SL;
+  SL.montar(C);
+
+  // Blocos de ateh 4096 linhas da tabela verdade, menores nos circuitos grandes (para
+  // que cada chamada nao passe muito do tempo minimo), mas de pelo menos 64 linhas (uma
+  // palavra do simulador em lote)
+  uint64_t N = max(64u, min(4096u, 64000000u/portas));
+  uint64_t L0 = 0, total = numLinhasTabela(NI);
+  vector<uint8_t> valores(N*bytesPorLinha(C.getNumOutputs()));
+  M.nome = "linhas";
+  M.valor = N*porSegundo(tempoMin, [&]()
+  {
+    simularLinhas(SL, L0, N, valores.data());
+    L0 = (L0+N+N<=total ? L0+N : 0);
+  });
+  medidas.push_back(M);
+
+  // Os NUM_VETORES vetores de uma vez
+  vector<bool3S> entradas;
+  for (unsigned v=0; v<NUM_VETORES; v++) entradas.insert(entradas.end(), vetores[v].begin(), vetores[v].end());
+  valores.resize(NUM_VETORES*bytesPorLinha(C.getNumOutputs()));
+  M.nome = "simularLote";
+  M.valor = NUM_VETORES*porSegundo(tempoMin, [&]() {SL.simularLote(entradas.data(), NUM_VETORES, valores.data());});
+  medidas.push_back(M);
+
+  // Escrita e leitura do arquivo do circuito
+  if (!C.salvar(arqTemp)) return false;
+  double MB = tamanhoArquivo(arqTemp)/1e6;
+  bool ok = true;
+  M.nome = "salvar";
+  M.unidade = "MB/s";
+  M.valor = MB*porSegundo(tempoMin, [&]() {ok = C.salvar(arqTemp) && ok;});
+  medidas.push_back(M);
+
+  Circuito lido;
+  M.nome = "ler";
+  M.valor = MB*porSegundo(tempoMin, [&]() {ok = lido.ler(arqTemp) && ok;});
+  medidas.push_back(M);
+  remove(arqTemp.c_str());
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  vector<unsigned> tamanhos = {10, 100, 1000, 10000, 100000, 1000000};
+  vector<unsigned> profundidades = {2, 10, 100, 1000};
+  double tempoMin = 0.5, tolerancia = 10.0;
+  string arqSaida, arqBase, arqTemp = "circbench.tmp";
+
+  for (int a=1; a<argc; a++)
+  {
+    string op = argv[a];
+    bool temValor = (a+1<argc);
+    bool ok = true;
+    if (op=="-n" && temValor) ok = lerLista(argv[++a], tamanhos);
+    else if (op=="-d" && temValor) ok = lerLista(argv[++a], profundidades);
+    else if (op=="-s" && temValor) ok = (tempoMin = atof(argv[++a])) > 0.0;
+    else if (op=="-k" && temValor)
+    {
+      repeticoes = unsigned(atol(argv[++a]));
+      ok = (repeticoes>0 && repeticoes<=1000);
+    }
+    else if (op=="-r")
+    {
+      tamanhos = {10, 100, 1000, 10000};
+      tempoMin = 0.1;
+    }
+    else if (op=="-o" && temValor) arqSaida = argv[++a];
+    else if (op=="-b" && temValor) arqBase = argv[++a];
+    else if (op=="-p" && temValor) ok = (tolerancia = atof(argv[++a])) >= 0.0;
+    else if (op=="-f" && temValor) arqTemp = argv[++a];
+    else if (op=="-h" || op=="--help")
+    {
+      uso();
+      return 0;
+    }
+    else ok = false;
+    if (!ok)
+    {
+      cerr << "circbench: opcao invalida ou incompleta: " << op << '\n';
+      uso();
+      return 1;
+    }
+  }
+
+  map<string, double> base;
+  if (!arqBase.empty() && !lerBase(arqBase, base))
+  {
+    cerr << "circbench: erro ao ler a base " << arqBase << '\n';
+    return 2;
+  }
+
+  ofstream arquivo;
+  if (!arqSaida.empty())
+  {
+    arquivo.open(arqSaida);
+    if (!arquivo.is_open())
+    {
+      cerr << "circbench: erro ao abrir " << arqSaida << '\n';
+      return 3;
+    }
+  }
+  ostream& O = (arqSaida.empty() ? cout : arquivo);
+
+  O << "{\n  \"ferramenta\": \"circbench\",\n  \"versao\": 1,\n"
+    << "  \"tempo_minimo\": " << tempoMin << ",\n  \"repeticoes\": " << repeticoes
+    << ",\n  \"entradas\": " << NUM_ENTRADAS << ",\n"
+    << "  \"resultados\": [";
+  unsigned numMedidas = 0, regressoes = 0;
+  for (unsigned t=0; t<tamanhos.size(); t++)
+  {
+    for (unsigned d=0; d<profundidades.size(); d++)
+    {
+      if (profundidades[d]>tamanhos[t]) continue;
+      ParametrosGerador P;
+      P.numInputs = NUM_ENTRADAS;
+      P.numOutputs = min(MAX_SAIDAS, tamanhos[t]);
+      P.numPorts = tamanhos[t];
+      P.profundidade = profundidades[d];
+      Circuito C;
+      vector<Medida> medidas;
+      if (!gerarCircuito(C, P) || !medir(C, P.numPorts, P.profundidade, tempoMin, arqTemp, medidas))
+      {
+        cerr << "circbench: erro com o circuito de " << P.numPorts << " portas e profundidade "
+             << P.profundidade << '\n';
+        return 2;
+      }
+      for (unsigned m=0; m<medidas.size(); m++)
+      {
+        const Medida& M = medidas[m];
+        O << (numMedidas++>0 ? ",\n" : "\n")
+          << "    {\"medida\": \"" << M.nome << "\", \"portas\": " << M.portas
+          << ", \"profundidade\": " << M.profundidade << ", \"valor\": " << M.valor
+          << ", \"unidade\": \"" << M.unidade << '"';
+        map<string, double>::const_iterator B = base.find(M.chave());
+        if (B!=base.end() && B->second>0.0)
+        {
+          double variacao = 100.0*(M.valor/B->second - 1.0);
+          bool regressao = (variacao < -tolerancia);
+          O << ", \"base\": " << B->second << ", \"variacao\": " << variacao
+            << ", \"regressao\": " << (regressao ? "true" : "false");
+          if (regressao)
+          {
+            regressoes++;
+            cerr << "circbench: regressao em " << M.nome << " (" << M.portas << " portas, profundidade "
+                 << M.profundidade << "): " << B->second << " -> " << M.valor << ' ' << M.unidade
+                 << " (" << variacao << "%)\n";
+          }
+        }
+        O << '}';
+      }
+      O.flush();
+    }
+  }
+  O << "\n  ],\n  \"regressoes\": " << regressoes << "\n}\n";
+  O.flush();
+  if (!O)
+  {
+    cerr << "circbench: erro de escrita\n";
+    return 3;
+  }
+  return (regressoes>0 ? 4 : 0);
+}
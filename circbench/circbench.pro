@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# circbench: medidas de desempenho do nucleo (simulacao, leitura e escrita)
+#
+#-------------------------------------------------
+
+TARGET = circbench
+
+include(../ferramenta.pri)
+
+SOURCES += circbench.cpp
@@ -0,0 +1,807 @@
+// circdiff: teste diferencial dos caminhos de simulacao do nucleo
+//
+// Uso: circdiff [opcoes]
+// Simula circuitos aleatorios (com lacos e com as portas fora de ordem) e vetores de
+// entrada aleatorios (ou todos) na simulacao de referencia, Circuito::simular, e em
+// cada um dos outros caminhos de simulacao (os "motores", ver criarMotores),
+// comparando o valor de cada porta e de cada saida (F, T ou ?) depois de cada vetor.
+// Na primeira divergencia, informa o circuito, o vetor, o motor, a porta (ou saida) e
+// os dois valores, e reduz o circuito e os vetores, enquanto a divergencia continuar
+// aparecendo, ateh um caso minimo, que eh gravado para ser reproduzido.
+//
+// Opcoes:
+//   -n N         numero de circuitos aleatorios (padrao: 1000)
+//   -i NI        numero maximo de entradas de cada circuito (padrao: 6)
+//   -p NP        numero maximo de portas de cada circuito (padrao: 40)
+//   -l L         numero maximo de lacos de cada circuito (padrao: 3)
+//   -v V         numero de vetores aleatorios por circuito (padrao: 32)
+//   -t           simula todos os 3^NI vetores (na ordem da tabela verdade) em vez
+//                de vetores aleatorios; soh em circuitos com ateh 10 entradas
+//   -x SEMENTE   semente do primeiro circuito (padrao: 1); o circuito K usa a
+//                semente SEMENTE+K, de modo que "-x S -n 1" repete o circuito de semente S
+//   -c ARQ       testa apenas o circuito do arquivo ARQ (com V vetores aleatorios ou -t)
+//   -o ARQ       arquivo do caso minimo (padrao: circdiff_falha.txt); os vetores sao
+//                gravados em ARQ.vet, no formato de circsim -v
+//
+// Codigos de retorno: 0 = nenhuma divergencia, 1 = parametros invalidos, 2 = erro de
+// leitura, 3 = erro de escrita, 4 = divergencia encontrada
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bdd.h"
+#include "circuito.h"
+#include "gerador.h"
+#include "simuladorincremental.h"
+#include "simuladorlote.h"
+#include "simuladorsequencial.h"
+#include "simuladortemporizado.h"
+#include "tabelaverdade.h"
+
+using namespace std;
+
+typedef vector<bool3S> Vetor;
+
+// Numero maximo de entradas para simular todos os vetores (-t)
+static const unsigned MAX_ENTRADAS_TODOS = 10;
+
+static void uso()
+{
+  cerr << "Uso: circdiff [opcoes]\n"
+          "  -n N        numero de circuitos aleatorios (padrao: 1000)\n"
+          "  -i NI       maximo de entradas de cada circuito (padrao: 6)\n"
+          "  -p NP       maximo de portas de cada circuito (padrao: 40)\n"
+          "  -l L        maximo de lacos de cada circuito (padrao: 3)\n"
+          "  -v V        vetores aleatorios por circuito (padrao: 32)\n"
+          "  -t          simula todos os vetores (ateh 10 entradas)\n"
+          "  -x SEMENTE  semente do primeiro circuito (padrao: 1)\n"
+          "  -c ARQ      testa apenas o circuito do arquivo ARQ\n"
+          "  -o ARQ      arquivo do caso minimo (padrao: circdiff_falha.txt)\n";
+}
+
+// Le um numero inteiro sem sinal
+// Retorna false se o texto nao for um numero valido
+static bool lerNumero(const char* texto, unsigned& N)
+{
+  char* fim;
+  unsigned long v = strtoul(texto, &fim, 10);
+  if (*texto=='\0' || *fim!='\0' || v>0xFFFFFFFFUL) return false;
+  N = unsigned(v);
+  return true;
+}
+
+// Texto de um vetor, um caractere por entrada
+static string textoVetor(const Vetor& V)
+{
+  string S;
+  for (unsigned j=0; j<V.size(); j++) S += toChar(V[j]);
+  return S;
+}
+
+/* ===================================================================== */
+/* MOTORES: OS CAMINHOS DE SIMULACAO COMPARADOS COM A REFERENCIA         */
+/* ===================================================================== */
+
+// Um caminho de simulacao que deve dar sempre os mesmos valores que Circuito::simular
+// Os vetores de um circuito sao simulados em sequencia, no mesmo objeto: os motores
+// que guardam estado entre vetores (o incremental) sao testados com as transicoes
+class Motor {
+public:
+  virtual ~Motor() {}
+  virtual const char* nome() const = 0;
+  // Prepara o motor para o circuito C (valido)
+  // Retorna false se o motor nao se aplica a esse circuito
+  virtual bool montar(const Circuito& C) = 0;
+  // Recebe, antes do primeiro simular, todos os vetores que serao simulados em
+  // seguida (para os motores que simulam muitos vetores de uma vez)
+  virtual void preparar(const vector<Vetor>&) {}
+  // Simula um vetor de entradas
+  // Retorna false se a simulacao deu erro
+  virtual bool simular(const Vetor& in_circ) = 0;
+  // Retorna true se o motor calcula o valor da porta IdPort
+  virtual bool calculaPorta(int IdPort) const = 0;
+  virtual bool3S getOutputPort(int IdPort) const = 0;
+  virtual bool3S getOutput(int IdOutput) const = 0;
+};
+
+// Circuito::simular restrito ao cone de entrada das saidas (portasNecessarias)
+class MotorCone: public Motor {
+private:
+  Circuito C;
+  vector<int> IdPorts;
+  vector<bool> noCone;
+
+public:
+  const char* nome() const {return "cone das saidas";}
+  bool montar(const Circuito& C0)
+  {
+    C = C0;
+    C.portasNecessarias(vector<bool>(C.getNumOutputs(), true), IdPorts);
+    noCone.assign(C.getNumPorts()+1, false);
+    for (unsigned k=0; k<IdPorts.size(); k++) noCone[IdPorts[k]] = true;
+    return true;
+  }
+  bool simular(const Vetor& in_circ) {return C.simular(in_circ, IdPorts);}
+  bool calculaPorta(int IdPort) const {return noCone[IdPort];}
+  bool3S getOutputPort(int IdPort) const {return C.getOutputPort(IdPort);}
+  bool3S getOutput(int IdOutput) const {return C.getOutput(IdOutput);}
+};
+
+// SimuladorIncremental::simular (o circuito inteiro, na estrutura plana)
+class MotorPlano: public Motor {
+private:
+  SimuladorIncremental S;
+
+public:
+  const char* nome() const {return "plano";}
+  bool montar(const Circuito& C)
+  {
+    S.clear();
+    return S.montar(C);
+  }
+  bool simular(const Vetor& in_circ)
+  {
+    S.simular(in_circ);
+    return true;
+  }
+  bool calculaPorta(int) const {return true;}
+  bool3S getOutputPort(int IdPort) const {return S.getOutputPort(IdPort);}
+  bool3S getOutput(int IdOutput) const {return S.getOutput(IdOutput);}
+};
+
+// SimuladorIncremental::setInput: as entradas do vetor sao alteradas uma a uma, a
+// partir dos valores do vetor anterior
+class MotorIncremental: public Motor {
+private:
+  SimuladorIncremental S;
+
+public:
+  const char* nome() const {return "incremental";}
+  // Comeca sempre com todas as entradas UNDEF
+  bool montar(const Circuito& C)
+  {
+    S.clear();
+    return S.montar(C);
+  }
+  bool simular(const Vetor& in_circ)
+  {
+    for (unsigned j=0; j<in_circ.size(); j++) S.setInput(-int(j)-1, in_circ[j]);
+    return true;
+  }
+  bool calculaPorta(int) const {return true;}
+  bool3S getOutputPort(int IdPort) const {return S.getOutputPort(IdPort);}
+  bool3S getOutput(int IdOutput) const {return S.getOutput(IdOutput);}
+};
+
+// simularLinhas (a geracao da tabela verdade): o vetor eh simulado como a linha
+// correspondente da tabela, com SimuladorLote; soh calcula as saidas
+class MotorLinhas: public Motor {
+private:
+  SimuladorLote S;
+  vector<uint8_t> linha;
+
+public:
+  const char* nome() const {return "linhas da tabela";}
+  bool montar(const Circuito& C0)
+  {
+    // O numero da linha deve caber em 64 bits
+    if (C0.getNumInputs()>40) return false;
+    if (!S.montar(C0)) return false;
+    linha.assign(bytesPorLinha(S.getNumOutputs()), 0);
+    return true;
+  }
+  bool simular(const Vetor& in_circ)
+  {
+    uint64_t L = 0;
+    for (unsigned j=0; j<in_circ.size(); j++) L = 3*L + uint64_t(in_circ[j]);
+    return simularLinhas(S, L, 1, linha.data());
+  }
+  bool calculaPorta(int) const {return false;}
+  bool3S getOutputPort(int) const {return bool3S::UNDEF;}
+  bool3S getOutput(int IdOutput) const {return lerValor(linha.data(), unsigned(IdOutput-1));}
+};
+
+// SimuladorLote::simularLote: todos os vetores sao simulados em preparar, de uma vez;
+// cada simular apenas passa para o resultado do vetor seguinte. Soh calcula as saidas
+class MotorLote: public Motor {
+private:
+  SimuladorLote S;
+  unsigned bytesLinha;
+  vector<uint8_t> saidas;
+  // O vetor atual (o do ultimo simular)
+  unsigned atual;
+
+public:
+  const char* nome() const {return "lote";}
+  bool montar(const Circuito& C)
+  {
+    bytesLinha = bytesPorLinha(C.getNumOutputs());
+    return S.montar(C);
+  }
+  void preparar(const vector<Vetor>& vetores)
+  {
+    vector<bool3S> entradas;
+    for (unsigned v=0; v<vetores.size(); v++) entradas.insert(entradas.end(), vetores[v].begin(), vetores[v].end());
+    saidas.assign(vetores.size()*bytesLinha, 0);
+    S.simularLote(entradas.data(), vetores.size(), saidas.data());
+    atual = unsigned(-1);
+  }
+  bool simular(const Vetor&)
+  {
+    atual++;
+    return true;
+  }
+  bool calculaPorta(int) const {return false;}
+  bool3S getOutputPort(int) const {return bool3S::UNDEF;}
+  bool3S getOutput(int IdOutput) const
+  {
+    return lerValor(saidas.data()+size_t(atual)*bytesLinha, unsigned(IdOutput-1));
+  }
+};
+
+// Simulacao por ciclos (SimuladorSequencial): os circuitos testados nao tem flip-flops,
+// entao cada ciclo eh uma simulacao combinacional
+class MotorSequencial: public Motor {
+private:
+  SimuladorSequencial S;
+
+public:
+  const char* nome() const {return "sequencial";}
+  bool montar(const Circuito& C) {return S.montar(C);}
+  bool simular(const Vetor& V)
+  {
+    S.ciclo(V.data());
+    return true;
+  }
+  bool calculaPorta(int) const {return true;}
+  bool3S getOutputPort(int IdPort) const {return S.getOutputPort(IdPort);}
+  bool3S getOutput(int IdOutput) const {return S.getOutput(IdOutput);}
+};
+
+// Simulacao com atrasos (SimuladorTemporizado), com atrasos sorteados: sem lacos, depois
+// que os eventos de cada vetor acabam, os valores sao os da simulacao sem atrasos,
+// quaisquer que sejam os atrasos e os valores do vetor anterior
+class MotorTemporizado: public Motor {
+private:
+  SimuladorTemporizado S;
+
+public:
+  const char* nome() const {return "temporizado";}
+  bool montar(const Circuito& C0)
+  {
+    vector<unsigned> nivel;
+    if (!C0.calcularNiveis(nivel)) return false;
+    Circuito C(C0);
+    sortearAtrasos(C, 4, C.getNumPorts());
+    return S.montar(C);
+  }
+  bool simular(const Vetor& V)
+  {
+    S.aplicar(V.data());
+    return S.estabilizar(uint64_t(1)<<20);
+  }
+  bool calculaPorta(int) const {return true;}
+  bool3S getOutputPort(int IdPort) const {return S.getOutputPort(IdPort);}
+  bool3S getOutput(int IdOutput) const {return S.getOutput(IdOutput);}
+};
+
+// Os BDDs das saidas (BDDCircuito, com entradas F, T e ?), avaliados em cada vetor:
+// soh calcula as saidas
+class MotorBDD: public Motor {
+private:
+  BDDCircuito B;
+  vector<BDD::No> saidasT, saidasF;
+  vector<bool3S> valores;
+
+public:
+  const char* nome() const {return "BDD";}
+  bool montar(const Circuito& C)
+  {
+    B.preparar(C, OrdemBDD::PROFUNDIDADE, true);
+    return B.construir(C, saidasT, saidasF);
+  }
+  bool simular(const Vetor& V)
+  {
+    valores.resize(saidasT.size());
+    for (unsigned i=0; i<saidasT.size(); i++) valores[i] = B.avaliar(saidasT[i], saidasF[i], V.data());
+    return true;
+  }
+  bool calculaPorta(int) const {return false;}
+  bool3S getOutputPort(int) const {return bool3S::UNDEF;}
+  bool3S getOutput(int IdOutput) const {return valores[IdOutput-1];}
+};
+
+// Cria todos os motores
+static void criarMotores(vector<unique_ptr<Motor> >& motores)
+{
+  motores.clear();
+  motores.emplace_back(new MotorCone);
+  motores.emplace_back(new MotorPlano);
+  motores.emplace_back(new MotorIncremental);
+  motores.emplace_back(new MotorLinhas);
+  motores.emplace_back(new MotorLote);
+  motores.emplace_back(new MotorSequencial);
+  motores.emplace_back(new MotorTemporizado);
+  motores.emplace_back(new MotorBDD);
+}
+
+/* ===================================================================== */
+/* COMPARACAO                                                            */
+/* ===================================================================== */
+
+// A primeira diferenca entre um motor e a referencia
+struct Divergencia {
+  // Indice do vetor (na sequencia simulada)
+  unsigned vetor;
+  string motor;
+  // A porta ou saida ("porta 7", "saida 2"), ou "simulacao" se o motor deu erro
+  string onde;
+  bool3S esperado;
+  bool3S obtido;
+};
+
+// Simula a sequencia de vetores no circuito C (valido), na referencia e em cada
+// motor aplicavel
+// Retorna true se algum motor divergiu da referencia (a primeira divergencia fica em D)
+static bool comparar(const Circuito& C, const vector<Vetor>& vetores,
+                     vector<unique_ptr<Motor> >& motores, Divergencia& D)
+{
+  Circuito ref(C);
+  vector<bool> aplicavel(motores.size());
+  for (unsigned m=0; m<motores.size(); m++)
+  {
+    aplicavel[m] = motores[m]->montar(C);
+    if (aplicavel[m]) motores[m]->preparar(vetores);
+  }
+
+  for (unsigned v=0; v<vetores.size(); v++)
+  {
+    ref.simular(vetores[v]);
+    for (unsigned m=0; m<motores.size(); m++) if (aplicavel[m])
+    {
+      Motor& M = *motores[m];
+      D.vetor = v;
+      D.motor = M.nome();
+      if (!M.simular(vetores[v]))
+      {
+        D.onde = "simulacao";
+        D.esperado = D.obtido = bool3S::UNDEF;
+        return true;
+      }
+      for (int id=1; id<=int(C.getNumPorts()); id++)
+      {
+        if (M.calculaPorta(id) && M.getOutputPort(id)!=ref.getOutputPort(id))
+        {
+          D.onde = "porta " + to_string(id);
+          D.esperado = ref.getOutputPort(id);
+          D.obtido = M.getOutputPort(id);
+          return true;
+        }
+      }
+      for (int id=1; id<=int(C.getNumOutputs()); id++)
+      {
+        if (M.getOutput(id)!=ref.getOutput(id))
+        {
+          D.onde = "saida " + to_string(id);
+          D.esperado = ref.getOutput(id);
+          D.obtido = M.getOutput(id);
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/* ===================================================================== */
+/* REDUCAO DO CASO QUE DIVERGE                                           */
+/* ===================================================================== */
+
+// Um circuito na forma de listas, mais facil de alterar que o Circuito
+struct Netlist {
+  unsigned Nin;
+  // Tipo e origens de cada porta (a porta de id k no indice k-1)
+  vector<string> tipos;
+  vector<vector<int> > origens;
+  // Origem de cada saida
+  vector<int> saidas;
+};
+
+static void lerNetlist(const Circuito& C, Netlist& N)
+{
+  N.Nin = C.getNumInputs();
+  N.tipos.resize(C.getNumPorts());
+  N.origens.resize(C.getNumPorts());
+  for (unsigned i=0; i<C.getNumPorts(); i++)
+  {
+    N.tipos[i] = C.getNamePort(i+1);
+    N.origens[i].resize(C.getNumInputsPort(i+1));
+    for (unsigned j=0; j<N.origens[i].size(); j++) N.origens[i][j] = C.getId_inPort(i+1, j);
+  }
+  N.saidas.resize(C.getNumOutputs());
+  for (unsigned i=0; i<N.saidas.size(); i++) N.saidas[i] = C.getIdOutput(i+1);
+}
+
+static void montarCircuito(const Netlist& N, Circuito& C)
+{
+  C.resize(N.Nin, N.saidas.size(), N.tipos.size());
+  for (unsigned i=0; i<N.tipos.size(); i++)
+  {
+    C.setPort(i+1, N.tipos[i], N.origens[i].size());
+    for (unsigned j=0; j<N.origens[i].size(); j++) C.setId_inPort(i+1, j, N.origens[i][j]);
+  }
+  for (unsigned i=0; i<N.saidas.size(); i++) C.setIdOutput(i+1, N.saidas[i]);
+}
+
+// Aplica F a todas as referencias a sinais do circuito (origens das portas e saidas)
+template <class Funcao>
+static void trocarOrigens(Netlist& N, Funcao F)
+{
+  for (unsigned i=0; i<N.origens.size(); i++)
+  {
+    for (unsigned j=0; j<N.origens[i].size(); j++) N.origens[i][j] = F(N.origens[i][j]);
+  }
+  for (unsigned i=0; i<N.saidas.size(); i++) N.saidas[i] = F(N.saidas[i]);
+}
+
+// Renumera as portas: a porta de id k passa a ter a id novaId[k]
+static void renumerarPortas(Netlist& N, const vector<int>& novaId)
+{
+  trocarOrigens(N, [&](int id) {return (id>0 ? novaId[id] : id);});
+  Netlist R(N);
+  for (unsigned k=1; k<novaId.size(); k++)
+  {
+    R.tipos[novaId[k]-1] = N.tipos[k-1];
+    R.origens[novaId[k]-1] = N.origens[k-1];
+  }
+  N.tipos.swap(R.tipos);
+  N.origens.swap(R.origens);
+}
+
+// O caso que diverge: o circuito e a sequencia de vetores
+struct Caso {
+  Netlist N;
+  vector<Vetor> vetores;
+};
+
+// Retorna true se o caso ainda diverge (e a divergencia em D)
+static bool diverge(const Caso& K, vector<unique_ptr<Motor> >& motores, Divergencia& D)
+{
+  Circuito C;
+  montarCircuito(K.N, C);
+  return C.valid() && comparar(C, K.vetores, motores, D);
+}
+
+// Reduz o caso K, que diverge, aplicando simplificacoes enquanto a divergencia continuar:
+// remover vetores, saidas, portas, entradas de portas e entradas do circuito, ligar
+// entradas de portas diretamente aa entrada -1 e trocar valores dos vetores por F.
+// Termina quando nenhuma simplificacao mantem a divergencia. D recebe a divergencia
+// do caso reduzido
+static void reduzir(Caso& K, vector<unique_ptr<Motor> >& motores, Divergencia& D)
+{
+  diverge(K, motores, D);
+  // Testa uma simplificacao: se o caso continuar divergindo, fica com ela
+  auto tentar = [&](const Caso& T) -> bool
+  {
+    Divergencia DT;
+    if (!diverge(T, motores, DT)) return false;
+    K = T;
+    D = DT;
+    return true;
+  };
+
+  bool mudou;
+  do
+  {
+    mudou = false;
+
+    // Os vetores depois do que diverge nao importam; os anteriores, talvez
+    if (K.vetores.size()>D.vetor+1)
+    {
+      K.vetores.resize(D.vetor+1);
+      mudou = true;
+    }
+    for (unsigned v=0; v+1<K.vetores.size(); )
+    {
+      Caso T(K);
+      T.vetores.erase(T.vetores.begin()+v);
+      if (tentar(T)) mudou = true;
+      else v++;
+    }
+
+    // Saidas
+    for (unsigned s=0; K.N.saidas.size()>1 && s<K.N.saidas.size(); )
+    {
+      Caso T(K);
+      T.N.saidas.erase(T.N.saidas.begin()+s);
+      if (tentar(T)) mudou = true;
+      else s++;
+    }
+
+    // Portas: os sinais que usavam a porta passam a usar a primeira origem dela
+    for (unsigned k=K.N.tipos.size(); K.N.tipos.size()>1 && k>=1; k--)
+    {
+      if (k>K.N.tipos.size()) continue;
+      Caso T(K);
+      int substituta = T.N.origens[k-1][0];
+      if (substituta==int(k)) substituta = -1;
+      trocarOrigens(T.N, [&](int id)
+      {
+        if (id==int(k)) id = substituta;
+        return (id>int(k) ? id-1 : id);
+      });
+      T.N.tipos.erase(T.N.tipos.begin()+(k-1));
+      T.N.origens.erase(T.N.origens.begin()+(k-1));
+      if (tentar(T)) mudou = true;
+    }
+
+    // Entradas das portas: remove uma entrada (uma porta de 2 entradas vira NT)
+    for (unsigned i=0; i<K.N.tipos.size(); i++)
+    {
+      for (unsigned j=0; K.N.origens[i].size()>1 && j<K.N.origens[i].size(); )
+      {
+        Caso T(K);
+        vector<int>& O = T.N.origens[i];
+        if (O.size()==2)
+        {
+          T.N.tipos[i] = "NT";
+          O.assign(1, O[1-j]);
+        }
+        else O.erase(O.begin()+j);
+        if (tentar(T)) mudou = true;
+        else j++;
+      }
+    }
+
+    // Entradas das portas ligadas a outras portas passam para a entrada -1
+    for (unsigned i=0; i<K.N.tipos.size(); i++)
+    {
+      for (unsigned j=0; j<K.N.origens[i].size(); j++)
+      {
+        if (K.N.origens[i][j]<0) continue;
+        Caso T(K);
+        T.N.origens[i][j] = -1;
+        if (tentar(T)) mudou = true;
+      }
+    }
+
+    // Entradas do circuito: os sinais que usavam a entrada passam a usar outra
+    for (unsigned m=K.N.Nin; K.N.Nin>1 && m>=1; m--)
+    {
+      if (m>K.N.Nin) continue;
+      Caso T(K);
+      int substituta = (m==1 ? -2 : -1);
+      trocarOrigens(T.N, [&](int id)
+      {
+        if (id==-int(m)) id = substituta;
+        return (id<-int(m) ? id+1 : id);
+      });
+      T.N.Nin--;
+      for (unsigned v=0; v<T.vetores.size(); v++) T.vetores[v].erase(T.vetores[v].begin()+(m-1));
+      if (tentar(T)) mudou = true;
+    }
+
+    // Valores dos vetores
+    for (unsigned v=0; v<K.vetores.size(); v++)
+    {
+      for (unsigned j=0; j<K.vetores[v].size(); j++)
+      {
+        if (K.vetores[v][j]==bool3S::FALSE) continue;
+        Caso T(K);
+        T.vetores[v][j] = bool3S::FALSE;
+        if (tentar(T)) mudou = true;
+      }
+    }
+  }
+  while (mudou);
+}
+
+/* ===================================================================== */
+/* CIRCUITOS E VETORES DE TESTE                                          */
+/* ===================================================================== */
+
+// Gera em C um circuito aleatorio pequeno a partir de G: camadas, com ou sem lacos,
+// com as ids das portas embaralhadas em metade dos casos (o que obriga a simulacao de
+// referencia a fazer mais de uma passada) ou, de vez em quando, um dos circuitos
+// aritmeticos do gerador
+static void gerarCaso(GeradorAleatorio& G, unsigned maxNI, unsigned maxNP, unsigned maxLacos,
+                      Circuito& C, string& descricao)
+{
+  unsigned familia = G.sortear(10);
+  if (familia==0 && maxNI>=3)
+  {
+    unsigned N = 1 + G.sortear((maxNI-1)/2);
+    if (G.sortear(2)==0) gerarSomadorRipple(C, N);
+    else gerarSomadorCLA(C, N);
+    descricao = "somador de " + to_string(N) + " bits";
+  }
+  else if (familia==1 && maxNI>=4)
+  {
+    unsigned N = 2 + G.sortear(maxNI/2-1);
+    gerarMultiplicador(C, N);
+    descricao = "multiplicador de " + to_string(N) + " bits";
+  }
+  else if (familia==2 && maxNI>=2)
+  {
+    unsigned N = 2 + G.sortear(maxNI-1);
+    gerarParidade(C, N, 2 + G.sortear(3));
+    descricao = "paridade de " + to_string(N) + " entradas";
+  }
+  else
+  {
+    ParametrosGerador P;
+    P.numInputs = 1 + G.sortear(maxNI);
+    P.numPorts = 1 + G.sortear(maxNP);
+    P.numOutputs = 1 + G.sortear(min(P.numPorts, 4u));
+    P.profundidade = 1 + G.sortear(P.numPorts);
+    P.minEntradasPorta = 2 + G.sortear(3);
+    P.maxEntradasPorta = P.minEntradasPorta + G.sortear(5-P.minEntradasPorta);
+    P.numLacos = G.sortear(maxLacos+1);
+    P.semente = G.proximo();
+    gerarCircuito(C, P);
+    descricao = to_string(P.numInputs) + " entradas, " + to_string(P.numPorts) +
+                " portas, profundidade " + to_string(P.profundidade) + ", " +
+                to_string(P.numLacos) + " lacos";
+  }
+
+  if (G.sortear(2)==0)
+  {
+    Netlist N;
+    lerNetlist(C, N);
+    vector<int> novaId(N.tipos.size()+1);
+    for (unsigned k=1; k<novaId.size(); k++) novaId[k] = int(k);
+    for (unsigned k=novaId.size()-1; k>1; k--) std::swap(novaId[k], novaId[1+G.sortear(k)]);
+    renumerarPortas(N, novaId);
+    montarCircuito(N, C);
+    descricao += ", portas embaralhadas";
+  }
+}
+
+// Gera os vetores de teste: todos os 3^NI, na ordem da tabela verdade, ou
+// numVetores aleatorios
+static void gerarVetores(GeradorAleatorio& G, unsigned NI, bool todos, unsigned numVetores,
+                         vector<Vetor>& vetores)
+{
+  if (todos)
+  {
+    vetores.resize(numLinhasTabela(NI));
+    for (uint64_t L=0; L<vetores.size(); L++) entradasLinha(L, NI, vetores[L]);
+    return;
+  }
+  vetores.resize(numVetores);
+  for (unsigned v=0; v<numVetores; v++)
+  {
+    vetores[v].resize(NI);
+    for (unsigned j=0; j<NI; j++) vetores[v][j] = bool3S(G.sortear(3));
+  }
+}
+
+// Informa a divergencia D do circuito C
+static void imprimirDivergencia(const Divergencia& D, const vector<Vetor>& vetores)
+{
+  cerr << "  motor: " << D.motor << '\n'
+       << "  vetor " << D.vetor << ": " << textoVetor(vetores[D.vetor]) << '\n';
+  if (D.onde=="simulacao") cerr << "  a simulacao retornou erro\n";
+  else cerr << "  " << D.onde << ": referencia " << toChar(D.esperado)
+            << ", motor " << toChar(D.obtido) << '\n';
+}
+
+// Grava o caso K: o circuito em arq e os vetores em arq.vet
+// Retorna false se deu erro de escrita
+static bool gravarCaso(const Caso& K, const string& arq)
+{
+  Circuito C;
+  montarCircuito(K.N, C);
+  ofstream F(arq + ".vet");
+  for (unsigned v=0; v<K.vetores.size(); v++) F << textoVetor(K.vetores[v]) << '\n';
+  F.close();
+  return F && C.salvar(arq);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned numCircuitos = 1000, maxNI = 6, maxNP = 40, maxLacos = 3, numVetores = 32;
+  bool todos = false;
+  uint64_t semente = 1;
+  string arqCircuito, arqFalha = "circdiff_falha.txt";
+
+  for (int a=1; a<argc; a++)
+  {
+    string op = argv[a];
+    bool temValor = (a+1<argc);
+    bool ok = true;
+    if (op=="-n" && temValor) ok = lerNumero(argv[++a], numCircuitos);
+    else if (op=="-i" && temValor) ok = lerNumero(argv[++a], maxNI) && maxNI>0;
+    else if (op=="-p" && temValor) ok = lerNumero(argv[++a], maxNP) && maxNP>0;
+    else if (op=="-l" && temValor) ok = lerNumero(argv[++a], maxLacos);
+    else if (op=="-v" && temValor) ok = lerNumero(argv[++a], numVetores);
+    else if (op=="-t") todos = true;
+    else if (op=="-x" && temValor)
+    {
+      char* fim;
+      semente = strtoull(argv[++a], &fim, 10);
+      ok = (*argv[a]!='\0' && *fim=='\0');
+    }
+    else if (op=="-c" && temValor) arqCircuito = argv[++a];
+    else if (op=="-o" && temValor) arqFalha = argv[++a];
+    else if (op=="-h" || op=="--help")
+    {
+      uso();
+      return 0;
+    }
+    else ok = false;
+    if (!ok)
+    {
+      cerr << "circdiff: parametro invalido: " << op << '\n';
+      uso();
+      return 1;
+    }
+  }
+  if (todos && arqCircuito.empty() && maxNI>MAX_ENTRADAS_TODOS)
+  {
+    cerr << "circdiff: -t soh pode ser usado com ateh " << MAX_ENTRADAS_TODOS << " entradas\n";
+    return 1;
+  }
+
+  Circuito lido;
+  if (!arqCircuito.empty())
+  {
+    if (!lido.ler(arqCircuito) || !lido.valid())
+    {
+      cerr << "circdiff: erro ao ler o circuito " << arqCircuito << '\n';
+      return 2;
+    }
+    if (todos && lido.getNumInputs()>MAX_ENTRADAS_TODOS)
+    {
+      cerr << "circdiff: -t soh pode ser usado com ateh " << MAX_ENTRADAS_TODOS << " entradas\n";
+      return 1;
+    }
+    numCircuitos = 1;
+  }
+
+  vector<unique_ptr<Motor> > motores;
+  criarMotores(motores);
+  uint64_t totalVetores = 0;
+  for (unsigned k=0; k<numCircuitos; k++)
+  {
+    GeradorAleatorio G(semente+k);
+    Circuito C;
+    string descricao;
+    if (arqCircuito.empty()) gerarCaso(G, maxNI, maxNP, maxLacos, C, descricao);
+    else
+    {
+      C = lido;
+      descricao = arqCircuito;
+    }
+    Caso K;
+    gerarVetores(G, C.getNumInputs(), todos, numVetores, K.vetores);
+    totalVetores += K.vetores.size();
+
+    Divergencia D;
+    if (!comparar(C, K.vetores, motores, D)) continue;
+
+    cerr << "circdiff: divergencia no circuito " << k;
+    if (arqCircuito.empty()) cerr << " (semente " << semente+k << ")";
+    cerr << ": " << descricao << '\n';
+    imprimirDivergencia(D, K.vetores);
+
+    lerNetlist(C, K.N);
+    reduzir(K, motores, D);
+    cerr << "circdiff: caso minimo: " << K.N.Nin << " entradas, " << K.N.tipos.size()
+         << " portas, " << K.N.saidas.size() << " saidas, " << K.vetores.size() << " vetores\n";
+    imprimirDivergencia(D, K.vetores);
+    if (!gravarCaso(K, arqFalha))
+    {
+      cerr << "circdiff: erro ao gravar " << arqFalha << '\n';
+      return 3;
+    }
+    cerr << "circdiff: gravado em " << arqFalha << " (vetores em " << arqFalha << ".vet)\n";
+    return 4;
+  }
+  cout << "circdiff: " << numCircuitos << " circuitos, " << totalVetores << " vetores, "
+       << motores.size() << " motores: nenhuma divergencia\n";
+  return 0;
+}
@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# circdiff: teste diferencial dos caminhos de simulacao do nucleo
+#
+#-------------------------------------------------
+
+TARGET = circdiff
+
+include(../ferramenta.pri)
+
+SOURCES += circdiff.cpp
@@ -0,0 +1,144 @@
+// circequiv: verificacao de equivalencia de dois circuitos
+//
+// Uso: circequiv [opcoes] CIRCUITO1 CIRCUITO2
+// Verifica se os dois circuitos tem as mesmas saidas (F, T ou ?) para todas as
+// combinacoes de entradas (ver equivalencia.h): primeiro com vetores aleatorios, depois
+// com todas as combinacoes, parando na primeira diferenca (ou, se forem combinacoes
+// demais, com os BDDs das saidas). Se os circuitos forem diferentes, informa as
+// entradas que os distinguem, a saida e os dois valores.
+//
+// Opcoes:
+//   -d           testa apenas entradas F e T (2^NI combinacoes, em vez de 3^NI)
+//   -a N         numero de vetores aleatorios (padrao: 16384)
+//   -m N         numero maximo de combinacoes testadas (padrao: 2^32); acima disso,
+//                usa os BDDs
+//   -x SEMENTE   semente dos vetores aleatorios (padrao: 1)
+//   -b N         numero maximo de nos dos BDDs (padrao: 2^22; 0 = nao usa BDDs); acima
+//                disso, sem contraexemplo, o resultado eh inconclusivo
+//   -j N         numero de threads (padrao: numero de processadores)
+//
+// Codigos de retorno: 0 = equivalentes, 1 = parametros invalidos, 2 = erro de leitura
+// (ou circuitos com numeros de entradas ou saidas diferentes), 4 = diferentes,
+// 5 = inconclusivo
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "circuito.h"
+#include "equivalencia.h"
+
+using namespace std;
+
+static void uso()
+{
+  cerr << "Uso: circequiv [opcoes] CIRCUITO1 CIRCUITO2\n"
+          "  -d          testa apenas entradas F e T\n"
+          "  -a N        numero de vetores aleatorios (padrao: 16384)\n"
+          "  -m N        maximo de combinacoes testadas (padrao: 2^32)\n"
+          "  -x SEMENTE  semente dos vetores aleatorios (padrao: 1)\n"
+          "  -b N        maximo de nos dos BDDs (padrao: 2^22; 0 = sem BDDs)\n"
+          "  -j N        numero de threads (padrao: numero de processadores)\n";
+}
+
+// Le um numero inteiro sem sinal de 64 bits
+// Retorna false se o texto nao for um numero valido
+static bool lerNumero(const char* texto, uint64_t& N)
+{
+  char* fim;
+  N = strtoull(texto, &fim, 10);
+  return (*texto!='\0' && *fim=='\0');
+}
+
+// Le um circuito, listando os problemas do arquivo
+// Retorna false se deu erro
+static bool lerCircuito(const string& arq, Circuito& C)
+{
+  ResultadoLeitura R;
+  if (!C.ler(arq, R))
+  {
+    for (unsigned k=0; k<R.erros.size(); k++) cerr << arq << ':' << R.erros[k] << '\n';
+    return false;
+  }
+  if (!C.valid())
+  {
+    cerr << arq << ": circuito incompleto\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  OpcoesEquivalencia O;
+  string arq[2];
+  unsigned numArqs = 0;
+
+  for (int a=1; a<argc; a++)
+  {
+    string op = argv[a];
+    bool temValor = (a+1<argc);
+    bool ok = true;
+    uint64_t N;
+    if (op=="-d") O.soDefinidas = true;
+    else if (op=="-a" && temValor) ok = lerNumero(argv[++a], O.vetoresAleatorios);
+    else if (op=="-m" && temValor) ok = lerNumero(argv[++a], O.maxVetores);
+    else if (op=="-x" && temValor) ok = lerNumero(argv[++a], O.semente);
+    else if (op=="-b" && temValor)
+    {
+      ok = lerNumero(argv[++a], N) && N<=UINT32_MAX;
+      O.maxNosBDD = size_t(N);
+    }
+    else if (op=="-j" && temValor)
+    {
+      ok = lerNumero(argv[++a], N) && N<=1024;
+      O.numThreads = unsigned(N);
+    }
+    else if (op=="-h" || op=="--help")
+    {
+      uso();
+      return 0;
+    }
+    else if (op.size()>1 && op[0]=='-') ok = false;
+    else if (numArqs<2) arq[numArqs++] = op;
+    else ok = false;
+    if (!ok)
+    {
+      cerr << "circequiv: parametro invalido: " << op << '\n';
+      uso();
+      return 1;
+    }
+  }
+  if (numArqs<2)
+  {
+    uso();
+    return 1;
+  }
+
+  Circuito C1, C2;
+  if (!lerCircuito(arq[0], C1) || !lerCircuito(arq[1], C2)) return 2;
+
+  ResultadoEquivalencia R;
+  equivalentes(C1, C2, &R, O);
+  switch (R.conclusao)
+  {
+  case Equivalencia::EQUIVALENTES:
+    cout << "equivalentes (" << R.vetoresSimulados << " vetores simulados";
+    if (R.nosBDD>0) cout << ", BDDs com " << R.nosBDD << " nos";
+    cout << ")\n";
+    return 0;
+  case Equivalencia::DIFERENTES:
+    cout << "diferentes: entradas ";
+    for (unsigned j=0; j<R.contraExemplo.size(); j++) cout << R.contraExemplo[j];
+    cout << ", saida " << R.IdOutput << ": " << R.saida1 << " em " << arq[0] << ", "
+         << R.saida2 << " em " << arq[1] << '\n';
+    return 4;
+  case Equivalencia::INCOMPATIVEIS:
+    cerr << "circequiv: os circuitos tem numeros de entradas ou de saidas diferentes\n";
+    return 2;
+  default:
+    cout << "inconclusivo: nenhuma diferenca em " << R.vetoresSimulados
+         << " vetores aleatorios (combinacoes demais para testar todas, ver -m, e BDDs"
+            " grandes demais, ver -b)\n";
+    return 5;
+  }
+}
@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# circequiv: verificacao de equivalencia de dois circuitos
+#
+#-------------------------------------------------
+
+TARGET = circequiv
+
+include(../ferramenta.pri)
+
+SOURCES += circequiv.cpp
@@ -0,0 +1,178 @@
+// circgen: gerador de circuitos sinteticos em linha de comando
+//
+// Uso: circgen [opcoes] FAMILIA [N]
+// Familias:
+//   aleatorio       circuito aleatorio em camadas (ver as opcoes abaixo)
+//   ripple N        somador de N bits com propagacao do vai-um
+//   cla N           somador de N bits com antecipacao do vai-um
+//   multiplicador N multiplicador em matriz de N bits
+//   paridade N      arvore de paridade com N entradas
+//   contador N      contador sincrono de N bits, com flip-flops (reset e habilitacao)
+// Opcoes do circuito aleatorio:
+//   -i NI        numero de entradas (padrao: 16)
+//   -s NO        numero de saidas (padrao: 16)
+//   -n NP        numero de portas (padrao: 1000)
+//   -d D         profundidade, em niveis de portas (padrao: 10)
+//   -e MIN,MAX   numero de entradas de cada porta (padrao: 2,4); para a arvore de
+//                paridade, soh MAX eh usado
+//   -f F         numero maximo de portas ligadas a cada sinal (padrao: 0 = sem limite)
+//   -l L         numero de lacos (padrao: 0)
+//   -x SEMENTE   semente do gerador (padrao: 1)
+// Opcoes de qualquer familia:
+//   -a MAX       sorteia o atraso de cada porta, de 1 a MAX (com a semente de -x), para
+//                a simulacao com atrasos (circsim -d); sem -a, todas tem atraso 1
+// Saida:
+//   -o ARQ       escreve o circuito em ARQ, em vez da saida padrao
+//   -F FORMATO   circuito (o formato lido pela aplicacao), verilog ou bench; o padrao
+//                eh deduzido da extensao de ARQ (.v = verilog, .bench = bench)
+//
+// O mesmo comando gera sempre o mesmo circuito, em qualquer maquina (ver gerador.h).
+//
+// Codigos de retorno: 0 = OK, 1 = parametros invalidos, 3 = erro de escrita
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "circuito.h"
+#include "gerador.h"
+
+using namespace std;
+
+static void uso()
+{
+  cerr << "Uso: circgen [opcoes] FAMILIA [N]\n"
+          "Familias: aleatorio, ripple N, cla N, multiplicador N, paridade N,\n"
+          "          contador N\n"
+          "  -i NI       entradas do circuito aleatorio (padrao: 16)\n"
+          "  -s NO       saidas do circuito aleatorio (padrao: 16)\n"
+          "  -n NP       portas do circuito aleatorio (padrao: 1000)\n"
+          "  -d D        profundidade do circuito aleatorio (padrao: 10)\n"
+          "  -e MIN,MAX  entradas de cada porta (padrao: 2,4)\n"
+          "  -f F        maximo de portas ligadas a cada sinal (padrao: 0 = sem limite)\n"
+          "  -l L        numero de lacos do circuito aleatorio (padrao: 0)\n"
+          "  -x SEMENTE  semente do gerador (padrao: 1)\n"
+          "  -a MAX      sorteia o atraso de cada porta, de 1 a MAX\n"
+          "  -o ARQ      escreve o circuito em ARQ, em vez da saida padrao\n"
+          "  -F FORMATO  circuito, verilog ou bench (padrao: pela extensao de ARQ)\n";
+}
+
+// Le um numero inteiro sem sinal
+// Retorna false se o texto nao for um numero valido
+static bool lerNumero(const char* texto, unsigned& N)
+{
+  char* fim;
+  unsigned long v = strtoul(texto, &fim, 10);
+  if (*texto=='\0' || *fim!='\0' || v>0xFFFFFFFFUL) return false;
+  N = unsigned(v);
+  return true;
+}
+
+// Retorna true se nome termina com ext
+static bool terminaCom(const string& nome, const string& ext)
+{
+  return nome.size()>=ext.size() && nome.compare(nome.size()-ext.size(), ext.size(), ext)==0;
+}
+
+int main(int argc, char *argv[])
+{
+  ParametrosGerador P;
+  string familia, arqSaida, formato;
+  unsigned N = 0, maxAtraso = 0;
+  bool temN = false;
+
+  for (int a=1; a<argc; a++)
+  {
+    string op = argv[a];
+    bool temValor = (a+1<argc);
+    bool ok = true;
+    if (op=="-i" && temValor) ok = lerNumero(argv[++a], P.numInputs);
+    else if (op=="-s" && temValor) ok = lerNumero(argv[++a], P.numOutputs);
+    else if (op=="-n" && temValor) ok = lerNumero(argv[++a], P.numPorts);
+    else if (op=="-d" && temValor) ok = lerNumero(argv[++a], P.profundidade);
+    else if (op=="-e" && temValor)
+    {
+      string v = argv[++a];
+      size_t virgula = v.find(',');
+      if (virgula==string::npos) ok = lerNumero(v.c_str(), P.maxEntradasPorta);
+      else ok = lerNumero(v.substr(0, virgula).c_str(), P.minEntradasPorta) &&
+                lerNumero(v.substr(virgula+1).c_str(), P.maxEntradasPorta);
+    }
+    else if (op=="-f" && temValor) ok = lerNumero(argv[++a], P.maxFanout);
+    else if (op=="-l" && temValor) ok = lerNumero(argv[++a], P.numLacos);
+    else if (op=="-a" && temValor) ok = lerNumero(argv[++a], maxAtraso);
+    else if (op=="-x" && temValor)
+    {
+      char* fim;
+      P.semente = strtoull(argv[++a], &fim, 10);
+      ok = (*argv[a]!='\0' && *fim=='\0');
+    }
+    else if (op=="-o" && temValor) arqSaida = argv[++a];
+    else if (op=="-F" && temValor) formato = argv[++a];
+    else if (op=="-h" || op=="--help")
+    {
+      uso();
+      return 0;
+    }
+    else if (op.size()>1 && op[0]=='-') ok = false;
+    else if (familia.empty()) familia = op;
+    else if (!temN) ok = temN = lerNumero(op.c_str(), N);
+    else ok = false;
+    if (!ok)
+    {
+      cerr << "circgen: parametro invalido: " << op << '\n';
+      uso();
+      return 1;
+    }
+  }
+  if (formato.empty())
+  {
+    if (terminaCom(arqSaida, ".v")) formato = "verilog";
+    else if (terminaCom(arqSaida, ".bench")) formato = "bench";
+    else formato = "circuito";
+  }
+  if (formato!="circuito" && formato!="verilog" && formato!="bench")
+  {
+    cerr << "circgen: formato invalido: " << formato << '\n';
+    return 1;
+  }
+
+  Circuito C;
+  bool ok;
+  if (familia=="aleatorio") ok = !temN && gerarCircuito(C, P);
+  else if (familia=="ripple") ok = temN && gerarSomadorRipple(C, N);
+  else if (familia=="cla") ok = temN && gerarSomadorCLA(C, N);
+  else if (familia=="multiplicador") ok = temN && gerarMultiplicador(C, N);
+  else if (familia=="paridade") ok = temN && gerarParidade(C, N, P.maxEntradasPorta);
+  else if (familia=="contador") ok = temN && gerarContador(C, N);
+  else ok = false;
+  if (ok && maxAtraso>0) ok = sortearAtrasos(C, maxAtraso, P.semente);
+  if (!ok)
+  {
+    cerr << "circgen: familia ou parametros invalidos\n";
+    uso();
+    return 1;
+  }
+
+  ofstream arquivo;
+  if (!arqSaida.empty())
+  {
+    arquivo.open(arqSaida);
+    if (!arquivo.is_open())
+    {
+      cerr << "circgen: erro ao abrir " << arqSaida << '\n';
+      return 3;
+    }
+  }
+  ostream& O = (arqSaida.empty() ? cout : arquivo);
+  if (formato=="verilog") C.exportarVerilog(O);
+  else if (formato=="bench") C.exportarBench(O);
+  else C.imprimir(O);
+  O.flush();
+  if (!O)
+  {
+    cerr << "circgen: erro de escrita\n";
+    return 3;
+  }
+  return 0;
+}
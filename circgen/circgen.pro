@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# circgen: gerador de circuitos sinteticos (aleatorios, somadores, multiplicadores, ...)
+#
+#-------------------------------------------------
+
+TARGET = circgen
+
+include(../ferramenta.pri)
+
+SOURCES += circgen.cpp
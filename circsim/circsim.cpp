@@ -0,0 +1,450 @@
+// circsim: simulador de circuitos em linha de comando (sem interface grafica)
+//
+// Uso: circsim [opcoes] CIRCUITO
+//   -v ARQ   simula os vetores de entrada do arquivo ARQ ("-" = entrada padrao)
+//   -t       gera a tabela verdade completa, em texto
+//   -T ARQ   gera a tabela verdade completa no arquivo ARQ, no formato binario da
+//            TabelaMapeada (o mesmo da exportacao da interface)
+//   -o ARQ   escreve os resultados em ARQ, em vez da saida padrao
+//   -j N     numero de threads de simulacao (padrao: numero de processadores)
+//   -e       ao final, imprime na saida de erro os contadores da simulacao (soh se o
+//            nucleo foi compilado com CIRCUITO_ESTATISTICAS, ver estatisticas.h); os
+//            vetores sao simulados com SimuladorLote, 64 de cada vez, e as passadas e
+//            avaliacoes de portas sao contadas por bloco de 64 vetores
+//   -r ARQ   grava em ARQ o rastro da execucao (leitura, simulacao de cada bloco em
+//            cada thread, escrita), no formato JSON de eventos do Chrome (ver rastro.h)
+//   -s V     simulacao sequencial (com -v): cada vetor eh um ciclo de clock e o estado
+//            dos flip-flops (portas DF) passa de um vetor para o seguinte; os
+//            flip-flops comecam no estado V (F, T ou ?). As saidas de cada ciclo sao
+//            as de antes da borda do clock (ver SimuladorSequencial). Usa uma thread
+//   -d P     simulacao com os atrasos das portas (com -v): o vetor k eh aplicado no
+//            instante k*P e o resultado sao as mudancas das saidas ao longo do tempo,
+//            incluindo os pulsos espurios (ver SimuladorTemporizado). Usa uma thread
+//
+// Vetores: um por linha, com um caractere por entrada do circuito (F, T ou ?; tambem
+// 0, 1 e X), separados ou nao por espacos. Linhas vazias e linhas comecando com #
+// sao ignoradas.
+// Resultado (-v e -t): uma linha por vetor (ou linha da tabela, ou ciclo), com as
+// entradas, um espaco e as saidas, por exemplo "FT? TF"
+// Resultado com -d: uma linha por instante em que alguma saida mudou, com o instante,
+// um espaco e os valores de todas as saidas depois das mudancas, por exemplo "12 TF"
+//
+// Codigos de retorno: 0 = OK, 1 = parametros invalidos, 2 = erro de leitura
+// (circuito ou vetores), 3 = erro de escrita
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "circuito.h"
+#include "rastro.h"
+#include "simuladorlote.h"
+#include "simuladorsequencial.h"
+#include "simuladortemporizado.h"
+#include "tabelaverdade.h"
+
+using namespace std;
+
+// Numero de vetores (ou linhas da tabela) simulados de cada vez: cada bloco eh
+// dividido entre as threads e escrito de uma vez
+static const unsigned VETORES_BLOCO = 1<<16;
+
+static void uso()
+{
+  cerr << "Uso: circsim [opcoes] CIRCUITO\n"
+          "  -v ARQ   simula os vetores de entrada do arquivo ARQ (\"-\" = entrada padrao)\n"
+          "  -t       gera a tabela verdade completa, em texto\n"
+          "  -T ARQ   gera a tabela verdade completa no arquivo binario ARQ\n"
+          "  -o ARQ   escreve os resultados em ARQ, em vez da saida padrao\n"
+          "  -j N     numero de threads de simulacao (padrao: numero de processadores)\n"
+          "  -e       imprime os contadores da simulacao na saida de erro\n"
+          "  -r ARQ   grava o rastro da execucao em ARQ (JSON de eventos do Chrome)\n"
+          "  -s V     simulacao por ciclos de clock (com -v), flip-flops comecando em V\n"
+          "  -d P     simulacao com atrasos (com -v), um vetor a cada P instantes\n";
+}
+
+// Converte um caractere de vetor no valor correspondente
+// Retorna false se nao for um valor valido
+static bool lerValor(char c, bool3S& B)
+{
+  switch (c)
+  {
+  case 'F': case 'f': case '0':
+    B = bool3S::FALSE;
+    return true;
+  case 'T': case 't': case '1':
+    B = bool3S::TRUE;
+    return true;
+  case '?': case 'X': case 'x':
+    B = bool3S::UNDEF;
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Um bloco de vetores: as entradas de N vetores em sequencia (N*NI valores)
+// e o texto do resultado de cada thread
+struct Bloco {
+  vector<bool3S> entradas;
+  unsigned N;
+  vector<string> texto;
+};
+
+// Escreve em texto o resultado de N vetores: as entradas (N*NI valores) e as saidas
+// empacotadas (N linhas de bytesPorLinha(NO) bytes)
+static void escreverTexto(const bool3S* entradas, const uint8_t* saidas, unsigned N,
+                          unsigned NI, unsigned NO, string& texto)
+{
+  unsigned bl = bytesPorLinha(NO);
+  texto.clear();
+  texto.reserve(size_t(N)*(NI+NO+2));
+  for (unsigned k=0; k<N; k++)
+  {
+    const bool3S* v = entradas + size_t(k)*NI;
+    const uint8_t* linha = saidas + size_t(k)*bl;
+    for (unsigned j=0; j<NI; j++) texto += toChar(v[j]);
+    texto += ' ';
+    for (unsigned i=0; i<NO; i++) texto += toChar(lerValor(linha, i));
+    texto += '\n';
+  }
+}
+
+// Simula os vetores do bloco de ini ateh fim-1 com o simulador S, de uma vez, e
+// escreve o resultado em texto
+static void simularBloco(SimuladorLote& S, const Bloco& B, unsigned ini, unsigned fim,
+                         string& texto)
+{
+  RASTRO("simular vetores", fim-ini);
+  unsigned NI = S.getNumInputs();
+  unsigned NO = S.getNumOutputs();
+  vector<uint8_t> saidas(size_t(fim-ini)*bytesPorLinha(NO));
+  const bool3S* entradas = B.entradas.data() + size_t(ini)*NI;
+  S.simularLote(entradas, fim-ini, saidas.data());
+  escreverTexto(entradas, saidas.data(), fim-ini, NI, NO, texto);
+}
+
+// Simula o bloco dividido entre as threads (um simulador por thread) e escreve o
+// resultado, na ordem dos vetores
+// Retorna false se deu erro de escrita
+static bool processarBloco(vector<SimuladorLote>& S, Bloco& B, FILE* saida)
+{
+  unsigned T = unsigned(S.size());
+  B.texto.resize(T);
+  unsigned porThread = (B.N+T-1)/T;
+  vector<thread> threads;
+  for (unsigned t=1; t<T; t++)
+  {
+    unsigned ini = min(B.N, t*porThread), fim = min(B.N, (t+1)*porThread);
+    threads.push_back(thread(simularBloco, ref(S[t]), cref(B), ini, fim, ref(B.texto[t])));
+  }
+  simularBloco(S[0], B, 0, min(B.N, porThread), B.texto[0]);
+  for (unsigned t=0; t<threads.size(); t++) threads[t].join();
+  RASTRO("escrever", B.N);
+  for (unsigned t=0; t<T; t++)
+  {
+    if (fwrite(B.texto[t].data(), 1, B.texto[t].size(), saida)!=B.texto[t].size()) return false;
+  }
+  return true;
+}
+
+// Simula os vetores do bloco como ciclos de clock sucessivos, com o simulador
+// sequencial Q (que guarda o estado dos flip-flops de um bloco para o seguinte), e
+// escreve o resultado
+// Retorna false se deu erro de escrita
+static bool processarCiclos(SimuladorSequencial& Q, Bloco& B, FILE* saida)
+{
+  B.texto.resize(1);
+  vector<uint8_t> saidas(size_t(B.N)*bytesPorLinha(Q.getNumOutputs()));
+  Q.simularCiclos(B.entradas.data(), B.N, saidas.data());
+  escreverTexto(B.entradas.data(), saidas.data(), B.N, Q.getNumInputs(), Q.getNumOutputs(), B.texto[0]);
+  RASTRO("escrever", B.N);
+  return fwrite(B.texto[0].data(), 1, B.texto[0].size(), saida)==B.texto[0].size();
+}
+
+// Simula os vetores do bloco com o simulador T, um a cada periodo instantes, a partir
+// do instante atual, e escreve as mudancas das saidas; atuais guarda o valor das
+// saidas de um bloco para o seguinte
+// Retorna false se deu erro de escrita
+static bool processarEventos(SimuladorTemporizado& T, uint64_t periodo, vector<bool3S>& atuais,
+                             Bloco& B, FILE* saida)
+{
+  B.texto.resize(1);
+  string& texto = B.texto[0];
+  texto.clear();
+  T.limparRegistro();
+  T.simular(B.entradas.data(), B.N, periodo);
+  const vector<SimuladorTemporizado::Mudanca>& R = T.getRegistro();
+  for (size_t k=0; k<R.size(); )
+  {
+    uint64_t tempo = R[k].tempo;
+    for (; k<R.size() && R[k].tempo==tempo; k++) atuais[R[k].IdOutput-1] = R[k].valor;
+    texto += to_string(tempo);
+    texto += ' ';
+    for (unsigned i=0; i<atuais.size(); i++) texto += toChar(atuais[i]);
+    texto += '\n';
+  }
+  RASTRO("escrever", B.N);
+  return fwrite(texto.data(), 1, texto.size(), saida)==texto.size();
+}
+
+// Simula todos os vetores lidos de entrada, com NI valores cada, passando cada bloco
+// lido para processar (que retorna false se deu erro de escrita)
+// Retorna o codigo de retorno do programa
+static int simularVetores(unsigned NI, istream& entrada, const string& nome,
+                          const function<bool(Bloco&)>& processar)
+{
+  Bloco B;
+  B.entradas.reserve(size_t(VETORES_BLOCO)*NI);
+  B.N = 0;
+  string linha;
+  unsigned long numLinha = 0;
+  while (getline(entrada, linha))
+  {
+    numLinha++;
+    size_t n0 = B.entradas.size();
+    bool3S V;
+    bool vazia = true;
+    for (size_t p=0; p<linha.size(); p++)
+    {
+      char c = linha[p];
+      if (c==' ' || c=='\t' || c=='\r') continue;
+      if (vazia && c=='#') break;
+      vazia = false;
+      if (!lerValor(c, V))
+      {
+        cerr << nome << ':' << numLinha << ':' << p+1 << ": valor invalido '" << c << "'\n";
+        return 2;
+      }
+      B.entradas.push_back(V);
+    }
+    if (vazia) continue;
+    if (B.entradas.size()-n0 != NI)
+    {
+      cerr << nome << ':' << numLinha << ": esperados " << NI << " valores, lidos "
+           << B.entradas.size()-n0 << '\n';
+      return 2;
+    }
+    if (++B.N==VETORES_BLOCO)
+    {
+      if (!processar(B)) return 3;
+      B.entradas.clear();
+      B.N = 0;
+    }
+  }
+  if (B.N>0 && !processar(B)) return 3;
+  return 0;
+}
+
+// Simula todas as linhas da tabela verdade, em ordem
+// Retorna o codigo de retorno do programa
+static int simularTabela(vector<SimuladorLote>& S, FILE* saida)
+{
+  unsigned NI = S[0].getNumInputs();
+  if (NI>=40)
+  {
+    cerr << "circsim: tabela verdade grande demais (" << NI << " entradas)\n";
+    return 1;
+  }
+  uint64_t total = numLinhasTabela(NI);
+  Bloco B;
+  vector<bool3S> in_circ;
+  for (uint64_t L=0; L<total; L+=VETORES_BLOCO)
+  {
+    B.N = unsigned(total-L<VETORES_BLOCO ? total-L : VETORES_BLOCO);
+    B.entradas.resize(size_t(B.N)*NI);
+    // As entradas das linhas (mesma ordem da tabela exibida na interface)
+    entradasLinha(L, NI, in_circ);
+    for (unsigned k=0; k<B.N; k++)
+    {
+      copy(in_circ.begin(), in_circ.end(), B.entradas.begin()+size_t(k)*NI);
+      int j = int(NI)-1;
+      while (j>=0 && in_circ[j]==bool3S::TRUE)
+      {
+        in_circ[j] = bool3S::UNDEF;
+        j--;
+      }
+      if (j>=0) in_circ[j]++;
+    }
+    if (!processarBloco(S, B, saida)) return 3;
+  }
+  return 0;
+}
+
+// Salva o rastro da execucao (se pedido) ao sair de main, em qualquer retorno
+struct GravacaoRastro {
+  string arq;
+  ~GravacaoRastro()
+  {
+    if (!arq.empty() && !salvarRastro(arq)) cerr << "circsim: erro ao gravar o rastro em " << arq << '\n';
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  string arqCircuito, arqVetores, arqTabela, arqSaida, arqRastro;
+  bool tabelaTexto = false, imprimirEstatisticas = false, sequencial = false;
+  bool3S estadoInicial = bool3S::UNDEF;
+  uint64_t periodo = 0;
+  unsigned numThreads = thread::hardware_concurrency();
+
+  for (int a=1; a<argc; a++)
+  {
+    string op = argv[a];
+    bool temValor = (a+1<argc);
+    if (op=="-v" && temValor) arqVetores = argv[++a];
+    else if (op=="-t") tabelaTexto = true;
+    else if (op=="-T" && temValor) arqTabela = argv[++a];
+    else if (op=="-o" && temValor) arqSaida = argv[++a];
+    else if (op=="-j" && temValor) numThreads = unsigned(atoi(argv[++a]));
+    else if (op=="-e") imprimirEstatisticas = true;
+    else if (op=="-r" && temValor) arqRastro = argv[++a];
+    else if (op=="-s" && temValor)
+    {
+      sequencial = true;
+      string v = argv[++a];
+      if (v.size()!=1 || !lerValor(v[0], estadoInicial))
+      {
+        cerr << "circsim: estado inicial invalido: " << v << '\n';
+        return 1;
+      }
+    }
+    else if (op=="-d" && temValor)
+    {
+      char* fim;
+      periodo = strtoull(argv[++a], &fim, 10);
+      if (*argv[a]=='\0' || *fim!='\0' || periodo==0)
+      {
+        cerr << "circsim: periodo invalido: " << argv[a] << '\n';
+        return 1;
+      }
+    }
+    else if (op=="-h" || op=="--help")
+    {
+      uso();
+      return 0;
+    }
+    else if (op.size()>1 && op[0]=='-')
+    {
+      cerr << "circsim: opcao invalida ou incompleta: " << op << '\n';
+      uso();
+      return 1;
+    }
+    else if (arqCircuito.empty()) arqCircuito = op;
+    else
+    {
+      uso();
+      return 1;
+    }
+  }
+  if (arqCircuito.empty() || (arqVetores.empty() && !tabelaTexto && arqTabela.empty()) ||
+      ((sequencial || periodo>0) && (arqVetores.empty() || tabelaTexto || !arqTabela.empty())) ||
+      (sequencial && periodo>0))
+  {
+    uso();
+    return 1;
+  }
+  if (numThreads==0) numThreads = 1;
+  GravacaoRastro rastro;
+  if (!arqRastro.empty())
+  {
+    iniciarRastro();
+    rastro.arq = arqRastro;
+  }
+
+  // Leitura do circuito (todos os problemas do arquivo sao listados)
+  Circuito C;
+  ResultadoLeitura R;
+  if (!C.ler(arqCircuito, R))
+  {
+    for (unsigned k=0; k<R.erros.size(); k++) cerr << arqCircuito << ':' << R.erros[k] << '\n';
+    return 2;
+  }
+  if (!C.valid())
+  {
+    cerr << arqCircuito << ": circuito incompleto\n";
+    return 2;
+  }
+
+  // Tabela em arquivo binario
+  if (!arqTabela.empty() && !gerarTabelaArquivo(C, arqTabela))
+  {
+    cerr << "circsim: erro ao gerar a tabela verdade em " << arqTabela << '\n';
+    return 3;
+  }
+  if (arqVetores.empty() && !tabelaTexto) return 0;
+
+  // Um simulador por thread, todos copias do primeiro
+  vector<SimuladorLote> S(1);
+  S[0].montar(C);
+  S[0].zerarEstatisticas();
+  S.resize(numThreads, S[0]);
+
+  FILE* saida = stdout;
+  if (!arqSaida.empty())
+  {
+    saida = fopen(arqSaida.c_str(), "wb");
+    if (saida==nullptr)
+    {
+      cerr << "circsim: erro ao abrir " << arqSaida << '\n';
+      return 3;
+    }
+  }
+
+  // O processamento de cada bloco de vetores: em lote (padrao), por ciclos de clock (-s)
+  // ou com atrasos (-d)
+  SimuladorSequencial Q;
+  SimuladorTemporizado T;
+  vector<bool3S> saidasAtuais;
+  function<bool(Bloco&)> processar = [&](Bloco& B) {return processarBloco(S, B, saida);};
+  if (sequencial)
+  {
+    Q.montar(C);
+    Q.reiniciar(estadoInicial);
+    processar = [&](Bloco& B) {return processarCiclos(Q, B, saida);};
+  }
+  else if (periodo>0)
+  {
+    T.montar(C);
+    saidasAtuais.assign(C.getNumOutputs(), bool3S::UNDEF);
+    processar = [&](Bloco& B) {return processarEventos(T, periodo, saidasAtuais, B, saida);};
+  }
+
+  int ret = 0;
+  if (!arqVetores.empty())
+  {
+    if (arqVetores=="-")
+    {
+      ios::sync_with_stdio(false);
+      ret = simularVetores(C.getNumInputs(), cin, "<entrada>", processar);
+    }
+    else
+    {
+      ifstream entrada(arqVetores);
+      if (!entrada.is_open())
+      {
+        cerr << "circsim: erro ao abrir " << arqVetores << '\n';
+        ret = 2;
+      }
+      else ret = simularVetores(C.getNumInputs(), entrada, arqVetores, processar);
+    }
+  }
+  if (ret==0 && tabelaTexto) ret = simularTabela(S, saida);
+  if ((saida!=stdout ? fclose(saida) : fflush(saida))!=0 && ret==0) ret = 3;
+  if (ret==3) cerr << "circsim: erro de escrita\n";
+  if (ret==0 && imprimirEstatisticas)
+  {
+    // Os contadores de todas as threads (o tempo eh a soma dos tempos das threads)
+    SimStats total = Q.getEstatisticas();
+    total += T.getEstatisticas();
+    for (unsigned t=0; t<S.size(); t++) total += S[t].getEstatisticas();
+    total.imprimir(cerr);
+    if (periodo>0) cerr << "eventos: " << T.getEventos() << '\n';
+  }
+  return ret;
+}
@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# circsim: simulador de circuitos em linha de comando
+#
+#-------------------------------------------------
+
+TARGET = circsim
+
+include(../ferramenta.pri)
+
+SOURCES += circsim.cpp
@@ -4,6 +4,14 @@
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <thread>
+#include <algorithm>
+#include "arquivomapeado.h"
+#include "leitura.h"
+#include "rastro.h"
 using namespace std;
 ///
 /// As strings que definem os tipos de porta
@@ -19,7 +27,8 @@ bool validType(std::string& Tipo)
     if (Tipo=="NT" ||
             Tipo=="AN" || Tipo=="NA" ||
             Tipo=="OR" || Tipo=="NO" ||
-            Tipo=="XO" || Tipo=="NX") return true;
+            Tipo=="XO" || Tipo=="NX" ||
+            Tipo=="DF") return true;
     return false;
 }
 
@@ -37,11 +46,49 @@ ptr_Port allocPort(std::string& Tipo)
     if (Tipo=="NO") return new Port_NOR;
     if (Tipo=="XO") return new Port_XOR;
     if (Tipo=="NX") return new Port_NXOR;
+    if (Tipo=="DF") return new Port_DFF;
 
     // Nunca deve chegar aqui...
     return nullptr;
 }
 
+// Funcoes auxiliares que retornam o nome da primitiva equivalente a um tipo de porta
+// (AN, OR, etc.) em Verilog estrutural e no formato .bench (ISCAS)
+// Caso o tipo nao seja nenhum dos validos, retorna uma string vazia
+// (o flip-flop nao eh uma primitiva do Verilog: eh exportado como um reg, ver exportarVerilog)
+std::string nomeVerilog(const std::string& Tipo)
+{
+    if (Tipo=="NT") return "not";
+    if (Tipo=="AN") return "and";
+    if (Tipo=="NA") return "nand";
+    if (Tipo=="OR") return "or";
+    if (Tipo=="NO") return "nor";
+    if (Tipo=="XO") return "xor";
+    if (Tipo=="NX") return "xnor";
+    return "";
+}
+
+std::string nomeBench(const std::string& Tipo)
+{
+    if (Tipo=="NT") return "NOT";
+    if (Tipo=="AN") return "AND";
+    if (Tipo=="NA") return "NAND";
+    if (Tipo=="OR") return "OR";
+    if (Tipo=="NO") return "NOR";
+    if (Tipo=="XO") return "XOR";
+    if (Tipo=="NX") return "XNOR";
+    if (Tipo=="DF") return "DFF";
+    return "";
+}
+
+// Funcao auxiliar que escreve o nome do sinal que corresponde a uma id de origem
+// (in# para entradas do circuito, p# para saidas de portas)
+void imprimirSinal(std::ostream& O, int IdOrig)
+{
+    if (IdOrig<0) O << "in" << -IdOrig;
+    else O << 'p' << IdOrig;
+}
+
 ///
 /// CLASSE CIRCUITO
 ///
@@ -49,14 +96,15 @@ ptr_Port allocPort(std::string& Tipo)
 /// ***********************
 /// Inicializacao e finalizacao
 /// ***********************
-Circuito::Circuito():id_out(),out_circ(),ports()
+Circuito::Circuito():Nin(0),id_out(),out_circ(),ports(),
+    arqBase(),portasAlteradas(),saidasAlteradas(),registrosDiario(0),estatisticas()
 {
 }
 Circuito::~Circuito()
 {
     clear();
 }
-Circuito::Circuito(const Circuito& C)
+Circuito::Circuito(const Circuito& C):registrosDiario(0)
 {
     Nin = C.Nin;
     id_out = C.id_out;
@@ -73,6 +121,10 @@ void Circuito::clear()
     id_out.clear();
     out_circ.clear();
     Nin = 0;
+    arqBase.clear();
+    portasAlteradas.clear();
+    saidasAlteradas.clear();
+    registrosDiario = 0;
     for(unsigned i=0; i<ports.size(); i++)
     {
         if (ports[i]!=nullptr) delete ports[i];
@@ -80,6 +132,18 @@ void Circuito::clear()
     ports.clear();
 }
 
+void Circuito::swap(Circuito& C)
+{
+    std::swap(Nin, C.Nin);
+    id_out.swap(C.id_out);
+    out_circ.swap(C.out_circ);
+    ports.swap(C.ports);
+    arqBase.swap(C.arqBase);
+    portasAlteradas.swap(C.portasAlteradas);
+    saidasAlteradas.swap(C.saidasAlteradas);
+    std::swap(registrosDiario, C.registrosDiario);
+}
+
 void Circuito::resize(unsigned NI, unsigned NO, unsigned NP)
 {
     if(NI<=0 && NO<=0 && NP<=0) return;
@@ -91,10 +155,14 @@ void Circuito::resize(unsigned NI, unsigned NO, unsigned NP)
 }
 void Circuito::operator=(const Circuito& C)
 {
-    for(unsigned i=0; i<ports.size(); i++)if (ports[i]!=nullptr) delete ports[i];
-    for (unsigned i = 0; i < C.getNumPorts(); i++) ports.push_back(C.ports[i] ->clone());
-    for ( unsigned i = 0; i < C.getNumOutputs(); i++)id_out.push_back(C.id_out[i]);
-    for (unsigned i = 0; i < C.getNumInputs(); i++) out_circ.push_back(C.out_circ[i]);
+    if (this==&C) return;
+    // Mesmo conteudo do construtor por copia: o vetor ports eh esvaziado (clear) antes
+    // de receber os clones, e nao apenas liberado
+    clear();
+    Nin = C.Nin;
+    id_out = C.id_out;
+    out_circ = C.out_circ;
+    for (unsigned i = 0; i < C.getNumPorts(); i++) ports.push_back(C.ports[i]->clone());
 }
 
 /// ***********************
@@ -155,6 +223,7 @@ bool Circuito::validPort(int IdPort) const
 // Essa funcao deve ser usada antes de salvar ou simular um circuito
 bool Circuito::valid() const
 {
+    RASTRO("validar");
     if (getNumInputs()<=0) return false;
     if (getNumOutputs()<=0) return false;
     if (getNumPorts()<=0) return false;
@@ -222,6 +291,11 @@ unsigned Circuito::getNumInputsPort(int IdPort) const
     }
 }
 
+unsigned Circuito::getAtrasoPort(int IdPort) const
+{
+    if (!definedPort(IdPort)) return 0;
+    return ports[IdPort-1]->getAtraso();
+}
 int Circuito::getId_inPort(int IdPort, unsigned I) const
 {
     if (definedPort(IdPort) && ports[IdPort-1] -> validIndex(I))  // && testar o indice da entrada I
@@ -233,6 +307,19 @@ int Circuito::getId_inPort(int IdPort, unsigned I) const
         return 0;
     }
 }
+
+bool3S Circuito::getOutputPort(int IdPort) const
+{
+    if (definedPort(IdPort))
+    {
+        return ports[IdPort-1]->getOutput();
+    }
+    else
+    {
+        return bool3S::UNDEF;
+    }
+}
+
 std::string Circuito::getNamePort(int IdPort) const
 {
     if (definedPort(IdPort))
@@ -244,6 +331,51 @@ std::string Circuito::getNamePort(int IdPort) const
         return "??";
     }
 }
+// Acumula os valores de 32 bits que descrevem a estrutura do circuito em dois hashes
+// de 64 bits independentes (FNV-1a e uma mistura multiplicativa), para a impressao digital
+struct HashCircuito
+{
+    uint64_t h1, h2;
+    HashCircuito(): h1(0xcbf29ce484222325ULL), h2(0x9e3779b97f4a7c15ULL) {}
+    void acrescentar(uint32_t v)
+    {
+        for (int i=0; i<4; i++)
+        {
+            h1 = (h1 ^ uint8_t(v>>(8*i))) * 0x100000001b3ULL;
+        }
+        h2 = (h2 ^ v) * 0xff51afd7ed558ccdULL;
+        h2 ^= h2>>32;
+    }
+};
+
+std::string Circuito::impressaoDigital() const
+{
+    if (!valid()) return "";
+    HashCircuito H;
+    // Versao do formato da impressao digital
+    H.acrescentar(1);
+    H.acrescentar(getNumInputs());
+    H.acrescentar(getNumOutputs());
+    H.acrescentar(getNumPorts());
+    for (unsigned i=0; i<getNumPorts(); i++)
+    {
+        std::string nome = ports[i]->getName();
+        H.acrescentar(uint32_t(nome.size()));
+        for (unsigned k=0; k<nome.size(); k++) H.acrescentar(uint8_t(nome[k]));
+        H.acrescentar(ports[i]->getNumInputs());
+        for (unsigned j=0; j<ports[i]->getNumInputs(); j++)
+        {
+            H.acrescentar(uint32_t(ports[i]->getId_in(j)));
+        }
+    }
+    for (unsigned j=0; j<getNumOutputs(); j++) H.acrescentar(uint32_t(id_out[j]));
+
+    char hex[33];
+    snprintf(hex, sizeof(hex), "%016llx%016llx",
+             (unsigned long long)H.h1, (unsigned long long)H.h2);
+    return hex;
+}
+
 /// ***********************
 /// Funcoes de modificacao
 /// ***********************
@@ -252,23 +384,36 @@ void Circuito::setIdOutput(int IdOut, int IdOrig)
     if(validIdOutput(IdOut) && validIdOrig(IdOrig))
     {
         id_out[IdOut-1] = IdOrig;
+        saidasAlteradas.push_back(IdOut);
     }
 }
 void Circuito::setPort(int IdPort, std::string Tipo, unsigned NIn)
 {
 
-    if(!validIdPort(IdPort) && !validIdInput(Nin) && !validType(Tipo)){
+    if(!validIdPort(IdPort) || !validType(Tipo)){
         return;
     }
+    unsigned atraso = (ports[IdPort-1]!=nullptr ? ports[IdPort-1]->getAtraso() : Port::ATRASO_PADRAO);
     delete ports[IdPort-1];
     ports[IdPort-1] = allocPort(Tipo);
     ports[IdPort-1]->setNumInputs(NIn);
+    ports[IdPort-1]->setAtraso(atraso);
+    portasAlteradas.push_back(IdPort);
 }
-void Circuito::setId_inPort(int IdPort, unsigned I, int IdOrig) const
+void Circuito::setId_inPort(int IdPort, unsigned I, int IdOrig)
 {
     if(definedPort(IdPort) && validIdOrig(IdOrig))
     {
         ports[IdPort-1]->setId_in(I, IdOrig);
+        portasAlteradas.push_back(IdPort);
+    }
+}
+void Circuito::setAtrasoPort(int IdPort, unsigned D)
+{
+    if(definedPort(IdPort))
+    {
+        ports[IdPort-1]->setAtraso(D);
+        portasAlteradas.push_back(IdPort);
     }
 }
 
@@ -333,52 +478,437 @@ void Circuito::digitar(int Nin, int Nout, int Nports)
 //    }
 //    while(contador < Nout);
 }
+// Um bloco de linhas da secao PORTAS, lido por uma thread
+// Cada linha nao vazia da secao contem exatamente uma porta. Antes da leitura, cada
+// bloco conta as suas linhas; com isso, cada bloco sabe a posicao (e portanto a id
+// esperada) da sua primeira porta, e as portas lidas sao colocadas diretamente nas
+// suas posicoes no vetor ports, sem que duas threads escrevam na mesma posicao
+struct BlocoPortas
+{
+    const char* base;             // inicio do arquivo (para calcular as posicoes dos erros)
+    const char* ini;              // inicio do bloco (inicio de uma linha)
+    const char* fim;              // fim do bloco (depois de um fim de linha ou fim da secao)
+    unsigned numLinhas;           // numero de linhas nao vazias do bloco
+    unsigned linhaInicial;        // indice (a partir de 0) da primeira porta do bloco
+    std::vector<Diagnostico> erros;
+    unsigned maxErros;
+    ProgressoLeitura* progresso;  // andamento da leitura (nullptr se nao acompanhada)
+};
+
+// Conta as linhas nao vazias (que contem algum caractere que nao seja separador) do bloco
+void contarLinhasBloco(BlocoPortas& B)
+{
+    RASTRO("contar linhas", B.fim-B.ini);
+    const char* pos = B.ini;
+    B.numLinhas = 0;
+    while (pos<B.fim)
+    {
+        pularEspacos(pos, B.fim);
+        if (pos>=B.fim) break;
+        B.numLinhas++;
+        pos = fimDaLinha(pos, B.fim);
+    }
+}
+
+// Registra um erro de leitura na posicao pos, se ainda nao atingiu o limite de erros
+void registrarErro(std::vector<Diagnostico>& erros, unsigned maxErros, const char* base,
+                   const char* pos, ErroLeitura codigo, const std::string& esperado)
+{
+    if (maxErros>0 && erros.size()>=maxErros) return;
+    Diagnostico D;
+    D.linha = D.coluna = 0;
+    D.codigo = codigo;
+    D.esperado = esperado;
+    D.posicao = uint64_t(pos-base);
+    erros.push_back(D);
+}
+
+// Leh todas as portas de um bloco, uma por linha
+// A porta da linha de indice k (contando a partir de linhaInicial) tem que ter id k+1
+// e eh colocada em ports[k]. Em caso de erro, registra o diagnostico, deixa a posicao
+// com nullptr e continua na proxima linha
+void Circuito::lerBlocoPortas(BlocoPortas& B)
+{
+    RASTRO("ler portas", B.fim-B.ini);
+    const char* pos = B.ini;
+    const char* fimLinha;
+    const char* palavra;
+    const char* inicioPorta;
+    size_t tam;
+    long long id;
+    string tipo;
+    Diagnostico D;
+    unsigned k = B.linhaInicial;
+    // O progresso eh atualizado a cada BYTES_PROGRESSO bytes lidos (nao a cada linha,
+    // para que as threads nao disputem o contador)
+    const ptrdiff_t BYTES_PROGRESSO = 1<<16;
+    const char* informado = B.ini;
+
+    pularEspacos(pos, B.fim);
+    while (pos<B.fim && !(B.maxErros>0 && B.erros.size()>=B.maxErros))
+    {
+        if (B.progresso!=nullptr && pos-informado>=BYTES_PROGRESSO)
+        {
+            B.progresso->lidos += uint64_t(pos-informado);
+            informado = pos;
+            if (B.progresso->cancelado) return;
+        }
+        const char* inicioLinha = pos;
+        fimLinha = fimDaLinha(pos, B.fim);
+        ptr_Port prov = nullptr;
+
+        if (k >= getNumPorts())
+        {
+            registrarErro(B.erros, B.maxErros, B.base, inicioLinha, ErroLeitura::NUM_PORTAS,
+                          "SAIDAS (o cabecalho informa "+to_string(getNumPorts())+" portas)");
+        }
+        // lê id 1) antes do nome da porta (o ')' vem colado na id)
+        else if (!lerInteiro(pos, fimLinha, id) || pos>=fimLinha || *pos!=')' || id!=k+1)
+        {
+            registrarErro(B.erros, B.maxErros, B.base, inicioLinha, ErroLeitura::ID_PORTA,
+                          to_string(k+1)+")");
+        }
+        // lê o tipo da porta
+        else if (pos++, !lerPalavra(pos, fimLinha, palavra, tam) ||
+                 (tipo.assign(palavra, tam), prov = allocPort(tipo))==nullptr)
+        {
+            registrarErro(B.erros, B.maxErros, B.base, palavra, ErroLeitura::TIPO_PORTA,
+                          "tipo de porta (NT,AN,NA,OR,NO,XO,NX,DF)");
+        }
+        else if (inicioPorta = pos, !prov->ler(pos, fimLinha, &D))
+        {
+            registrarErro(B.erros, B.maxErros, B.base, pos, D.codigo, D.esperado);
+            delete prov;
+            prov = nullptr;
+        }
+        else
+        {
+            // Confere as origens das entradas da porta. Para localizar no texto a entrada
+            // invalida, basta reler os numeros que vem depois do ':'
+            for (unsigned j=0; prov!=nullptr && j<prov->getNumInputs(); j++)
+            {
+                if (validIdOrig(prov->getId_in(j))) continue;
+                const char* p = inicioPorta;
+                while (*p!=':') p++;
+                p++;
+                for (unsigned m=0; m<=j; m++)
+                {
+                    pularEspacos(p, fimLinha);
+                    palavra = p;
+                    lerInteiro(p, fimLinha, id);
+                }
+                registrarErro(B.erros, B.maxErros, B.base, palavra, ErroLeitura::ORIGEM_PORTA,
+                              "origem entre -"+to_string(getNumInputs())+" e "+
+                              to_string(getNumPorts())+" (diferente de 0)");
+                delete prov;
+                prov = nullptr;
+            }
+            // Nao pode haver mais nada na linha depois da porta
+            pularEspacos(pos, fimLinha);
+            if (prov!=nullptr && pos<fimLinha)
+            {
+                registrarErro(B.erros, B.maxErros, B.base, pos, ErroLeitura::PORTA, "fim da linha");
+                delete prov;
+                prov = nullptr;
+            }
+        }
+        if (k < getNumPorts()) ports[k] = prov;
+        else delete prov;
+        k++;
+        pos = fimLinha;
+        pularEspacos(pos, B.fim);
+    }
+    if (B.progresso!=nullptr) B.progresso->lidos += uint64_t(pos-informado);
+}
+
 bool Circuito::ler(const std::string& arq)
 {
-    ifstream I(arq.c_str());
-    bool resultado=true;
-    try
+    ResultadoLeitura R;
+    if (ler(arq, R)) return true;
+    cout<<"Arquivo de leitura Invalido";
+    for (unsigned i=0; i<R.erros.size(); i++) cout<<'\n'<<arq<<':'<<R.erros[i];
+    cout<<endl;
+    return false;
+}
+
+bool Circuito::ler(const std::string& arq, ResultadoLeitura& R)
+{
+    RASTRO("ler circuito");
+    ArquivoMapeado A;
+    R.limpar();
+    clear();
+    if (!A.abrir(arq) || A.tamanho()==0)
+    {
+        Diagnostico D;
+        D.linha = D.coluna = 0;
+        D.codigo = ErroLeitura::ARQUIVO;
+        D.esperado = "arquivo de circuito existente e nao vazio";
+        D.posicao = 0;
+        R.erros.push_back(D);
+        return false;
+    }
+    ProgressoLeitura* P = R.progresso;
+    if (P!=nullptr)
+    {
+        P->lidos = 0;
+        P->total = A.tamanho();
+    }
+    const char* base = (const char*)A.dados();
+    const char* pos = base;
+    const char* fim = pos + A.tamanho();
+    const char* palavra;
+    size_t tam;
+    long long Nin=0,Nout=0,Nports=0,id=0;
+
+    // Cabecalho: sem ele nao eh possivel continuar
+    pularEspacos(pos, fim);
+    if (!lerPalavra(pos,fim,palavra,tam) || string(palavra,tam)!="CIRCUITO")
+    {
+        registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::CABECALHO, "CIRCUITO");
+    }
+    else if (pularEspacos(pos,fim), palavra=pos,
+             !lerInteiro(pos,fim,Nin) || Nin<=0 || Nin>INT_MAX)
+    {
+        registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::CABECALHO,
+                      "numero de entradas (maior que 0)");
+    }
+    else if (pularEspacos(pos,fim), palavra=pos,
+             !lerInteiro(pos,fim,Nout) || Nout<=0 || Nout>INT_MAX)
+    {
+        registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::CABECALHO,
+                      "numero de saidas (maior que 0)");
+    }
+    // Cada porta e cada saida ocupam pelo menos 4 caracteres: um cabecalho maior do que
+    // isso so pode ser um erro, e nao deve provocar uma alocacao enorme
+    else if (pularEspacos(pos,fim), palavra=pos,
+             !lerInteiro(pos,fim,Nports) || Nports<=0 || Nports>INT_MAX ||
+             (Nports+Nout)*4 > fim-pos)
+    {
+        registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::CABECALHO,
+                      "numero de portas (maior que 0 e compativel com o tamanho do arquivo)");
+    }
+    else if (!lerPalavra(pos,fim,palavra,tam) || string(palavra,tam)!="PORTAS")
+    {
+        registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::SECAO_PORTAS, "PORTAS");
+    }
+    if (!R.ok())
+    {
+        localizarDiagnosticos(base, R.erros);
+        return false;
+    }
+    resize(Nin,Nout,Nports);
+    if (P!=nullptr) P->lidos = uint64_t(pos-base);
+
+    // A secao PORTAS vai ateh a palavra SAIDAS, procurada a partir do final do
+    // arquivo (a secao SAIDAS eh bem menor que a secao PORTAS)
+    const char* fimPortas = nullptr;
+    for (const char* p=fim-6; p>=pos; p--)
+    {
+        if (memcmp(p,"SAIDAS",6)==0 && ehEspaco(p[-1]))
+        {
+            fimPortas = p;
+            break;
+        }
+    }
+    if (fimPortas==nullptr)
+    {
+        registrarErro(R.erros, R.maxErros, base, fim, ErroLeitura::SECAO_SAIDAS, "SAIDAS");
+        fimPortas = fim;
+    }
+
+    // Divide a secao PORTAS em blocos que terminam em fim de linha.
+    // Soh vale a pena usar mais de uma thread para secoes grandes
+    const size_t BYTES_MIN_BLOCO = 1<<20;
+    size_t tamPortas = size_t(fimPortas-pos);
+    unsigned nThreads = thread::hardware_concurrency();
+    if (nThreads==0) nThreads = 1;
+    if (tamPortas/BYTES_MIN_BLOCO < nThreads) nThreads = unsigned(tamPortas/BYTES_MIN_BLOCO);
+    if (nThreads==0) nThreads = 1;
+    vector<BlocoPortas> blocos(nThreads);
+    const char* ini = pos;
+    for (unsigned t=0; t<nThreads; t++)
+    {
+        const char* f = (t+1==nThreads ? fimPortas : pos + (tamPortas/nThreads)*(t+1));
+        if (f<ini) f = ini;
+        while (f<fimPortas && f[-1]!='\n') f++;
+        blocos[t].base = base;
+        blocos[t].ini = ini;
+        blocos[t].fim = f;
+        blocos[t].maxErros = R.maxErros;
+        blocos[t].progresso = P;
+        ini = f;
+    }
+
+    // Primeira passada em paralelo: conta as linhas de cada bloco, para saber
+    // qual eh a primeira porta de cada bloco
+    vector<thread> threads;
+    for (unsigned t=1; t<nThreads; t++) threads.push_back(thread(contarLinhasBloco, ref(blocos[t])));
+    contarLinhasBloco(blocos[0]);
+    for (unsigned t=0; t<threads.size(); t++) threads[t].join();
+    threads.clear();
+    unsigned numLinhas = 0;
+    for (unsigned t=0; t<nThreads; t++)
+    {
+        blocos[t].linhaInicial = numLinhas;
+        numLinhas += blocos[t].numLinhas;
+    }
+
+    // Segunda passada em paralelo: leh as portas de cada bloco diretamente para as
+    // suas posicoes em ports (o primeiro bloco eh lido na propria thread)
+    for (unsigned t=1; t<nThreads; t++)
+    {
+        threads.push_back(thread(&Circuito::lerBlocoPortas, this, ref(blocos[t])));
+    }
+    lerBlocoPortas(blocos[0]);
+    for (unsigned t=0; t<threads.size(); t++) threads[t].join();
+    if (P!=nullptr && P->cancelado)
     {
-        if (!I.is_open()) throw 1;
-        string ps;
-        int Nin,Nout,Nports;
-        I >> ps >> Nin>> Nout >> Nports;
-        if (!I.good() || ps!="CIRCUITO"|| Nin<=0 || Nout<=0 || Nports<=0) throw 2;
         clear();
-        resize(Nin,Nout,Nports);
-        I >> ps;
-        if(ps!="PORTAS") throw 3;
+        registrarErro(R.erros, 0, base, base, ErroLeitura::CANCELADA, "");
+        localizarDiagnosticos(base, R.erros);
+        return false;
+    }
+    for (unsigned t=0; t<nThreads; t++)
+    {
+        R.erros.insert(R.erros.end(), blocos[t].erros.begin(), blocos[t].erros.end());
+    }
+    if (numLinhas < Nports)
+    {
+        registrarErro(R.erros, R.maxErros, base, fimPortas, ErroLeitura::NUM_PORTAS,
+                      to_string(numLinhas+1)+") (o cabecalho informa "+to_string(Nports)+" portas)");
+    }
 
-        for (int i=0; i<Nports; i++)
+    //saidas
+    pos = (fimPortas<fim ? fimPortas+6 : fim);
+    for (int i=0; i<Nout && !R.cheio(); i++)
+    {
+        pularEspacos(pos,fim);
+        const char* fimLinha = fimDaLinha(pos, fim);
+        palavra = pos;
+        // lê id 1) antes da origem da saida
+        if (!lerInteiro(pos,fimLinha,id) || id!=i+1 || pos>=fimLinha || *pos!=')')
         {
-            I>>ps; // lê id 1) antes do nome da porta
-            if(ps!=to_string(i+1)+")") throw 4;
-            I >> ps; // lê o tipo d porta
-            if(!validType(ps)) throw 5;
-            ports[i] = allocPort(ps);
-            if (!ports[i]->ler(I)) throw 6;
+            registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::ID_SAIDA, to_string(i+1)+")");
         }
-        //saidas
-        I >> ps;
-        if(ps!="SAIDAS") throw 7;
-        for (int i=0; i<Nout; i++)
+        else if (pos++, pularEspacos(pos,fimLinha), palavra=pos,
+                 !lerInteiro(pos,fimLinha,id) || id<INT_MIN || id>INT_MAX || !validIdOrig(int(id)))
         {
-            I>>ps; // lê id 1) antes do nome da porta
-            if(ps!=to_string(i+1)+")") throw 8;
-            I>>ps; //lê o id de saida
-            if(!validIdOrig(stoi(ps))) throw 9;
-            id_out[i]=stoi(ps);
+            registrarErro(R.erros, R.maxErros, base, palavra, ErroLeitura::ORIGEM_SAIDA,
+                          "origem entre -"+to_string(Nin)+" e "+to_string(Nports)+" (diferente de 0)");
         }
+        else if (pularEspacos(pos,fimLinha), pos<fimLinha)
+        {
+            registrarErro(R.erros, R.maxErros, base, pos, ErroLeitura::ORIGEM_SAIDA, "fim da linha");
+        }
+        else id_out[i]=int(id);
+        pos = fimLinha;
     }
-    catch (int i)
+
+    if (R.maxErros>0 && R.erros.size()>R.maxErros) R.erros.resize(R.maxErros);
+    if (!R.ok())
     {
-        cout<<"Arquivo de leitura Invalido";
+        localizarDiagnosticos(base, R.erros);
         clear();
-        resultado = false;
+        return false;
+    }
+    A.fechar();
+    if (P!=nullptr) P->lidos = P->total.load();
+
+    // Aplica o diario de alteracoes, se houver
+    if (!lerDiario(arq, R))
+    {
+        clear();
+        return false;
+    }
+    arqBase = arq;
+    return true;
+}
+
+bool Circuito::lerDiario(const std::string& arq, ResultadoLeitura& R)
+{
+    RASTRO("ler diario");
+    ArquivoMapeado A;
+    registrosDiario = 0;
+    portasAlteradas.clear();
+    saidasAlteradas.clear();
+    // Sem diario, nao hah nada a fazer
+    if (!A.abrir(arq+".jrn") || A.tamanho()==0) return true;
+    const char* base = (const char*)A.dados();
+    const char* fim = base + A.tamanho();
+    const char* pos = base;
+    const char* palavra;
+    string tipo;
+    size_t tam;
+    long long id;
+    Diagnostico D;
+    vector<Diagnostico> erros;
+    const string esperado = "registro valido no diario "+arq+".jrn";
+
+    pularEspacos(pos, fim);
+    while (pos<fim && !(R.maxErros>0 && R.erros.size()+erros.size()>=R.maxErros))
+    {
+        const char* fimLinha = fimDaLinha(pos, fim);
+        // Um registro sem fim de linha no final do diario foi interrompido durante
+        // a gravacao: eh ignorado
+        if (fimLinha==fim) break;
+        char reg = *pos++;
+        const char* inicio = pos;
+        if (reg=='P')
+        {
+            ptr_Port prov = nullptr;
+            bool ok = (lerInteiro(pos,fimLinha,id) && pos<fimLinha && *pos==')' &&
+                       validIdPort(int(id)));
+            if (ok)
+            {
+                pos++;
+                ok = lerPalavra(pos,fimLinha,palavra,tam);
+            }
+            if (ok)
+            {
+                tipo.assign(palavra,tam);
+                prov = allocPort(tipo);
+                ok = (prov!=nullptr && prov->ler(pos,fimLinha,&D));
+            }
+            // Nada mais na linha depois da porta
+            if (ok) ok = (pularEspacos(pos,fimLinha), pos==fimLinha);
+            for (unsigned j=0; ok && j<prov->getNumInputs(); j++) ok = validIdOrig(prov->getId_in(j));
+            if (ok)
+            {
+                delete ports[id-1];
+                ports[id-1] = prov;
+            }
+            else
+            {
+                delete prov;
+                registrarErro(erros, 0, base, inicio, ErroLeitura::DIARIO, esperado);
+            }
+        }
+        else if (reg=='S')
+        {
+            if (lerInteiro(pos,fimLinha,id) && pos<fimLinha && *pos==')' && validIdOutput(int(id)))
+            {
+                int IdOut = int(id);
+                pos++;
+                if (lerInteiro(pos,fimLinha,id) && id>=INT_MIN && id<=INT_MAX && validIdOrig(int(id)) &&
+                    (pularEspacos(pos,fimLinha), pos==fimLinha))
+                {
+                    id_out[IdOut-1] = int(id);
+                }
+                else registrarErro(erros, 0, base, inicio, ErroLeitura::DIARIO, esperado);
+            }
+            else registrarErro(erros, 0, base, inicio, ErroLeitura::DIARIO, esperado);
+        }
+        else registrarErro(erros, 0, base, pos-1, ErroLeitura::DIARIO, esperado);
+        registrosDiario++;
+        pos = fimLinha;
+        pularEspacos(pos, fim);
     }
-    if (I.is_open()) I.close();
-    return resultado;
+    if (erros.empty()) return true;
+    localizarDiagnosticos(base, erros);
+    R.erros.insert(R.erros.end(), erros.begin(), erros.end());
+    return false;
 }
+
 std::ostream& Circuito::imprimir(std::ostream& arq) const
 {
     //Exemplo de arquivos validos
@@ -405,14 +935,245 @@ std::ostream& Circuito::imprimir(std::ostream& arq) const
 
     return arq;
 }
+// Grava o circuito C em um arquivo temporario que depois substitui arq: se a gravacao
+// falhar (disco cheio, erro de E/S), o arquivo anterior continua intacto
+// Retorna true se deu tudo OK
+static bool gravarSubstituindo(const Circuito& C, const std::string& arq)
+{
+    string temp = arq+".tmp";
+    ofstream arq1(temp);
+    if (!arq1.is_open()) return false;
+    C.imprimir(arq1);
+    arq1.close();
+    if (arq1.fail())
+    {
+        std::remove(temp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    // No Windows, rename nao substitui um arquivo existente
+    std::remove(arq.c_str());
+#endif
+    return std::rename(temp.c_str(), arq.c_str())==0;
+}
+
+// Descarta um registro interrompido durante a gravacao (sem fim de linha) no final do
+// diario nomeDiario, que ler ignora: sem isso, o proximo registro acrescentado ficaria
+// na mesma linha. O diario eh limitado ao tamanho do circuito (ver salvarIncremental)
+// e soh eh reescrito nesse caso
+// Retorna true se deu tudo OK (inclusive se o diario nao existe)
+static bool descartarRegistroIncompleto(const std::string& nomeDiario)
+{
+    ifstream jrn(nomeDiario, ios::binary);
+    if (!jrn.is_open()) return true;
+    jrn.seekg(0, ios::end);
+    streamoff tam = jrn.tellg();
+    if (tam<=0) return true;
+    char ultimo;
+    jrn.seekg(tam-1);
+    if (!jrn.get(ultimo)) return false;
+    if (ultimo=='\n') return true;
+    string conteudo(size_t(tam), '\0');
+    jrn.seekg(0);
+    if (!jrn.read(&conteudo[0], tam)) return false;
+    jrn.close();
+    size_t fimUltimaLinha = conteudo.rfind('\n');
+    conteudo.resize(fimUltimaLinha==string::npos ? 0 : fimUltimaLinha+1);
+    string temp = nomeDiario+".tmp";
+    ofstream novo(temp, ios::binary);
+    if (!novo.is_open()) return false;
+    novo.write(conteudo.data(), streamsize(conteudo.size()));
+    novo.close();
+    if (novo.fail())
+    {
+        std::remove(temp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    std::remove(nomeDiario.c_str());
+#endif
+    return std::rename(temp.c_str(), nomeDiario.c_str())==0;
+}
+
 bool Circuito::salvar(const std::string& arq) const
+{
+    RASTRO("salvar circuito");
+    if(!valid()) return false;
+    if (!gravarSubstituindo(*this, arq)) return false;
+    // O diario, se houver, se referia ao conteudo anterior do arquivo
+    std::remove((arq+".jrn").c_str());
+    return true;
+}
+
+bool Circuito::compactar(const std::string& arq)
+{
+    if(!valid()) return false;
+    // Se o programa for interrompido depois de substituir o arquivo e antes de apagar
+    // o diario, aplicar o diario sobre o novo arquivo nao altera nada (cada registro
+    // contem o estado completo de uma porta ou saida)
+    if (!gravarSubstituindo(*this, arq)) return false;
+    std::remove((arq+".jrn").c_str());
+    arqBase = arq;
+    portasAlteradas.clear();
+    saidasAlteradas.clear();
+    registrosDiario = 0;
+    return true;
+}
+
+bool Circuito::salvarIncremental(const std::string& arq)
+{
+    if(!valid()) return false;
+    // Varias alteracoes na mesma porta ou saida geram um unico registro
+    sort(portasAlteradas.begin(), portasAlteradas.end());
+    portasAlteradas.erase(unique(portasAlteradas.begin(), portasAlteradas.end()), portasAlteradas.end());
+    sort(saidasAlteradas.begin(), saidasAlteradas.end());
+    saidasAlteradas.erase(unique(saidasAlteradas.begin(), saidasAlteradas.end()), saidasAlteradas.end());
+    unsigned novos = portasAlteradas.size()+saidasAlteradas.size();
+    // O diario soh vale para o arquivo base e enquanto for menor que o proprio circuito
+    unsigned limite = getNumPorts()+getNumOutputs();
+    if (limite<64) limite = 64;
+    if (arq!=arqBase || registrosDiario+novos > limite) return compactar(arq);
+    if (novos==0) return true;
+
+    if (!descartarRegistroIncompleto(arq+".jrn")) return false;
+    ofstream jrn(arq+".jrn", ios::app);
+    if (!jrn.is_open()) return false;
+    for (unsigned i=0; i<portasAlteradas.size(); i++)
+    {
+        int IdPort = portasAlteradas[i];
+        jrn<<"P "<<IdPort<<") ";
+        ports[IdPort-1]->imprimir(jrn);
+        jrn<<'\n';
+    }
+    for (unsigned i=0; i<saidasAlteradas.size(); i++)
+    {
+        int IdOut = saidasAlteradas[i];
+        jrn<<"S "<<IdOut<<") "<<id_out[IdOut-1]<<'\n';
+    }
+    jrn.close();
+    if (jrn.fail()) return false;
+    registrosDiario += novos;
+    portasAlteradas.clear();
+    saidasAlteradas.clear();
+    return true;
+}
+
+std::ostream& Circuito::exportarVerilog(std::ostream& O, const std::string& modulo) const
+{
+    //Exemplo (circuito do exemplo de imprimir)
+    //module circuito(in1, in2, out1);
+    //input in1;
+    //...
+    //wire p1;
+    //...
+    //or g1 (p1, in1, in2);
+    //not g2 (p2, in2);
+    //and g3 (p3, p1, p2);
+    //assign out1 = p3;
+    //endmodule
+    //Se houver flip-flops (DF), o modulo ganha a entrada clk e cada flip-flop eh um reg:
+    //reg p4;
+    //always @(posedge clk) p4 <= p3;
+    if (!valid()) return O;
+    bool temFlipFlops = false;
+    for (unsigned i=0; i<getNumPorts(); i++) if (ports[i]->getName()=="DF") temFlipFlops = true;
+    O<<"module "<<modulo<<'(';
+    if (temFlipFlops) O<<"clk, ";
+    for (unsigned i=0; i<getNumInputs(); i++) O<<"in"<<i+1<<", ";
+    for (unsigned i=0; i<getNumOutputs(); i++)
+    {
+        if (i>0) O<<", ";
+        O<<"out"<<i+1;
+    }
+    O<<");"<<'\n';
+    if (temFlipFlops) O<<"input clk;"<<'\n';
+    for (unsigned i=0; i<getNumInputs(); i++) O<<"input in"<<i+1<<";"<<'\n';
+    for (unsigned i=0; i<getNumOutputs(); i++) O<<"output out"<<i+1<<";"<<'\n';
+    for (unsigned i=0; i<getNumPorts(); i++)
+    {
+        O<<(ports[i]->getName()=="DF" ? "reg p" : "wire p")<<i+1<<";"<<'\n';
+    }
+    for (unsigned i=0; i<getNumPorts(); i++)
+    {
+        if (ports[i]->getName()=="DF")
+        {
+            O<<"always @(posedge clk) p"<<i+1<<" <= ";
+            imprimirSinal(O, ports[i]->getId_in(0));
+            O<<";"<<'\n';
+            continue;
+        }
+        O<<nomeVerilog(ports[i]->getName())<<" g"<<i+1<<" (p"<<i+1;
+        for (unsigned j=0; j<ports[i]->getNumInputs(); j++)
+        {
+            O<<", ";
+            imprimirSinal(O, ports[i]->getId_in(j));
+        }
+        O<<");"<<'\n';
+    }
+    for (unsigned i=0; i<getNumOutputs(); i++)
+    {
+        O<<"assign out"<<i+1<<" = ";
+        imprimirSinal(O, id_out[i]);
+        O<<";"<<'\n';
+    }
+    O<<"endmodule"<<'\n';
+    return O;
+}
+
+std::ostream& Circuito::exportarBench(std::ostream& O) const
+{
+    //Exemplo (circuito do exemplo de imprimir)
+    //INPUT(in1)
+    //INPUT(in2)
+    //OUTPUT(out1)
+    //p1 = OR(in1, in2)
+    //p2 = NOT(in2)
+    //p3 = AND(p1, p2)
+    //out1 = BUFF(p3)
+    //Um flip-flop (DF) eh um DFF, como nos circuitos sequenciais do ISCAS-89: p4 = DFF(p3)
+    if (!valid()) return O;
+    O<<"# "<<getNumInputs()<<" entradas, "<<getNumOutputs()<<" saidas, "
+     <<getNumPorts()<<" portas"<<'\n';
+    for (unsigned i=0; i<getNumInputs(); i++) O<<"INPUT(in"<<i+1<<")"<<'\n';
+    for (unsigned i=0; i<getNumOutputs(); i++) O<<"OUTPUT(out"<<i+1<<")"<<'\n';
+    for (unsigned i=0; i<getNumPorts(); i++)
+    {
+        O<<'p'<<i+1<<" = "<<nomeBench(ports[i]->getName())<<'(';
+        for (unsigned j=0; j<ports[i]->getNumInputs(); j++)
+        {
+            if (j>0) O<<", ";
+            imprimirSinal(O, ports[i]->getId_in(j));
+        }
+        O<<')'<<'\n';
+    }
+    // No formato .bench uma saida nao pode ser apenas um nome alternativo de outro sinal
+    for (unsigned i=0; i<getNumOutputs(); i++)
+    {
+        O<<"out"<<i+1<<" = BUFF(";
+        imprimirSinal(O, id_out[i]);
+        O<<')'<<'\n';
+    }
+    return O;
+}
+
+bool Circuito::salvarVerilog(const std::string& arq) const
 {
     if(!valid()) return false;
     ofstream arq1(arq);
     if (!arq1.is_open()) return false;
-    imprimir(arq1);
+    exportarVerilog(arq1);
     arq1.close();
-    return true;
+    return !arq1.fail();
+}
+
+bool Circuito::salvarBench(const std::string& arq) const
+{
+    if(!valid()) return false;
+    ofstream arq1(arq);
+    if (!arq1.is_open()) return false;
+    exportarBench(arq1);
+    arq1.close();
+    return !arq1.fail();
 }
 
 
@@ -425,16 +1186,20 @@ bool Circuito::simular(const std::vector<bool3S>& in_circ)
     bool tudo_def,alguma_def;
     std::vector<bool3S> in_port;
     int id;
+    ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+    ESTATISTICA(uint64_t passada = 0);
 
     for(unsigned i=0; i<getNumPorts(); i++)
     {
 
         ports[i]->setOutput(bool3S::UNDEF);
     }
+    ESTATISTICA(estatisticas.marcarFase(SimStats::INICIALIZACAO, inicio));
     do
     {
         tudo_def = true;
         alguma_def = false;
+        ESTATISTICA(passada++);
         for (unsigned i = 0; i < getNumPorts(); i++)
         {
             if (ports[i] -> getOutput() == bool3S::UNDEF)
@@ -454,6 +1219,8 @@ bool Circuito::simular(const std::vector<bool3S>& in_circ)
                     }
                 }
                 ports[i]->simular(in_port);
+                ESTATISTICA(estatisticas.contarAvaliacao(SimStats::indiceTipo(ports[i]->getName()),
+                                                         ports[i]->getOutput()!=bool3S::UNDEF, passada));
                 if(ports[i]->getOutput()== bool3S::UNDEF)
                 {
 
@@ -467,6 +1234,7 @@ bool Circuito::simular(const std::vector<bool3S>& in_circ)
         }
     }
     while(!tudo_def && alguma_def);
+    ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
     // DETERMINAÇÃO DAS SAÍDAS
 
     for(unsigned j=0; j<getNumOutputs(); j++)
@@ -481,5 +1249,226 @@ bool Circuito::simular(const std::vector<bool3S>& in_circ)
             out_circ[j] = in_circ[-id-1];
         }
     }
+    ESTATISTICA(estatisticas.marcarFase(SimStats::SAIDAS, inicio));
+    ESTATISTICA(estatisticas.contarVetor(passada, (tudo_def ? 0 :
+        count_if(ports.begin(), ports.end(), [](ptr_Port P) {return P->getOutput()==bool3S::UNDEF;}))));
     return true;
 }
+
+bool Circuito::simular(const std::vector<bool3S>& in_circ, const std::vector<int>& IdPorts)
+{
+    bool tudo_def,alguma_def;
+    std::vector<bool3S> in_port;
+    int id;
+
+    ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+    ESTATISTICA(uint64_t passada = 0);
+
+    for (unsigned k=0; k<IdPorts.size(); k++)
+    {
+        ports[IdPorts[k]-1]->setOutput(bool3S::UNDEF);
+    }
+    ESTATISTICA(estatisticas.marcarFase(SimStats::INICIALIZACAO, inicio));
+    // Mesma iteracao do simular completo, restrita as portas de IdPorts
+    do
+    {
+        tudo_def = true;
+        alguma_def = false;
+        ESTATISTICA(passada++);
+        for (unsigned k=0; k<IdPorts.size(); k++)
+        {
+            ptr_Port P = ports[IdPorts[k]-1];
+            if (P->getOutput() == bool3S::UNDEF)
+            {
+                in_port.resize(P->getNumInputs());
+                for (unsigned j=0; j<P->getNumInputs(); j++)
+                {
+                    id = P->getId_in(j);
+                    in_port[j] = (id>0 ? ports[id-1]->getOutput() : in_circ[-id-1]);
+                }
+                P->simular(in_port);
+                ESTATISTICA(estatisticas.contarAvaliacao(SimStats::indiceTipo(P->getName()),
+                                                         P->getOutput()!=bool3S::UNDEF, passada));
+                if (P->getOutput() == bool3S::UNDEF) tudo_def = false;
+                else alguma_def = true;
+            }
+        }
+    }
+    while(!tudo_def && alguma_def);
+    ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+
+    for(unsigned j=0; j<getNumOutputs(); j++)
+    {
+        id = id_out[j];
+        out_circ[j] = (id>0 ? ports[id-1]->getOutput() : in_circ[-id-1]);
+    }
+    ESTATISTICA(estatisticas.marcarFase(SimStats::SAIDAS, inicio));
+    ESTATISTICA(estatisticas.contarVetor(passada, (tudo_def ? 0 :
+        count_if(IdPorts.begin(), IdPorts.end(), [this](int k) {return ports[k-1]->getOutput()==bool3S::UNDEF;}))));
+    return true;
+}
+
+/// ***********************
+/// Dependencias entre portas e saidas
+/// ***********************
+
+void Circuito::montarDestinosPortas(std::vector<unsigned>& inicio, std::vector<int>& destino) const
+{
+    // Uma passada para contar quantas vezes cada porta eh usada e outra para
+    // preencher as listas
+    unsigned NP = getNumPorts();
+    inicio.assign(NP+1, 0);
+    for (unsigned i=0; i<NP; i++) if (ports[i]!=nullptr)
+    {
+        for (unsigned j=0; j<ports[i]->getNumInputs(); j++)
+        {
+            int id = ports[i]->getId_in(j);
+            if (id>0 && id<=int(NP)) inicio[id]++;
+        }
+    }
+    for (unsigned i=0; i<NP; i++) inicio[i+1] += inicio[i];
+    destino.resize(inicio[NP]);
+    std::vector<unsigned> pos(inicio.begin(), inicio.end()-1);
+    for (unsigned i=0; i<NP; i++) if (ports[i]!=nullptr)
+    {
+        for (unsigned j=0; j<ports[i]->getNumInputs(); j++)
+        {
+            int id = ports[i]->getId_in(j);
+            if (id>0 && id<=int(NP)) destino[pos[id-1]++] = int(i+1);
+        }
+    }
+}
+
+bool Circuito::calcularNiveis(std::vector<unsigned>& nivel) const
+{
+    RASTRO("calcular niveis");
+    unsigned NP = getNumPorts();
+    nivel.assign(NP, 0);
+    std::vector<unsigned> inicio;
+    std::vector<int> destino;
+    montarDestinosPortas(inicio, destino);
+
+    // Ordenacao topologica (algoritmo de Kahn): uma porta entra na fila quando todas
+    // as portas das quais ela depende jah tem nivel
+    // A saida de um flip-flop nao depende combinacionalmente da sua entrada: ele tem
+    // nivel 1, como uma porta ligada apenas a entradas do circuito, e um laco que passa
+    // por um flip-flop nao eh um laco
+    std::vector<bool> flipFlop(NP, false);
+    for (unsigned i=0; i<NP; i++) flipFlop[i] = (ports[i]!=nullptr && ports[i]->getName()=="DF");
+    std::vector<unsigned> faltam(NP, 0);
+    for (unsigned i=0; i<NP; i++) if (ports[i]!=nullptr && !flipFlop[i])
+    {
+        for (unsigned j=0; j<ports[i]->getNumInputs(); j++)
+        {
+            int id = ports[i]->getId_in(j);
+            if (id>0 && id<=int(NP)) faltam[i]++;
+        }
+    }
+    std::vector<bool> calculado(NP, false);
+    std::vector<int> fila;
+    for (unsigned i=0; i<NP; i++) if (faltam[i]==0) fila.push_back(int(i+1));
+    bool semLacos = true;
+    unsigned numCalculados = 0;
+    unsigned proximo = 0;   // menor id que pode ainda nao ter nivel (para quebrar lacos)
+    while (numCalculados<NP)
+    {
+        if (fila.empty())
+        {
+            // Todas as portas restantes estao em lacos ou dependem de um laco: a de menor
+            // id eh tratada como se as origens ainda sem nivel tivessem nivel 0
+            semLacos = false;
+            while (calculado[proximo]) proximo++;
+            fila.push_back(int(proximo+1));
+        }
+        int id = fila.back();
+        fila.pop_back();
+        if (calculado[id-1]) continue;
+        unsigned n = 0;
+        if (ports[id-1]!=nullptr && !flipFlop[id-1])
+        {
+            for (unsigned j=0; j<ports[id-1]->getNumInputs(); j++)
+            {
+                int orig = ports[id-1]->getId_in(j);
+                if (orig>0 && orig<=int(NP) && calculado[orig-1] && nivel[orig-1]>n) n = nivel[orig-1];
+            }
+        }
+        nivel[id-1] = n+1;
+        calculado[id-1] = true;
+        numCalculados++;
+        for (unsigned k=inicio[id-1]; k<inicio[id]; k++)
+        {
+            int dest = destino[k];
+            if (!calculado[dest-1] && !flipFlop[dest-1] && --faltam[dest-1]==0) fila.push_back(dest);
+        }
+    }
+    return semLacos;
+}
+
+void Circuito::saidasDependentes(int IdPort, std::vector<bool>& afetadas) const
+{
+    afetadas.assign(getNumOutputs(), false);
+    if (!validIdPort(IdPort)) return;
+
+    // Portas que dependem de IdPort: percorre o grafo no sentido das saidas das portas,
+    // a partir de IdPort
+    unsigned NP = getNumPorts();
+    std::vector<unsigned> inicio;
+    std::vector<int> destino;
+    montarDestinosPortas(inicio, destino);
+
+    std::vector<bool> depende(NP, false);
+    std::vector<int> pilha(1, IdPort);
+    depende[IdPort-1] = true;
+    while (!pilha.empty())
+    {
+        int id = pilha.back();
+        pilha.pop_back();
+        for (unsigned k=inicio[id-1]; k<inicio[id]; k++)
+        {
+            if (!depende[destino[k]-1])
+            {
+                depende[destino[k]-1] = true;
+                pilha.push_back(destino[k]);
+            }
+        }
+    }
+
+    for (unsigned j=0; j<getNumOutputs(); j++)
+    {
+        afetadas[j] = (id_out[j]>0 && id_out[j]<=int(NP) && depende[id_out[j]-1]);
+    }
+}
+
+void Circuito::portasNecessarias(const std::vector<bool>& saidas, std::vector<int>& IdPorts) const
+{
+    IdPorts.clear();
+    unsigned NP = getNumPorts();
+    std::vector<bool> necessaria(NP, false);
+    std::vector<int> pilha;
+    for (unsigned j=0; j<getNumOutputs() && j<saidas.size(); j++)
+    {
+        int id = id_out[j];
+        if (saidas[j] && id>0 && id<=int(NP) && !necessaria[id-1])
+        {
+            necessaria[id-1] = true;
+            pilha.push_back(id);
+        }
+    }
+    // Percorre o grafo no sentido das entradas das portas
+    while (!pilha.empty())
+    {
+        int id = pilha.back();
+        pilha.pop_back();
+        if (ports[id-1]==nullptr) continue;
+        for (unsigned j=0; j<ports[id-1]->getNumInputs(); j++)
+        {
+            int orig = ports[id-1]->getId_in(j);
+            if (orig>0 && orig<=int(NP) && !necessaria[orig-1])
+            {
+                necessaria[orig-1] = true;
+                pilha.push_back(orig);
+            }
+        }
+    }
+    for (unsigned i=0; i<NP; i++) if (necessaria[i]) IdPorts.push_back(int(i+1));
+}
@@ -6,6 +6,8 @@
 #include <vector>
 #include "bool3S.h"
 #include "port.h"
+#include "leitura.h"
+#include "estatisticas.h"
 
 /// ###########################################################################
 /// ATENCAO PARA A CONVENCAO DOS NOMES E TIPOS PARA OS PARAMETROS DAS FUNCOES:
@@ -23,6 +25,9 @@
 /// CLASSE CIRCUIT
 ///
 
+// Bloco de linhas da secao PORTAS de um arquivo (definido em circuito.cpp)
+struct BlocoPortas;
+
 class Circuito {
 private:
   /// ***********************
@@ -47,6 +52,30 @@ private:
   // As portas
   std::vector<ptr_Port> ports;  // vetor a ser alocado com dimensao "Nports"
 
+  // Leh as portas de um bloco de linhas da secao PORTAS de um arquivo (usado por ler)
+  void lerBlocoPortas(BlocoPortas& B);
+
+  // O diario de alteracoes (salvamento incremental, ver salvarIncremental)
+  // Arquivo base ao qual o diario se refere (o ultimo lido ou salvo com salvarIncremental)
+  std::string arqBase;
+  // Ids das portas e saidas alteradas desde o ultimo salvamento (podem se repetir)
+  std::vector<int> portasAlteradas;
+  std::vector<int> saidasAlteradas;
+  // Numero de registros gravados no diario de arqBase
+  unsigned registrosDiario;
+
+  // Os contadores das simulacoes (soh atualizados com CIRCUITO_ESTATISTICAS)
+  SimStats estatisticas;
+
+  // Monta, para cada porta, a lista das portas que a usam como origem de alguma entrada
+  // (o sentido inverso de getId_inPort): as portas que usam a porta de id k ficam em
+  // destino[inicio[k-1]] ... destino[inicio[k]-1]
+  void montarDestinosPortas(std::vector<unsigned>& inicio, std::vector<int>& destino) const;
+
+  // Aplica sobre o circuito os registros do diario de arq (arq+".jrn"), se existir
+  // Retorna false (com os diagnosticos em R) se o diario contiver algum registro invalido
+  bool lerDiario(const std::string& arq, ResultadoLeitura& R);
+
 public:
 
   /// ***********************
@@ -80,6 +109,11 @@ public:
   // Serah necessario utilizar a funcao virtual clone para criar copias das portas
   void operator=(const Circuito& C);
 
+  // Troca todo o conteudo (inclusive o diario de alteracoes) com o circuito C, sem copiar
+  // as portas: apenas os vetores e os ponteiros sao trocados
+  // Permite ler um circuito em outra variavel e so depois substituir o circuito atual
+  void swap(Circuito& C);
+
   // Redimensiona o circuito para passar a ter NI entradas, NO saidas e NP ports
   // Inicialmente checa os parametros. Caso sejam validos,
   // depois de limpar conteudo anterior (clear), altera Nin; os vetores tem as dimensoes
@@ -167,6 +201,26 @@ public:
   // ou 0 se parametro invalido
   int getId_inPort(int IdPort, unsigned I) const;
 
+  // Retorna o atraso da porta (usado apenas pela simulacao com atrasos, ver
+  // SimuladorTemporizado)
+  // Depois de testar se a porta existe (definedPort), retorna ports[IdPort-1]->getAtraso()
+  // ou 0 se parametro invalido
+  unsigned getAtrasoPort(int IdPort) const;
+
+  // Retorna o valor logico atual da saida da porta cuja id eh IdPort (o resultado da
+  // ultima simulacao)
+  // Depois de testar se a porta existe (definedPort), retorna ports[IdPort-1]->getOutput()
+  // ou bool3S::UNDEF se parametro invalido
+  bool3S getOutputPort(int IdPort) const;
+
+  // Impressao digital (hash estrutural) do circuito: 32 digitos hexadecimais calculados
+  // a partir do numero de entradas, dos tipos e das origens das entradas de todas as
+  // portas e das origens de todas as saidas. Nao depende da formatacao do arquivo de
+  // onde o circuito foi lido, nem da plataforma: dois circuitos com a mesma estrutura
+  // tem a mesma impressao digital (usada como chave do cache de tabelas verdade)
+  // Retorna uma string vazia se o circuito nao for valido
+  std::string impressaoDigital() const;
+
   /// ***********************
   /// Funcoes de modificacao
   /// ***********************
@@ -185,12 +239,17 @@ public:
   // 1) Libera a antiga area de memoria: delete ports[IdPort-1]
   // 2) Cria a nova porta: ports[IdPort-1] <- new ... (de acordo com tipo)
   // 3) Fixa o numero de entrada: ports[IdPort-1]->setNumInputs(NIn)
+  // Se a porta jah existia, a nova porta fica com o mesmo atraso
   void setPort(int IdPort, std::string Tipo, unsigned NIn);
 
   // Altera a origem da I-esima entrada da porta cuja id eh IdPort, que passa a ser "IdOrig"
   // Depois de VARIOS testes (definedPort, validIndex, validIdOrig)
   // faz: ports[IdPort-1]->setId_in(I,Idorig)
-  void setId_inPort(int IdPort, unsigned I, int IdOrig) const;
+  void setId_inPort(int IdPort, unsigned I, int IdOrig);
+
+  // Altera o atraso da porta cuja id eh IdPort
+  // Depois de testar se a porta existe (definedPort), faz: ports[IdPort-1]->setAtraso(D)
+  void setAtrasoPort(int IdPort, unsigned D);
 
   /// ***********************
   /// E/S de dados
@@ -199,7 +258,7 @@ public:
   // Entrada dos dados de um circuito via teclado
   // O usuario digita o numero de entradas, saidas e portas
   // apos o que, se os valores estiverem corretos (>0), redimensiona o circuito
-  // Em seguida, para cada porta o usuario digita o tipo (NT,AN,NA,OR,NO,XO,NX) que eh conferido
+  // Em seguida, para cada porta o usuario digita o tipo (NT,AN,NA,OR,NO,XO,NX,DF) que eh conferido
   // Apos criada dinamicamente (new) a porta do tipo correto, chama a
   // funcao digitar na porta recem-criada. A porta digitada eh conferida (validPort).
   // Em seguida, o usuario digita as ids de todas as saidas, que sao conferidas (validIdOrig).
@@ -216,18 +275,79 @@ public:
   // Em seguida, leh as ids de todas as saidas, que sao conferidas (validIdOrig)
   // Retorna true se deu tudo OK; false se deu erro.
   // Deve utilizar o metodo ler da classe Port
+  // O arquivo eh mapeado em memoria e a secao PORTAS eh dividida em blocos que terminam
+  // em fim de linha; os blocos sao lidos em paralelo (uma thread por nucleo, para arquivos
+  // grandes) e depois as ids das portas e das suas entradas sao conferidas em uma unica passada
+  // Em caso de erro, imprime em cout todos os problemas encontrados (linha, coluna,
+  // codigo do erro e o que era esperado)
   bool ler(const std::string& arq);
 
+  // Versao de ler que nao imprime nada: todos os problemas encontrados no arquivo
+  // (e nao apenas o primeiro) sao devolvidos em R, com linha, coluna, codigo do erro e
+  // o que era esperado. A leitura nao usa excecoes: apos um erro em uma linha, continua
+  // na linha seguinte, de modo que um arquivo pode ser totalmente validado em uma passada
+  // Cada porta e cada saida devem estar em uma linha propria (como imprimir escreve)
+  // Se existir um diario de alteracoes (arq+".jrn", ver salvarIncremental), ele eh
+  // aplicado sobre o circuito lido
+  // Se R.progresso nao for nullptr, o numero de bytes jah lidos eh atualizado durante a
+  // leitura, e a leitura termina com o erro CANCELADA se R.progresso->cancelado ficar true
+  // Retorna true se deu tudo OK (R.ok()); false se deu erro (e o circuito fica vazio)
+  bool ler(const std::string& arq, ResultadoLeitura& R);
+
   // Saida dos dados de um circuito (em tela ou arquivo, a mesma funcao serve para os dois)
   // Imprime os cabecalhos e os dados do circuito, caso o circuito seja valido
   // Deve utilizar os metodos de impressao da classe Port
   std::ostream& imprimir(std::ostream& O=std::cout) const;
 
+  // Arquivo ao qual se refere o diario de alteracoes (vazio se nenhum)
+  const std::string& getArqBase() const {return arqBase;}
+
   // Salvar circuito em arquivo, caso o circuito seja valido
-  // Abre a stream, chama o metodo imprimir e depois fecha a stream
+  // Chama o metodo imprimir em um arquivo temporario, que depois substitui arq: se der
+  // erro na gravacao, o arquivo e o diario anteriores continuam intactos
   // Retorna true se deu tudo OK; false se deu erro
+  // Como o arquivo foi inteiramente reescrito, apaga o diario de alteracoes (arq+".jrn"),
+  // se existir
   bool salvar(const std::string& arq) const;
 
+  // Salvamento incremental, atraves de um diario de alteracoes (arquivo arq+".jrn")
+  // Se arq eh o arquivo base do circuito (o ultimo arquivo lido ou salvo com esta funcao),
+  // apenas acrescenta ao final do diario um pequeno registro para cada porta e saida
+  // alterada desde o ultimo salvamento (custo proporcional ao numero de alteracoes, e
+  // nao ao tamanho do circuito). Caso contrario, ou se o diario ficar maior que o proprio
+  // circuito, faz um salvamento completo (compactar).
+  // Registros do diario: "P <id>) <porta>" (mesmo formato da secao PORTAS) e
+  // "S <id>) <origem>" (mesmo formato da secao SAIDAS). Ao ler o arquivo base, o diario
+  // eh aplicado sobre ele (ver ler); um registro incompleto no final (sem fim de linha)
+  // eh ignorado, e descartado antes de acrescentar novos registros
+  // Retorna true se deu tudo OK; false se deu erro (inclusive circuito invalido)
+  bool salvarIncremental(const std::string& arq);
+
+  // Incorpora o diario ao arquivo: salva o circuito completo em arq (em um arquivo
+  // temporario que depois substitui arq) e apaga o diario
+  // Retorna true se deu tudo OK; false se deu erro (inclusive circuito invalido)
+  bool compactar(const std::string& arq);
+
+  // Exportacao do circuito para outros formatos de netlist, para permitir comparar
+  // os resultados e o desempenho com outros simuladores sobre o mesmo circuito.
+  // As entradas do circuito sao nomeadas in1..inN, as saidas das portas p1..pM e
+  // as saidas do circuito out1..outK.
+  // A escrita eh feita porta a porta diretamente na stream (sem montar o texto em
+  // memoria), de modo que o consumo de memoria nao cresce com o tamanho do circuito.
+  // Se o circuito nao for valido, nada eh escrito.
+
+  // Escreve o circuito como Verilog estrutural plano, usando as primitivas
+  // and, nand, or, nor, xor, xnor e not
+  std::ostream& exportarVerilog(std::ostream& O, const std::string& modulo="circuito") const;
+
+  // Escreve o circuito no formato .bench (ISCAS)
+  std::ostream& exportarBench(std::ostream& O) const;
+
+  // Abrem a stream, chamam o metodo de exportacao correspondente e depois fecham a stream
+  // Retornam true se deu tudo OK; false se deu erro (inclusive circuito invalido)
+  bool salvarVerilog(const std::string& arq) const;
+  bool salvarBench(const std::string& arq) const;
+
   /// ***********************
   /// SIMULACAO (funcao principal do circuito)
   /// ***********************
@@ -242,6 +362,42 @@ public:
   // Retorna true se a simulacao foi OK; false caso deh erro
   bool simular(const std::vector<bool3S>& in_circ);
 
+  // Versao de simular que calcula apenas as portas cujas ids estao em IdPorts
+  // (por exemplo, o cone de entrada de algumas saidas, ver portasNecessarias).
+  // Como cada porta soh depende do seu cone de entrada, essas portas terminam com os
+  // mesmos valores que teriam na simulacao completa; as saidas que dependem de outras
+  // portas ficam com valores sem significado
+  bool simular(const std::vector<bool3S>& in_circ, const std::vector<int>& IdPorts);
+
+  // Os contadores de desempenho das simulacoes feitas com este circuito (ver
+  // estatisticas.h): ficam em zero se o nucleo nao foi compilado com CIRCUITO_ESTATISTICAS
+  // Nao sao copiados junto com o circuito
+  const SimStats& getEstatisticas() const {return estatisticas;}
+  void zerarEstatisticas() {estatisticas.zerar();}
+
+  /// ***********************
+  /// Dependencias entre portas e saidas
+  /// Usadas para recalcular apenas parte da tabela verdade depois de uma alteracao
+  /// ***********************
+
+  // Marca em afetadas (redimensionado para NumOutputs) as saidas do circuito cujo valor
+  // depende da porta IdPort, diretamente ou atraves de outras portas (o cone de saida)
+  void saidasDependentes(int IdPort, std::vector<bool>& afetadas) const;
+
+  // Preenche IdPorts com as ids (em ordem crescente) de todas as portas das quais
+  // dependem as saidas marcadas em saidas (o cone de entrada dessas saidas)
+  void portasNecessarias(const std::vector<bool>& saidas, std::vector<int>& IdPorts) const;
+
+  // Calcula o nivel logico de cada porta (nivel[IdPort-1]): 1 + o maior nivel entre as
+  // portas de origem das suas entradas (as entradas do circuito tem nivel 0), ou seja,
+  // a profundidade da porta na ordem topologica do grafo das ligacoes
+  // Uma porta em um laco (realimentacao) nao tem profundidade definida: o laco eh
+  // quebrado na porta de menor id, como se as origens ainda sem nivel tivessem nivel 0
+  // Um flip-flop (DF) tem sempre nivel 1: a sua saida (o estado) nao depende
+  // combinacionalmente da entrada, e os lacos que passam por flip-flops nao contam
+  // Retorna true se o circuito nao tem lacos
+  bool calcularNiveis(std::vector<unsigned>& nivel) const;
+
 };
 
 // Operador de impressao da classe Circuit
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include "circuitoplano.h"
+#include "circuito.h"
+#include "estatisticas.h"
+
+///
+/// ESTRUTURA CIRCUITOPLANO
+///
+
+CircuitoPlano::CircuitoPlano():
+  Nin(0), Nports(0), tipos(), sinais(), niveis(), inicioOrigens(1,0), origens(), saidas(),
+  maxNivel(0), semLacos(true)
+{
+}
+
+bool CircuitoPlano::montar(const Circuito& C)
+{
+  if (!C.valid())
+  {
+    clear();
+    return false;
+  }
+  Nin = C.getNumInputs();
+  Nports = C.getNumPorts();
+
+  // A ordem das portas por nivel (ordenacao por contagem, estavel: dentro de um nivel,
+  // na ordem das ids)
+  std::vector<unsigned> nivel;
+  semLacos = C.calcularNiveis(nivel);
+  maxNivel = 0;
+  for (unsigned i=0; i<Nports; i++) maxNivel = std::max(maxNivel, nivel[i]);
+  std::vector<unsigned> inicioNivel(maxNivel+2, 0);
+  for (unsigned i=0; i<Nports; i++) inicioNivel[nivel[i]+1]++;
+  for (unsigned n=0; n<=maxNivel; n++) inicioNivel[n+1] += inicioNivel[n];
+  std::vector<unsigned> ordem(Nports);
+  for (unsigned i=0; i<Nports; i++) ordem[inicioNivel[nivel[i]]++] = i;
+
+  // Tipo, sinal, nivel e origens de cada porta, na ordem
+  tipos.resize(Nports);
+  sinais.resize(Nports);
+  niveis.resize(Nports);
+  inicioOrigens.assign(Nports+1, 0);
+  origens.clear();
+  for (unsigned k=0; k<Nports; k++)
+  {
+    int idPort = int(ordem[k]+1);
+    tipos[k] = uint8_t(SimStats::indiceTipo(C.getNamePort(idPort)));
+    sinais[k] = Nin+ordem[k];
+    niveis[k] = nivel[ordem[k]];
+    inicioOrigens[k] = unsigned(origens.size());
+    for (unsigned j=0; j<C.getNumInputsPort(idPort); j++) origens.push_back(sinal(C.getId_inPort(idPort, j)));
+  }
+  inicioOrigens[Nports] = unsigned(origens.size());
+  saidas.resize(C.getNumOutputs());
+  for (unsigned j=0; j<saidas.size(); j++) saidas[j] = sinal(C.getIdOutput(int(j+1)));
+  return true;
+}
+
+void CircuitoPlano::clear()
+{
+  Nin = Nports = 0;
+  tipos.clear();
+  sinais.clear();
+  niveis.clear();
+  inicioOrigens.assign(1, 0);
+  origens.clear();
+  saidas.clear();
+  maxNivel = 0;
+  semLacos = true;
+}
+
+void CircuitoPlano::calcularDestinos(std::vector<unsigned>& inicioDestinos,
+                                     std::vector<unsigned>& destinos) const
+{
+  // Ordenacao por contagem das origens pelo sinal
+  inicioDestinos.assign(Nin+Nports+1, 0);
+  for (unsigned m=0; m<origens.size(); m++) inicioDestinos[origens[m]+1]++;
+  for (unsigned s=0; s<Nin+Nports; s++) inicioDestinos[s+1] += inicioDestinos[s];
+  destinos.resize(origens.size());
+  std::vector<unsigned> proximo(inicioDestinos.begin(), inicioDestinos.end()-1);
+  for (unsigned k=0; k<Nports; k++)
+  {
+    for (unsigned m=inicioOrigens[k]; m<inicioOrigens[k+1]; m++) destinos[proximo[origens[m]]++] = k;
+  }
+}
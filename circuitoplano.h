@@ -0,0 +1,113 @@
+#ifndef _CIRCUITOPLANO_H_
+#define _CIRCUITOPLANO_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+
+class Circuito;
+
+// Os tipos de porta, na representacao plana (a mesma ordem de SimStats::nomeTipo)
+enum TipoPorta : uint8_t {
+  TIPO_NT, TIPO_AN, TIPO_NA, TIPO_OR, TIPO_NO, TIPO_XO, TIPO_NX, TIPO_DF
+};
+
+///
+/// ESTRUTURA CIRCUITOPLANO
+///
+
+// A copia "plana" da estrutura de um circuito, comum aos simuladores (incremental, em
+// lote, por ciclos, com atrasos) e aos BDDs: montada uma vez, em vetores compactos, e
+// depois independente do Circuito.
+// Os sinais sao numerados: entradas do circuito de 0 a Nin-1 e portas de Nin em diante
+// (a porta IdPort eh o sinal Nin+IdPort-1).
+// As portas ficam em ordem de nivel logico (Circuito::calcularNiveis; dentro de um
+// nivel, na ordem das ids): sem lacos, uma passada nessa ordem encontra todas as
+// origens de cada porta jah calculadas. As origens da k-esima porta da ordem ficam em
+// origens[inicioOrigens[k]] ... origens[inicioOrigens[k+1]-1].
+struct CircuitoPlano {
+  unsigned Nin;
+  unsigned Nports;
+  // Tipo (TipoPorta), sinal de saida e nivel da k-esima porta da ordem
+  std::vector<uint8_t> tipos;
+  std::vector<unsigned> sinais;
+  std::vector<unsigned> niveis;
+  // Os sinais de origem das entradas de cada porta
+  std::vector<unsigned> inicioOrigens;
+  std::vector<unsigned> origens;
+  // Sinal de cada saida do circuito
+  std::vector<unsigned> saidas;
+  // O maior nivel e se o circuito nao tem lacos (os que passam por flip-flops nao
+  // contam, ver Circuito::calcularNiveis)
+  unsigned maxNivel;
+  bool semLacos;
+
+  CircuitoPlano();
+
+  // Monta a estrutura do circuito C
+  // Retorna false (e fica vazio) se o circuito nao for valido
+  bool montar(const Circuito& C);
+
+  // Esvazia a estrutura
+  void clear();
+
+  // O sinal correspondente a uma id de origem (IdInput<0 ou IdPort>0)
+  unsigned sinal(int IdOrig) const
+  {
+    return (IdOrig<0 ? unsigned(-IdOrig-1) : Nin+unsigned(IdOrig-1));
+  }
+
+  // O sentido inverso das origens: as portas (posicoes na ordem) que usam o sinal s
+  // ficam em destinos[inicioDestinos[s]] ... destinos[inicioDestinos[s+1]-1], em ordem
+  // crescente (uma porta que usa o mesmo sinal em duas entradas aparece duas vezes)
+  void calcularDestinos(std::vector<unsigned>& inicioDestinos,
+                        std::vector<unsigned>& destinos) const;
+};
+
+///
+/// AVALIACAO DE UMA PORTA
+///
+
+// Calcula a saida de uma porta de tipo Tipo com NumEntradas entradas, com os mesmos
+// resultados das funcoes simular das portas (port.cpp), em qualquer representacao dos
+// valores (bool3S, tabelas, palavras de 64 vetores, BDDs): entrada(j) eh o valor da
+// entrada j, e Op fornece os operadores de bool3S nessa representacao:
+// Op.nao(A), Op.e(A,B), Op.ou(A,B), Op.xou(A,B) e Op.indefinido()
+// Um flip-flop (DF) vale sempre UNDEF: sem clock, o seu estado eh desconhecido
+template <class Valor, class Operacoes, class Entrada>
+inline Valor avaliarPorta(uint8_t Tipo, unsigned NumEntradas, const Entrada& entrada,
+                          Operacoes& Op)
+{
+  Valor S = entrada(0);
+  switch (Tipo)
+  {
+  case TIPO_NT:
+    return Op.nao(S);
+  case TIPO_DF:
+    return Op.indefinido();
+  case TIPO_AN:
+  case TIPO_NA:
+    for (unsigned j=1; j<NumEntradas; j++) S = Op.e(S, entrada(j));
+    break;
+  case TIPO_OR:
+  case TIPO_NO:
+    for (unsigned j=1; j<NumEntradas; j++) S = Op.ou(S, entrada(j));
+    break;
+  default:
+    for (unsigned j=1; j<NumEntradas; j++) S = Op.xou(S, entrada(j));
+    break;
+  }
+  if (Tipo==TIPO_NA || Tipo==TIPO_NO || Tipo==TIPO_NX) S = Op.nao(S);
+  return S;
+}
+
+// Os operadores de bool3S, para avaliarPorta com valores bool3S
+struct OperacoesBool3S {
+  static bool3S nao(bool3S A) {return ~A;}
+  static bool3S e(bool3S A, bool3S B) {return A & B;}
+  static bool3S ou(bool3S A, bool3S B) {return A | B;}
+  static bool3S xou(bool3S A, bool3S B) {return A ^ B;}
+  static bool3S indefinido() {return bool3S::UNDEF;}
+};
+
+#endif // _CIRCUITOPLANO_H_
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "equivalencia.h"
+#include "bdd.h"
+#include "circuito.h"
+#include "gerador.h"
+#include "rastro.h"
+#include "simuladorlote.h"
+#include "tabelaverdade.h"
+
+// Numero de palavras (de 64 vetores) que cada thread da enumeracao pega de cada vez
+static const unsigned PALAVRAS_BLOCO = 64;
+
+OpcoesEquivalencia::OpcoesEquivalencia():
+  soDefinidas(false), vetoresAleatorios(16384), maxVetores(uint64_t(1)<<32), semente(1),
+  numThreads(0), maxNosBDD(BDD::MAX_NOS_PADRAO)
+{
+}
+
+ResultadoEquivalencia::ResultadoEquivalencia():
+  conclusao(Equivalencia::INCOMPATIVEIS), contraExemplo(), IdOutput(0),
+  saida1(bool3S::UNDEF), saida2(bool3S::UNDEF), vetoresSimulados(0), nosBDD(0)
+{
+}
+
+// A enumeracao de todas as combinacoes de entradas, na ordem da tabela verdade (a
+// ultima entrada varia mais rapido), em palavras de ateh 64 vetores: as m ultimas
+// entradas variam dentro da palavra, com padroes fixos de bits (2^m vetores por
+// palavra, ou 3^m com UNDEF), e as demais sao constantes em toda a palavra
+struct Enumeracao {
+  unsigned NI;
+  bool soDefinidas;
+  unsigned m;
+  unsigned porPalavra;
+  // Os bits usados de cada palavra
+  uint64_t usados;
+  // Os trilhos da entrada NI-1-p, para p<m
+  uint64_t padraoT[6];
+  uint64_t padraoF[6];
+
+  Enumeracao(unsigned NumInputs, bool SoDefinidas):
+    NI(NumInputs), soDefinidas(SoDefinidas), m(0), porPalavra(1), usados(0)
+  {
+    unsigned base = (soDefinidas ? 2 : 3);
+    m = std::min(NI, soDefinidas ? 6u : 3u);
+    unsigned peso = 1;
+    for (unsigned p=0; p<m; p++, peso*=base)
+    {
+      // No vetor b da palavra, a entrada NI-1-p vale o digito p de b na base 2 (F=0,
+      // T=1) ou 3 (UNDEF=0, F=1, T=2)
+      padraoT[p] = padraoF[p] = 0;
+      for (unsigned b=0; b<64; b++)
+      {
+        unsigned digito = (b/peso) % base + (soDefinidas ? 1 : 0);
+        if (digito==2) padraoT[p] |= uint64_t(1)<<b;
+        else if (digito==1) padraoF[p] |= uint64_t(1)<<b;
+      }
+    }
+    porPalavra = peso;
+    usados = (porPalavra==64 ? ~uint64_t(0) : (uint64_t(1)<<porPalavra)-1);
+    for (unsigned p=0; p<m; p++)
+    {
+      padraoT[p] &= usados;
+      padraoF[p] &= usados;
+    }
+  }
+
+  // O valor da entrada J na combinacao numero L
+  bool3S entrada(uint64_t L, unsigned J) const
+  {
+    if (!soDefinidas) return entradaLinha(L, NI, J);
+    return ((L>>(NI-1-J))&1 ? bool3S::TRUE : bool3S::FALSE);
+  }
+
+  // Preenche os trilhos das entradas da palavra cujo primeiro vetor eh a combinacao L
+  // (L multiplo de porPalavra)
+  void palavra(uint64_t L, uint64_t* T, uint64_t* F) const
+  {
+    for (unsigned j=0; j<NI; j++)
+    {
+      unsigned p = NI-1-j;
+      if (p<m)
+      {
+        T[j] = padraoT[p];
+        F[j] = padraoF[p];
+        continue;
+      }
+      bool3S B = entrada(L, j);
+      T[j] = (B==bool3S::TRUE ? usados : 0);
+      F[j] = (B==bool3S::FALSE ? usados : 0);
+    }
+  }
+};
+
+// Numero de combinacoes de NI entradas (3^NI, ou 2^NI soh com F e T), ou UINT64_MAX
+// se nao couber em 64 bits
+static uint64_t numCombinacoes(unsigned NI, bool soDefinidas)
+{
+  if (soDefinidas) return (NI<64 ? uint64_t(1)<<NI : UINT64_MAX);
+  return (NI<=40 ? numLinhasTabela(NI) : UINT64_MAX);
+}
+
+// Os dois circuitos simulados juntos, palavra a palavra (um par por thread)
+struct ParSimuladores {
+  SimuladorLote S1, S2;
+  std::vector<uint64_t> T1, F1, T2, F2;
+
+  ParSimuladores(const SimuladorLote& A, const SimuladorLote& B):
+    S1(A), S2(B), T1(A.getNumOutputs()), F1(A.getNumOutputs()), T2(A.getNumOutputs()),
+    F2(A.getNumOutputs())
+  {
+  }
+
+  // Simula uma palavra de entradas nos dois circuitos
+  // Retorna os bits dos vetores em que alguma saida difere
+  uint64_t diferencas(const uint64_t* T, const uint64_t* F)
+  {
+    S1.simularPalavras(T, F, T1.data(), F1.data());
+    S2.simularPalavras(T, F, T2.data(), F2.data());
+    uint64_t d = 0;
+    for (unsigned i=0; i<T1.size(); i++) d |= (T1[i]^T2[i]) | (F1[i]^F2[i]);
+    return d;
+  }
+};
+
+// O indice do bit menos significativo ligado de d (d!=0)
+static unsigned primeiroBit(uint64_t d)
+{
+  unsigned b = 0;
+  while (!((d>>b)&1)) b++;
+  return b;
+}
+
+// Preenche o contraexemplo de R com as entradas v e a primeira saida diferente
+static void registrarContraExemplo(SimuladorLote& S1, SimuladorLote& S2,
+                                   const std::vector<bool3S>& v, ResultadoEquivalencia& R)
+{
+  unsigned NO = S1.getNumOutputs();
+  std::vector<uint8_t> linha1(bytesPorLinha(NO)), linha2(bytesPorLinha(NO));
+  S1.simularLote(v.data(), 1, linha1.data());
+  S2.simularLote(v.data(), 1, linha2.data());
+  R.conclusao = Equivalencia::DIFERENTES;
+  R.contraExemplo = v;
+  for (unsigned i=0; i<NO; i++)
+  {
+    if (lerValor(linha1.data(), i)==lerValor(linha2.data(), i)) continue;
+    R.IdOutput = int(i+1);
+    R.saida1 = lerValor(linha1.data(), i);
+    R.saida2 = lerValor(linha2.data(), i);
+    break;
+  }
+}
+
+// Retorna true se C1 e C2 (validos, com os mesmos numeros de entradas e saidas) tem a
+// mesma estrutura: as mesmas portas, com as mesmas origens, e as mesmas saidas
+// (a comparacao direta custa o mesmo que calcular as impressoes digitais, que podem
+// coincidir em circuitos diferentes)
+static bool mesmaEstrutura(const Circuito& C1, const Circuito& C2)
+{
+  if (C1.getNumPorts()!=C2.getNumPorts()) return false;
+  for (unsigned i=0; i<C1.getNumPorts(); i++)
+  {
+    int idPort = int(i+1);
+    unsigned NIn = C1.getNumInputsPort(idPort);
+    if (C1.getNamePort(idPort)!=C2.getNamePort(idPort) || NIn!=C2.getNumInputsPort(idPort)) return false;
+    for (unsigned j=0; j<NIn; j++)
+    {
+      if (C1.getId_inPort(idPort, j)!=C2.getId_inPort(idPort, j)) return false;
+    }
+  }
+  for (unsigned j=0; j<C1.getNumOutputs(); j++)
+  {
+    if (C1.getIdOutput(int(j+1))!=C2.getIdOutput(int(j+1))) return false;
+  }
+  return true;
+}
+
+// A fase 3 de equivalentes: compara os BDDs das saidas de C1 e C2
+static bool equivalentesBDD(const Circuito& C1, const Circuito& C2, SimuladorLote& S1,
+                            SimuladorLote& S2, ResultadoEquivalencia& R,
+                            const OpcoesEquivalencia& O)
+{
+  R.conclusao = Equivalencia::INCONCLUSIVO;
+  if (O.maxNosBDD==0) return false;
+  RASTRO("BDDs");
+  BDDCircuito B;
+  B.preparar(C1, OrdemBDD::PROFUNDIDADE, !O.soDefinidas, O.maxNosBDD);
+  std::vector<BDD::No> T1, F1, T2, F2;
+  bool construidos = B.construir(C1, T1, F1) && B.construir(C2, T2, F2);
+  BDD& D = B.getBDD();
+  // As combinacoes de entradas em que alguma saida difere
+  BDD::No diferentes = BDD::FALSO;
+  for (unsigned i=0; construidos && i<T1.size(); i++)
+  {
+    diferentes = D.ou(diferentes, D.ou(D.xou(T1[i], T2[i]), D.xou(F1[i], F2[i])));
+  }
+  R.nosBDD = D.getNumNos();
+  if (!construidos || D.getEstourado()) return false;
+  if (diferentes==BDD::FALSO)
+  {
+    R.conclusao = Equivalencia::EQUIVALENTES;
+    return true;
+  }
+  std::vector<bool3S> v;
+  B.exemploEntradas(diferentes, v);
+  registrarContraExemplo(S1, S2, v, R);
+  return false;
+}
+
+bool equivalentes(const Circuito& C1, const Circuito& C2, ResultadoEquivalencia* R0,
+                  const OpcoesEquivalencia& O)
+{
+  RASTRO("verificar equivalencia");
+  ResultadoEquivalencia Rlocal;
+  ResultadoEquivalencia& R = (R0!=nullptr ? *R0 : Rlocal);
+  R = ResultadoEquivalencia();
+  if (!C1.valid() || !C2.valid() || C1.getNumInputs()!=C2.getNumInputs() ||
+      C1.getNumOutputs()!=C2.getNumOutputs()) return false;
+
+  // Circuitos com a mesma estrutura calculam a mesma funcao
+  if (mesmaEstrutura(C1, C2))
+  {
+    R.conclusao = Equivalencia::EQUIVALENTES;
+    return true;
+  }
+
+  SimuladorLote S1, S2;
+  S1.montar(C1);
+  S2.montar(C2);
+  unsigned NI = C1.getNumInputs();
+  uint64_t total = numCombinacoes(NI, O.soDefinidas);
+  std::vector<bool3S> v(NI);
+  std::vector<uint64_t> T(NI), F(NI);
+
+  // 1) Vetores aleatorios, se a enumeracao nao for mais curta: cada entrada eh F ou T
+  // com probabilidade 3/8 e UNDEF com 1/4 (ou F e T com 1/2, soh com F e T)
+  if (total>O.vetoresAleatorios)
+  {
+    RASTRO("vetores aleatorios", int64_t(O.vetoresAleatorios));
+    GeradorAleatorio G(O.semente);
+    ParSimuladores P(S1, S2);
+    for (uint64_t feitos=0; feitos<O.vetoresAleatorios; feitos+=64)
+    {
+      for (unsigned j=0; j<NI; j++)
+      {
+        uint64_t valor = G.proximo();
+        uint64_t definido = (O.soDefinidas ? ~uint64_t(0) : G.proximo() | G.proximo());
+        T[j] = valor & definido;
+        F[j] = ~valor & definido;
+      }
+      uint64_t d = P.diferencas(T.data(), F.data());
+      if (d!=0)
+      {
+        unsigned b = primeiroBit(d);
+        R.vetoresSimulados += b+1;
+        for (unsigned j=0; j<NI; j++)
+        {
+          v[j] = ((T[j]>>b)&1 ? bool3S::TRUE : (F[j]>>b)&1 ? bool3S::FALSE : bool3S::UNDEF);
+        }
+        registrarContraExemplo(S1, S2, v, R);
+        return false;
+      }
+      R.vetoresSimulados += 64;
+    }
+  }
+
+  // 2) Todas as combinacoes, se nao forem demais; senao, 3) os BDDs
+  if (total>O.maxVetores)
+  {
+    return equivalentesBDD(C1, C2, S1, S2, R, O);
+  }
+  RASTRO("enumeracao", int64_t(total));
+  const Enumeracao E(NI, O.soDefinidas);
+  uint64_t numPalavras = total/E.porPalavra;
+  unsigned numThreads = (O.numThreads>0 ? O.numThreads : std::thread::hardware_concurrency());
+  uint64_t numBlocos = (numPalavras+PALAVRAS_BLOCO-1)/PALAVRAS_BLOCO;
+  numThreads = unsigned(std::max<uint64_t>(1, std::min<uint64_t>(numThreads, numBlocos)));
+  // Os blocos de palavras sao distribuidos em ordem e uma thread continua enquanto o
+  // seu bloco vier antes da primeira diferenca jah encontrada: a diferenca final eh
+  // sempre a primeira da tabela
+  std::atomic<uint64_t> proxima(0), primeira(total), simulados(0);
+  auto enumerar = [&]() {
+    ParSimuladores P(S1, S2);
+    std::vector<uint64_t> Tt(NI), Ft(NI);
+    uint64_t w0;
+    while ((w0 = proxima.fetch_add(PALAVRAS_BLOCO))<numPalavras && w0*E.porPalavra<primeira)
+    {
+      uint64_t fim = std::min<uint64_t>(numPalavras, w0+PALAVRAS_BLOCO);
+      for (uint64_t w=w0; w<fim; w++)
+      {
+        uint64_t L = w*E.porPalavra;
+        E.palavra(L, Tt.data(), Ft.data());
+        uint64_t d = P.diferencas(Tt.data(), Ft.data()) & E.usados;
+        if (d!=0)
+        {
+          unsigned b = primeiroBit(d);
+          simulados += b+1;
+          uint64_t atual = primeira;
+          while (L+b<atual && !primeira.compare_exchange_weak(atual, L+b)) {}
+          return;
+        }
+        simulados += E.porPalavra;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t=1; t<numThreads; t++) threads.emplace_back(enumerar);
+  enumerar();
+  for (unsigned t=0; t<threads.size(); t++) threads[t].join();
+  R.vetoresSimulados += simulados;
+
+  if (primeira<total)
+  {
+    for (unsigned j=0; j<NI; j++) v[j] = E.entrada(primeira, j);
+    registrarContraExemplo(S1, S2, v, R);
+    return false;
+  }
+  R.conclusao = Equivalencia::EQUIVALENTES;
+  return true;
+}
@@ -0,0 +1,80 @@
+#ifndef _EQUIVALENCIA_H_
+#define _EQUIVALENCIA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+
+class Circuito;
+
+///
+/// EQUIVALENCIA DE CIRCUITOS
+///
+
+// Verificacao de que dois circuitos calculam a mesma funcao: as mesmas saidas (F, T ou
+// ?) para todas as combinacoes de entradas, sem gerar nem comparar as tabelas verdade.
+// Os dois circuitos sao simulados juntos com SimuladorLote (64 vetores por palavra):
+// 1) primeiro com vetores aleatorios, que encontram rapidamente a maioria das
+//    diferencas;
+// 2) depois, se nenhuma diferenca apareceu, com todas as combinacoes de entradas, na
+//    ordem da tabela verdade, divididas entre as threads, parando na primeira
+//    diferenca (o contraexemplo eh sempre a primeira linha diferente da tabela);
+// 3) se houver combinacoes demais para testar todas, com os BDDs das saidas dos dois
+//    circuitos (BDDCircuito), comparados no por no: o resultado eh exato, em tempo
+//    proporcional ao tamanho dos BDDs (o contraexemplo eh uma combinacao qualquer).
+// Os flip-flops (DF) e os lacos tem os mesmos valores de Circuito::simular.
+
+// A conclusao de uma verificacao
+enum class Equivalencia {
+  EQUIVALENTES,   // as saidas sao iguais para todas as combinacoes de entradas
+  DIFERENTES,     // foi encontrado um contraexemplo
+  INCOMPATIVEIS,  // circuito invalido ou numeros de entradas ou de saidas diferentes
+  INCONCLUSIVO    // nenhum contraexemplo nos vetores aleatorios, combinacoes demais
+                  // para testar todas (OpcoesEquivalencia::maxVetores) e BDDs
+                  // grandes demais (OpcoesEquivalencia::maxNosBDD)
+};
+
+// Os parametros de uma verificacao
+struct OpcoesEquivalencia {
+  // Testa apenas as entradas F e T (2^NI combinacoes), em vez de F, T e ? (3^NI)
+  bool soDefinidas;
+  // Numero de vetores aleatorios testados antes da enumeracao (padrao: 16384)
+  uint64_t vetoresAleatorios;
+  // Numero maximo de combinacoes da enumeracao (padrao: 2^32); acima disso, o resultado
+  // sem contraexemplo eh INCONCLUSIVO
+  uint64_t maxVetores;
+  // Semente dos vetores aleatorios (padrao: 1)
+  uint64_t semente;
+  // Numero de threads da enumeracao (padrao: 0 = numero de processadores)
+  unsigned numThreads;
+  // Numero maximo de nos dos BDDs, quando a enumeracao nao eh possivel (padrao:
+  // BDD::MAX_NOS_PADRAO; 0 = nao usa BDDs)
+  size_t maxNosBDD;
+
+  OpcoesEquivalencia();
+};
+
+// O resultado de uma verificacao
+struct ResultadoEquivalencia {
+  Equivalencia conclusao;
+  // Se DIFERENTES: as entradas que distinguem os circuitos, a primeira saida diferente
+  // e os valores dela em cada circuito
+  std::vector<bool3S> contraExemplo;
+  int IdOutput;
+  bool3S saida1;
+  bool3S saida2;
+  // Numero de vetores simulados (em cada circuito)
+  uint64_t vetoresSimulados;
+  // Numero de nos dos BDDs construidos (0 se os BDDs nao foram usados)
+  size_t nosBDD;
+
+  ResultadoEquivalencia();
+};
+
+// Verifica se C1 e C2 sao equivalentes (ver acima)
+// Retorna true se forem (conclusao EQUIVALENTES); os detalhes vao para R, se R!=nullptr
+bool equivalentes(const Circuito& C1, const Circuito& C2, ResultadoEquivalencia* R=nullptr,
+                  const OpcoesEquivalencia& O=OpcoesEquivalencia());
+
+#endif // _EQUIVALENCIA_H_
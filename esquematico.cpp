@@ -0,0 +1,440 @@
+#include "esquematico.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+// Geometria do desenho (em unidades da cena)
+static const qreal LARGURA_COLUNA = 200;
+static const qreal LARGURA_NO = 80;
+static const qreal ALTURA_LINHA = 40;
+static const qreal ALTURA_NO = 28;
+
+// Niveis de detalhe (escala da view) a partir dos quais cada coisa eh desenhada
+static const qreal LOD_PORTAS = 0.1;   // abaixo disso, cada coluna eh um bloco
+static const qreal LOD_DETALHE = 0.4;  // a partir disso, nomes e ligacoes
+
+// Valores de DadosEsquematico::destaque (podem ser combinados: em um laco, um no pode
+// estar nos dois cones)
+static const unsigned char CONE_ENTRADA = 1;
+static const unsigned char CONE_SAIDA = 2;
+static const unsigned char NO_DESTACADO = 4;
+
+// A cor de preenchimento de um no
+static QColor corNo(const DadosEsquematico& D, unsigned k)
+{
+  unsigned char d = D.destaque[k];
+  if (d & NO_DESTACADO) return QColor(255,120,120);
+  if (d & CONE_ENTRADA) return QColor(255,200,120);
+  if (d & CONE_SAIDA) return QColor(150,200,255);
+  if (k < D.Nin) return QColor(200,235,200);
+  if (k >= D.Nin+D.Nports) return QColor(200,220,240);
+  return QColor(230,230,230);
+}
+
+/* ======================================================================== *
+ * DADOSESQUEMATICO                                                         *
+ * ======================================================================== */
+
+DadosEsquematico::DadosEsquematico():
+  Nin(0), Nports(0), Nout(0), coluna(), linha(), colunas(),
+  inicioOrigens(1,0), origens(), inicioDestinos(1,0), destinos(), tipos(),
+  destaque(), noDestacado(-1), numConeEntrada(0), numConeSaida(0)
+{
+}
+
+void DadosEsquematico::montar(const Circuito& C)
+{
+  Nin = C.getNumInputs();
+  Nports = C.getNumPorts();
+  Nout = C.getNumOutputs();
+  unsigned N = Nin+Nports+Nout;
+
+  // Colunas: o nivel de cada porta; as saidas depois do ultimo nivel
+  std::vector<unsigned> nivel;
+  C.calcularNiveis(nivel);
+  unsigned maxNivel = 0;
+  for (unsigned i=0; i<Nports; i++) maxNivel = std::max(maxNivel, nivel[i]);
+  coluna.assign(N, 0);
+  for (unsigned i=0; i<Nports; i++) coluna[Nin+i] = nivel[i];
+  for (unsigned j=0; j<Nout; j++) coluna[Nin+Nports+j] = maxNivel+1;
+
+  // Origens de cada no (as entradas do circuito nao tem origem)
+  tipos.assign(Nports, "");
+  inicioOrigens.assign(N+1, 0);
+  origens.clear();
+  for (unsigned k=0; k<N; k++)
+  {
+    inicioOrigens[k] = unsigned(origens.size());
+    if (k>=Nin && k<Nin+Nports)
+    {
+      int idPort = int(k-Nin+1);
+      tipos[k-Nin] = C.getNamePort(idPort);
+      for (unsigned j=0; j<C.getNumInputsPort(idPort); j++)
+      {
+        int id = C.getId_inPort(idPort, j);
+        origens.push_back(id<0 ? unsigned(-id-1) : Nin+unsigned(id-1));
+      }
+    }
+    else if (k>=Nin+Nports)
+    {
+      int id = C.getIdOutput(int(k-Nin-Nports+1));
+      origens.push_back(id<0 ? unsigned(-id-1) : Nin+unsigned(id-1));
+    }
+  }
+  inicioOrigens[N] = unsigned(origens.size());
+
+  // Destinos: o sentido inverso das origens
+  inicioDestinos.assign(N+1, 0);
+  for (unsigned m=0; m<origens.size(); m++) inicioDestinos[origens[m]+1]++;
+  for (unsigned k=0; k<N; k++) inicioDestinos[k+1] += inicioDestinos[k];
+  destinos.resize(origens.size());
+  std::vector<unsigned> pos(inicioDestinos.begin(), inicioDestinos.end()-1);
+  for (unsigned k=0; k<N; k++)
+  {
+    for (unsigned m=inicioOrigens[k]; m<inicioOrigens[k+1]; m++) destinos[pos[origens[m]]++] = k;
+  }
+
+  // Linhas: em cada coluna, os nos sao ordenados pela linha media das suas origens nas
+  // colunas anteriores (jah posicionadas), o que reduz os cruzamentos das ligacoes
+  colunas.assign(maxNivel+2, std::vector<unsigned>());
+  for (unsigned k=0; k<N; k++) colunas[coluna[k]].push_back(k);
+  linha.assign(N, 0);
+  std::vector<double> media(N, 0.0);
+  for (unsigned c=0; c<colunas.size(); c++)
+  {
+    std::vector<unsigned>& nos = colunas[c];
+    if (c>0)
+    {
+      for (unsigned i=0; i<nos.size(); i++)
+      {
+        unsigned k = nos[i];
+        double soma = 0.0;
+        unsigned n = 0;
+        for (unsigned m=inicioOrigens[k]; m<inicioOrigens[k+1]; m++)
+        {
+          if (coluna[origens[m]]<c)
+          {
+            soma += linha[origens[m]];
+            n++;
+          }
+        }
+        media[k] = (n>0 ? soma/n : double(i));
+      }
+      std::stable_sort(nos.begin(), nos.end(),
+                       [&media](unsigned a, unsigned b) {return media[a]<media[b];});
+    }
+    for (unsigned i=0; i<nos.size(); i++) linha[nos[i]] = i;
+  }
+
+  destaque.assign(N, 0);
+  noDestacado = -1;
+  numConeEntrada = numConeSaida = 0;
+}
+
+std::string DadosEsquematico::nome(unsigned k) const
+{
+  if (k<Nin) return "E"+std::to_string(k+1);
+  if (k<Nin+Nports) return std::to_string(k-Nin+1)+") "+tipos[k-Nin];
+  return "S"+std::to_string(k-Nin-Nports+1);
+}
+
+void DadosEsquematico::destacar(int k)
+{
+  std::fill(destaque.begin(), destaque.end(), 0);
+  noDestacado = k;
+  numConeEntrada = numConeSaida = 0;
+  if (k<0 || unsigned(k)>=destaque.size()) return;
+
+  // Cone de entrada: percorre as origens a partir de k; cone de saida: os destinos
+  std::vector<unsigned> pilha(1, unsigned(k));
+  while (!pilha.empty())
+  {
+    unsigned n = pilha.back();
+    pilha.pop_back();
+    for (unsigned m=inicioOrigens[n]; m<inicioOrigens[n+1]; m++)
+    {
+      unsigned o = origens[m];
+      if (!(destaque[o] & CONE_ENTRADA))
+      {
+        destaque[o] |= CONE_ENTRADA;
+        numConeEntrada++;
+        pilha.push_back(o);
+      }
+    }
+  }
+  pilha.assign(1, unsigned(k));
+  while (!pilha.empty())
+  {
+    unsigned n = pilha.back();
+    pilha.pop_back();
+    for (unsigned m=inicioDestinos[n]; m<inicioDestinos[n+1]; m++)
+    {
+      unsigned d = destinos[m];
+      if (!(destaque[d] & CONE_SAIDA))
+      {
+        destaque[d] |= CONE_SAIDA;
+        numConeSaida++;
+        pilha.push_back(d);
+      }
+    }
+  }
+  destaque[k] |= NO_DESTACADO;
+}
+
+/* ======================================================================== *
+ * CLASSE ITEMCOLUNA                                                        *
+ * ======================================================================== */
+
+ItemColuna::ItemColuna(const DadosEsquematico& Dados, unsigned Coluna) :
+  QGraphicsItem(),
+  D(Dados),
+  col(Coluna),
+  limites(Coluna*LARGURA_COLUNA, 0, LARGURA_NO,
+          Dados.colunas[Coluna].size()*ALTURA_LINHA)
+{
+  limites.adjust(-2,-2,2,2);
+  // Para receber em option->exposedRect apenas a regiao que precisa ser redesenhada
+  setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+QRectF ItemColuna::boundingRect() const
+{
+  return limites;
+}
+
+void ItemColuna::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+  const std::vector<unsigned>& nos = D.colunas[col];
+  if (nos.empty()) return;
+  qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+  qreal x = col*LARGURA_COLUNA;
+
+  if (lod < LOD_PORTAS)
+  {
+    // A coluna inteira como um bloco, destacado se tiver algum no destacado
+    unsigned destacados = 0;
+    if (D.noDestacado>=0) for (unsigned i=0; i<nos.size(); i++) if (D.destaque[nos[i]]) destacados++;
+    QRectF bloco(x, 0, LARGURA_NO, nos.size()*ALTURA_LINHA);
+    painter->fillRect(bloco, destacados>0 ? QColor(255,200,120) : QColor(210,210,210));
+    painter->setPen(QPen(QColor(120,120,120), 0));
+    painter->drawRect(bloco);
+    // O texto eh escrito em pixels da tela (na escala da cena ficaria invisivel)
+    QPointF p = painter->worldTransform().map(bloco.topLeft());
+    painter->save();
+    painter->resetTransform();
+    painter->setPen(QColor(Qt::black));
+    QString texto = QString::number(unsigned(nos.size()));
+    if (destacados>0) texto += " (" + QString::number(destacados) + ")";
+    painter->drawText(p + QPointF(2, 12), texto);
+    painter->restore();
+    return;
+  }
+
+  // Apenas as linhas da regiao exposta
+  QRectF exp = option->exposedRect;
+  int r0 = std::max(0, int(std::floor(exp.top()/ALTURA_LINHA)));
+  int r1 = std::min(int(nos.size())-1, int(std::ceil(exp.bottom()/ALTURA_LINHA)));
+  if (r0>r1) return;
+
+  painter->setPen(QPen(QColor(90,90,90), 0));
+  for (int r=r0; r<=r1; r++)
+  {
+    unsigned k = nos[r];
+    QRectF caixa(x, r*ALTURA_LINHA, LARGURA_NO, ALTURA_NO);
+    painter->fillRect(caixa, corNo(D, k));
+    if (lod >= LOD_DETALHE)
+    {
+      painter->drawRect(caixa);
+      painter->drawText(caixa, Qt::AlignCenter, QString::fromStdString(D.nome(k)));
+    }
+  }
+}
+
+/* ======================================================================== *
+ * CLASSE ITEMLIGACOES                                                      *
+ * ======================================================================== */
+
+ItemLigacoes::ItemLigacoes(const DadosEsquematico& Dados, unsigned ColOrigem,
+                           unsigned ColDestino,
+                           std::vector<std::pair<unsigned,unsigned> >&& Ligacoes) :
+  QGraphicsItem(),
+  D(Dados),
+  x0(ColOrigem*LARGURA_COLUNA + LARGURA_NO),
+  x1(ColDestino*LARGURA_COLUNA),
+  ligacoes(std::move(Ligacoes)),
+  limites()
+{
+  unsigned l0 = ~0u, l1 = 0;
+  for (unsigned i=0; i<ligacoes.size(); i++)
+  {
+    unsigned lo = D.linha[ligacoes[i].first], ld = D.linha[ligacoes[i].second];
+    l0 = std::min(l0, std::min(lo, ld));
+    l1 = std::max(l1, std::max(lo, ld));
+  }
+  if (l0>l1) l0 = l1 = 0;
+  limites = QRectF(std::min(x0, x1), l0*ALTURA_LINHA + ALTURA_NO/2,
+                   std::abs(x1-x0), (l1-l0)*ALTURA_LINHA).adjusted(-2,-2,2,2);
+  setZValue(-1);
+  setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+QRectF ItemLigacoes::boundingRect() const
+{
+  return limites;
+}
+
+void ItemLigacoes::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+  qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+  if (lod < LOD_DETALHE) return;
+
+  // Todas as ligacoes vao de x0 a x1: uma ligacao cruza a regiao exposta se a sua
+  // altura nas bordas da regiao (limitadas a [x0,x1]) tiver algum ponto na faixa de
+  // alturas da regiao
+  QRectF exp = option->exposedRect;
+  qreal xa = std::max(exp.left(), std::min(x0, x1)), xb = std::min(exp.right(), std::max(x0, x1));
+  if (xa>xb) return;
+  qreal ta = (x1!=x0 ? (xa-x0)/(x1-x0) : 0.0), tb = (x1!=x0 ? (xb-x0)/(x1-x0) : 1.0);
+
+  // As ligacoes do cone destacado por cima das demais
+  QPen normal(QColor(160,160,160), 0), destacada(QColor(220,80,40), 0);
+  for (int pass=0; pass<2; pass++)
+  {
+    painter->setPen(pass==0 ? normal : destacada);
+    for (unsigned i=0; i<ligacoes.size(); i++)
+    {
+      unsigned o = ligacoes[i].first, k = ligacoes[i].second;
+      bool noCone = (D.destaque[k]!=0 && D.destaque[o]!=0 &&
+                     ((D.destaque[k] & (CONE_SAIDA|NO_DESTACADO) && D.destaque[o] & (CONE_SAIDA|NO_DESTACADO)) ||
+                      (D.destaque[k] & (CONE_ENTRADA|NO_DESTACADO) && D.destaque[o] & CONE_ENTRADA)));
+      if (noCone != (pass==1)) continue;
+      qreal yo = D.linha[o]*ALTURA_LINHA + ALTURA_NO/2, yd = D.linha[k]*ALTURA_LINHA + ALTURA_NO/2;
+      qreal ya = yo + (yd-yo)*ta, yb = yo + (yd-yo)*tb;
+      if (std::max(ya, yb) < exp.top() || std::min(ya, yb) > exp.bottom()) continue;
+      painter->drawLine(QPointF(x0, yo), QPointF(x1, yd));
+    }
+  }
+}
+
+/* ======================================================================== *
+ * CLASSE VISTAESQUEMATICO                                                  *
+ * ======================================================================== */
+
+VistaEsquematico::VistaEsquematico(QWidget *parent) :
+  QGraphicsView(parent),
+  cena(new QGraphicsScene(this)),
+  dados()
+{
+  // O indice BSP descarta as colunas fora da tela sem chamar paint
+  cena->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+  setScene(cena);
+  setDragMode(QGraphicsView::ScrollHandDrag);
+  setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+  setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+  setOptimizationFlag(QGraphicsView::DontSavePainterState);
+  setMouseTracking(true);
+  viewport()->setMouseTracking(true);
+}
+
+void VistaEsquematico::setCircuito(const Circuito& C)
+{
+  // Os itens guardam referencias a dados: sao removidos antes de refazer os dados
+  cena->clear();
+  dados = DadosEsquematico();
+  if (C.valid())
+  {
+    dados.montar(C);
+    for (unsigned c=0; c<dados.colunas.size(); c++) cena->addItem(new ItemColuna(dados, c));
+    // As ligacoes, agrupadas pelo par (coluna da origem, coluna do destino)
+    std::map<std::pair<unsigned,unsigned>, std::vector<std::pair<unsigned,unsigned> > > pares;
+    unsigned N = unsigned(dados.coluna.size());
+    for (unsigned k=0; k<N; k++)
+    {
+      for (unsigned m=dados.inicioOrigens[k]; m<dados.inicioOrigens[k+1]; m++)
+      {
+        unsigned o = dados.origens[m];
+        pares[std::make_pair(dados.coluna[o], dados.coluna[k])].push_back(std::make_pair(o, k));
+      }
+    }
+    for (std::map<std::pair<unsigned,unsigned>, std::vector<std::pair<unsigned,unsigned> > >::iterator
+         p=pares.begin(); p!=pares.end(); ++p)
+    {
+      cena->addItem(new ItemLigacoes(dados, p->first.first, p->first.second, std::move(p->second)));
+    }
+  }
+  cena->setSceneRect(cena->itemsBoundingRect());
+  resetTransform();
+  // Comeca com o circuito inteiro na tela, mas sem ampliar circuitos pequenos
+  fitInView(cena->sceneRect(), Qt::KeepAspectRatio);
+  if (transform().m11() > 1.0) resetTransform();
+  emit signNoSobMouse(QString());
+}
+
+void VistaEsquematico::wheelEvent(QWheelEvent *event)
+{
+  // Zoom em torno do ponto sob o mouse (AnchorUnderMouse), limitado a 4x
+  qreal fator = std::pow(1.0015, event->angleDelta().y());
+  if (transform().m11()*fator > 4.0) fator = 4.0/transform().m11();
+  scale(fator, fator);
+  event->accept();
+}
+
+void VistaEsquematico::mouseMoveEvent(QMouseEvent *event)
+{
+  QGraphicsView::mouseMoveEvent(event);
+  // Enquanto arrasta, nao muda o destaque
+  if (event->buttons()!=Qt::NoButton) return;
+  int k = noEm(mapToScene(event->pos()));
+  if (k==dados.noDestacado) return;
+  dados.destacar(k);
+  cena->update();
+  if (k<0)
+  {
+    emit signNoSobMouse(QString());
+    return;
+  }
+  QString descricao = QString::fromStdString(dados.nome(unsigned(k))) +
+      "   nivel " + QString::number(dados.coluna[k]) +
+      "   cone de entrada: " + QString::number(dados.numConeEntrada) +
+      "   cone de saida: " + QString::number(dados.numConeSaida);
+  emit signNoSobMouse(descricao);
+}
+
+int VistaEsquematico::noEm(const QPointF& p) const
+{
+  if (p.x()<0 || p.y()<0) return -1;
+  unsigned c = unsigned(p.x()/LARGURA_COLUNA);
+  unsigned r = unsigned(p.y()/ALTURA_LINHA);
+  if (c>=dados.colunas.size() || r>=dados.colunas[c].size()) return -1;
+  if (p.x()-c*LARGURA_COLUNA > LARGURA_NO || p.y()-r*ALTURA_LINHA > ALTURA_NO) return -1;
+  return int(dados.colunas[c][r]);
+}
+
+/* ======================================================================== *
+ * CLASSE JANELAESQUEMATICO                                                 *
+ * ======================================================================== */
+
+JanelaEsquematico::JanelaEsquematico(QWidget *parent) :
+  QDialog(parent),
+  vista(new VistaEsquematico(this)),
+  legenda(new QLabel(this))
+{
+  setWindowTitle("Esquematico do circuito");
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(vista);
+  layout->addWidget(legenda);
+  resize(900, 600);
+  connect(vista, &VistaEsquematico::signNoSobMouse,
+          legenda, &QLabel::setText);
+}
+
+void JanelaEsquematico::setCircuito(const Circuito& C)
+{
+  vista->setCircuito(C);
+  if (!C.valid()) legenda->setText("O Circuito nao esta completamente definido.");
+}
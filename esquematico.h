@@ -0,0 +1,156 @@
+#ifndef ESQUEMATICO_H
+#define ESQUEMATICO_H
+
+#include <QDialog>
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QLabel>
+#include <string>
+#include <utility>
+#include <vector>
+#include "circuito.h"
+
+/* ======================================================================== *
+ * O DESENHO ESQUEMATICO DO CIRCUITO                                        *
+ * ======================================================================== */
+
+// O circuito eh desenhado em colunas, pelo nivel logico (Circuito::calcularNiveis):
+// as entradas do circuito na coluna 0, cada porta na coluna do seu nivel e as saidas
+// do circuito na ultima coluna. Cada no (entrada, porta ou saida) ocupa uma linha da
+// sua coluna, com posicao fixa: a posicao de qualquer no eh calculada em O(1) e os
+// nos de um retangulo visivel sao encontrados diretamente, sem percorrer o circuito.
+//
+// A cena tem um item por coluna (ItemColuna), e nao um por porta, e um item para as
+// ligacoes entre cada par de colunas (ItemLigacoes): com dezenas de milhares de portas,
+// a cena continua com poucos itens, que o indice espacial da QGraphicsScene (arvore BSP)
+// descarta rapidamente quando estao fora da tela. O retangulo de cada item contem apenas
+// o que ele desenha (a coluna, ou a faixa entre as duas colunas), e cada item desenha
+// apenas o que passa pela regiao exposta, com nivel de detalhe conforme o zoom:
+// - zoom muito pequeno: a coluna inteira como um bloco, com o numero de portas
+// - zoom pequeno: cada porta como um retangulo, sem texto e sem ligacoes
+// - zoom normal: portas com nome e id, e as ligacoes que cruzam a regiao visivel
+//
+// Com o mouse sobre uma porta, os seus cones de entrada (as portas das quais ela
+// depende) e de saida (as portas e saidas que dependem dela) sao destacados.
+
+// Os dados do desenho, compartilhados pelos itens das colunas e pela view
+// Os nos sao numerados: entradas do circuito de 0 a Nin-1, portas de Nin a Nin+Nports-1
+// e saidas do circuito de Nin+Nports a Nin+Nports+Nout-1
+struct DadosEsquematico
+{
+  unsigned Nin, Nports, Nout;
+  // Coluna e linha de cada no
+  std::vector<unsigned> coluna;
+  std::vector<unsigned> linha;
+  // Os nos de cada coluna, na ordem das linhas
+  std::vector<std::vector<unsigned> > colunas;
+  // Origens das entradas de cada no (indices de no), em formato compacto:
+  // as origens do no k ficam em origens[inicioOrigens[k]] ... origens[inicioOrigens[k+1]-1]
+  std::vector<unsigned> inicioOrigens;
+  std::vector<unsigned> origens;
+  // O mesmo, no sentido inverso: os nos que usam o no k
+  std::vector<unsigned> inicioDestinos;
+  std::vector<unsigned> destinos;
+  // O tipo (AN, OR, ...) de cada porta
+  std::vector<std::string> tipos;
+
+  // Destaque de cada no (ver os valores em esquematico.cpp) e o no sob o mouse
+  std::vector<unsigned char> destaque;
+  int noDestacado;
+  // Numero de nos nos cones de entrada e de saida do no destacado
+  unsigned numConeEntrada, numConeSaida;
+
+  DadosEsquematico();
+  // Monta o desenho do circuito C (que deve ser valido)
+  void montar(const Circuito& C);
+  // Nome exibido para o no k: E1, 12) AN, S3, ...
+  std::string nome(unsigned k) const;
+  // Destaca os cones de entrada e de saida do no k (ou apaga o destaque, se k<0)
+  void destacar(int k);
+};
+
+// Uma coluna do esquematico (um nivel logico)
+class ItemColuna : public QGraphicsItem
+{
+public:
+  ItemColuna(const DadosEsquematico& Dados, unsigned Coluna);
+
+  QRectF boundingRect() const override;
+  void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+             QWidget *widget) override;
+
+private:
+  const DadosEsquematico& D;
+  unsigned col;
+  // Retangulo que contem os nos da coluna
+  QRectF limites;
+};
+
+// As ligacoes das saidas dos nos de uma coluna (origem) para as entradas dos nos de
+// outra (destino; anterior ou a mesma, em lacos), desenhadas abaixo das colunas
+class ItemLigacoes : public QGraphicsItem
+{
+public:
+  // Ligacoes: os pares (no de origem, no de destino)
+  ItemLigacoes(const DadosEsquematico& Dados, unsigned ColOrigem, unsigned ColDestino,
+               std::vector<std::pair<unsigned,unsigned> >&& Ligacoes);
+
+  QRectF boundingRect() const override;
+  void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+             QWidget *widget) override;
+
+private:
+  const DadosEsquematico& D;
+  // As abscissas das pontas de todas as ligacoes (saida da origem e entrada do destino)
+  qreal x0, x1;
+  std::vector<std::pair<unsigned,unsigned> > ligacoes;
+  // Retangulo que contem todas as ligacoes do item
+  QRectF limites;
+};
+
+// A view do esquematico: zoom com a roda do mouse, arrastar para mover
+// e destaque dos cones da porta sob o mouse
+class VistaEsquematico : public QGraphicsView
+{
+  Q_OBJECT
+
+public:
+  explicit VistaEsquematico(QWidget *parent = 0);
+
+  // Passa a exibir o circuito C (os dados sao copiados: C pode ser alterado depois)
+  void setCircuito(const Circuito& C);
+
+signals:
+  // O no sob o mouse mudou (texto vazio se nenhum)
+  void signNoSobMouse(QString descricao);
+
+protected:
+  void wheelEvent(QWheelEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+  QGraphicsScene *cena;
+  DadosEsquematico dados;
+
+  // O no na posicao p da cena, ou -1 se nenhum
+  int noEm(const QPointF& p) const;
+};
+
+// A janela (nao modal) que exibe o esquematico
+class JanelaEsquematico : public QDialog
+{
+  Q_OBJECT
+
+public:
+  explicit JanelaEsquematico(QWidget *parent = 0);
+
+  // Passa a exibir o circuito C (ou uma mensagem, se C nao for valido)
+  void setCircuito(const Circuito& C);
+
+private:
+  VistaEsquematico *vista;
+  QLabel *legenda;
+};
+
+#endif // ESQUEMATICO_H
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <iomanip>
+#include "estatisticas.h"
+
+#ifdef CIRCUITO_ESTATISTICAS
+const bool SimStats::ATIVAS = true;
+#else
+const bool SimStats::ATIVAS = false;
+#endif
+
+// As siglas dos tipos, na ordem dos indices (a mesma de simuladorincremental.cpp)
+static const char* nomesTipos[SimStats::NUM_TIPOS] = {"NT", "AN", "NA", "OR", "NO", "XO", "NX", "DF"};
+static const char* nomesFases[SimStats::NUM_FASES] = {"inicializacao", "avaliacao", "saidas"};
+
+///
+/// ESTRUTURA SIMSTATS
+///
+
+SimStats::SimStats()
+{
+  zerar();
+}
+
+void SimStats::zerar()
+{
+  vetores = passadas = maxPassadas = avaliacoes = 0;
+  definidas = resolucoes = indefinidas = 0;
+  std::fill(avaliacoesTipo, avaliacoesTipo+NUM_TIPOS, 0);
+  std::fill(nanossegundos, nanossegundos+NUM_FASES, 0);
+}
+
+SimStats& SimStats::operator+=(const SimStats& S)
+{
+  vetores += S.vetores;
+  passadas += S.passadas;
+  maxPassadas = std::max(maxPassadas, S.maxPassadas);
+  avaliacoes += S.avaliacoes;
+  for (unsigned t=0; t<NUM_TIPOS; t++) avaliacoesTipo[t] += S.avaliacoesTipo[t];
+  definidas += S.definidas;
+  resolucoes += S.resolucoes;
+  indefinidas += S.indefinidas;
+  for (unsigned f=0; f<NUM_FASES; f++) nanossegundos[f] += S.nanossegundos[f];
+  return *this;
+}
+
+unsigned SimStats::indiceTipo(const std::string& nome)
+{
+  for (unsigned t=0; t<NUM_TIPOS; t++) if (nome==nomesTipos[t]) return t;
+  return NUM_TIPOS;
+}
+
+const char* SimStats::nomeTipo(unsigned t)
+{
+  return (t<NUM_TIPOS ? nomesTipos[t] : "??");
+}
+
+const char* SimStats::nomeFase(unsigned f)
+{
+  return (f<NUM_FASES ? nomesFases[f] : "??");
+}
+
+void SimStats::marcarFase(Fase f, std::chrono::steady_clock::time_point& inicio)
+{
+  std::chrono::steady_clock::time_point agora = std::chrono::steady_clock::now();
+  nanossegundos[f] += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(agora-inicio).count());
+  inicio = agora;
+}
+
+std::ostream& SimStats::imprimir(std::ostream& O) const
+{
+  if (!ATIVAS)
+  {
+    O << "Estatisticas nao disponiveis: o nucleo nao foi compilado com CIRCUITO_ESTATISTICAS"
+         " (qmake CONFIG+=estatisticas)\n";
+    return O;
+  }
+  // Media por vetor
+  double V = (vetores>0 ? double(vetores) : 1.0);
+  std::ios::fmtflags formato = O.flags();
+  std::streamsize precisao = O.precision();
+  O << std::fixed << std::setprecision(2);
+  O << "Vetores simulados: " << vetores << '\n'
+    << "Passadas: " << passadas << " (" << passadas/V << " por vetor, maximo " << maxPassadas << ")\n"
+    << "Avaliacoes de portas: " << avaliacoes << " (" << avaliacoes/V << " por vetor)\n";
+  for (unsigned t=0; t<NUM_TIPOS; t++)
+  {
+    if (avaliacoesTipo[t]>0) O << "  " << nomeTipo(t) << ": " << avaliacoesTipo[t] << '\n';
+  }
+  O << "Avaliacoes com resultado definido: " << definidas << '\n'
+    << "UNDEF resolvidos em passadas seguintes: " << resolucoes << '\n'
+    << "Portas UNDEF no fim da simulacao: " << indefinidas << " (" << indefinidas/V << " por vetor)\n"
+    << "Tempo por fase:\n";
+  for (unsigned f=0; f<NUM_FASES; f++)
+  {
+    O << "  " << nomeFase(f) << ": " << nanossegundos[f]/1e6 << " ms ("
+      << nanossegundos[f]/V << " ns por vetor)\n";
+  }
+  O.flags(formato);
+  O.precision(precisao);
+  return O;
+}
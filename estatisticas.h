@@ -0,0 +1,102 @@
+#ifndef _ESTATISTICAS_H_
+#define _ESTATISTICAS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/// ###########################################################################
+/// CONTADORES DE DESEMPENHO DA SIMULACAO
+/// Os contadores soh sao atualizados se o nucleo for compilado com a macro
+/// CIRCUITO_ESTATISTICAS (qmake CONFIG+=estatisticas, ver nucleo.pri); sem ela, o
+/// codigo de contagem nao eh compilado e a simulacao nao fica nem um pouco mais lenta.
+/// A estrutura e as funcoes de consulta existem sempre (os contadores ficam em zero),
+/// para que a interface e as ferramentas nao dependam da macro.
+/// ###########################################################################
+
+// Executa o comando apenas se as estatisticas estiverem ativas
+#ifdef CIRCUITO_ESTATISTICAS
+#define ESTATISTICA(comando) comando
+#else
+#define ESTATISTICA(comando)
+#endif
+
+///
+/// ESTRUTURA SIMSTATS
+///
+
+// Os contadores de uma simulacao (Circuito::simular ou SimuladorIncremental),
+// acumulados desde a criacao do simulador ou desde o ultimo zerar()
+struct SimStats {
+  // true se o nucleo foi compilado com CIRCUITO_ESTATISTICAS
+  static const bool ATIVAS;
+
+  // As fases de uma simulacao: as portas voltam a UNDEF, as portas sao avaliadas
+  // (todas as passadas) e as saidas do circuito sao copiadas
+  enum Fase {INICIALIZACAO, AVALIACAO, SAIDAS, NUM_FASES};
+  // Os tipos de porta: NT, AN, NA, OR, NO, XO, NX, DF (ver nomeTipo)
+  static const unsigned NUM_TIPOS = 8;
+
+  // Vetores simulados (no SimuladorIncremental, tambem cada entrada alterada)
+  uint64_t vetores;
+  // Passadas pela lista de portas: soma de todos os vetores e maior numero em um vetor
+  // (mais de uma passada por vetor soh com lacos ou portas fora de ordem)
+  uint64_t passadas;
+  uint64_t maxPassadas;
+  // Avaliacoes de portas, no total e por tipo de porta
+  uint64_t avaliacoes;
+  uint64_t avaliacoesTipo[NUM_TIPOS];
+  // Avaliacoes que resultaram em F ou T, e quantas delas resolveram, a partir da
+  // segunda passada, uma porta que tinha ficado UNDEF na passada anterior
+  uint64_t definidas;
+  uint64_t resolucoes;
+  // Portas que terminaram a simulacao de um vetor em UNDEF (soma de todos os vetores)
+  uint64_t indefinidas;
+  // Tempo gasto em cada fase, em nanossegundos
+  uint64_t nanossegundos[NUM_FASES];
+
+  SimStats();
+
+  // Zera todos os contadores
+  void zerar();
+
+  // Acumula os contadores de S (por exemplo, de simuladores em threads diferentes)
+  SimStats& operator+=(const SimStats& S);
+
+  // Indice do tipo de porta de sigla nome (Port::getName); NUM_TIPOS se invalido
+  static unsigned indiceTipo(const std::string& nome);
+  // Sigla do tipo de porta de indice t e nome da fase f
+  static const char* nomeTipo(unsigned t);
+  static const char* nomeFase(unsigned f);
+
+  // Conta uma avaliacao de porta do tipo t (indiceTipo), feita na passada indicada
+  // (a partir de 1), com resultado definido (F ou T) ou nao
+  void contarAvaliacao(unsigned t, bool definida, uint64_t passada)
+  {
+    avaliacoes++;
+    if (t<NUM_TIPOS) avaliacoesTipo[t]++;
+    if (definida)
+    {
+      definidas++;
+      if (passada>1) resolucoes++;
+    }
+  }
+  // Conta o fim da simulacao de um vetor, com numPassadas passadas e numIndefinidas
+  // portas em UNDEF
+  void contarVetor(uint64_t numPassadas, uint64_t numIndefinidas)
+  {
+    vetores++;
+    passadas += numPassadas;
+    if (numPassadas>maxPassadas) maxPassadas = numPassadas;
+    indefinidas += numIndefinidas;
+  }
+
+  // Acrescenta aa fase f o tempo decorrido desde inicio, e passa inicio para agora
+  void marcarFase(Fase f, std::chrono::steady_clock::time_point& inicio);
+
+  // Imprime os contadores, em texto, com as medias por vetor
+  std::ostream& imprimir(std::ostream& O=std::cout) const;
+};
+
+#endif // _ESTATISTICAS_H_
@@ -0,0 +1,13 @@
+# Configuracao comum das ferramentas de linha de comando: aplicacoes de console,
+# sem Qt, ligadas aa biblioteca do nucleo (nucleo/nucleo.pro)
+
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += $$PWD
+LIBS += -L$$OUT_PWD/../lib -lnucleo
+
+# Religa a ferramenta quando a biblioteca mudar
+win32-msvc*: PRE_TARGETDEPS += $$OUT_PWD/../lib/nucleo.lib
+else: PRE_TARGETDEPS += $$OUT_PWD/../lib/libnucleo.a
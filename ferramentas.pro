@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# As ferramentas de linha de comando, que nao dependem do Qt nem de uma tela:
+# a biblioteca do nucleo e os programas construidos sobre ela
+#   qmake ferramentas.pro && make
+# A aplicacao grafica continua sendo construida por Circuito.pro
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = nucleo circsim circbench circgen circdiff circequiv circbdd
+
+circsim.depends = nucleo
+circbench.depends = nucleo
+circgen.depends = nucleo
+circdiff.depends = nucleo
+circequiv.depends = nucleo
+circbdd.depends = nucleo
@@ -0,0 +1,298 @@
+#include <cctype>
+#include "filtrotabela.h"
+#include "tabelaverdade.h"
+#include "simuladorlote.h"
+
+///
+/// CLASSE FILTROTABELA
+///
+
+// Tamanho dos arrays locais usados por aceita
+static const unsigned MAX_ENTRADAS_FILTRO = 41;
+static const unsigned MAX_PILHA_LOCAL = 64;
+
+FiltroTabela::FiltroTabela():Nin(0),Nout(0),programa(),usaEntradas(false),maxPilha(0)
+{
+}
+
+// Funcao auxiliar: pula os espacos do texto
+static void pularEspacosFiltro(const std::string& T, size_t& pos)
+{
+  while (pos<T.size() && isspace((unsigned char)T[pos])) pos++;
+}
+
+// Funcao auxiliar: mensagem de erro com a coluna (a partir de 1)
+static bool erroFiltro(size_t pos, const std::string& esperado, std::string& erro)
+{
+  erro = "coluna "+std::to_string(pos+1)+": esperado "+esperado;
+  return false;
+}
+
+bool FiltroTabela::compilar(const std::string& texto, unsigned NI, unsigned NO, std::string& erro)
+{
+  Nin = NI;
+  Nout = NO;
+  programa.clear();
+  if (NI>=MAX_ENTRADAS_FILTRO) return erroFiltro(0, "circuito com menos de 41 entradas", erro);
+  usaEntradas = false;
+  maxPilha = 0;
+  erro.clear();
+
+  size_t pos=0;
+  pularEspacosFiltro(texto, pos);
+  // Expressao vazia: aceita tudo
+  if (pos>=texto.size()) return true;
+  if (!compilarOu(texto, pos, erro) ||
+      (pos<texto.size() && !erroFiltro(pos, "& ou | ou fim da expressao", erro)))
+  {
+    programa.clear();
+    return false;
+  }
+
+  // Calcula a profundidade maxima da pilha de avaliacao
+  unsigned prof=0;
+  for (unsigned i=0; i<programa.size(); i++)
+  {
+    switch (programa[i].op)
+    {
+    case Op::E:
+    case Op::OU:
+      prof--;
+      break;
+    case Op::NAO:
+      break;
+    default:
+      prof++;
+      if (prof>maxPilha) maxPilha = prof;
+    }
+  }
+  return true;
+}
+
+// ou := e ('|' e)*
+bool FiltroTabela::compilarOu(const std::string& T, size_t& pos, std::string& erro)
+{
+  if (!compilarE(T, pos, erro)) return false;
+  pularEspacosFiltro(T, pos);
+  while (pos<T.size() && T[pos]=='|')
+  {
+    pos++;
+    if (!compilarE(T, pos, erro)) return false;
+    programa.push_back(Instrucao{Op::OU, bool3S::UNDEF, 0});
+    pularEspacosFiltro(T, pos);
+  }
+  return true;
+}
+
+// e := fator ('&' fator)*
+bool FiltroTabela::compilarE(const std::string& T, size_t& pos, std::string& erro)
+{
+  if (!compilarFator(T, pos, erro)) return false;
+  pularEspacosFiltro(T, pos);
+  while (pos<T.size() && T[pos]=='&')
+  {
+    pos++;
+    if (!compilarFator(T, pos, erro)) return false;
+    programa.push_back(Instrucao{Op::E, bool3S::UNDEF, 0});
+    pularEspacosFiltro(T, pos);
+  }
+  return true;
+}
+
+// fator := '!' fator | '(' ou ')' | ('E'|'S') (id|'*') ('='|'!=') ('T'|'F'|'?')
+bool FiltroTabela::compilarFator(const std::string& T, size_t& pos, std::string& erro)
+{
+  pularEspacosFiltro(T, pos);
+  if (pos>=T.size()) return erroFiltro(pos, "uma condicao (ex.: S1=T)", erro);
+
+  if (T[pos]=='!')
+  {
+    pos++;
+    if (!compilarFator(T, pos, erro)) return false;
+    programa.push_back(Instrucao{Op::NAO, bool3S::UNDEF, 0});
+    return true;
+  }
+  if (T[pos]=='(')
+  {
+    pos++;
+    if (!compilarOu(T, pos, erro)) return false;
+    pularEspacosFiltro(T, pos);
+    if (pos>=T.size() || T[pos]!=')') return erroFiltro(pos, ")", erro);
+    pos++;
+    return true;
+  }
+
+  // Condicao: E ou S
+  char c = toupper((unsigned char)T[pos]);
+  if (c!='E' && c!='S') return erroFiltro(pos, "E ou S", erro);
+  bool saida = (c=='S');
+  unsigned limite = (saida ? Nout : Nin);
+  pos++;
+
+  // Id (ou * = qualquer uma)
+  Instrucao I{Op::ENTRADA, bool3S::UNDEF, 0};
+  size_t inicio = pos;
+  if (pos<T.size() && T[pos]=='*')
+  {
+    I.op = (saida ? Op::ALGUMA_SAIDA : Op::ALGUMA_ENTRADA);
+    pos++;
+  }
+  else
+  {
+    unsigned long id=0;
+    while (pos<T.size() && isdigit((unsigned char)T[pos]) && id<=limite)
+    {
+      id = 10*id + (T[pos]-'0');
+      pos++;
+    }
+    if (pos==inicio) return erroFiltro(pos, "id ou *", erro);
+    if (id<1 || id>limite)
+    {
+      return erroFiltro(inicio, (saida ? "id de saida" : "id de entrada")+
+                        std::string(" entre 1 e ")+std::to_string(limite), erro);
+    }
+    I.op = (saida ? Op::SAIDA : Op::ENTRADA);
+    I.indice = unsigned(id-1);
+  }
+
+  // Comparacao: = ou !=
+  pularEspacosFiltro(T, pos);
+  bool diferente=false;
+  if (pos<T.size() && T[pos]=='!')
+  {
+    diferente = true;
+    pos++;
+  }
+  if (pos>=T.size() || T[pos]!='=') return erroFiltro(pos, "= ou !=", erro);
+  pos++;
+
+  // Valor
+  pularEspacosFiltro(T, pos);
+  if (pos>=T.size()) return erroFiltro(pos, "T, F ou ?", erro);
+  c = toupper((unsigned char)T[pos]);
+  if (c=='T') I.valor = bool3S::TRUE;
+  else if (c=='F') I.valor = bool3S::FALSE;
+  else if (c=='?') I.valor = bool3S::UNDEF;
+  else return erroFiltro(pos, "T, F ou ?", erro);
+  pos++;
+
+  if (I.op==Op::ENTRADA || I.op==Op::ALGUMA_ENTRADA) usaEntradas = true;
+  programa.push_back(I);
+  if (diferente) programa.push_back(Instrucao{Op::NAO, bool3S::UNDEF, 0});
+  return true;
+}
+
+bool FiltroTabela::vazio() const
+{
+  return programa.empty();
+}
+
+bool FiltroTabela::aceita(uint64_t L, const uint8_t* linha) const
+{
+  if (programa.empty()) return true;
+
+  // As entradas soh sao calculadas se algum termo as usa
+  // Como o numero da linha cabe em 64 bits, ha no maximo 40 entradas (3^41 > 2^64)
+  // Os arrays sao locais, sem alocacao: aceita eh chamada para cada linha, e pode ser
+  // chamada de varias threads ao mesmo tempo
+  bool3S entradas[MAX_ENTRADAS_FILTRO];
+  if (usaEntradas)
+  {
+    for (unsigned j=Nin; j>0; j--)
+    {
+      entradas[j-1] = bool3S(L%3);
+      L /= 3;
+    }
+  }
+  // A pilha de avaliacao (soh eh alocada se a expressao for muito profunda)
+  uint8_t pilhaLocal[MAX_PILHA_LOCAL];
+  std::vector<uint8_t> pilhaGrande;
+  uint8_t* pilha = pilhaLocal;
+  if (maxPilha>MAX_PILHA_LOCAL)
+  {
+    pilhaGrande.resize(maxPilha);
+    pilha = pilhaGrande.data();
+  }
+  unsigned topo=0;
+  bool x;
+
+  for (unsigned i=0; i<programa.size(); i++)
+  {
+    const Instrucao& I = programa[i];
+    switch (I.op)
+    {
+    case Op::ENTRADA:
+      pilha[topo++] = (entradas[I.indice]==I.valor);
+      break;
+    case Op::SAIDA:
+      pilha[topo++] = (lerValor(linha, I.indice)==I.valor);
+      break;
+    case Op::ALGUMA_ENTRADA:
+      x = false;
+      for (unsigned j=0; !x && j<Nin; j++) x = (entradas[j]==I.valor);
+      pilha[topo++] = x;
+      break;
+    case Op::ALGUMA_SAIDA:
+      x = false;
+      for (unsigned j=0; !x && j<Nout; j++) x = (lerValor(linha, j)==I.valor);
+      pilha[topo++] = x;
+      break;
+    case Op::NAO:
+      pilha[topo-1] = !pilha[topo-1];
+      break;
+    case Op::E:
+      topo--;
+      pilha[topo-1] = (pilha[topo-1] && pilha[topo]);
+      break;
+    case Op::OU:
+      topo--;
+      pilha[topo-1] = (pilha[topo-1] || pilha[topo]);
+      break;
+    }
+  }
+  return (pilha[0]!=0);
+}
+
+///
+/// Filtragem de linhas
+///
+
+void filtrarTabela(const FiltroTabela& F, const TabelaVerdade& T, uint64_t L0, uint64_t N,
+                   std::vector<uint64_t>& linhas, std::vector<uint8_t>& valores)
+{
+  unsigned bl = bytesPorLinha(T.getNumOutputs());
+  for (uint64_t L=L0; L<L0+N; L++)
+  {
+    const uint8_t* p = T.linha(L);
+    if (p==nullptr) break;
+    if (F.aceita(L, p))
+    {
+      linhas.push_back(L);
+      valores.insert(valores.end(), p, p+bl);
+    }
+  }
+}
+
+bool filtrarSimulando(const FiltroTabela& F, SimuladorLote& S, uint64_t L0, uint64_t N,
+                      std::vector<uint64_t>& linhas, std::vector<uint8_t>& valores)
+{
+  // Simula em blocos pequenos, filtrando cada bloco
+  const uint64_t LINHAS_BLOCO = 256;
+  unsigned bl = bytesPorLinha(S.getNumOutputs());
+  std::vector<uint8_t> bloco(LINHAS_BLOCO*bl);
+  for (uint64_t L=L0; L<L0+N; L+=LINHAS_BLOCO)
+  {
+    uint64_t n = (L0+N-L<LINHAS_BLOCO ? L0+N-L : LINHAS_BLOCO);
+    if (!simularLinhas(S, L, n, bloco.data())) return false;
+    for (uint64_t k=0; k<n; k++)
+    {
+      const uint8_t* p = bloco.data() + k*bl;
+      if (F.aceita(L+k, p))
+      {
+        linhas.push_back(L+k);
+        valores.insert(valores.end(), p, p+bl);
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,86 @@
+#ifndef _FILTROTABELA_H_
+#define _FILTROTABELA_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+
+class TabelaVerdade;
+class SimuladorLote;
+
+///
+/// CLASSE FILTROTABELA
+///
+
+// Um filtro para as linhas de uma tabela verdade, escrito como uma expressao:
+//   S2=?            a saida 2 vale ?
+//   E1!=F           a entrada 1 nao vale F
+//   S*=?            alguma saida vale ? (E* = alguma entrada)
+//   S1=T & S3!=F    e logico (& tem precedencia sobre |)
+//   S1=T | !(E2=?)  ou logico, negacao e parenteses
+// Os valores sao T, F e ? (maiusculas ou minusculas); ids a partir de 1.
+// A expressao eh compilada uma vez em um pequeno programa (notacao posfixa),
+// que eh avaliado para cada linha diretamente sobre a linha empacotada
+// (ver o layout em tabelaverdade.h), sem converter a linha para bool3S.
+// Um filtro vazio aceita todas as linhas.
+class FiltroTabela {
+private:
+  // As instrucoes do programa
+  enum class Op : uint8_t {
+    ENTRADA,        // empilha (entrada[indice] == valor)
+    SAIDA,          // empilha (saida[indice] == valor)
+    ALGUMA_ENTRADA, // empilha (alguma entrada == valor)
+    ALGUMA_SAIDA,   // empilha (alguma saida == valor)
+    NAO,            // desempilha x, empilha !x
+    E,              // desempilha x, y, empilha x && y
+    OU              // desempilha x, y, empilha x || y
+  };
+  struct Instrucao {
+    Op op;
+    bool3S valor;
+    unsigned indice;
+  };
+
+  unsigned Nin;
+  unsigned Nout;
+  std::vector<Instrucao> programa;
+  // Se alguma instrucao consulta as entradas (que sao calculadas a partir do numero da linha)
+  bool usaEntradas;
+  // Tamanho maximo da pilha de avaliacao
+  unsigned maxPilha;
+
+  // O analisador (descendente recursivo); pos avanca sobre o texto
+  // Retornam false e preenchem erro em caso de erro de sintaxe
+  bool compilarOu(const std::string& T, size_t& pos, std::string& erro);
+  bool compilarE(const std::string& T, size_t& pos, std::string& erro);
+  bool compilarFator(const std::string& T, size_t& pos, std::string& erro);
+
+public:
+  FiltroTabela();
+
+  // Compila a expressao texto para uma tabela com NI entradas e NO saidas
+  // Retorna true se deu tudo OK; false se a expressao for invalida, com a
+  // descricao do problema (e a coluna onde ocorreu) em erro
+  bool compilar(const std::string& texto, unsigned NI, unsigned NO, std::string& erro);
+
+  // Retorna true se o filtro aceita todas as linhas (expressao vazia)
+  bool vazio() const;
+
+  // Avalia o filtro para a linha L, cujas saidas empacotadas estao em linha
+  bool aceita(uint64_t L, const uint8_t* linha) const;
+};
+
+// Filtra as N linhas da tabela T a partir da linha L0 (que devem estar armazenadas),
+// acrescentando o numero e as saidas empacotadas de cada linha aceita em linhas e valores
+void filtrarTabela(const FiltroTabela& F, const TabelaVerdade& T, uint64_t L0, uint64_t N,
+                   std::vector<uint64_t>& linhas, std::vector<uint8_t>& valores);
+
+// O mesmo, mas simulando as linhas com o simulador S (montado para o circuito, ver
+// simuladorlote.h) em vez de le-las de uma tabela (para tabelas que nao foram geradas
+// ou que nao cabem em memoria)
+// Retorna true se deu tudo OK; false se deu erro na simulacao
+bool filtrarSimulando(const FiltroTabela& F, SimuladorLote& S, uint64_t L0, uint64_t N,
+                      std::vector<uint64_t>& linhas, std::vector<uint8_t>& valores);
+
+#endif // _FILTROTABELA_H_
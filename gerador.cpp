@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <vector>
+#include "gerador.h"
+#include "circuito.h"
+
+// Maior numero de bits dos somadores e do multiplicador e de entradas da arvore de
+// paridade (as ids das entradas e das portas tem que caber em um int)
+static const unsigned MAX_BITS = 1u<<20;
+static const unsigned MAX_BITS_MULTIPLICADOR = 1u<<12;
+
+///
+/// CLASSE GERADORALEATORIO
+///
+
+GeradorAleatorio::GeradorAleatorio(uint64_t Semente): estado(Semente)
+{
+}
+
+uint64_t GeradorAleatorio::proximo()
+{
+  uint64_t z = (estado += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z>>30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z>>27)) * 0x94D049BB133111EBULL;
+  return z ^ (z>>31);
+}
+
+unsigned GeradorAleatorio::sortear(unsigned N)
+{
+  // Multiplicacao em vez de resto: sem divisao e sem favorecer os numeros pequenos
+  // (o vies que sobra, para N<2^32, eh desprezivel)
+  return unsigned(((proximo()>>32) * uint64_t(N)) >> 32);
+}
+
+///
+/// MONTAGEM DOS CIRCUITOS
+///
+
+// Um circuito em construcao, porta a porta: o numero de portas soh eh conhecido no
+// fim, quando o Circuito eh criado de uma vez (montar)
+struct Montagem {
+  unsigned Nin;
+  std::vector<const char*> tipos;
+  std::vector<std::vector<int> > origens;
+  std::vector<int> saidas;
+
+  explicit Montagem(unsigned NI): Nin(NI), tipos(), origens(), saidas() {}
+
+  // Acrescenta uma porta e retorna a sua id
+  int porta(const char* tipo, const std::vector<int>& orig)
+  {
+    tipos.push_back(tipo);
+    origens.push_back(orig);
+    return int(tipos.size());
+  }
+
+  // Porta AN ou OR das origens; com uma soh origem, retorna a propria origem
+  int e(const std::vector<int>& orig)
+  {
+    return (orig.size()==1 ? orig[0] : porta("AN", orig));
+  }
+  int ou(const std::vector<int>& orig)
+  {
+    return (orig.size()==1 ? orig[0] : porta("OR", orig));
+  }
+
+  // Soma de ateh tres bits (uma origem igual a 0 eh um bit ausente): s e c recebem
+  // a soma e o vai-um (0 se nao houver vai-um)
+  void somar(int x, int y, int z, int& s, int& c)
+  {
+    std::vector<int> bits;
+    if (x!=0) bits.push_back(x);
+    if (y!=0) bits.push_back(y);
+    if (z!=0) bits.push_back(z);
+    c = 0;
+    if (bits.size()==1) s = bits[0];
+    else if (bits.size()==2)
+    {
+      s = porta("XO", bits);
+      c = porta("AN", bits);
+    }
+    else
+    {
+      int p = porta("XO", {bits[0], bits[1]});
+      s = porta("XO", {p, bits[2]});
+      c = porta("OR", {porta("AN", {bits[0], bits[1]}), porta("AN", {p, bits[2]})});
+    }
+  }
+
+  // Cria em C o circuito montado
+  void montar(Circuito& C) const
+  {
+    Circuito novo;
+    novo.resize(Nin, unsigned(saidas.size()), unsigned(tipos.size()));
+    for (unsigned i=0; i<tipos.size(); i++)
+    {
+      int idPort = int(i+1);
+      novo.setPort(idPort, tipos[i], unsigned(origens[i].size()));
+      for (unsigned j=0; j<origens[i].size(); j++) novo.setId_inPort(idPort, j, origens[i][j]);
+    }
+    for (unsigned j=0; j<saidas.size(); j++) novo.setIdOutput(int(j+1), saidas[j]);
+    C.swap(novo);
+  }
+};
+
+///
+/// CIRCUITOS SINTETICOS
+///
+
+ParametrosGerador::ParametrosGerador():
+  numInputs(16), numOutputs(16), numPorts(1000), profundidade(10), minEntradasPorta(2),
+  maxEntradasPorta(4), maxFanout(0), numLacos(0), semente(1)
+{
+}
+
+bool gerarCircuito(Circuito& C, const ParametrosGerador& P)
+{
+  if (P.numInputs==0 || P.numOutputs==0 || P.numPorts==0 ||
+      P.numInputs>=MAX_BITS || P.numPorts>=(1u<<30) ||
+      P.profundidade==0 || P.profundidade>P.numPorts ||
+      P.minEntradasPorta<2 || P.minEntradasPorta>P.maxEntradasPorta || P.maxEntradasPorta>4)
+  {
+    return false;
+  }
+  static const char* tipos[] = {"AN", "NA", "OR", "NO", "XO", "NX"};
+  GeradorAleatorio G(P.semente);
+  Montagem M(P.numInputs);
+  M.tipos.reserve(P.numPorts);
+  M.origens.reserve(P.numPorts);
+
+  // Numero de portas que usam cada sinal (entradas de 0 a NI-1, portas de NI em diante)
+  std::vector<unsigned> uso(P.numInputs+P.numPorts, 0);
+  // As portas do nivel anterior ao atual tem ids de iniAnterior+1 a fimAnterior
+  unsigned iniAnterior = 0, fimAnterior = 0;
+  // Sorteia uma origem do nivel anterior (as entradas, no primeiro nivel) ou entre
+  // as entradas e todas as portas dos niveis anteriores, tentando respeitar o fan-out
+  auto sortearOrigem = [&](bool doAnterior) -> int
+  {
+    int id = 0;
+    for (unsigned tentativa=0; tentativa<8; tentativa++)
+    {
+      if (doAnterior && fimAnterior>0) id = int(iniAnterior + G.sortear(fimAnterior-iniAnterior) + 1);
+      else if (doAnterior) id = -int(G.sortear(P.numInputs)+1);
+      else
+      {
+        unsigned k = G.sortear(P.numInputs+fimAnterior);
+        id = (k<P.numInputs ? -int(k+1) : int(k-P.numInputs+1));
+      }
+      unsigned s = (id<0 ? unsigned(-id-1) : P.numInputs+unsigned(id-1));
+      if (P.maxFanout==0 || uso[s]<P.maxFanout || tentativa==7)
+      {
+        uso[s]++;
+        break;
+      }
+    }
+    return id;
+  };
+
+  unsigned base = P.numPorts/P.profundidade, resto = P.numPorts%P.profundidade;
+  for (unsigned n=0; n<P.profundidade; n++)
+  {
+    unsigned numNivel = base + (n<resto ? 1 : 0);
+    for (unsigned k=0; k<numNivel; k++)
+    {
+      // 1 em cada 8 portas eh NT
+      if (G.sortear(8)==0)
+      {
+        M.porta("NT", {sortearOrigem(true)});
+        continue;
+      }
+      unsigned NIn = P.minEntradasPorta + G.sortear(P.maxEntradasPorta-P.minEntradasPorta+1);
+      std::vector<int> orig(1, sortearOrigem(true));
+      for (unsigned j=1; j<NIn; j++) orig.push_back(sortearOrigem(G.sortear(2)==0));
+      M.porta(tipos[G.sortear(6)], orig);
+    }
+    iniAnterior = fimAnterior;
+    fimAnterior += numNivel;
+  }
+
+  // Lacos: a partir de uma porta Y, volta pelas primeiras entradas ateh uma porta X
+  // com mais de uma entrada, e liga Y a uma das outras entradas de X. Como as
+  // primeiras entradas nunca sao alteradas, um laco nao desfaz os anteriores
+  unsigned criados = 0;
+  for (unsigned tentativa=0; criados<P.numLacos && tentativa<8*P.numLacos; tentativa++)
+  {
+    int Y = int(G.sortear(P.numPorts)+1);
+    int X = Y;
+    for (unsigned passos=G.sortear(P.profundidade); passos>0 && M.origens[X-1][0]>0; passos--)
+    {
+      X = M.origens[X-1][0];
+    }
+    while (X>0 && M.origens[X-1].size()<2) X = M.origens[X-1][0];
+    if (X<0) continue;
+    // Uma entrada ligada a uma porta de id maior ou igual jah eh um laco
+    int& entrada = M.origens[X-1][1+G.sortear(unsigned(M.origens[X-1].size())-1)];
+    if (entrada>=X) continue;
+    entrada = Y;
+    criados++;
+  }
+
+  // Saidas: as ultimas portas, do fim para o comeco
+  for (unsigned j=0; j<P.numOutputs; j++) M.saidas.push_back(int(P.numPorts - j%P.numPorts));
+  M.montar(C);
+  return true;
+}
+
+bool gerarSomadorRipple(Circuito& C, unsigned N)
+{
+  if (N==0 || N>MAX_BITS) return false;
+  Montagem M(2*N+1);
+  int c = -int(2*N+1), s;
+  for (unsigned i=0; i<N; i++)
+  {
+    M.somar(-int(i+1), -int(N+i+1), c, s, c);
+    M.saidas.push_back(s);
+  }
+  M.saidas.push_back(c);
+  M.montar(C);
+  return true;
+}
+
+bool gerarSomadorCLA(Circuito& C, unsigned N)
+{
+  if (N==0 || N>MAX_BITS) return false;
+  Montagem M(2*N+1);
+  int c = -int(2*N+1);
+  for (unsigned ini=0; ini<N; ini+=4)
+  {
+    unsigned K = (N-ini<4 ? N-ini : 4);
+    // Geracao e propagacao de cada bit do bloco
+    std::vector<int> g(K), p(K);
+    for (unsigned i=0; i<K; i++)
+    {
+      int a = -int(ini+i+1), b = -int(N+ini+i+1);
+      g[i] = M.porta("AN", {a, b});
+      p[i] = M.porta("XO", {a, b});
+    }
+    // Vai-um do bit j do bloco: g(j-1) + p(j-1).g(j-2) + ... + p(j-1)...p(0).c
+    std::vector<int> vaiUm(1, c);
+    for (unsigned j=1; j<K; j++)
+    {
+      std::vector<int> termos;
+      for (unsigned m=0; m<=j; m++)
+      {
+        std::vector<int> fatores(p.begin()+(j-m), p.begin()+j);
+        fatores.push_back(m<j ? g[j-1-m] : c);
+        termos.push_back(M.e(fatores));
+      }
+      vaiUm.push_back(M.ou(termos));
+    }
+    for (unsigned i=0; i<K; i++) M.saidas.push_back(M.porta("XO", {p[i], vaiUm[i]}));
+    // Geracao e propagacao do bloco, e o vai-um para o proximo bloco
+    std::vector<int> termos;
+    for (unsigned m=0; m<K; m++)
+    {
+      std::vector<int> fatores(p.begin()+(K-m), p.end());
+      fatores.push_back(g[K-1-m]);
+      termos.push_back(M.e(fatores));
+    }
+    int GB = M.ou(termos), PB = M.e(p);
+    c = M.porta("OR", {GB, M.porta("AN", {PB, c})});
+  }
+  M.saidas.push_back(c);
+  M.montar(C);
+  return true;
+}
+
+bool gerarMultiplicador(Circuito& C, unsigned N)
+{
+  if (N<2 || N>MAX_BITS_MULTIPLICADOR) return false;
+  Montagem M(2*N);
+  // Soma acumulada, bit a bit (0 = bit ainda sem sinal)
+  std::vector<int> soma(2*N, 0);
+  for (unsigned i=0; i<N; i++)
+  {
+    int b = -int(N+i+1), vaiUm = 0;
+    for (unsigned j=0; j<N; j++)
+    {
+      int produto = M.porta("AN", {-int(j+1), b});
+      M.somar(soma[i+j], produto, vaiUm, soma[i+j], vaiUm);
+    }
+    soma[i+N] = vaiUm;
+  }
+  M.saidas = soma;
+  M.montar(C);
+  return true;
+}
+
+bool gerarParidade(Circuito& C, unsigned N, unsigned K)
+{
+  if (N<2 || N>MAX_BITS || K<2 || K>4) return false;
+  Montagem M(N);
+  std::vector<int> nivel, proximo;
+  for (unsigned i=0; i<N; i++) nivel.push_back(-int(i+1));
+  while (nivel.size()>1)
+  {
+    proximo.clear();
+    for (unsigned i=0; i<nivel.size(); i+=K)
+    {
+      std::vector<int> grupo(nivel.begin()+i, nivel.begin()+std::min<size_t>(i+K, nivel.size()));
+      proximo.push_back(grupo.size()==1 ? grupo[0] : M.porta("XO", grupo));
+    }
+    nivel.swap(proximo);
+  }
+  M.saidas.push_back(nivel[0]);
+  M.montar(C);
+  return true;
+}
+
+bool gerarContador(Circuito& C, unsigned N)
+{
+  if (N==0 || N>MAX_BITS) return false;
+  Montagem M(2);
+  // Os flip-flops primeiro, para que os bits do contador possam ser usados antes de
+  // existir a porta ligada aa entrada D (que eh acertada depois)
+  std::vector<int> q(N);
+  for (unsigned i=0; i<N; i++) q[i] = M.porta("DF", {-1});
+  int semReset = M.porta("NT", {-1});
+  // O bit i muda quando a habilitacao e todos os bits anteriores estao em T
+  int vaiUm = -2;
+  for (unsigned i=0; i<N; i++)
+  {
+    int soma = M.porta("XO", {q[i], vaiUm});
+    M.origens[q[i]-1][0] = M.porta("AN", {semReset, soma});
+    if (i+1<N) vaiUm = M.porta("AN", {vaiUm, q[i]});
+  }
+  M.saidas = q;
+  M.montar(C);
+  return true;
+}
+
+bool sortearAtrasos(Circuito& C, unsigned maxAtraso, uint64_t Semente)
+{
+  if (maxAtraso<1 || maxAtraso>Port::ATRASO_MAXIMO) return false;
+  GeradorAleatorio G(Semente);
+  for (unsigned i=0; i<C.getNumPorts(); i++) C.setAtrasoPort(int(i+1), 1+G.sortear(maxAtraso));
+  return true;
+}
@@ -0,0 +1,97 @@
+#ifndef _GERADOR_H_
+#define _GERADOR_H_
+
+#include <cstdint>
+
+class Circuito;
+
+///
+/// CLASSE GERADORALEATORIO
+///
+
+// Gerador de numeros pseudo-aleatorios (splitmix64) para os circuitos sinteticos:
+// a mesma semente gera sempre a mesma sequencia, em qualquer plataforma e compilador
+// (o que nao eh garantido por rand nem pelas distribuicoes da <random>)
+class GeradorAleatorio {
+private:
+  uint64_t estado;
+
+public:
+  explicit GeradorAleatorio(uint64_t Semente=0);
+
+  // O proximo numero da sequencia
+  uint64_t proximo();
+  // Um numero de 0 a N-1 (N>0)
+  unsigned sortear(unsigned N);
+};
+
+///
+/// CIRCUITOS SINTETICOS
+///
+
+// Os circuitos gerados sao sempre os mesmos para os mesmos parametros, em qualquer
+// maquina: servem para medidas de desempenho e testes reproduziveis.
+// Todas as funcoes retornam false (e nao alteram C) se os parametros forem invalidos.
+
+// Os parametros de um circuito aleatorio (ver gerarCircuito)
+struct ParametrosGerador {
+  unsigned numInputs;
+  unsigned numOutputs;
+  unsigned numPorts;
+  // Numero de niveis logicos de portas (de 1 a numPorts)
+  unsigned profundidade;
+  // Numero minimo e maximo de entradas de cada porta que nao eh NT (2 a 4)
+  unsigned minEntradasPorta;
+  unsigned maxEntradasPorta;
+  // Numero maximo de portas que usam cada sinal (0 = sem limite)
+  // O limite eh respeitado sempre que possivel: quando todos os sinais candidatos jah
+  // estao no limite, algum eh usado assim mesmo
+  unsigned maxFanout;
+  // Numero de lacos (realimentacoes) acrescentados ao circuito
+  unsigned numLacos;
+  uint64_t semente;
+
+  ParametrosGerador();
+};
+
+// Gera em C um circuito aleatorio em camadas: as portas sao distribuidas igualmente
+// pelos niveis e numeradas nivel a nivel; cada porta tem pelo menos uma entrada vinda
+// do nivel anterior (sem lacos, o circuito tem exatamente P.profundidade niveis) e as
+// demais vindas do nivel anterior ou de qualquer sinal anterior. As saidas sao as
+// ultimas portas (as do ultimo nivel primeiro).
+// Cada laco liga a saida de uma porta a uma entrada (que nao a primeira) de outra
+// porta da qual ela depende, ou dela mesma
+bool gerarCircuito(Circuito& C, const ParametrosGerador& P);
+
+// Somadores de dois numeros de N bits (N>=1), com vai-um de entrada
+// Entradas: A (bit 0 primeiro) de -1 a -N, B de -N-1 a -2N e o vai-um em -2N-1
+// Saidas: a soma (bit 0 primeiro) de 1 a N e o vai-um em N+1
+// - propagacao do vai-um (ripple carry): um somador completo por bit
+// - antecipacao do vai-um (carry lookahead): blocos de 4 bits, cada um com os vai-uns
+//   internos e o de saida calculados em dois niveis de portas a partir dos sinais de
+//   geracao e propagacao; os blocos sao ligados em sequencia
+bool gerarSomadorRipple(Circuito& C, unsigned N);
+bool gerarSomadorCLA(Circuito& C, unsigned N);
+
+// Multiplicador em matriz de dois numeros de N bits (N>=2): os produtos parciais
+// A(j).B(i) somados linha a linha por somadores com propagacao do vai-um
+// Entradas: A (bit 0 primeiro) de -1 a -N e B de -N-1 a -2N
+// Saidas: o produto, com 2N bits (bit 0 primeiro)
+bool gerarMultiplicador(Circuito& C, unsigned N);
+
+// Arvore de portas XO com N entradas (N>=2), de ateh K entradas cada (2 a 4),
+// e uma saida: a paridade das entradas
+bool gerarParidade(Circuito& C, unsigned N, unsigned K);
+
+// Contador sincrono de N bits (N>=1), com um flip-flop (DF) por bit: a cada ciclo de
+// clock, o contador volta a zero se o reset estiver em T ou soma 1 se a habilitacao
+// estiver em T (ver SimuladorSequencial)
+// Entradas: o reset em -1 e a habilitacao em -2
+// Saidas: o valor do contador (bit 0 primeiro), o estado dos N flip-flops
+bool gerarContador(Circuito& C, unsigned N);
+
+// Sorteia o atraso de cada porta de C (ver SimuladorTemporizado), de 1 a maxAtraso
+// (de 1 a Port::ATRASO_MAXIMO); nao altera a funcao logica do circuito
+bool sortearAtrasos(Circuito& C, unsigned maxAtraso, uint64_t Semente);
+
+#endif // _GERADOR_H_
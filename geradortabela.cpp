@@ -0,0 +1,199 @@
+#include "geradortabela.h"
+#include <chrono>
+#include <vector>
+
+GeradorTabela::GeradorTabela(const Circuito& Circ, unsigned Execucao) :
+  QObject(nullptr),
+  C(Circ),
+  parcial(false),
+  portas(),
+  S(),
+  execucao(Execucao),
+  cancelado(false)
+{
+}
+
+GeradorTabela::GeradorTabela(const Circuito& Circ, const std::vector<bool>& Colunas,
+                             unsigned Execucao) :
+  QObject(nullptr),
+  C(Circ),
+  parcial(true),
+  portas(),
+  S(),
+  execucao(Execucao),
+  cancelado(false)
+{
+  C.portasNecessarias(Colunas, portas);
+}
+
+void GeradorTabela::cancelar()
+{
+  cancelado = true;
+}
+
+const SimStats& GeradorTabela::getEstatisticas() const
+{
+  return (parcial ? C.getEstatisticas() : S.getEstatisticas());
+}
+
+void GeradorTabela::gerar()
+{
+  // As linhas sao simuladas em blocos pequenos (para que o cancelamento seja rapido)
+  // e enviadas aa interface a cada INTERVALO, ou quando o buffer fica grande
+  const uint64_t LINHAS_BLOCO = 64;
+  const int MAX_BUFFER = 1<<20;
+  const std::chrono::milliseconds INTERVALO(100);
+
+  bool ok = (parcial ? C.valid() : S.montar(C));
+  unsigned bl = bytesPorLinha(C.getNumOutputs());
+  uint64_t total = (ok ? numLinhasTabela(C.getNumInputs()) : 0);
+  std::vector<uint8_t> valores(LINHAS_BLOCO*bl);
+  QByteArray buffer;
+  std::chrono::steady_clock::time_point ultimo = std::chrono::steady_clock::now();
+
+  for (uint64_t L=0; ok && L<total && !cancelado; L+=LINHAS_BLOCO)
+  {
+    uint64_t n = (total-L<LINHAS_BLOCO ? total-L : LINHAS_BLOCO);
+    bool simulou = (parcial ? simularLinhas(C, L, n, valores.data(), portas) :
+                              simularLinhas(S, L, n, valores.data()));
+    if (!simulou)
+    {
+      ok = false;
+      break;
+    }
+    buffer.append((const char*)valores.data(), int(n*bl));
+
+    std::chrono::steady_clock::time_point agora = std::chrono::steady_clock::now();
+    if (buffer.size()>=MAX_BUFFER || agora-ultimo>=INTERVALO)
+    {
+      emit signLinhas(execucao, buffer);
+      buffer.clear();
+      ultimo = agora;
+    }
+  }
+  if (ok && !cancelado && !buffer.isEmpty()) emit signLinhas(execucao, buffer);
+  emit signTerminado(execucao, ok && !cancelado);
+}
+
+/* ======================================================================== *
+ * CLASSE FILTRADORTABELA                                                   *
+ * ======================================================================== */
+
+FiltradorTabela::FiltradorTabela(const FiltroTabela& Filtro, const TabelaVerdade* Tabela,
+                                 const Circuito& Circ, unsigned Execucao) :
+  QObject(nullptr),
+  F(Filtro),
+  T(Tabela),
+  S(Tabela==nullptr ? new SimuladorLote() : nullptr),
+  Nin(Circ.getNumInputs()),
+  Nout(Circ.getNumOutputs()),
+  execucao(Execucao),
+  cancelado(false)
+{
+  if (S!=nullptr) S->montar(Circ);
+}
+
+void FiltradorTabela::cancelar()
+{
+  cancelado = true;
+}
+
+void FiltradorTabela::filtrar()
+{
+  // Percorre a tabela em blocos; as linhas aceitas sao enviadas aa interface a cada
+  // INTERVALO (ou quando acumulam muitas), junto com o progresso
+  // Os blocos sao maiores quando nao eh preciso simular (filtrar eh bem mais rapido)
+  const uint64_t LINHAS_BLOCO = (T!=nullptr ? 65536 : 256);
+  const size_t MAX_ACEITAS = 65536;
+  const std::chrono::milliseconds INTERVALO(100);
+
+  bool ok = (T!=nullptr ? T->completa() : S->montado());
+  uint64_t total = (ok ? numLinhasTabela(Nin) : 0);
+  std::vector<uint64_t> linhas;
+  std::vector<uint8_t> valores;
+  std::chrono::steady_clock::time_point ultimo = std::chrono::steady_clock::now();
+  uint64_t L;
+
+  for (L=0; ok && L<total && !cancelado; L+=LINHAS_BLOCO)
+  {
+    uint64_t n = (total-L<LINHAS_BLOCO ? total-L : LINHAS_BLOCO);
+    if (T!=nullptr) filtrarTabela(F, *T, L, n, linhas, valores);
+    else ok = filtrarSimulando(F, *S, L, n, linhas, valores);
+
+    std::chrono::steady_clock::time_point agora = std::chrono::steady_clock::now();
+    if (ok && (linhas.size()>=MAX_ACEITAS || agora-ultimo>=INTERVALO || L+n==total))
+    {
+      emit signFiltradas(execucao,
+                         QByteArray((const char*)linhas.data(), int(linhas.size()*sizeof(uint64_t))),
+                         QByteArray((const char*)valores.data(), int(valores.size())),
+                         quint64(L+n));
+      linhas.clear();
+      valores.clear();
+      ultimo = agora;
+    }
+  }
+  emit signTerminado(execucao, ok && !cancelado);
+}
+
+/* ======================================================================== *
+ * CLASSE EXPORTADORTABELA                                                  *
+ * ======================================================================== */
+
+ExportadorTabela::ExportadorTabela(const Circuito& Circ, const std::string& Arq,
+                                   const CacheTabelas& Cache, unsigned Execucao) :
+  QObject(nullptr),
+  C(Circ),
+  arq(Arq),
+  cache(Cache.getDiretorio(), Cache.getMaxBytes()),
+  execucao(Execucao),
+  progresso()
+{
+}
+
+void ExportadorTabela::cancelar()
+{
+  progresso.cancelado = true;
+}
+
+const ProgressoTabela& ExportadorTabela::getProgresso() const
+{
+  return progresso;
+}
+
+const std::string& ExportadorTabela::getArquivo() const
+{
+  return arq;
+}
+
+void ExportadorTabela::exportar()
+{
+  // Cancelada ou com erro, gerarTabelaArquivo retorna false e apaga o arquivo
+  bool ok = C.valid() && gerarTabelaArquivo(C, arq, cache, &progresso);
+  emit signTerminado(execucao, ok);
+}
+
+/* ======================================================================== *
+ * CLASSE GRAVADORCACHE                                                     *
+ * ======================================================================== */
+
+GravadorCache::GravadorCache(const TabelaVerdade* Tabela, const std::string& Chave,
+                             const CacheTabelas& Cache, unsigned Execucao) :
+  QObject(nullptr),
+  T(Tabela),
+  chave(Chave),
+  cache(Cache.getDiretorio(), Cache.getMaxBytes()),
+  execucao(Execucao),
+  cancelado(false)
+{
+}
+
+void GravadorCache::cancelar()
+{
+  cancelado = true;
+}
+
+void GravadorCache::gravar()
+{
+  bool ok = cache.guardar(chave, *T, &cancelado);
+  emit signTerminado(execucao, ok);
+}
@@ -0,0 +1,196 @@
+#ifndef GERADORTABELA_H
+#define GERADORTABELA_H
+
+#include <QObject>
+#include <QByteArray>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "circuito.h"
+#include "simuladorlote.h"
+#include "tabelaverdade.h"
+#include "cachetabelas.h"
+#include "filtrotabela.h"
+
+/* ======================================================================== *
+ * A GERACAO DA TABELA VERDADE EM SEGUNDO PLANO                             *
+ * ======================================================================== */
+
+// Objeto que gera as linhas da tabela verdade em uma thread separada
+// (deve ser movido para uma QThread com moveToThread, e gerar() chamado pelo
+// sinal started da thread), para que a janela continue respondendo.
+// As linhas sao enviadas aa interface em blocos, na ordem, assim que calculadas.
+// Cada geracao recebe um numero (execucao), repetido em todos os sinais, para
+// que a interface possa descartar os blocos de uma geracao jah cancelada.
+class GeradorTabela : public QObject
+{
+  Q_OBJECT
+
+public:
+  // O circuito eh copiado: o circuito da interface pode ser alterado durante a geracao
+  GeradorTabela(const Circuito& Circ, unsigned Execucao);
+
+  // Recalcula apenas as saidas marcadas em Colunas (depois de uma alteracao no circuito):
+  // soh as portas das quais essas saidas dependem sao simuladas, e nas linhas enviadas
+  // apenas essas saidas tem valores corretos (ver TabelaVerdade::atualizarColunas)
+  GeradorTabela(const Circuito& Circ, const std::vector<bool>& Colunas, unsigned Execucao);
+
+  // Interrompe a geracao (antes do proximo bloco de linhas)
+  // Pode ser chamada de qualquer thread
+  void cancelar();
+
+  // Os contadores da simulacao das linhas (ver estatisticas.h)
+  // Soh devem ser lidos depois de signTerminado
+  const SimStats& getEstatisticas() const;
+
+public slots:
+  // Simula todas as linhas, emitindo signLinhas a cada bloco e signTerminado no final
+  void gerar();
+
+signals:
+  // Mais um bloco de linhas empacotadas (ver TabelaVerdade), na sequencia das anteriores
+  void signLinhas(unsigned execucao, QByteArray valores);
+  // Fim da geracao: ok==false se houve erro na simulacao ou se foi cancelada
+  void signTerminado(unsigned execucao, bool ok);
+
+private:
+  Circuito C;
+  // Se apenas algumas colunas sao recalculadas, as portas que precisam ser simuladas
+  // (no circuito, linha a linha); senao, as linhas sao simuladas em lote, com S
+  bool parcial;
+  std::vector<int> portas;
+  SimuladorLote S;
+  unsigned execucao;
+  std::atomic<bool> cancelado;
+};
+
+/* ======================================================================== *
+ * A FILTRAGEM DA TABELA VERDADE EM SEGUNDO PLANO                           *
+ * ======================================================================== */
+
+// Objeto que procura as linhas da tabela verdade aceitas por um filtro, em uma
+// thread separada (usado da mesma forma que GeradorTabela), em blocos de linhas.
+// Se a tabela completa estah em memoria, o filtro eh avaliado sobre as linhas
+// empacotadas; caso contrario (tabela nao gerada ou grande demais), cada bloco de
+// linhas eh simulado e filtrado, sem que a tabela inteira jamais seja armazenada.
+// As linhas aceitas sao enviadas em blocos: os numeros das linhas (uint64_t) e as
+// saidas empacotadas de cada uma.
+class FiltradorTabela : public QObject
+{
+  Q_OBJECT
+
+public:
+  // Filtra as linhas de Tabela, que deve estar completa e nao pode ser alterada nem
+  // destruida ateh o fim da filtragem; ou, se Tabela==nullptr, simula as linhas de Circ
+  FiltradorTabela(const FiltroTabela& Filtro, const TabelaVerdade* Tabela,
+                  const Circuito& Circ, unsigned Execucao);
+
+  // Interrompe a filtragem (antes do proximo bloco de linhas)
+  // Pode ser chamada de qualquer thread
+  void cancelar();
+
+public slots:
+  // Percorre todas as linhas, emitindo signFiltradas a cada bloco e signTerminado no final
+  void filtrar();
+
+signals:
+  // Mais um bloco de linhas aceitas e quantas linhas da tabela jah foram percorridas
+  void signFiltradas(unsigned execucao, QByteArray linhas, QByteArray valores,
+                     quint64 percorridas);
+  // Fim da filtragem: ok==false se houve erro na simulacao ou se foi cancelada
+  void signTerminado(unsigned execucao, bool ok);
+
+private:
+  FiltroTabela F;
+  const TabelaVerdade* T;
+  // O simulador do circuito (soh quando as linhas forem simuladas)
+  std::unique_ptr<SimuladorLote> S;
+  unsigned Nin;
+  unsigned Nout;
+  unsigned execucao;
+  std::atomic<bool> cancelado;
+};
+
+/* ======================================================================== *
+ * A EXPORTACAO DA TABELA VERDADE PARA ARQUIVO EM SEGUNDO PLANO             *
+ * ======================================================================== */
+
+// Objeto que gera a tabela verdade completa diretamente em um arquivo (ver
+// gerarTabelaArquivo), em uma thread separada (usado da mesma forma que LeitorCircuito:
+// o andamento eh consultado com getProgresso). A tabela eh copiada do cache, se estiver
+// lah, e guardada nele no final; o cache usado eh uma instancia propria no mesmo
+// diretorio (o indice eh relido a cada operacao, como se fosse outro processo).
+// Se a exportacao falhar ou for cancelada, o arquivo eh apagado.
+class ExportadorTabela : public QObject
+{
+  Q_OBJECT
+
+public:
+  // O circuito eh copiado: o circuito da interface pode ser alterado durante a geracao
+  ExportadorTabela(const Circuito& Circ, const std::string& Arq, const CacheTabelas& Cache,
+                   unsigned Execucao);
+
+  // Interrompe a exportacao (antes do proximo bloco de linhas)
+  // Pode ser chamada de qualquer thread
+  void cancelar();
+
+  // O andamento da exportacao. Pode ser consultado de qualquer thread
+  const ProgressoTabela& getProgresso() const;
+
+  const std::string& getArquivo() const;
+
+public slots:
+  // Gera o arquivo e emite signTerminado no final
+  void exportar();
+
+signals:
+  // Fim da exportacao: ok==false se houve erro (inclusive disco cheio) ou se foi cancelada
+  void signTerminado(unsigned execucao, bool ok);
+
+private:
+  Circuito C;
+  std::string arq;
+  CacheTabelas cache;
+  unsigned execucao;
+  ProgressoTabela progresso;
+};
+
+/* ======================================================================== *
+ * A GRAVACAO DA TABELA VERDADE NO CACHE EM SEGUNDO PLANO                   *
+ * ======================================================================== */
+
+// Objeto que guarda no cache a tabela verdade exibida, em uma thread separada (usado da
+// mesma forma que GeradorTabela), para que a janela nao pare enquanto o arquivo eh
+// gravado. Como em FiltradorTabela, a tabela eh lida no lugar: ela nao pode ser
+// alterada nem destruida ateh o fim da gravacao (a interface cancela a gravacao antes
+// de alterar a tabela, e nesse caso a tabela simplesmente nao fica no cache).
+class GravadorCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  // Tabela deve estar completa; Chave eh a impressao digital do circuito
+  GravadorCache(const TabelaVerdade* Tabela, const std::string& Chave,
+                const CacheTabelas& Cache, unsigned Execucao);
+
+  // Interrompe a gravacao (o arquivo incompleto eh apagado)
+  // Pode ser chamada de qualquer thread
+  void cancelar();
+
+public slots:
+  // Grava a tabela no cache e emite signTerminado no final
+  void gravar();
+
+signals:
+  // Fim da gravacao: ok==false se a tabela nao foi guardada (erro ou cancelamento)
+  void signTerminado(unsigned execucao, bool ok);
+
+private:
+  const TabelaVerdade* T;
+  std::string chave;
+  CacheTabelas cache;
+  unsigned execucao;
+  std::atomic<bool> cancelado;
+};
+
+#endif // GERADORTABELA_H
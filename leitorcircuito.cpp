@@ -0,0 +1,43 @@
+#include "leitorcircuito.h"
+
+LeitorCircuito::LeitorCircuito(const std::string& Arq, unsigned Execucao) :
+  QObject(nullptr),
+  arq(Arq),
+  execucao(Execucao),
+  C(),
+  progresso(),
+  R()
+{
+  R.progresso = &progresso;
+}
+
+void LeitorCircuito::cancelar()
+{
+  progresso.cancelado = true;
+}
+
+const ProgressoLeitura& LeitorCircuito::getProgresso() const
+{
+  return progresso;
+}
+
+Circuito& LeitorCircuito::getCircuito()
+{
+  return C;
+}
+
+const ResultadoLeitura& LeitorCircuito::getResultado() const
+{
+  return R;
+}
+
+const std::string& LeitorCircuito::getArquivo() const
+{
+  return arq;
+}
+
+void LeitorCircuito::ler()
+{
+  bool ok = C.ler(arq, R);
+  emit signTerminado(execucao, ok);
+}
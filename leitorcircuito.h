@@ -0,0 +1,54 @@
+#ifndef LEITORCIRCUITO_H
+#define LEITORCIRCUITO_H
+
+#include <QObject>
+#include <string>
+#include "circuito.h"
+#include "leitura.h"
+
+/* ======================================================================== *
+ * A LEITURA DE UM ARQUIVO DE CIRCUITO EM SEGUNDO PLANO                     *
+ * ======================================================================== */
+
+// Objeto que leh um circuito de um arquivo em uma thread separada (usado da mesma
+// forma que GeradorTabela: movido para uma QThread, com ler() chamado pelo sinal
+// started da thread), para que a janela continue respondendo durante a leitura de
+// arquivos grandes.
+// O circuito eh lido em uma variavel propria: o circuito da interface nao eh tocado
+// e, se a leitura der certo, eh trocado pelo circuito lido (getCircuito().swap).
+// O andamento (bytes lidos) pode ser consultado a qualquer momento com getProgresso.
+class LeitorCircuito : public QObject
+{
+  Q_OBJECT
+
+public:
+  LeitorCircuito(const std::string& Arq, unsigned Execucao);
+
+  // Interrompe a leitura. Pode ser chamada de qualquer thread
+  void cancelar();
+
+  // O andamento da leitura. Pode ser consultado de qualquer thread
+  const ProgressoLeitura& getProgresso() const;
+
+  // O resultado: soh devem ser acessados depois de signTerminado
+  Circuito& getCircuito();
+  const ResultadoLeitura& getResultado() const;
+  const std::string& getArquivo() const;
+
+public slots:
+  // Leh o arquivo e emite signTerminado no final
+  void ler();
+
+signals:
+  // Fim da leitura: ok==false se houve erro (ver getResultado) ou se foi cancelada
+  void signTerminado(unsigned execucao, bool ok);
+
+private:
+  std::string arq;
+  unsigned execucao;
+  Circuito C;
+  ProgressoLeitura progresso;
+  ResultadoLeitura R;
+};
+
+#endif // LEITORCIRCUITO_H
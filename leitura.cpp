@@ -0,0 +1,36 @@
+#include <algorithm>
+#include "leitura.h"
+
+// Imprime um diagnostico no formato "linha:coluna: erro N: esperado ..."
+std::ostream& operator<<(std::ostream& O, const Diagnostico& D)
+{
+  O << D.linha << ':' << D.coluna << ": erro " << int(D.codigo);
+  if (!D.esperado.empty()) O << ": esperado " << D.esperado;
+  return O;
+}
+
+// Funcao auxiliar para ordenar os diagnosticos pela posicao no arquivo
+static bool antes(const Diagnostico& A, const Diagnostico& B)
+{
+  return A.posicao < B.posicao;
+}
+
+void localizarDiagnosticos(const char* base, std::vector<Diagnostico>& erros)
+{
+  std::stable_sort(erros.begin(), erros.end(), antes);
+  uint64_t pos=0, inicioLinha=0;
+  unsigned linha=1;
+  for (unsigned i=0; i<erros.size(); i++)
+  {
+    for (; pos<erros[i].posicao; pos++)
+    {
+      if (base[pos]=='\n')
+      {
+        linha++;
+        inicioLinha = pos+1;
+      }
+    }
+    erros[i].linha = linha;
+    erros[i].coluna = unsigned(erros[i].posicao - inicioLinha + 1);
+  }
+}
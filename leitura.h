@@ -0,0 +1,153 @@
+#ifndef _LEITURA_H_
+#define _LEITURA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// ###########################################################################
+/// FUNCOES AUXILIARES PARA LEITURA DE TEXTO DIRETAMENTE DE UM BLOCO DE MEMORIA
+/// Usadas pelos metodos ler de Port e Circuito, que leem o arquivo mapeado em
+/// memoria (ArquivoMapeado) em vez de usar streams, para poder dividir o texto
+/// em blocos independentes.
+/// const char*& pos: posicao atual da leitura (avanca apos ler)
+/// const char* fim: primeira posicao apos o final do bloco
+/// Nenhuma dessas funcoes gera excecoes: os erros sao informados pelo valor de retorno
+/// ###########################################################################
+
+// Retorna true se o caractere eh um separador (espaco, tabulacao, fim de linha)
+inline bool ehEspaco(char c)
+{
+  return (c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f');
+}
+
+// Avanca pos ateh o primeiro caractere que nao seja separador (ou ateh fim)
+inline void pularEspacos(const char*& pos, const char* fim)
+{
+  while (pos<fim && ehEspaco(*pos)) pos++;
+}
+
+// Retorna a posicao do proximo fim de linha ('\n') a partir de pos, ou fim se nao houver
+inline const char* fimDaLinha(const char* pos, const char* fim)
+{
+  if (pos>=fim) return fim;
+  const char* p = (const char*)memchr(pos, '\n', size_t(fim-pos));
+  return (p==nullptr ? fim : p);
+}
+
+// Leh uma palavra (sequencia de caracteres nao separadores), depois de pular os separadores
+// Ao final, ini aponta para o inicio da palavra e tam contem o numero de caracteres
+// Retorna false se nao havia nenhuma palavra ateh o fim do bloco
+inline bool lerPalavra(const char*& pos, const char* fim, const char*& ini, size_t& tam)
+{
+  pularEspacos(pos, fim);
+  ini = pos;
+  while (pos<fim && !ehEspaco(*pos)) pos++;
+  tam = size_t(pos-ini);
+  return (tam>0);
+}
+
+// Leh um inteiro (com sinal opcional), depois de pular os separadores
+// Nao consome o caractere que vem logo apos os digitos (por exemplo, ':' ou ')')
+// Retorna false se nao havia um inteiro valido na posicao
+inline bool lerInteiro(const char*& pos, const char* fim, long long& N)
+{
+  pularEspacos(pos, fim);
+  bool negativo=false;
+  if (pos<fim && (*pos=='-' || *pos=='+'))
+  {
+    negativo = (*pos=='-');
+    pos++;
+  }
+  if (pos>=fim || *pos<'0' || *pos>'9') return false;
+  long long v=0;
+  while (pos<fim && *pos>='0' && *pos<='9')
+  {
+    v = 10*v + (*pos-'0');
+    // Valores absurdamente grandes sao tratados como invalidos
+    if (v>(1LL<<40)) return false;
+    pos++;
+  }
+  N = (negativo ? -v : v);
+  return true;
+}
+
+// Testa se o proximo caractere (depois de pular os separadores) eh c; se for, consome
+inline bool lerCaractere(const char*& pos, const char* fim, char c)
+{
+  pularEspacos(pos, fim);
+  if (pos>=fim || *pos!=c) return false;
+  pos++;
+  return true;
+}
+
+/// ***********************
+/// Diagnosticos de leitura
+/// ***********************
+
+// Codigos dos erros que podem ser encontrados ao ler um arquivo de circuito
+enum class ErroLeitura {
+  NENHUM = 0,
+  ARQUIVO = 1,        // arquivo inexistente, vazio ou que nao pode ser aberto
+  CABECALHO = 2,      // CIRCUITO Nin Nout Nports ausente ou com valores invalidos
+  SECAO_PORTAS = 3,   // palavra PORTAS ausente
+  ID_PORTA = 4,       // id da porta (1), 2), ...) ausente ou fora de ordem
+  TIPO_PORTA = 5,     // tipo de porta invalido
+  PORTA = 6,          // numero de entradas, ':' ou id de entrada da porta invalidos
+  SECAO_SAIDAS = 7,   // palavra SAIDAS ausente
+  ID_SAIDA = 8,       // id da saida (1), 2), ...) ausente ou fora de ordem
+  ORIGEM_SAIDA = 9,   // origem de saida ausente ou fora dos limites do circuito
+  ORIGEM_PORTA = 10,  // origem de entrada de porta fora dos limites do circuito
+  NUM_PORTAS = 11,    // numero de portas diferente do informado no cabecalho
+  DIARIO = 12,        // registro invalido no diario de alteracoes (arquivo .jrn)
+  CANCELADA = 13      // leitura interrompida (ProgressoLeitura::cancelado)
+};
+
+// Um problema encontrado na leitura: onde ocorreu e o que era esperado naquele ponto
+struct Diagnostico {
+  unsigned linha;        // linha do arquivo (a partir de 1)
+  unsigned coluna;       // coluna do arquivo (a partir de 1)
+  ErroLeitura codigo;
+  std::string esperado;  // descricao do que era esperado na posicao
+  uint64_t posicao;      // deslocamento em bytes desde o inicio do arquivo
+};
+
+// Imprime um diagnostico no formato "linha:coluna: erro N: esperado ..."
+std::ostream& operator<<(std::ostream& O, const Diagnostico& D);
+
+// O andamento de uma leitura, que pode ser acompanhada e interrompida de outra thread
+// (por exemplo, pela interface, enquanto o arquivo eh lido em segundo plano)
+struct ProgressoLeitura {
+  std::atomic<uint64_t> lidos;   // bytes do arquivo jah lidos
+  std::atomic<uint64_t> total;   // tamanho do arquivo (0 enquanto nao for conhecido)
+  std::atomic<bool> cancelado;   // se true, a leitura eh interrompida assim que possivel
+
+  ProgressoLeitura(): lidos(0), total(0), cancelado(false) {}
+};
+
+// O resultado da leitura de um arquivo de circuito: a lista de todos os problemas
+// encontrados (vazia se a leitura foi bem sucedida)
+// A leitura nao para no primeiro erro: pula para a proxima linha e continua,
+// ateh o limite de maxErros diagnosticos (0 = sem limite)
+struct ResultadoLeitura {
+  std::vector<Diagnostico> erros;
+  unsigned maxErros;
+  // Se nao for nullptr, atualizado durante a leitura (e consultado para cancela-la)
+  ProgressoLeitura* progresso;
+
+  ResultadoLeitura(unsigned MaxErros=1000): erros(), maxErros(MaxErros), progresso(nullptr) {}
+  bool ok() const {return erros.empty();}
+  bool cheio() const {return (maxErros>0 && erros.size()>=maxErros);}
+  void limpar() {erros.clear();}
+};
+
+// Calcula a linha e a coluna de cada diagnostico a partir da posicao em bytes,
+// percorrendo o texto (que comeca em base) uma unica vez.
+// Os diagnosticos sao ordenados pela posicao no arquivo
+void localizarDiagnosticos(const char* base, std::vector<Diagnostico>& erros);
+
+#endif // _LEITURA_H_
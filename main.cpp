@@ -1,12 +1,26 @@
 #include "maincircuito.h"
 #include <QApplication>
+#include <cstdlib>
+#include "rastro.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
-    MainCircuito w;
 
-    w.show();
+    // Com a variavel de ambiente CIRCUITO_RASTRO=arquivo, o rastro da execucao (leitura,
+    // geracao da tabela verdade, ...) eh gravado no arquivo ao fechar o programa
+    const char* arqRastro = std::getenv("CIRCUITO_RASTRO");
+    if (arqRastro!=nullptr && *arqRastro!='\0') iniciarRastro();
 
-    return a.exec();
+    int ret;
+    {
+        MainCircuito w;
+
+        w.show();
+
+        ret = a.exec();
+    }
+    // O destrutor da janela espera as threads de leitura e de simulacao terminarem
+    if (rastroAtivo()) salvarRastro(arqRastro);
+    return ret;
 }
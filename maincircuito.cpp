@@ -7,11 +7,27 @@
 #include <QString>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QHeaderView>
+#include <QDir>
+#include <QStandardPaths>
 #include <time.h>
 #include <cmath>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <utility>
+#include <cstring>
 #include "bool3S.h"
+#include "tabelaverdade.h"
+#include "filtrotabela.h"
+
+// O diretorio do cache de tabelas verdade (criado se nao existir)
+static std::string diretorioCache()
+{
+  QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)+"/tabelas";
+  QDir().mkpath(dir);
+  return dir.toStdString();
+}
 
 MainCircuito::MainCircuito(QWidget *parent) : QMainWindow(parent)
 ,ui(new Ui::MainCircuito)
@@ -21,15 +37,66 @@ MainCircuito::MainCircuito(QWidget *parent) : QMainWindow(parent)
 ,newCircuito(new NewCircuito(this))
 ,modificarPorta(new ModificarPorta(this))
 ,modificarSaida(new ModificarSaida(this))
+,janelaEsquematico(new JanelaEsquematico(this))
+,modeloPortas(new ModeloPortas(C, simulador, this))
+,modeloSaidas(new ModeloSaidas(C, simulador, this))
+,modeloEntradas(new ModeloEntradas(simulador, this))
+,modeloTabela(new ModeloTabelaVerdade(this))
+,threadTabela(nullptr)
+,geradorTabela(nullptr)
+,execucaoTabela(0)
+,progressoTabela(new QProgressBar(this))
+,colunasAtualizando()
+,linhaAtualizacao(0)
+,estatisticasTabela()
+,threadLeitura(nullptr)
+,leitor(nullptr)
+,execucaoLeitura(0)
+,progressoLeitura(new QProgressBar(this))
+,botaoCancelarLeitura(new QPushButton("Cancelar leitura", this))
+,timerLeitura(new QTimer(this))
+,cacheTabelas(diretorioCache())
+,threadFiltro(nullptr)
+,filtrador(nullptr)
+,execucaoFiltro(0)
+,progressoFiltro(new QProgressBar(this))
+,threadExportacao(nullptr)
+,exportador(nullptr)
+,execucaoExportacao(0)
+,progressoExportacao(new QProgressBar(this))
+,timerExportacao(new QTimer(this))
+,threadGravacao(nullptr)
+,gravador(nullptr)
+,execucaoGravacao(0)
 {
   ui->setupUi(this);
 
-  // Cabecalhos da tabela de portas
+  // A tabela verdade eh exibida a partir de um modelo: a view soh pede os valores
+  // das linhas visiveis, e todas as linhas tem a mesma altura (nao precisa medi-las)
+  ui->tableTabelaVerdade->setModel(modeloTabela);
+  ui->tableTabelaVerdade->setItemDelegate(new DelegadoTabelaVerdade(this));
+  ui->tableTabelaVerdade->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+  // As tabelas de portas e saidas sao exibidas a partir de modelos que leem o circuito
+  // (os cabecalhos tambem sao fornecidos pelos modelos)
+  ui->tablePortas->setModel(modeloPortas);
   ui->tablePortas->horizontalHeader()->setVisible(true);
   ui->tablePortas->verticalHeader()->setVisible(true);
-  ui->tablePortas->setHorizontalHeaderLabels(QStringList() << "TIPO" << "NUM\nENTR"
-                                             << "ENTR\n1" << "ENTR\n2" << "ENTR\n3" << "ENTR\n4");
-  ui->tableSaidas->setHorizontalHeaderLabels(QStringList() << "ORIG\nSAIDA");
+  ui->tablePortas->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  ui->tableSaidas->setModel(modeloSaidas);
+  ui->tableSaidas->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+  // O painel da simulacao interativa, inicialmente fechado, eh aberto pelo menu Simular
+  ui->tableEntradas->setModel(modeloEntradas);
+  ui->tableEntradas->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  ui->dockSimulacao->hide();
+  ui->dockSimulacao->toggleViewAction()->setChecked(false);
+  ui->menuSimular->addSeparator();
+  ui->menuSimular->addAction(ui->dockSimulacao->toggleViewAction());
+  connect(ui->dockSimulacao->toggleViewAction(), &QAction::toggled,
+          this, &MainCircuito::slotSimulacaoInterativa);
+  connect(modeloEntradas, &ModeloEntradas::signEntradaAlterada,
+          this, &MainCircuito::slotEntradaAlterada);
 
   // Insere os widgets da barra de status
   statusBar()->insertWidget(0,new QLabel("Num entradas: "));
@@ -39,6 +106,36 @@ MainCircuito::MainCircuito(QWidget *parent) : QMainWindow(parent)
   statusBar()->insertWidget(4,new QLabel("   Num portas: "));
   statusBar()->insertWidget(5,numPortas);
 
+  // O progresso da geracao da tabela verdade, soh visivel durante a geracao
+  progressoTabela->setRange(0,100);
+  progressoTabela->setFormat("Tabela verdade: %p%");
+  progressoTabela->setVisible(false);
+  statusBar()->addPermanentWidget(progressoTabela);
+  progressoFiltro->setRange(0,100);
+  progressoFiltro->setFormat("Filtro: %p%");
+  progressoFiltro->setVisible(false);
+  statusBar()->addPermanentWidget(progressoFiltro);
+  progressoExportacao->setRange(0,100);
+  progressoExportacao->setFormat("Exportando tabela: %p%");
+  progressoExportacao->setVisible(false);
+  statusBar()->addPermanentWidget(progressoExportacao);
+  timerExportacao->setInterval(100);
+  connect(timerExportacao, &QTimer::timeout,
+          this, &MainCircuito::slotProgressoExportacao);
+  // O progresso da leitura de arquivo, com o botao de cancelar, soh visiveis durante a leitura
+  progressoLeitura->setRange(0,100);
+  progressoLeitura->setFormat("Lendo circuito: %p%");
+  progressoLeitura->setVisible(false);
+  statusBar()->addPermanentWidget(progressoLeitura);
+  botaoCancelarLeitura->setVisible(false);
+  statusBar()->addPermanentWidget(botaoCancelarLeitura);
+  connect(botaoCancelarLeitura, &QPushButton::clicked,
+          this, &MainCircuito::cancelarLeitura);
+  timerLeitura->setInterval(100);
+  connect(timerLeitura, &QTimer::timeout,
+          this, &MainCircuito::slotProgressoLeitura);
+  ui->actionCancelar_tabela->setEnabled(false);
+
   // Conecta sinais
   // Sinais da janela principal para janela novo circuito
   connect(this, &MainCircuito::signShowNewCircuito,
@@ -72,6 +169,11 @@ MainCircuito::MainCircuito(QWidget *parent) : QMainWindow(parent)
 
 MainCircuito::~MainCircuito()
 {
+  cancelarLeitura();
+  cancelarFiltro();
+  cancelarTabela();
+  cancelarExportacao();
+  cancelarGravacao();
   delete ui;
 }
 
@@ -86,25 +188,39 @@ void MainCircuito::slotNewCircuito(int NInputs, int NOutputs, int NPortas)
     redimensionaTabelas();
 }
 
-void MainCircuito::slotModificarPorta(int IdPort, QString TipoPort, int NumInputsPort,
-                                      int IdInput0, int IdInput1, int IdInput2, int IdInput3)
+void MainCircuito::slotModificarPorta(int IdPort, QString TipoPort, QVector<int> IdInputs)
 {
+  // Guarda a porta atual, para saber se a alteracao muda alguma coisa
+  std::string tipoAntigo = C.getNamePort(IdPort);
+  QVector<int> entradasAntigas;
+  for (unsigned j=0; j<C.getNumInputsPort(IdPort); j++)
+  {
+    entradasAntigas.push_back(C.getId_inPort(IdPort, j));
+  }
+
   // Aqui deve ser chamado um metodo da classe Circuito que altere a porta cuja
   // id eh IdPort para que ela assuma as caracteristicas especificadas por
-  // TipoPort, NumInputsPort
-  C.setPort(IdPort, TipoPort.toStdString(),NumInputsPort);
+  // TipoPort e pelo numero de entradas
+  C.setPort(IdPort, TipoPort.toStdString(), IdInputs.size());
   // Aqui devem ser chamados metodos da classe Circuito que altere a porta cuja
-  // id eh IdPort para que as origens de suas entradas sejam dadas pelas ids em IdInput#
-  // Soh levar em conta os parametros de entrada que sejam >0
-  C.setId_inPort(IdPort, 0, IdInput0);
-  C.setId_inPort(IdPort, 1, IdInput1);
-  C.setId_inPort(IdPort, 2, IdInput2);
-  C.setId_inPort(IdPort, 3, IdInput3);
-
-  // Depois de alterada, deve ser reexibida a porta correspondente e limpa a tabela verdade
+  // id eh IdPort para que as origens de suas entradas sejam dadas pelas ids em IdInputs
+  for (int j=0; j<IdInputs.size(); j++)
+  {
+    C.setId_inPort(IdPort, j, IdInputs[j]);
+  }
 
-  showPort(IdPort);
-  limparTabelaVerdade();
+  // Depois de alterada, deve ser reexibida a porta correspondente
+  modeloPortas->portaAlterada(IdPort);
+  atualizarEsquematico();
+  atualizarSimulacao();
+  if (tipoAntigo==TipoPort.toStdString() && entradasAntigas==IdInputs) return;
+
+  // Na tabela verdade, soh as saidas que dependem da porta sao recalculadas
+  std::vector<bool> colunas, afetadas;
+  if (!prepararAtualizacaoTabela(colunas)) return;
+  C.saidasDependentes(IdPort, afetadas);
+  for (unsigned i=0; i<colunas.size(); i++) colunas[i] = (colunas[i] || afetadas[i]);
+  recalcularColunas(colunas);
 }
 
 void MainCircuito::slotModificarSaida(int IdSaida, int IdOrigemSaida)
@@ -116,10 +232,34 @@ void MainCircuito::slotModificarSaida(int IdSaida, int IdOrigemSaida)
   if(!(C.validIdOrig(IdOrigemSaida) && C.validIdOutput(IdSaida))){
       QMessageBox::critical(this, tr("Saida invlida"),  "No foi possivel modificar a saida");
   }
+  int origemAntiga = C.getIdOutput(IdSaida);
   C.setIdOutput(IdSaida, IdOrigemSaida);
-  // Depois de alterada, deve ser reexibida a saida correspondente e limpa a tabela verdade
-  showOutput(IdSaida);
-  limparTabelaVerdade();
+  // Depois de alterada, deve ser reexibida a saida correspondente
+  modeloSaidas->saidaAlterada(IdSaida);
+  atualizarEsquematico();
+  atualizarSimulacao();
+  int origem = C.getIdOutput(IdSaida);
+  if (origem==origemAntiga) return;
+
+  // Na tabela verdade, soh a coluna da saida muda. Quando a nova origem eh uma entrada
+  // do circuito, ou a origem de outra saida jah calculada, a coluna eh preenchida na
+  // hora; caso contrario, eh recalculada em segundo plano
+  std::vector<bool> colunas;
+  if (!prepararAtualizacaoTabela(colunas)) return;
+  unsigned I = unsigned(IdSaida-1);
+  colunas[I] = false;
+  if (origem<0)
+  {
+    modeloTabela->copiarEntrada(unsigned(-origem-1), I);
+  }
+  else
+  {
+    unsigned k=0;
+    while (k<colunas.size() && (k==I || colunas[k] || C.getIdOutput(k+1)!=origem)) k++;
+    if (k<colunas.size()) modeloTabela->copiarColuna(k, I);
+    else colunas[I] = true;
+  }
+  recalcularColunas(colunas);
 }
 
 // Redimensiona todas as tabelas e reexibe todos os valores da barra de status
@@ -130,11 +270,6 @@ void MainCircuito::redimensionaTabelas()
   int numOutputs=C.getNumOutputs();
   int numPorts=C.getNumPorts();
 
-  // Variaveis auxiliares
-  QString texto;
-  QLabel *prov;
-  int i;
-
   // ==========================================================
   // Ajusta os valores da barra de status
   // ==========================================================
@@ -147,65 +282,34 @@ void MainCircuito::redimensionaTabelas()
   // Redimensiona a tabela das portas e conexoes
   // ==========================================================
 
-  // Limpa o conteudo, mas nao os cabecalhos
-  ui->tablePortas->clearContents();
-
-  ui->tablePortas->setRowCount(numPorts);
-  for (i=0; i<=numPorts; i++)
-  {
-    showPort(i);
-  }
+  // O modelo passa a exibir todas as portas do circuito
+  // (apenas as linhas visiveis sao efetivamente lidas do circuito)
+  modeloPortas->recarregar();
 
   // ==========================================================
   // Redimensiona a tabela de saidas
   // ==========================================================
 
-  // Limpa o conteudo, mas nao os cabecalhos
-  ui->tableSaidas->clearContents();
-
-  ui->tableSaidas->setRowCount(numOutputs);
-  for (i=0; i<=numOutputs; i++)
-  {
-    showOutput(i);
-  }
+  modeloSaidas->recarregar();
 
   // ==========================================================
-  // Redimensiona a tabela verdade
+  // Redesenha o esquematico
   // ==========================================================
 
-  // Antes de redimensionar a tabela, anula todos os setSpan da primeira linha
-  // Se nao fizer isso, dah erro ao redimensionar
-  ui->tableTabelaVerdade->clearSpans();
+  atualizarEsquematico();
 
-  // Limpa todo o conteudo, inclusive cabecalhos
-  ui->tableTabelaVerdade->clear();
+  // ==========================================================
+  // Refaz a simulacao interativa
+  // ==========================================================
 
-  // Modifica as dimensoes
-  ui->tableTabelaVerdade->setColumnCount(numInputs+numOutputs);
-  int numCombinacoesEntrada = (numInputs>0 ? round(pow(3,numInputs)) : 0);
-  // a tabela verdade tem uma linha a mais do que o numero de combinacoes de entrada
-  // para conter o pseudocabecalho
-  ui->tableTabelaVerdade->setRowCount(1 + numCombinacoesEntrada);
+  atualizarSimulacao();
 
-  // Cria o pseudocabecalho na primeira linha
-  // Entradas
-  if (numInputs > 0)
-  {
-    ui->tableTabelaVerdade->setSpan(0,0,1,numInputs);
-    prov = new QLabel("ENTRADAS");
-    prov->setAlignment(Qt::AlignCenter);
-    prov->setStyleSheet("font-weight: bold");
-    ui->tableTabelaVerdade->setCellWidget(0,0,prov);
-  }
-  // Saidas
-  if (numOutputs > 0)
-  {
-    ui->tableTabelaVerdade->setSpan(0,numInputs,1,numOutputs);
-    prov = new QLabel("SAIDAS");
-    prov->setAlignment(Qt::AlignCenter);
-    prov->setStyleSheet("font-weight: bold");
-    ui->tableTabelaVerdade->setCellWidget(0,numInputs,prov);
-  }
+  // ==========================================================
+  // Redimensiona a tabela verdade
+  // ==========================================================
+
+  // A tabela fica vazia, soh com os cabecalhos das colunas de entradas e saidas
+  limparTabelaVerdade();
 
   // ==========================================================
   // Fixa os limites para os spin boxs (emit signSetRangeInputs)
@@ -217,116 +321,166 @@ void MainCircuito::redimensionaTabelas()
   emit signSetRangeInputs(-numInputs, numPorts);
 }
 
-// Exibe os dados da i-esima porta (i = indice de 0 a numPorts-1 = Id-1)
-// Essa funcao deve ser chamada sempre que mudar caracteristicas da porta
-// A funcao redimensiona_tabela jah deve chamar essa funcao para todas as portas
-void MainCircuito::showPort(unsigned i)
+// Redesenha o esquematico, se estiver aberto
+// (fechado, ele soh eh montado quando for exibido)
+void MainCircuito::atualizarEsquematico()
 {
-  // ok
-  if (!C.validIdPort(i)) return;  // Encerra a funcao sem fazer nada
-  // Esses valores (namePort, numInputsPort)
-  // devem ser lidos a partir de metodos de consulta da classe Circuito
-  // Provisoriamente, estao sendo inicializados com valores nulos ou invalidos
-
-  QString namePort=C.getNamePort(i).c_str();
-  int numInputsPort=C.getNumInputsPort(i);
-
-  // Variaveis auxiliares
-  QLabel *prov;
-  int j;
-
-  // As id das entradas da porta
-  int idInputPort[4];
+  if (janelaEsquematico->isVisible()) janelaEsquematico->setCircuito(C);
+}
 
-  // Esses valores (idInputPorta[])
-  // devem ser lidos a partir de metodos de consulta da classe Circuito
-  // Provisoriamente, estao sendo inicializados com valores nulos
-  for (j=0; j<numInputsPort; j++)
+// Monta de novo o simulador da simulacao interativa, se o painel estiver aberto
+// (fechado, o simulador fica vazio e as colunas de valores ficam em branco)
+void MainCircuito::atualizarSimulacao()
+{
+  unsigned numEntradas = simulador.getNumInputs();
+  if (ui->dockSimulacao->isHidden())
   {
-    idInputPort[j] = C.getId_inPort(i, j);
+    simulador.clear();
   }
-
-  // Cria e define valores dos widgets da linha da tabela que corresponde aa porta
-
-  // Coluna 0
-  prov = new QLabel(namePort);
-  prov->setAlignment(Qt::AlignCenter);
-  ui->tablePortas->setCellWidget(i-1,0,prov);
-  // Coluna 1
-  prov = new QLabel;
-  prov->setAlignment(Qt::AlignCenter);
-  prov->setNum(numInputsPort);
-  ui->tablePortas->setCellWidget(i-1,1,prov);
-
-  // As entradas de cada porta
-  for (j=0; j<4; j++)
+  else if (!simulador.montar(C))
   {
-    // Cria os widgets das celulas da tabela de portas
-    // Coluna 2 em diante
-    prov = new QLabel;
-    prov->setAlignment(Qt::AlignCenter);
-    if (j<numInputsPort) prov->setNum(idInputPort[j]);
-    ui->tablePortas->setCellWidget(i-1,2+j,prov);
+    ui->labelSimulacao->setText("O Circuito nao esta completamente definido.");
   }
-}
-
-// Exibe os dados da i-esima saida (i = indice de 0 a numOutputs-1 = Id-1)
-// Essa funcao deve ser chamada sempre que mudar valores da saida
-// A funcao redimensiona_tabela jah deve chamar essa funcao para todas as saidas
-void MainCircuito::showOutput(unsigned i)
-{
-  // Testa se indice i eh valido, comparando com num saidas consultado da classe Circuito
-
-  if (!C.validIdOutput(i)) return;  // Encerra a funcao sem fazer nada
-
-  // Esse valor (idOutput) deve ser lido a partir de metodos de consulta da classe Circuito
-  // Provisoriamente, estah sendo inicializado com valor nulo
-  int idOutput=C.getIdOutput(i);
-
-  // Variavel auxiliar
-  QLabel *prov;
-
-  // Cria o widget da celula da tabela de saidas
-  // Coluna 0 (unica)
-  prov = new QLabel;
-  prov->setAlignment(Qt::AlignCenter);
-  prov->setNum(idOutput);
-  ui->tableSaidas->setCellWidget(i-1,0,prov);
+  else
+  {
+    ui->labelSimulacao->setText(simulador.getSemLacos() ?
+                                "Clique nas entradas para alternar entre F, ? e T" :
+                                "Clique nas entradas para alternar entre F, ? e T\n"
+                                "(circuito com lacos: cada alteracao recalcula o cone inteiro)");
+  }
+  // As entradas mantem os valores se o numero delas nao mudou
+  if (simulador.getNumInputs()!=numEntradas) modeloEntradas->recarregar();
+  modeloPortas->valoresAlterados();
+  modeloSaidas->valoresAlterados();
 }
 
 // Limpa a tabela verdade
 // Deve ser chamada sempre que alguma caracteristica do circuito (porta, saida) for alterada
 void MainCircuito::limparTabelaVerdade()
 {
-    //ok
-  // Esses valores (numInputs, numOutputs)
-  // devem ser lidos a partir de metodos de consulta da classe Circuito
-  int numInputs=C.getNumInputs();
-  int numOutputs=C.getNumOutputs();
+  // O filtro e a gravacao no cache em andamento leem a tabela, que vai ser alterada
+  cancelarFiltro();
+  cancelarGravacao();
+  cancelarTabela();
+  // Mantem apenas os cabecalhos (as colunas de entradas e saidas)
+  modeloTabela->redimensionar(C.getNumInputs(), C.getNumOutputs());
+}
 
-  // Variavel auxiliar
-  QLabel *prov;
+// Interrompe a geracao da tabela verdade em andamento, se houver
+void MainCircuito::cancelarTabela()
+{
+  if (threadTabela==nullptr) return;
+  geradorTabela->cancelar();
+  // Os blocos jah enviados pela geracao cancelada serao ignorados ao chegar
+  execucaoTabela++;
+  colunasAtualizando.clear();
+  encerrarThreadTabela();
+}
+
+// Espera a thread de geracao terminar e libera a thread e o gerador
+void MainCircuito::encerrarThreadTabela()
+{
+  if (threadTabela==nullptr) return;
+  threadTabela->quit();
+  threadTabela->wait();
+  delete geradorTabela;
+  delete threadTabela;
+  geradorTabela = nullptr;
+  threadTabela = nullptr;
+  progressoTabela->setVisible(false);
+  ui->actionCancelar_tabela->setEnabled(threadFiltro!=nullptr || threadExportacao!=nullptr);
+}
 
-  // Limpa todo o conteudo, inclusive cabecalhos
-  ui->tableTabelaVerdade->clear();
+// Inicia a thread de geracao (ou de atualizacao) da tabela verdade com o gerador G
+void MainCircuito::iniciarGeradorTabela(GeradorTabela *G)
+{
+  // O gerador comeca a trabalhar assim que a thread inicia
+  threadTabela = new QThread;
+  geradorTabela = G;
+  geradorTabela->moveToThread(threadTabela);
+  connect(threadTabela, &QThread::started,
+          geradorTabela, &GeradorTabela::gerar);
+  connect(geradorTabela, &GeradorTabela::signLinhas,
+          this, &MainCircuito::slotLinhasTabela);
+  connect(geradorTabela, &GeradorTabela::signTerminado,
+          this, &MainCircuito::slotTabelaTerminada);
+
+  progressoTabela->setValue(0);
+  progressoTabela->setVisible(true);
+  ui->actionCancelar_tabela->setEnabled(true);
+  threadTabela->start();
+}
 
-  // Recoloca os textos dos cabecalhos na primeira linha
-  // Entradas
-  if (numInputs > 0)
+// Verifica se a tabela verdade pode ser atualizada (em vez de limpa) apos uma alteracao
+bool MainCircuito::prepararAtualizacaoTabela(std::vector<bool>& colunas)
+{
+  const TabelaVerdade& T = modeloTabela->getTabela();
+  // Uma tabela incompleta (ainda em geracao, ou cancelada) nao eh aproveitada:
+  // basta gera-la de novo
+  if (!C.valid() || !T.completa() ||
+      T.getNumInputs()!=C.getNumInputs() || T.getNumOutputs()!=C.getNumOutputs())
   {
-    prov = new QLabel("ENTRADAS");
-    prov->setAlignment(Qt::AlignCenter);
-    prov->setStyleSheet("font-weight: bold");
-    ui->tableTabelaVerdade->setCellWidget(0,0,prov);
+    limparTabelaVerdade();
+    return false;
   }
-  // Saidas
-  if (numOutputs > 0)
+
+  // As linhas filtradas seriam calculadas sobre a tabela sendo alterada
+  // (o filtro eh refeito no final da atualizacao), assim como a gravacao no cache
+  cancelarFiltro();
+  cancelarGravacao();
+  // As colunas que uma atualizacao anterior ainda nao terminou continuam pendentes
+  colunas = colunasAtualizando;
+  colunas.resize(C.getNumOutputs(), false);
+  cancelarTabela();
+  return true;
+}
+
+// Recalcula em segundo plano apenas as colunas de saida marcadas
+void MainCircuito::recalcularColunas(const std::vector<bool>& colunas)
+{
+  bool alguma = false;
+  for (unsigned i=0; i<colunas.size(); i++) alguma = (alguma || colunas[i]);
+  if (!alguma)
   {
-    prov = new QLabel("SAIDAS");
-    prov->setAlignment(Qt::AlignCenter);
-    prov->setStyleSheet("font-weight: bold");
-    ui->tableTabelaVerdade->setCellWidget(0,numInputs,prov);
+    // Nada a recalcular: a tabela jah estah atualizada
+    modeloTabela->setColunasPendentes(std::vector<bool>());
+    if (modeloTabela->getFiltrado()) on_editFiltro_returnPressed();
+    return;
   }
+
+  // O circuito alterado pode ser igual a um jah simulado (por exemplo, ao desfazer
+  // uma alteracao): nesse caso a tabela inteira vem do cache
+  if (lerTabelaCache()) return;
+
+  // As linhas recalculadas substituem apenas essas colunas (ver slotLinhasTabela)
+  execucaoTabela++;
+  colunasAtualizando = colunas;
+  linhaAtualizacao = 0;
+  modeloTabela->setColunasPendentes(colunas);
+  iniciarGeradorTabela(new GeradorTabela(C, colunas, execucaoTabela));
+}
+
+// Interrompe a filtragem em andamento, se houver
+void MainCircuito::cancelarFiltro()
+{
+  if (threadFiltro==nullptr) return;
+  filtrador->cancelar();
+  execucaoFiltro++;
+  encerrarThreadFiltro();
+}
+
+// Espera a thread de filtragem terminar e libera a thread e o filtrador
+void MainCircuito::encerrarThreadFiltro()
+{
+  if (threadFiltro==nullptr) return;
+  threadFiltro->quit();
+  threadFiltro->wait();
+  delete filtrador;
+  delete threadFiltro;
+  filtrador = nullptr;
+  threadFiltro = nullptr;
+  progressoFiltro->setVisible(false);
+  ui->actionCancelar_tabela->setEnabled(threadTabela!=nullptr || threadExportacao!=nullptr);
 }
 
 void MainCircuito::on_actionSair_triggered()
@@ -346,13 +500,95 @@ void MainCircuito::on_actionLer_triggered()
     //ok
     QString fileName = QFileDialog::getOpenFileName(this, tr("Arquivo de circuito"), "../Circuito", tr("Circuitos (*.txt);;Todos (*.*)"));
     if(fileName.isEmpty()) return;
-    if(!C.ler(fileName.toStdString())){
-      QMessageBox msgBox;
-      msgBox.setText("Erro ao ler um circuito a partir do arquivo:\n"+fileName);
-      msgBox.exec();
-      return;
-    }
+
+    // Uma nova leitura substitui a que estiver em andamento
+    cancelarLeitura();
+
+    // O arquivo eh lido em um circuito separado, em outra thread
+    execucaoLeitura++;
+    threadLeitura = new QThread;
+    leitor = new LeitorCircuito(fileName.toStdString(), execucaoLeitura);
+    leitor->moveToThread(threadLeitura);
+    connect(threadLeitura, &QThread::started,
+            leitor, &LeitorCircuito::ler);
+    connect(leitor, &LeitorCircuito::signTerminado,
+            this, &MainCircuito::slotLeituraTerminada);
+
+    progressoLeitura->setValue(0);
+    progressoLeitura->setVisible(true);
+    botaoCancelarLeitura->setVisible(true);
+    timerLeitura->start();
+    threadLeitura->start();
+}
+
+// Atualiza o progresso da leitura em andamento
+void MainCircuito::slotProgressoLeitura()
+{
+  if (leitor==nullptr) return;
+  const ProgressoLeitura& P = leitor->getProgresso();
+  uint64_t total = P.total;
+  if (total>0) progressoLeitura->setValue(int(100*P.lidos/total));
+}
+
+// Recebe o aviso de fim da leitura do arquivo
+void MainCircuito::slotLeituraTerminada(unsigned execucao, bool ok)
+{
+  // Fim de uma leitura cancelada (jah encerrada por cancelarLeitura)
+  if (execucao!=execucaoLeitura) return;
+
+  // O leitor nao mexe mais no circuito lido depois de emitir signTerminado
+  QString fileName = QString::fromStdString(leitor->getArquivo());
+  if (ok)
+  {
+    // O circuito lido passa a ser o circuito atual de uma soh vez (sem copiar as portas);
+    // o circuito antigo fica no leitor e eh destruido junto com ele
+    C.swap(leitor->getCircuito());
+    encerrarThreadLeitura();
     redimensionaTabelas();
+    return;
+  }
+
+  const ResultadoLeitura R = leitor->getResultado();
+  encerrarThreadLeitura();
+  if (!R.erros.empty() && R.erros[0].codigo==ErroLeitura::CANCELADA) return;
+
+  // Exibe os primeiros problemas encontrados, com linha e coluna
+  // (o circuito atual nao foi alterado)
+  QString erros;
+  for (unsigned i=0; i<R.erros.size() && i<10; i++)
+  {
+    std::ostringstream O;
+    O << R.erros[i];
+    erros += "\n" + QString::fromStdString(O.str());
+  }
+  if (R.erros.size()>10) erros += "\n... ("+QString::number(R.erros.size())+" erros)";
+  QMessageBox msgBox;
+  msgBox.setText("Erro ao ler um circuito a partir do arquivo:\n"+fileName+"\n"+erros);
+  msgBox.exec();
+}
+
+// Interrompe a leitura em andamento, se houver
+void MainCircuito::cancelarLeitura()
+{
+  if (threadLeitura==nullptr) return;
+  leitor->cancelar();
+  execucaoLeitura++;
+  encerrarThreadLeitura();
+}
+
+// Espera a thread de leitura terminar e libera a thread e o leitor
+void MainCircuito::encerrarThreadLeitura()
+{
+  if (threadLeitura==nullptr) return;
+  threadLeitura->quit();
+  threadLeitura->wait();
+  delete leitor;
+  delete threadLeitura;
+  leitor = nullptr;
+  threadLeitura = nullptr;
+  timerLeitura->stop();
+  progressoLeitura->setVisible(false);
+  botaoCancelarLeitura->setVisible(false);
 }
 
 // Abre uma caixa de dialogo para salvar um arquivo
@@ -366,13 +602,23 @@ void MainCircuito::on_actionSalvar_triggered()
     return;
   }
 
-  QString fileName = QFileDialog::getSaveFileName(this, tr("Arquivo de circuito"), "../Circuito",
+  // No salvamento incremental, sugere o arquivo de onde o circuito foi lido
+  QString dir = "../Circuito";
+  if (ui->actionSalvamento_incremental->isChecked() && !C.getArqBase().empty())
+  {
+    dir = QString::fromStdString(C.getArqBase());
+  }
+  QString fileName = QFileDialog::getSaveFileName(this, tr("Arquivo de circuito"), dir,
                                                   tr("Circuitos (*.txt);;Todos (*.*)"));
 
   if (!fileName.isEmpty()) {
     //ok
     // Salva o circuito no arquivo com nome "fileName", usando a funcao apropriada da classe Circuito
-    if (!C.salvar(fileName.toStdString()))
+    // (no salvamento incremental, soh as alteracoes sao gravadas, no diario do arquivo)
+    bool ok = (ui->actionSalvamento_incremental->isChecked() ?
+               C.salvarIncremental(fileName.toStdString()) :
+               C.salvar(fileName.toStdString()));
+    if (!ok)
     {
       // Exibe uma msg de erro na leitura
       QMessageBox msgBox;
@@ -382,10 +628,61 @@ void MainCircuito::on_actionSalvar_triggered()
   }
 }
 
+// Abre uma caixa de dialogo para exportar o circuito em Verilog estrutural
+void MainCircuito::on_actionExportar_Verilog_triggered()
+{
+  // Soh pode exportar se o Circuito for valido
+  if (!C.valid()){
+    QMessageBox msgBox;
+    msgBox.setText("O Circuito nao esta completamente definido.\nNao pode ser exportado.");
+    msgBox.exec();
+    return;
+  }
+
+  QString fileName = QFileDialog::getSaveFileName(this, tr("Arquivo Verilog"), "../Circuito",
+                                                  tr("Verilog (*.v);;Todos (*.*)"));
+
+  if (!fileName.isEmpty()) {
+    if (!C.salvarVerilog(fileName.toStdString()))
+    {
+      QMessageBox msgBox;
+      msgBox.setText("Erro ao exportar o circuito para o arquivo:\n"+fileName);
+      msgBox.exec();
+    }
+  }
+}
+
+// Abre uma caixa de dialogo para exportar o circuito no formato .bench (ISCAS)
+void MainCircuito::on_actionExportar_bench_triggered()
+{
+  // Soh pode exportar se o Circuito for valido
+  if (!C.valid()){
+    QMessageBox msgBox;
+    msgBox.setText("O Circuito nao esta completamente definido.\nNao pode ser exportado.");
+    msgBox.exec();
+    return;
+  }
+
+  QString fileName = QFileDialog::getSaveFileName(this, tr("Arquivo .bench"), "../Circuito",
+                                                  tr("ISCAS bench (*.bench);;Todos (*.*)"));
+
+  if (!fileName.isEmpty()) {
+    if (!C.salvarBench(fileName.toStdString()))
+    {
+      QMessageBox msgBox;
+      msgBox.setText("Erro ao exportar o circuito para o arquivo:\n"+fileName);
+      msgBox.exec();
+    }
+  }
+}
+
 // Gera e exibe a tabela verdade para o circuito
 // Chama a funcao simular da classe circuito
 void MainCircuito::on_actionGerar_tabela_triggered()
 {
+  // Uma nova geracao substitui a que estiver em andamento
+  cancelarTabela();
+
   // Soh pode simular se o Circuito for valido
   if (!C.valid()){
     QMessageBox msgBox;
@@ -394,78 +691,377 @@ void MainCircuito::on_actionGerar_tabela_triggered()
     return;
   }
 
-  int numInputs=C.getNumInputs();
-  int numOutputs=C.getNumOutputs();
-  // Calcula o numero de combinacoes de entrada
-  int numCombinacoesEntrada = (numInputs>0 ? round(pow(3,numInputs)) : 0);
+  // Tabelas muito grandes nao sao mantidas em memoria
+  if (!TabelaVerdade::cabeEmMemoria(C.getNumInputs(), C.getNumOutputs())){
+    QMessageBox msgBox;
+    msgBox.setText("A tabela verdade eh grande demais para ser exibida.\n"
+                   "Use a opcao Exportar tabela para gera-la em arquivo.");
+    msgBox.exec();
+    return;
+  }
 
-  // As entradas do circuito
-  std::vector<bool3S> in_circ(numInputs);    // bool3S::UNDEF; bool3S::FALSE; bool3S::TRUE
+  // A tabela fica vazia e as linhas sao acrescentadas aa medida que chegam
+  limparTabelaVerdade();
+
+  // Um circuito com a mesma estrutura jah foi simulado: a tabela vem do cache
+  if (lerTabelaCache()) return;
+
+  // Cria a thread e o gerador (com uma copia do circuito)
+  execucaoTabela++;
+  iniciarGeradorTabela(new GeradorTabela(C, execucaoTabela));
+}
 
-  // Variaveis auxiliares
-  QLabel *prov;
-  int i,j;
+// Procura a tabela verdade do circuito no cache
+bool MainCircuito::lerTabelaCache()
+{
+  TabelaVerdade T;
+  if (!cacheTabelas.buscar(C.impressaoDigital(), T) ||
+      T.getNumInputs()!=C.getNumInputs() || T.getNumOutputs()!=C.getNumOutputs()) return false;
+  bool filtrado = modeloTabela->getFiltrado();
+  cancelarGravacao();
+  modeloTabela->setTabela(std::move(T));
+  // O filtro eh refeito sobre a nova tabela
+  if (filtrado) on_editFiltro_returnPressed();
+  statusBar()->showMessage("Tabela verdade lida do cache", 5000);
+  return true;
+}
+
+// Interrompe a geracao da tabela verdade, a filtragem e a exportacao em andamento
+void MainCircuito::on_actionCancelar_tabela_triggered()
+{
+  cancelarExportacao();
+  cancelarFiltro();
+  // Uma atualizacao interrompida deixaria colunas desatualizadas na tabela
+  if (!colunasAtualizando.empty()) limparTabelaVerdade();
+  else cancelarTabela();
+}
 
-  // Inicializa todas as entradas com bool3S::UNDEF
-  for (i=0; i<numInputs; i++) in_circ[i] = bool3S::UNDEF;
+// Apaga todas as tabelas verdade guardadas no cache
+void MainCircuito::on_actionLimpar_cache_triggered()
+{
+  cacheTabelas.limpar();
+  statusBar()->showMessage("Cache de tabelas verdade apagado", 5000);
+}
 
-  //
-  // Gera todas as combinacoes de entrada e as linhas correspondentes da tabela verdade
-  //
-  for (i=0; i<numCombinacoesEntrada; i++)
+// Exibe os contadores da simulacao
+void MainCircuito::on_actionEstatisticas_triggered()
+{
+  std::ostringstream O;
+  if (!SimStats::ATIVAS)
   {
-    //
-    // Exibe a i-esima combinao de entrada
-    //
+    estatisticasTabela.imprimir(O);
+  }
+  else
+  {
+    O << "GERACAO DA TABELA VERDADE\n";
+    estatisticasTabela.imprimir(O);
+    O << "\nSIMULACAO INTERATIVA\n";
+    simulador.getEstatisticas().imprimir(O);
+  }
+  QMessageBox msgBox(this);
+  msgBox.setWindowTitle("Estatisticas da simulacao");
+  msgBox.setText(QString::fromStdString(O.str()));
+  msgBox.exec();
+}
 
-    // Cria os QLabels correspondentes aas entradas in_circ[j]
-    for (j=0; j<numInputs; j++)
-    {
-      prov = new QLabel( QString( toChar(in_circ[j]) ) );
-      prov->setAlignment(Qt::AlignCenter);
-      ui->tableTabelaVerdade->setCellWidget(i+1, j, prov);
-    }
+// Abre ou fecha o painel da simulacao interativa
+void MainCircuito::slotSimulacaoInterativa(bool)
+{
+  atualizarSimulacao();
+}
 
-    //
-    // Simula a saida para a i-esima combinacao de entrada
-    //
+// Reexibe os valores das portas e saidas depois que uma entrada foi alterada
+// (soh as linhas visiveis das tabelas sao lidas de novo)
+void MainCircuito::slotEntradaAlterada(int IdInput, unsigned avaliadas)
+{
+  modeloPortas->valoresAlterados();
+  modeloSaidas->valoresAlterados();
+  ui->labelSimulacao->setText("E"+QString::number(-IdInput)+" = "+
+                              QString(QChar(toChar(simulador.getInput(IdInput))))+": "+
+                              QString::number(avaliadas)+" portas recalculadas");
+}
 
-    // Chama o metodo de simulacao da classe Circuito
-     if(!C.simular(in_circ)){
-         QMessageBox msgBox;
-         msgBox.setText("O Circuito nao pode ser simulado.");
-         msgBox.exec();
-         return;
-     }
+// Exibe o esquematico do circuito (janela nao modal)
+void MainCircuito::on_actionEsquematico_triggered()
+{
+  janelaEsquematico->setCircuito(C);
+  janelaEsquematico->show();
+  janelaEsquematico->raise();
+  janelaEsquematico->activateWindow();
+}
 
-    //
-    // Exibe a saida correspondente aa i-esima combinacao de entrada
-    //
+// Recebe mais um bloco de linhas da tabela verdade em geracao
+void MainCircuito::slotLinhasTabela(unsigned execucao, QByteArray valores)
+{
+  // Bloco de uma geracao cancelada
+  if (execucao!=execucaoTabela) return;
 
-    // Cria os QLabels correspondentes aas saidas outputs[j]
-    for (j=0; j<numOutputs; j++)
-    {
-      // A saida deve ser obtida com um metodo de consulta da classe Circuito
-      bool3S output = C.getOutput(j+1);
-      prov = new QLabel( QString( toChar(output) ) );
-      prov->setAlignment(Qt::AlignCenter);
-      ui->tableTabelaVerdade->setCellWidget(i+1, j+numInputs, prov);
-    }
+  const TabelaVerdade& T = modeloTabela->getTabela();
+  unsigned bl = bytesPorLinha(T.getNumOutputs());
+  if (!colunasAtualizando.empty())
+  {
+    // Atualizacao: as linhas jah existem, soh as colunas recalculadas sao copiadas
+    uint64_t n = uint64_t(valores.size())/bl;
+    modeloTabela->atualizarColunas(linhaAtualizacao, n, colunasAtualizando,
+                                   (const uint8_t*)valores.constData());
+    linhaAtualizacao += n;
+    progressoTabela->setValue(int(100*linhaAtualizacao/T.getNumLinhasTotal()));
+    return;
+  }
+  modeloTabela->acrescentarLinhas((const uint8_t*)valores.constData(), uint64_t(valores.size())/bl);
+  if (T.getNumLinhasTotal()>0)
+  {
+    progressoTabela->setValue(int(100*T.getNumLinhas()/T.getNumLinhasTotal()));
+  }
+}
+
+// Recebe o aviso de fim da geracao da tabela verdade
+void MainCircuito::slotTabelaTerminada(unsigned execucao, bool ok)
+{
+  // Fim de uma geracao cancelada (jah encerrada por cancelarTabela)
+  if (execucao!=execucaoTabela) return;
+
+  bool atualizacao = !colunasAtualizando.empty();
+  colunasAtualizando.clear();
+  // O gerador nao simula mais nada depois de emitir signTerminado
+  estatisticasTabela = geradorTabela->getEstatisticas();
+  encerrarThreadTabela();
+  if (!ok){
+    QMessageBox msgBox;
+    msgBox.setText("O Circuito nao pode ser simulado.");
+    msgBox.exec();
+    limparTabelaVerdade();
+    return;
+  }
+  // A tabela completa fica guardada no cache, para a proxima vez que o mesmo circuito
+  // for simulado (em segundo plano: o arquivo pode ter centenas de MB)
+  iniciarGravacaoCache();
+  if (atualizacao){
+    modeloTabela->setColunasPendentes(std::vector<bool>());
+    // O filtro eh refeito sobre a tabela atualizada
+    if (modeloTabela->getFiltrado()) on_editFiltro_returnPressed();
+  }
+}
 
-    // Gera a proxima combinacao de entrada
+// Aplica o filtro digitado sobre a tabela verdade
+void MainCircuito::on_editFiltro_returnPressed()
+{
+  // Um novo filtro substitui o que estiver em andamento
+  cancelarFiltro();
 
-    // Incrementa a ultima entrada que nao for TRUE
-    // Se a ultima for TRUE, faz essa ser UNDEF e tenta incrementar a anterior
-    j = numInputs-1;
-    while (in_circ[j]==bool3S::TRUE && j>=0)
-    {
-      in_circ[j] = bool3S::UNDEF;
-      j--;
-    };
-    // Incrementa a input selecionada
-    if (j>=0) in_circ[j]++;
+  // Filtro vazio: volta a exibir todas as linhas
+  QString texto = ui->editFiltro->text().trimmed();
+  if (texto.isEmpty()){
+    modeloTabela->setFiltrado(false);
+    return;
   }
 
+  // Soh pode filtrar se o Circuito for valido
+  if (!C.valid()){
+    QMessageBox msgBox;
+    msgBox.setText("O Circuito nao esta completamente definido.\nNao pode ser simulado.");
+    msgBox.exec();
+    return;
+  }
+
+  FiltroTabela F;
+  std::string erro;
+  if (!F.compilar(texto.toStdString(), C.getNumInputs(), C.getNumOutputs(), erro)){
+    QMessageBox msgBox;
+    msgBox.setText("Filtro invalido:\n"+QString::fromStdString(erro));
+    msgBox.exec();
+    return;
+  }
+
+  // Se a tabela completa jah estah em memoria, o filtro eh avaliado sobre ela;
+  // caso contrario, as linhas sao simuladas pelo filtrador (sem gerar a tabela inteira)
+  const TabelaVerdade& T = modeloTabela->getTabela();
+  modeloTabela->setFiltrado(true);
+  execucaoFiltro++;
+  threadFiltro = new QThread;
+  // (durante uma atualizacao de colunas a tabela eh alterada, e as linhas sao simuladas)
+  bool usaTabela = (T.completa() && colunasAtualizando.empty());
+  filtrador = new FiltradorTabela(F, (usaTabela ? &T : nullptr), C, execucaoFiltro);
+  filtrador->moveToThread(threadFiltro);
+  connect(threadFiltro, &QThread::started,
+          filtrador, &FiltradorTabela::filtrar);
+  connect(filtrador, &FiltradorTabela::signFiltradas,
+          this, &MainCircuito::slotLinhasFiltradas);
+  connect(filtrador, &FiltradorTabela::signTerminado,
+          this, &MainCircuito::slotFiltroTerminado);
+
+  progressoFiltro->setValue(0);
+  progressoFiltro->setVisible(true);
+  ui->actionCancelar_tabela->setEnabled(true);
+  threadFiltro->start();
+}
+
+// Recebe mais um bloco de linhas aceitas pelo filtro
+void MainCircuito::slotLinhasFiltradas(unsigned execucao, QByteArray linhas, QByteArray valores,
+                                       quint64 percorridas)
+{
+  // Bloco de uma filtragem cancelada
+  if (execucao!=execucaoFiltro) return;
+
+  // Copia os numeros das linhas (os bytes do QByteArray podem nao estar alinhados)
+  std::vector<uint64_t> numeros(linhas.size()/sizeof(uint64_t));
+  if (!numeros.empty()) memcpy(numeros.data(), linhas.constData(), numeros.size()*sizeof(uint64_t));
+  modeloTabela->acrescentarFiltradas(numeros.data(), (const uint8_t*)valores.constData(),
+                                     numeros.size());
+  uint64_t total = numLinhasTabela(C.getNumInputs());
+  progressoFiltro->setValue(int(100*percorridas/total));
+}
+
+// Recebe o aviso de fim da filtragem
+void MainCircuito::slotFiltroTerminado(unsigned execucao, bool ok)
+{
+  // Fim de uma filtragem cancelada (jah encerrada por cancelarFiltro)
+  if (execucao!=execucaoFiltro) return;
+
+  encerrarThreadFiltro();
+  if (!ok){
+    QMessageBox msgBox;
+    msgBox.setText("O Circuito nao pode ser simulado.");
+    msgBox.exec();
+    return;
+  }
+  statusBar()->showMessage(QString::number(modeloTabela->rowCount())+
+                           " linhas aceitas pelo filtro", 5000);
+}
+
+// Gera a tabela verdade completa diretamente em um arquivo de tabela mapeada
+void MainCircuito::on_actionExportar_tabela_triggered()
+{
+  // Soh pode simular se o Circuito for valido
+  if (!C.valid()){
+    QMessageBox msgBox;
+    msgBox.setText("O Circuito nao esta completamente definido.\nNao pode ser simulado.");
+    msgBox.exec();
+    return;
+  }
+
+  QString fileName = QFileDialog::getSaveFileName(this, tr("Arquivo de tabela verdade"), "../Circuito",
+                                                  tr("Tabelas verdade (*.tvd);;Todos (*.*)"));
+
+  if (!fileName.isEmpty()) {
+    // Uma nova exportacao substitui a que estiver em andamento
+    cancelarExportacao();
+
+    // A tabela eh gerada em segundo plano (com uma copia do circuito); se jah estiver
+    // no cache, o arquivo eh apenas copiado
+    execucaoExportacao++;
+    threadExportacao = new QThread;
+    exportador = new ExportadorTabela(C, fileName.toStdString(), cacheTabelas,
+                                      execucaoExportacao);
+    exportador->moveToThread(threadExportacao);
+    connect(threadExportacao, &QThread::started,
+            exportador, &ExportadorTabela::exportar);
+    connect(exportador, &ExportadorTabela::signTerminado,
+            this, &MainCircuito::slotExportacaoTerminada);
+
+    progressoExportacao->setValue(0);
+    progressoExportacao->setVisible(true);
+    ui->actionCancelar_tabela->setEnabled(true);
+    timerExportacao->start();
+    threadExportacao->start();
+  }
+}
+
+// Atualiza o progresso da exportacao em andamento
+void MainCircuito::slotProgressoExportacao()
+{
+  if (exportador==nullptr) return;
+  const ProgressoTabela& P = exportador->getProgresso();
+  uint64_t total = P.total;
+  if (total>0) progressoExportacao->setValue(int(100*P.linhas/total));
+}
+
+// Recebe o aviso de fim da exportacao da tabela verdade
+void MainCircuito::slotExportacaoTerminada(unsigned execucao, bool ok)
+{
+  // Fim de uma exportacao cancelada (jah encerrada por cancelarExportacao)
+  if (execucao!=execucaoExportacao) return;
+
+  QString fileName = QString::fromStdString(exportador->getArquivo());
+  encerrarThreadExportacao();
+  if (!ok)
+  {
+    QMessageBox msgBox;
+    msgBox.setText("Erro ao gerar a tabela verdade no arquivo:\n"+fileName);
+    msgBox.exec();
+    return;
+  }
+  statusBar()->showMessage("Tabela verdade exportada para "+fileName, 5000);
+}
+
+// Guarda no cache, em segundo plano, a tabela verdade completa exibida
+void MainCircuito::iniciarGravacaoCache()
+{
+  cancelarGravacao();
+  execucaoGravacao++;
+  threadGravacao = new QThread;
+  gravador = new GravadorCache(&modeloTabela->getTabela(), C.impressaoDigital(), cacheTabelas,
+                               execucaoGravacao);
+  gravador->moveToThread(threadGravacao);
+  connect(threadGravacao, &QThread::started,
+          gravador, &GravadorCache::gravar);
+  connect(gravador, &GravadorCache::signTerminado,
+          this, &MainCircuito::slotGravacaoTerminada);
+  threadGravacao->start();
+}
+
+// Recebe o aviso de fim da gravacao da tabela verdade no cache
+void MainCircuito::slotGravacaoTerminada(unsigned execucao, bool)
+{
+  // Fim de uma gravacao cancelada (jah encerrada por cancelarGravacao)
+  if (execucao!=execucaoGravacao) return;
+  // Uma tabela que nao foi guardada sera simplesmente gerada de novo
+  encerrarThreadGravacao();
+}
+
+// Interrompe a gravacao no cache em andamento, se houver
+void MainCircuito::cancelarGravacao()
+{
+  if (threadGravacao==nullptr) return;
+  gravador->cancelar();
+  execucaoGravacao++;
+  encerrarThreadGravacao();
+}
+
+// Espera a thread de gravacao terminar e libera a thread e o gravador
+void MainCircuito::encerrarThreadGravacao()
+{
+  if (threadGravacao==nullptr) return;
+  threadGravacao->quit();
+  threadGravacao->wait();
+  delete gravador;
+  delete threadGravacao;
+  gravador = nullptr;
+  threadGravacao = nullptr;
+}
+
+// Interrompe a exportacao em andamento, se houver (o arquivo incompleto eh apagado)
+void MainCircuito::cancelarExportacao()
+{
+  if (threadExportacao==nullptr) return;
+  exportador->cancelar();
+  execucaoExportacao++;
+  encerrarThreadExportacao();
+}
+
+// Espera a thread de exportacao terminar e libera a thread e o exportador
+void MainCircuito::encerrarThreadExportacao()
+{
+  if (threadExportacao==nullptr) return;
+  threadExportacao->quit();
+  threadExportacao->wait();
+  delete exportador;
+  delete threadExportacao;
+  exportador = nullptr;
+  threadExportacao = nullptr;
+  timerExportacao->stop();
+  progressoExportacao->setVisible(false);
+  ui->actionCancelar_tabela->setEnabled(threadTabela!=nullptr || threadFiltro!=nullptr);
 }
 
 // Exibe a caixa de dialogo para fixar caracteristicas de uma porta
@@ -481,17 +1077,16 @@ void MainCircuito::on_tablePortas_activated(const QModelIndex &index)
   int numInputsPort = C.getNumInputsPort(idPort);
 
   // As id das entradas da porta
-  int idInputPort[4];
-  // Esses valores (idInputPorta[])
+  // Esses valores (idInputPort[])
   // devem ser lidos a partir de metodos de consulta da classe Circuito
+  QVector<int> idInputPort(numInputsPort);
   for (int j=0; j<numInputsPort; j++)
   {
     idInputPort[j] = C.getId_inPort(idPort, j);
   }
 
   // Informa as caracteristicas atuais da porta (emit signShowModificarPorta)
-  emit signShowModificarPorta(idPort, namePort, numInputsPort,
-                              idInputPort[0],idInputPort[1],idInputPort[2],idInputPort[3]);
+  emit signShowModificarPorta(idPort, namePort, idInputPort);
 }
 
 // Exibe a caixa de dialogo para fixar caracteristicas de uma saida
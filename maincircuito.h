@@ -3,10 +3,23 @@
 
 #include <QMainWindow>
 #include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTimer>
+#include <QThread>
+#include <QByteArray>
+#include <QVector>
 #include "newcircuito.h"
 #include "modificarporta.h"
 #include "modificarsaida.h"
 #include "circuito.h"
+#include "modelotabela.h"
+#include "cachetabelas.h"
+#include "leitorcircuito.h"
+#include "modelocircuito.h"
+#include "simuladorincremental.h"
+#include "geradortabela.h"
+#include "esquematico.h"
 
 
 /* ======================================================================== *
@@ -30,8 +43,8 @@ private slots:
   void slotNewCircuito(int NInputs, int NOutputs, int NPortas);
 
   // Modifica uma porta
-  void slotModificarPorta(int IdPort, QString TipoPort, int NumInputsPort,
-                          int IdInput0, int IdInput1, int IdInput2, int IdInput3);
+  // (o numero de entradas da porta eh o tamanho de IdInputs)
+  void slotModificarPorta(int IdPort, QString TipoPort, QVector<int> IdInputs);
 
   // Modifica uma saida
   void slotModificarSaida(int idSaida, int idOrigemSaida);
@@ -43,15 +56,84 @@ private slots:
   void on_actionNovo_triggered();
 
   // Abre uma caixa de dialogo para ler um arquivo
+  // O arquivo eh lido em segundo plano (LeitorCircuito), com o progresso na barra de
+  // status; o circuito atual soh eh substituido se a leitura der certo
   void on_actionLer_triggered();
 
+  // Atualiza o progresso da leitura em andamento (chamada periodicamente por timerLeitura)
+  void slotProgressoLeitura();
+
+  // Recebe o aviso de fim da leitura do arquivo
+  void slotLeituraTerminada(unsigned execucao, bool ok);
+
   // Abre uma caixa de dialogo para salvar um arquivo
   void on_actionSalvar_triggered();
 
+  // Abrem uma caixa de dialogo para exportar o circuito em Verilog estrutural
+  // ou no formato .bench (ISCAS)
+  void on_actionExportar_Verilog_triggered();
+  void on_actionExportar_bench_triggered();
+
   // Gera e exibe a tabela verdade para o circuito
-  // Chama a funcao simular da classe circuito
+  // A geracao eh feita em segundo plano (GeradorTabela), e as linhas sao exibidas
+  // aa medida que chegam (slotLinhasTabela)
   void on_actionGerar_tabela_triggered();
 
+  // Interrompe a geracao da tabela verdade, a filtragem e a exportacao em andamento
+  // As linhas jah calculadas (ou filtradas) continuam sendo exibidas
+  void on_actionCancelar_tabela_triggered();
+
+  // Apaga todas as tabelas verdade guardadas no cache
+  void on_actionLimpar_cache_triggered();
+
+  // Exibe os contadores da ultima geracao da tabela verdade e da simulacao interativa
+  // (soh se o nucleo foi compilado com CIRCUITO_ESTATISTICAS)
+  void on_actionEstatisticas_triggered();
+
+  // Exibe o esquematico do circuito (janela nao modal)
+  void on_actionEsquematico_triggered();
+
+  // Abre ou fecha o painel da simulacao interativa
+  void slotSimulacaoInterativa(bool aberto);
+
+  // Reexibe os valores das portas e saidas depois que uma entrada do painel da
+  // simulacao interativa foi alterada
+  void slotEntradaAlterada(int IdInput, unsigned avaliadas);
+
+  // Recebe mais um bloco de linhas da tabela verdade em geracao
+  void slotLinhasTabela(unsigned execucao, QByteArray valores);
+
+  // Recebe o aviso de fim da geracao da tabela verdade
+  void slotTabelaTerminada(unsigned execucao, bool ok);
+
+  // Aplica o filtro digitado: passa a exibir apenas as linhas aceitas por ele
+  // (ou todas as linhas, se o filtro estiver vazio)
+  // A filtragem eh feita em segundo plano (FiltradorTabela)
+  void on_editFiltro_returnPressed();
+
+  // Recebe mais um bloco de linhas aceitas pelo filtro
+  void slotLinhasFiltradas(unsigned execucao, QByteArray linhas, QByteArray valores,
+                           quint64 percorridas);
+
+  // Recebe o aviso de fim da filtragem
+  void slotFiltroTerminado(unsigned execucao, bool ok);
+
+  // Gera a tabela verdade completa diretamente em um arquivo de tabela mapeada
+  // (ver TabelaMapeada), sem exibi-la
+  // A geracao eh feita em segundo plano (ExportadorTabela), com o progresso na barra
+  // de status, e pode ser interrompida por actionCancelar_tabela
+  void on_actionExportar_tabela_triggered();
+
+  // Atualiza o progresso da exportacao em andamento (chamada periodicamente por
+  // timerExportacao)
+  void slotProgressoExportacao();
+
+  // Recebe o aviso de fim da exportacao da tabela verdade
+  void slotExportacaoTerminada(unsigned execucao, bool ok);
+
+  // Recebe o aviso de fim da gravacao da tabela verdade no cache
+  void slotGravacaoTerminada(unsigned execucao, bool ok);
+
   // Exibe a caixa de dialogo para fixar caracteristicas de uma porta
   void on_tablePortas_activated(const QModelIndex &index);
 
@@ -66,8 +148,7 @@ signals:
   // Sinaliza a necessidade de exibicao da janela de novo circuito
   void signShowNewCircuito();
   // Sinaliza a necessidade de exibicao da janela de modificar porta
-  void signShowModificarPorta(int IdPort, QString TipoPort, int NumInputsPort,
-                              int IdInput0, int IdInput1, int IdInput2, int IdInput3);
+  void signShowModificarPorta(int IdPort, QString TipoPort, QVector<int> IdInputs);
   // Sinaliza a necessidade de exibicao da janela de modificar saida
   void signShowModificarSaida(int IdSaida, int IdOrigemSaida);
 
@@ -75,6 +156,8 @@ private:
   Ui::MainCircuito *ui;
 
   Circuito C;
+  // A simulacao interativa do circuito C (vazio se o painel estiver fechado)
+  SimuladorIncremental simulador;
   // Os exibidores dos valores na barra de status
   QLabel *numIn;     // Exibe o numero de entradas do circuito na barra de status
   QLabel *numOut;    // Exibe o numero de saidas do circuito na barra de status
@@ -85,22 +168,119 @@ private:
   ModificarPorta *modificarPorta;  // Caixa de dialogo para modificar uma porta
   ModificarSaida *modificarSaida;  // Caixa de dialogo para modificar uma saida
 
+  // A janela (nao modal) do esquematico do circuito
+  JanelaEsquematico *janelaEsquematico;
+
+  // Os modelos que exibem as portas (em tablePortas) e as saidas (em tableSaidas)
+  // lendo os valores diretamente do circuito C
+  ModeloPortas *modeloPortas;
+  ModeloSaidas *modeloSaidas;
+  // O modelo das entradas da simulacao interativa (em tableEntradas)
+  ModeloEntradas *modeloEntradas;
+
+  // O modelo que guarda e exibe a tabela verdade (em tableTabelaVerdade)
+  ModeloTabelaVerdade *modeloTabela;
+
+  // A geracao da tabela verdade em segundo plano
+  QThread *threadTabela;          // A thread da geracao em andamento (nullptr se nenhuma)
+  GeradorTabela *geradorTabela;   // O objeto que gera as linhas, na threadTabela
+  unsigned execucaoTabela;        // O numero da geracao atual (os blocos de outras sao ignorados)
+  QProgressBar *progressoTabela;  // Exibe o progresso da geracao na barra de status
+  // Depois de uma alteracao no circuito, a geracao pode recalcular apenas algumas saidas
+  // de uma tabela jah completa: as colunas recalculadas (vazio se geracao normal) e a
+  // proxima linha a ser atualizada
+  std::vector<bool> colunasAtualizando;
+  uint64_t linhaAtualizacao;
+  // Os contadores da simulacao da ultima geracao da tabela verdade terminada
+  SimStats estatisticasTabela;
+
+  // A leitura de arquivo de circuito em segundo plano
+  QThread *threadLeitura;              // A thread da leitura em andamento (nullptr se nenhuma)
+  LeitorCircuito *leitor;              // O objeto que leh o arquivo, na threadLeitura
+  unsigned execucaoLeitura;            // O numero da leitura atual
+  QProgressBar *progressoLeitura;      // Exibe o progresso (bytes lidos) na barra de status
+  QPushButton *botaoCancelarLeitura;   // Interrompe a leitura (na barra de status)
+  QTimer *timerLeitura;                // Atualiza progressoLeitura durante a leitura
+
+  // O cache em disco das tabelas verdade jah geradas (indexado pela impressao digital)
+  CacheTabelas cacheTabelas;
+
+  // A filtragem da tabela verdade em segundo plano (mesmo esquema da geracao)
+  QThread *threadFiltro;          // A thread da filtragem em andamento (nullptr se nenhuma)
+  FiltradorTabela *filtrador;     // O objeto que filtra as linhas, na threadFiltro
+  unsigned execucaoFiltro;        // O numero da filtragem atual
+  QProgressBar *progressoFiltro;  // Exibe o progresso da filtragem na barra de status
+
+  // A exportacao da tabela verdade para arquivo em segundo plano (mesmo esquema da leitura)
+  QThread *threadExportacao;           // A thread da exportacao em andamento (nullptr se nenhuma)
+  ExportadorTabela *exportador;        // O objeto que gera o arquivo, na threadExportacao
+  unsigned execucaoExportacao;         // O numero da exportacao atual
+  QProgressBar *progressoExportacao;   // Exibe o progresso (linhas gravadas) na barra de status
+  QTimer *timerExportacao;             // Atualiza progressoExportacao durante a exportacao
+
+  // A gravacao no cache da tabela verdade recem-gerada, em segundo plano
+  // (a tabela exibida eh lida pelo gravador: deve ser cancelada antes de alterar a tabela)
+  QThread *threadGravacao;             // A thread da gravacao em andamento (nullptr se nenhuma)
+  GravadorCache *gravador;             // O objeto que grava a tabela, na threadGravacao
+  unsigned execucaoGravacao;           // O numero da gravacao atual
+
   // Redimensiona todas as tabelas e reexibe todos os valores da barra de status
   // Essa funcao deve ser chamada sempre que mudar o circuito (digitar ou ler de arquivo)
   void redimensionaTabelas();
 
-  // Exibe os dados da i-esima porta
-  // Essa funcao deve ser chamada sempre que mudar caracteristicas da porta
-  // A funcao redimensiona_tabela jah chama essa funcao para todas as portas
-  void showPort(unsigned i);
+  // Redesenha o esquematico, se estiver aberto
+  // Deve ser chamada sempre que o circuito for alterado
+  void atualizarEsquematico();
 
-  // Exibe os dados da i-esima saida
-  // Essa funcao deve ser chamada sempre que mudar valores da saida
-  // A funcao redimensiona_tabela jah chama essa funcao para todas as saidas
-  void showOutput(unsigned i);
+  // Monta de novo o simulador da simulacao interativa (mantendo as entradas), se o
+  // painel estiver aberto, e reexibe os valores
+  // Deve ser chamada sempre que o circuito for alterado
+  void atualizarSimulacao();
 
   // Limpa o resultado da simulacao (tabela verdade)
+  // Cancela a geracao e a filtragem da tabela, se houver alguma em andamento
   void limparTabelaVerdade();
+
+  // Interrompe a geracao da tabela verdade em andamento, se houver, e espera a thread terminar
+  // Os blocos de linhas que ainda estiverem a caminho serao ignorados
+  void cancelarTabela();
+
+  // Espera a thread de geracao terminar e libera a thread e o gerador
+  void encerrarThreadTabela();
+
+  // O mesmo, para a filtragem da tabela verdade
+  void cancelarFiltro();
+  void encerrarThreadFiltro();
+
+  // O mesmo, para a leitura de arquivo (o circuito atual nao eh alterado)
+  void cancelarLeitura();
+  void encerrarThreadLeitura();
+
+  // O mesmo, para a exportacao da tabela verdade (o arquivo incompleto eh apagado)
+  void cancelarExportacao();
+  void encerrarThreadExportacao();
+
+  // Inicia em segundo plano a gravacao no cache da tabela verdade completa exibida
+  // (cancelarGravacao e encerrarThreadGravacao: o mesmo que os anteriores)
+  void iniciarGravacaoCache();
+  void cancelarGravacao();
+  void encerrarThreadGravacao();
+
+  // Se a tabela verdade do circuito atual estiver no cache, passa a exibi-la
+  // Retorna true se a encontrou
+  bool lerTabelaCache();
+
+  // Inicia a thread de geracao com o gerador G
+  void iniciarGeradorTabela(GeradorTabela *G);
+
+  // Atualizacao incremental da tabela verdade, depois de alterada uma porta ou saida:
+  // Verifica se a tabela atual pode ser aproveitada (completa e com as dimensoes do
+  // circuito). Se nao puder, limpa a tabela e retorna false. Se puder, interrompe a
+  // filtragem e a atualizacao em andamento e retorna em colunas as saidas que ainda
+  // precisam ser recalculadas (as que a atualizacao interrompida nao terminou)
+  bool prepararAtualizacaoTabela(std::vector<bool>& colunas);
+  // Recalcula em segundo plano apenas as saidas marcadas em colunas
+  void recalcularColunas(const std::vector<bool>& colunas);
 };
 
 #endif // MAINCIRCUITO_H
@@ -0,0 +1,235 @@
+#include "modelocircuito.h"
+#include <QColor>
+
+// O texto e a cor de um valor da simulacao interativa (os mesmos da tabela verdade)
+static QVariant dadoValor(bool3S B, int role)
+{
+  static const QColor cores[3] = {QColor(128,128,128), QColor(170,0,0), QColor(0,120,0)};
+  if (role==Qt::DisplayRole) return QString(QChar(toChar(B)));
+  if (role==Qt::ForegroundRole) return cores[int(B)];
+  return QVariant();
+}
+
+/* ======================================================================== *
+ * CLASSE MODELOPORTAS                                                      *
+ * ======================================================================== */
+
+// Numero minimo de colunas de entradas (o mesmo da tabela original)
+static const int MIN_ENTRADAS = 4;
+
+ModeloPortas::ModeloPortas(const Circuito& Circ, const SimuladorIncremental& Sim, QObject *parent) :
+  QAbstractTableModel(parent),
+  C(Circ),
+  S(Sim),
+  maxEntradas(MIN_ENTRADAS)
+{
+}
+
+void ModeloPortas::recarregar()
+{
+  beginResetModel();
+  maxEntradas = MIN_ENTRADAS;
+  for (int id=1; id<=int(C.getNumPorts()); id++)
+  {
+    if (int(C.getNumInputsPort(id)) > maxEntradas) maxEntradas = C.getNumInputsPort(id);
+  }
+  endResetModel();
+}
+
+void ModeloPortas::portaAlterada(int IdPort)
+{
+  if (!C.validIdPort(IdPort)) return;
+  // Se a porta passou a ter mais entradas que todas as outras, cria as colunas que faltam
+  int numInputs = C.getNumInputsPort(IdPort);
+  if (numInputs > maxEntradas)
+  {
+    beginInsertColumns(QModelIndex(), 3+maxEntradas, 3+numInputs-1);
+    maxEntradas = numInputs;
+    endInsertColumns();
+  }
+  emit dataChanged(index(IdPort-1, 0), index(IdPort-1, columnCount()-1));
+}
+
+void ModeloPortas::valoresAlterados()
+{
+  // A view soh vai ler novamente as linhas visiveis
+  if (rowCount()>0) emit dataChanged(index(0, 0), index(rowCount()-1, 0));
+}
+
+int ModeloPortas::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return int(C.getNumPorts());
+}
+
+int ModeloPortas::columnCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return 3+maxEntradas;
+}
+
+QVariant ModeloPortas::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid()) return QVariant();
+  if (role==Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+  int idPort = index.row()+1;
+  int coluna = index.column();
+  // Coluna 0: o valor na simulacao interativa
+  if (coluna==0)
+  {
+    if (!S.montado()) return QVariant();
+    return dadoValor(S.getOutputPort(idPort), role);
+  }
+  if (role!=Qt::DisplayRole) return QVariant();
+
+  // Porta ainda nao definida: soh exibe o tipo (??)
+  if (coluna==1) return QString::fromStdString(C.getNamePort(idPort));
+  if (!C.definedPort(idPort)) return QVariant();
+  int numInputs = C.getNumInputsPort(idPort);
+  if (coluna==2) return numInputs;
+  // Colunas 3 em diante: as entradas
+  if (coluna-3 < numInputs) return C.getId_inPort(idPort, coluna-3);
+  return QVariant();
+}
+
+QVariant ModeloPortas::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (role!=Qt::DisplayRole) return QVariant();
+  // Cabecalho vertical: a id da porta
+  if (orientation==Qt::Vertical) return section+1;
+  if (section==0) return QString("VALOR");
+  if (section==1) return QString("TIPO");
+  if (section==2) return QString("NUM\nENTR");
+  return "ENTR\n"+QString::number(section-2);
+}
+
+/* ======================================================================== *
+ * CLASSE MODELOSAIDAS                                                      *
+ * ======================================================================== */
+
+ModeloSaidas::ModeloSaidas(const Circuito& Circ, const SimuladorIncremental& Sim, QObject *parent) :
+  QAbstractTableModel(parent),
+  C(Circ),
+  S(Sim)
+{
+}
+
+void ModeloSaidas::recarregar()
+{
+  beginResetModel();
+  endResetModel();
+}
+
+void ModeloSaidas::saidaAlterada(int IdOut)
+{
+  if (!C.validIdOutput(IdOut)) return;
+  emit dataChanged(index(IdOut-1, 0), index(IdOut-1, 1));
+}
+
+void ModeloSaidas::valoresAlterados()
+{
+  if (rowCount()>0) emit dataChanged(index(0, 0), index(rowCount()-1, 0));
+}
+
+int ModeloSaidas::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return int(C.getNumOutputs());
+}
+
+int ModeloSaidas::columnCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return 2;
+}
+
+QVariant ModeloSaidas::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid()) return QVariant();
+  if (role==Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+  // Coluna 0: o valor na simulacao interativa
+  if (index.column()==0)
+  {
+    if (!S.montado()) return QVariant();
+    return dadoValor(S.getOutput(index.row()+1), role);
+  }
+  if (role!=Qt::DisplayRole) return QVariant();
+  return C.getIdOutput(index.row()+1);
+}
+
+QVariant ModeloSaidas::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (role!=Qt::DisplayRole) return QVariant();
+  if (orientation==Qt::Vertical) return section+1;
+  if (section==0) return QString("VALOR");
+  return QString("ORIG\nSAIDA");
+}
+
+/* ======================================================================== *
+ * CLASSE MODELOENTRADAS                                                    *
+ * ======================================================================== */
+
+ModeloEntradas::ModeloEntradas(SimuladorIncremental& Sim, QObject *parent) :
+  QAbstractTableModel(parent),
+  S(Sim)
+{
+}
+
+void ModeloEntradas::recarregar()
+{
+  beginResetModel();
+  endResetModel();
+}
+
+int ModeloEntradas::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return int(S.getNumInputs());
+}
+
+int ModeloEntradas::columnCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return 1;
+}
+
+QVariant ModeloEntradas::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid()) return QVariant();
+  bool3S B = S.getInput(-(index.row()+1));
+  if (role==Qt::CheckStateRole)
+  {
+    if (B==bool3S::TRUE) return int(Qt::Checked);
+    if (B==bool3S::FALSE) return int(Qt::Unchecked);
+    return int(Qt::PartiallyChecked);
+  }
+  if (role==Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+  return dadoValor(B, role);
+}
+
+bool ModeloEntradas::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+  if (!index.isValid() || role!=Qt::CheckStateRole) return false;
+  int estado = value.toInt();
+  bool3S B = (estado==int(Qt::Checked) ? bool3S::TRUE :
+              estado==int(Qt::Unchecked) ? bool3S::FALSE : bool3S::UNDEF);
+  int idInput = -(index.row()+1);
+  unsigned avaliadas = S.setInput(idInput, B);
+  emit dataChanged(index, index);
+  emit signEntradaAlterada(idInput, avaliadas);
+  return true;
+}
+
+Qt::ItemFlags ModeloEntradas::flags(const QModelIndex &index) const
+{
+  if (!index.isValid()) return Qt::NoItemFlags;
+  // A caixa alterna F -> ? -> T -> F a cada clique
+  return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable | Qt::ItemIsUserTristate;
+}
+
+QVariant ModeloEntradas::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (role!=Qt::DisplayRole) return QVariant();
+  if (orientation==Qt::Vertical) return "E"+QString::number(section+1);
+  return QString("VALOR");
+}
@@ -0,0 +1,117 @@
+#ifndef MODELOCIRCUITO_H
+#define MODELOCIRCUITO_H
+
+#include <QAbstractTableModel>
+#include "circuito.h"
+#include "simuladorincremental.h"
+
+/* ======================================================================== *
+ * OS MODELOS (QAbstractTableModel) QUE EXIBEM AS PORTAS E AS SAIDAS        *
+ * ======================================================================== */
+
+// Os modelos nao copiam nada: leem os valores diretamente do Circuito, apenas
+// para as linhas visiveis. Quando o circuito for alterado, a janela deve avisar
+// o modelo: recarregar() se as dimensoes mudaram (novo circuito ou leitura),
+// portaAlterada()/saidaAlterada() se apenas uma porta ou saida mudou.
+// A coluna VALOR exibe o valor atual da porta ou saida na simulacao interativa
+// (SimuladorIncremental), e fica vazia se o simulador nao estiver montado; a janela
+// deve chamar valoresAlterados() depois de alterar as entradas do simulador.
+
+// A tabela de portas: uma linha por porta (id = linha+1)
+// Colunas: valor, tipo, numero de entradas e as ids de origem de cada entrada
+// O numero de colunas de entrada acompanha a porta com mais entradas (no minimo 4)
+class ModeloPortas : public QAbstractTableModel
+{
+  Q_OBJECT
+
+public:
+  // O circuito e o simulador devem continuar existindo enquanto o modelo existir
+  ModeloPortas(const Circuito& Circ, const SimuladorIncremental& Sim, QObject *parent = 0);
+
+  // Reexibe todo o circuito (apos mudar o numero de portas)
+  void recarregar();
+
+  // Reexibe apenas a linha da porta IdPort
+  void portaAlterada(int IdPort);
+
+  // Reexibe a coluna de valores
+  void valoresAlterados();
+
+  // Funcoes do QAbstractTableModel
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  const Circuito& C;
+  const SimuladorIncremental& S;
+  // Numero de colunas de entradas exibidas
+  int maxEntradas;
+};
+
+// A tabela de saidas: uma linha por saida (id = linha+1), com o valor e a id de origem
+class ModeloSaidas : public QAbstractTableModel
+{
+  Q_OBJECT
+
+public:
+  // O circuito e o simulador devem continuar existindo enquanto o modelo existir
+  ModeloSaidas(const Circuito& Circ, const SimuladorIncremental& Sim, QObject *parent = 0);
+
+  // Reexibe todas as saidas (apos mudar o numero de saidas)
+  void recarregar();
+
+  // Reexibe apenas a linha da saida IdOut
+  void saidaAlterada(int IdOut);
+
+  // Reexibe a coluna de valores
+  void valoresAlterados();
+
+  // Funcoes do QAbstractTableModel
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  const Circuito& C;
+  const SimuladorIncremental& S;
+};
+
+// As entradas da simulacao interativa: uma linha por entrada do simulador (E1, E2, ...),
+// com uma caixa de tres estados que alterna o valor da entrada:
+// desmarcada = F, parcialmente marcada = ?, marcada = T
+// Ao alterar uma entrada, o simulador recalcula apenas o que depende dela e o modelo
+// emite signEntradaAlterada, para a janela reexibir os valores das portas e saidas
+class ModeloEntradas : public QAbstractTableModel
+{
+  Q_OBJECT
+
+public:
+  // O simulador deve continuar existindo enquanto o modelo existir
+  explicit ModeloEntradas(SimuladorIncremental& Sim, QObject *parent = 0);
+
+  // Reexibe todas as entradas (apos montar ou esvaziar o simulador)
+  void recarregar();
+
+  // Funcoes do QAbstractTableModel
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex &index) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+signals:
+  // A entrada IdInput foi alterada; avaliadas: numero de portas recalculadas
+  void signEntradaAlterada(int IdInput, unsigned avaliadas);
+
+private:
+  SimuladorIncremental& S;
+};
+
+#endif // MODELOCIRCUITO_H
@@ -0,0 +1,245 @@
+#include "modelotabela.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <QColor>
+#include <QFont>
+#include <utility>
+#include <climits>
+
+/* ======================================================================== *
+ * CLASSE MODELOTABELAVERDADE                                               *
+ * ======================================================================== */
+
+ModeloTabelaVerdade::ModeloTabelaVerdade(QObject *parent) :
+  QAbstractTableModel(parent),
+  tabela(),
+  filtrado(false),
+  linhasFiltradas(),
+  valoresFiltrados(),
+  colunasPendentes()
+{
+}
+
+void ModeloTabelaVerdade::redimensionar(unsigned NI, unsigned NO)
+{
+  beginResetModel();
+  tabela.redimensionar(NI, NO);
+  colunasPendentes.clear();
+  filtrado = false;
+  std::vector<uint64_t>().swap(linhasFiltradas);
+  std::vector<uint8_t>().swap(valoresFiltrados);
+  endResetModel();
+}
+
+void ModeloTabelaVerdade::setTabela(TabelaVerdade&& T)
+{
+  beginResetModel();
+  tabela = std::move(T);
+  colunasPendentes.clear();
+  filtrado = false;
+  std::vector<uint64_t>().swap(linhasFiltradas);
+  std::vector<uint8_t>().swap(valoresFiltrados);
+  endResetModel();
+}
+
+void ModeloTabelaVerdade::acrescentarLinhas(const uint8_t* valores, uint64_t N)
+{
+  uint64_t L0 = tabela.getNumLinhas();
+  uint64_t total = tabela.getNumLinhasTotal();
+  if (L0+N > total) N = total-L0;
+  if (N==0) return;
+  // Enquanto filtrado, as linhas novas sao armazenadas mas nao exibidas
+  if (!filtrado) beginInsertRows(QModelIndex(), int(L0), int(L0+N-1));
+  tabela.acrescentarLinhas(valores, N);
+  if (!filtrado) endInsertRows();
+}
+
+void ModeloTabelaVerdade::setFiltrado(bool F)
+{
+  beginResetModel();
+  filtrado = F;
+  std::vector<uint64_t>().swap(linhasFiltradas);
+  std::vector<uint8_t>().swap(valoresFiltrados);
+  endResetModel();
+}
+
+bool ModeloTabelaVerdade::getFiltrado() const
+{
+  return filtrado;
+}
+
+void ModeloTabelaVerdade::acrescentarFiltradas(const uint64_t* linhas, const uint8_t* valores, uint64_t N)
+{
+  if (!filtrado) return;
+  // O numero de linhas exibidas tem que caber em um int
+  uint64_t L0 = linhasFiltradas.size();
+  if (L0+N > uint64_t(INT_MAX)) N = uint64_t(INT_MAX)-L0;
+  if (N==0) return;
+  unsigned bl = bytesPorLinha(tabela.getNumOutputs());
+  beginInsertRows(QModelIndex(), int(L0), int(L0+N-1));
+  linhasFiltradas.insert(linhasFiltradas.end(), linhas, linhas+N);
+  valoresFiltrados.insert(valoresFiltrados.end(), valores, valores+N*bl);
+  endInsertRows();
+}
+
+const TabelaVerdade& ModeloTabelaVerdade::getTabela() const
+{
+  return tabela;
+}
+
+void ModeloTabelaVerdade::saidasAlteradas(unsigned I0, unsigned I1)
+{
+  // As linhas filtradas guardam copias dos valores: nao mudam (o filtro tem que ser refeito)
+  if (filtrado || rowCount()==0) return;
+  int numInputs = int(tabela.getNumInputs());
+  emit dataChanged(index(0, numInputs+int(I0)), index(rowCount()-1, numInputs+int(I1)));
+}
+
+void ModeloTabelaVerdade::atualizarColunas(uint64_t L0, uint64_t N, const std::vector<bool>& colunas,
+                                           const uint8_t* valores)
+{
+  tabela.atualizarColunas(L0, N, colunas, valores);
+  if (filtrado || N==0 || L0>=tabela.getNumLinhas()) return;
+  // Apenas o retangulo entre a primeira e a ultima coluna alterada
+  unsigned I0=tabela.getNumOutputs(), I1=0;
+  for (unsigned i=0; i<colunas.size() && i<tabela.getNumOutputs(); i++) if (colunas[i])
+  {
+    if (i<I0) I0 = i;
+    I1 = i;
+  }
+  if (I0>I1) return;
+  uint64_t L1 = (L0+N<tabela.getNumLinhas() ? L0+N : tabela.getNumLinhas()) - 1;
+  int numInputs = int(tabela.getNumInputs());
+  emit dataChanged(index(int(L0), numInputs+int(I0)), index(int(L1), numInputs+int(I1)));
+}
+
+void ModeloTabelaVerdade::copiarColuna(unsigned Orig, unsigned Dest)
+{
+  tabela.copiarColuna(Orig, Dest);
+  saidasAlteradas(Dest, Dest);
+}
+
+void ModeloTabelaVerdade::copiarEntrada(unsigned J, unsigned Dest)
+{
+  tabela.copiarEntrada(J, Dest);
+  saidasAlteradas(Dest, Dest);
+}
+
+bool ModeloTabelaVerdade::pendente(int coluna) const
+{
+  int I = coluna-int(tabela.getNumInputs());
+  return (I>=0 && unsigned(I)<colunasPendentes.size() && colunasPendentes[I]);
+}
+
+void ModeloTabelaVerdade::setColunasPendentes(const std::vector<bool>& pendentes)
+{
+  colunasPendentes = pendentes;
+  emit headerDataChanged(Qt::Horizontal, 0, columnCount()-1);
+}
+
+int ModeloTabelaVerdade::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  if (filtrado) return int(linhasFiltradas.size());
+  // TabelaVerdade::cabeEmMemoria garante que o numero de linhas cabe em um int
+  return int(tabela.getNumLinhas());
+}
+
+int ModeloTabelaVerdade::columnCount(const QModelIndex &parent) const
+{
+  if (parent.isValid()) return 0;
+  return int(tabela.getNumInputs() + tabela.getNumOutputs());
+}
+
+uint64_t ModeloTabelaVerdade::numeroLinha(int linha) const
+{
+  return (filtrado ? linhasFiltradas[linha] : uint64_t(linha));
+}
+
+bool3S ModeloTabelaVerdade::valor(int linha, int coluna) const
+{
+  unsigned numInputs = tabela.getNumInputs();
+  if (unsigned(coluna) < numInputs) return entradaLinha(numeroLinha(linha), numInputs, coluna);
+  if (!filtrado) return tabela.getSaida(linha, coluna-numInputs);
+  unsigned bl = bytesPorLinha(tabela.getNumOutputs());
+  return lerValor(valoresFiltrados.data() + uint64_t(linha)*bl, coluna-numInputs);
+}
+
+QVariant ModeloTabelaVerdade::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid()) return QVariant();
+  switch (role)
+  {
+  case Qt::DisplayRole:
+    return QString(QChar(toChar(valor(index.row(), index.column()))));
+  case ValorRole:
+    return int(valor(index.row(), index.column()));
+  case Qt::TextAlignmentRole:
+    return int(Qt::AlignCenter);
+  default:
+    return QVariant();
+  }
+}
+
+QVariant ModeloTabelaVerdade::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation==Qt::Vertical)
+  {
+    // Numero da linha (a partir de 0, o mesmo usado na TabelaMapeada)
+    // Se filtrado, o numero original da linha na tabela completa
+    if (role==Qt::DisplayRole && section<rowCount()) return quint64(numeroLinha(section));
+    return QVariant();
+  }
+  int numInputs = int(tabela.getNumInputs());
+  switch (role)
+  {
+  case Qt::DisplayRole:
+    if (section < numInputs) return "E"+QString::number(section+1);
+    return "S"+QString::number(section-numInputs+1);
+  case Qt::ToolTipRole:
+    if (pendente(section)) return QString("Coluna sendo recalculada");
+    return QVariant();
+  case Qt::FontRole:
+    {
+      // As colunas sendo recalculadas ficam em italico
+      QFont fonte;
+      fonte.setBold(true);
+      fonte.setItalic(pendente(section));
+      return fonte;
+    }
+  default:
+    return QVariant();
+  }
+}
+
+/* ======================================================================== *
+ * CLASSE DELEGADOTABELAVERDADE                                             *
+ * ======================================================================== */
+
+DelegadoTabelaVerdade::DelegadoTabelaVerdade(QObject *parent) :
+  QStyledItemDelegate(parent)
+{
+}
+
+void DelegadoTabelaVerdade::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                  const QModelIndex &index) const
+{
+  // Os textos e as cores de cada valor (na ordem de bool3S: UNDEF, FALSE, TRUE)
+  static const QString textos[3] = {"?", "F", "T"};
+  static const QColor cores[3] = {QColor(128,128,128), QColor(170,0,0), QColor(0,120,0)};
+
+  // O fundo (cores alternadas, selecao) eh desenhado pelo estilo; o texto, aqui
+  // (sem initStyleOption, que pediria ao modelo varios papeis de cada celula)
+  QStyleOptionViewItem opt = option;
+  const QWidget *widget = opt.widget;
+  QStyle *style = (widget!=nullptr ? widget->style() : QApplication::style());
+  style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+  int v = index.data(ModeloTabelaVerdade::ValorRole).toInt();
+  if (v<0 || v>2) return;
+  painter->save();
+  painter->setPen(cores[v]);
+  painter->drawText(option.rect, Qt::AlignCenter, textos[v]);
+  painter->restore();
+}
@@ -0,0 +1,108 @@
+#ifndef MODELOTABELA_H
+#define MODELOTABELA_H
+
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <vector>
+#include "tabelaverdade.h"
+
+/* ======================================================================== *
+ * O MODELO (QAbstractTableModel) QUE EXIBE A TABELA VERDADE                *
+ * ======================================================================== */
+
+// A tabela verdade eh exibida em um QTableView a partir deste modelo, que
+// guarda a tabela empacotada (TabelaVerdade, poucos bytes por linha) e
+// fornece os valores apenas das celulas visiveis, quando a view os pede.
+// Colunas: as entradas (E1, E2, ...) seguidas das saidas (S1, S2, ...)
+class ModeloTabelaVerdade : public QAbstractTableModel
+{
+  Q_OBJECT
+
+public:
+  // Papel (role) em que data() retorna o valor da celula como int(bool3S)
+  static const int ValorRole = Qt::UserRole;
+
+  explicit ModeloTabelaVerdade(QObject *parent = 0);
+
+  // Passa a exibir uma tabela vazia (sem linhas) para NI entradas e NO saidas
+  void redimensionar(unsigned NI, unsigned NO);
+
+  // Passa a exibir a tabela T (que eh movida para dentro do modelo)
+  void setTabela(TabelaVerdade&& T);
+
+  // Acrescenta N linhas empacotadas ao final da tabela exibida
+  // (as linhas de uma geracao em andamento aparecem aa medida que sao calculadas)
+  void acrescentarLinhas(const uint8_t* valores, uint64_t N);
+
+  // A tabela exibida
+  const TabelaVerdade& getTabela() const;
+
+  // Atualizacao de colunas de saida da tabela jah calculada, depois de uma alteracao
+  // no circuito (ver as funcoes de mesmo nome de TabelaVerdade)
+  void atualizarColunas(uint64_t L0, uint64_t N, const std::vector<bool>& colunas,
+                        const uint8_t* valores);
+  void copiarColuna(unsigned Orig, unsigned Dest);
+  void copiarEntrada(unsigned J, unsigned Dest);
+
+  // Marca as colunas de saida que estao sendo recalculadas (o cabecalho as indica)
+  // Um vetor vazio desmarca todas
+  void setColunasPendentes(const std::vector<bool>& pendentes);
+
+  // Passa a exibir apenas as linhas filtradas (inicialmente nenhuma, ver
+  // acrescentarFiltradas), ou volta a exibir todas as linhas da tabela (filtrado==false)
+  // Cada linha filtrada eh exibida com o seu numero original no cabecalho vertical
+  void setFiltrado(bool filtrado);
+  bool getFiltrado() const;
+
+  // Acrescenta N linhas filtradas: os numeros das linhas e as suas saidas empacotadas
+  // (as linhas filtradas podem vir de uma tabela que nao estah em memoria)
+  void acrescentarFiltradas(const uint64_t* linhas, const uint8_t* valores, uint64_t N);
+
+  // Funcoes do QAbstractTableModel
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+private:
+  TabelaVerdade tabela;
+
+  // As linhas filtradas, exibidas no lugar da tabela quando filtrado==true
+  bool filtrado;
+  std::vector<uint64_t> linhasFiltradas;
+  std::vector<uint8_t> valoresFiltrados;
+
+  // As colunas de saida que estao sendo recalculadas
+  std::vector<bool> colunasPendentes;
+
+  // Avisa a view que os valores das saidas I0 ateh I1 mudaram em todas as linhas
+  void saidasAlteradas(unsigned I0, unsigned I1);
+  // Se a coluna (da view) eh uma saida que estah sendo recalculada
+  bool pendente(int coluna) const;
+
+  // O numero (na tabela completa) da linha exibida na posicao linha
+  uint64_t numeroLinha(int linha) const;
+
+  // O valor da celula (linha, coluna)
+  bool3S valor(int linha, int coluna) const;
+};
+
+/* ======================================================================== *
+ * O DELEGATE QUE DESENHA AS CELULAS DA TABELA VERDADE                      *
+ * ======================================================================== */
+
+// Desenha cada celula diretamente (F, T ou ?, centralizado e colorido), sem
+// criar nenhum widget; a view soh o chama para as celulas visiveis
+class DelegadoTabelaVerdade : public QStyledItemDelegate
+{
+  Q_OBJECT
+
+public:
+  explicit DelegadoTabelaVerdade(QObject *parent = 0);
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option,
+             const QModelIndex &index) const override;
+};
+
+#endif // MODELOTABELA_H
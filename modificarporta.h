@@ -2,6 +2,9 @@
 #define MODIFICARPORTA_H
 
 #include <QDialog>
+#include <QVector>
+#include <QLabel>
+#include <QSpinBox>
 
 /* ======================================================================== *
  * ESSA EH A CLASSE QUE REPRESENTA A CAIXA DE DIALOGO PARA ALTERAR PORTAS   *
@@ -25,27 +28,24 @@ public slots:
   void slotSetRangeInputs(int minimo, int maximo);
 
   // Fixa as caracteristas da porta que estah sendo modificada
+  // (o numero de entradas da porta eh o tamanho de IdInputs)
   // Depois exibe (show) a janela de modificar porta
-  void slotShowModificarPorta(int IdPort, QString TipoPort, int NumInputsPort,
-                              int IdInput0, int IdInput1, int IdInput2, int IdInput3);
+  void slotShowModificarPorta(int IdPort, QString TipoPort, QVector<int> IdInputs);
 
 private slots:
   // Sempre que modificar o tipo de porta, modifica os limites do spinBox que eh utilizado
   // para escolher o numero de entradas daquela porta:
   // NT: de 1 a 1
-  // Demais: de 2 a 4
+  // Demais: de 2 ao numero de origens possiveis (entradas do circuito + portas)
   void on_comboTipoPorta_currentTextChanged(const QString &arg1);
 
-  // Quando modifica o numero de entradas da porta, habilita apenas os spinBoxs que sao utilizados
+  // Quando modifica o numero de entradas da porta, exibe apenas os spinBoxs que sao utilizados
   // para indicar a origem do sinal de entradas que existem na porta em questao
   void on_spinNumInputs_valueChanged(int arg1);
 
   // Quando modifica o valor da entrada de alguma das portas, testa se alguma delas tem valor
-  // invalido (zero) e estah habilitada; se for o caso, desabilita o botao OK
-  void on_spinInput1_valueChanged(int arg1);
-  void on_spinInput2_valueChanged(int arg1);
-  void on_spinInput3_valueChanged(int arg1);
-  void on_spinInput4_valueChanged(int arg1);
+  // invalido (zero) e estah visivel; se for o caso, desabilita o botao OK
+  void slotInputChanged(int arg1);
 
   // Sinaliza a alteracao das caracteristas da porta "idPorta"
   // de acordo com os valores especificados pelo usuario
@@ -57,13 +57,28 @@ private:
   // Qual porta estah sendo modificada
   int idPort;
 
+  // Os limites das ids de origem das entradas (fixados por slotSetRangeInputs)
+  int minimoInputs;
+  int maximoInputs;
+
+  // Os spinBoxs (e os labels correspondentes) das origens das entradas da porta
+  // Sao criados conforme a necessidade (um por entrada) e nunca destruidos:
+  // os que sobram ficam apenas ocultos
+  QVector<QLabel*> labelInputs;
+  QVector<QSpinBox*> spinInputs;
+
+  // Cria os spinBoxs que faltarem e exibe apenas os NumInputs primeiros
+  void ajustaEntradas(int NumInputs);
+
+  // Fixa os limites do spinBox do numero de entradas, de acordo com o tipo de porta
+  void ajustaRangeNumInputs();
+
   // Testa se a origem (id) do sinal de alguma das entradas da porta tem valor invalido (zero)
-  // e se a entrada estah habilitada; se for o caso, desabilita o botao OK
+  // e se a entrada estah visivel; se for o caso, desabilita o botao OK
   void testa_entradas_validas();
 
 signals:
-  void signModificarPorta(int IdPort, QString TipoPort, int NumInputsPort,
-                          int IdInput0, int IdInput1, int IdInput2, int IdInput3);
+  void signModificarPorta(int IdPort, QString TipoPort, QVector<int> IdInputs);
 };
 
 #endif // MODIFICARPORTA_H
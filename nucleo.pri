@@ -0,0 +1,54 @@
+# Os fontes do nucleo do simulador (sem nenhuma dependencia do Qt): as classes
+# bool3S, Port e Circuito e o que eh construido sobre elas (tabela verdade,
+# cache, filtro, simulacao interativa, em lote, por ciclos e com atrasos,
+# equivalencia, BDDs, circuitos sinteticos)
+# Incluido pela aplicacao grafica (Circuito.pro) e pela biblioteca nucleo (nucleo/nucleo.pro)
+
+INCLUDEPATH += $$PWD
+
+# A leitura de arquivos grandes usa std::thread
+CONFIG += c++11 thread
+
+# Contadores de desempenho da simulacao (SimStats, ver estatisticas.h), desligados
+# por padrao: qmake CONFIG+=estatisticas
+estatisticas: DEFINES += CIRCUITO_ESTATISTICAS
+
+SOURCES += \
+    $$PWD/bool3S.cpp \
+    $$PWD/port.cpp \
+    $$PWD/circuito.cpp \
+    $$PWD/estatisticas.cpp \
+    $$PWD/rastro.cpp \
+    $$PWD/arquivomapeado.cpp \
+    $$PWD/leitura.cpp \
+    $$PWD/tabelaverdade.cpp \
+    $$PWD/filtrotabela.cpp \
+    $$PWD/cachetabelas.cpp \
+    $$PWD/circuitoplano.cpp \
+    $$PWD/simuladorincremental.cpp \
+    $$PWD/simuladorlote.cpp \
+    $$PWD/simuladorsequencial.cpp \
+    $$PWD/simuladortemporizado.cpp \
+    $$PWD/equivalencia.cpp \
+    $$PWD/bdd.cpp \
+    $$PWD/gerador.cpp
+
+HEADERS += \
+    $$PWD/bool3S.h \
+    $$PWD/port.h \
+    $$PWD/circuito.h \
+    $$PWD/estatisticas.h \
+    $$PWD/rastro.h \
+    $$PWD/arquivomapeado.h \
+    $$PWD/leitura.h \
+    $$PWD/tabelaverdade.h \
+    $$PWD/filtrotabela.h \
+    $$PWD/cachetabelas.h \
+    $$PWD/circuitoplano.h \
+    $$PWD/simuladorincremental.h \
+    $$PWD/simuladorlote.h \
+    $$PWD/simuladorsequencial.h \
+    $$PWD/simuladortemporizado.h \
+    $$PWD/equivalencia.h \
+    $$PWD/bdd.h \
+    $$PWD/gerador.h
@@ -0,0 +1,16 @@
+#-------------------------------------------------
+#
+# Biblioteca estatica com o nucleo do simulador, sem Qt
+# (usada pelas ferramentas de linha de comando, ver ferramentas.pro)
+#
+#-------------------------------------------------
+
+TEMPLATE = lib
+TARGET = nucleo
+CONFIG += staticlib
+CONFIG -= qt
+
+# Todas as ferramentas procuram a biblioteca no mesmo diretorio
+DESTDIR = $$OUT_PWD/../lib
+
+include(../nucleo.pri)
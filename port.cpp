@@ -1,5 +1,7 @@
 #include <fstream>
+#include <climits>
 #include "port.h"
+#include "leitura.h"
 
 //
 // CLASSE PORT
@@ -11,8 +13,8 @@
 
 // Construtor (recebe como parametro o numero de entradas da porta)
 // Dimensiona o array id_in e inicializa elementos com valor invalido (0),
-// inicializa out_port com UNDEF
-Port::Port(unsigned NI):id_in(NI,0),out_port(bool3S::UNDEF)
+// inicializa out_port com UNDEF e o atraso com ATRASO_PADRAO
+Port::Port(unsigned NI):id_in(NI,0),out_port(bool3S::UNDEF),atraso(ATRASO_PADRAO)
 {
   // Nao pode testar o parametro NI com validNumInputs pq o construtor de
   // Port eh chamado pelo construtor de Port_NOT, mas sem que ocorra
@@ -28,7 +30,7 @@ Port::Port(unsigned NI):id_in(NI,0),out_port(bool3S::UNDEF)
 }
 
 // Construtor por copia
-Port::Port(const Port& P):id_in(P.id_in),out_port(P.out_port)
+Port::Port(const Port& P):id_in(P.id_in),out_port(P.out_port),atraso(P.atraso)
 {
 }
 
@@ -86,6 +88,12 @@ int Port::getId_in(unsigned I) const
   return id_in.at(I);
 }
 
+// Atraso da porta
+unsigned Port::getAtraso() const
+{
+  return atraso;
+}
+
 /// ***********************
 /// Funcoes de modificacao
 /// ***********************
@@ -116,6 +124,12 @@ void Port::setId_in(unsigned I, int Id)
   if (validIndex(I) && Id!=0) id_in.at(I) = Id;
 }
 
+// Fixa o atraso da porta, se estiver entre 1 e ATRASO_MAXIMO
+void Port::setAtraso(unsigned D)
+{
+  if (D>=1 && D<=ATRASO_MAXIMO) atraso = D;
+}
+
 /// ***********************
 /// E/S de dados
 /// ***********************
@@ -167,28 +181,116 @@ void Port::digitar()
 // apropriado para o tipo de porta.
 bool Port::ler(std::istream& ArqI)
 {
-  try
+  unsigned Nin;
+  char c;
+
+  ArqI >> Nin;
+  if (!ArqI.good() || !validNumInputs(Nin))
+  {
+    id_in.clear();
+    return false;
+  }
+  id_in.resize(Nin);
+  ArqI >> c;
+  if (!ArqI.good() || c != ':')
+  {
+    id_in.clear();
+    return false;
+  }
+  for (unsigned i=0; i<getNumInputs(); i++)
+  {
+    ArqI >> id_in.at(i);
+    if (!ArqI.good() || id_in.at(i) == 0)
+    {
+      id_in.clear();
+      return false;
+    }
+  }
+  // O atraso opcional
+  atraso = ATRASO_PADRAO;
+  ArqI >> std::ws;
+  if (ArqI.peek()=='@')
   {
-    unsigned Nin;
-    char c;
+    unsigned D=0;
+    ArqI.get();
+    ArqI >> D;
+    if (ArqI.fail() || D<1 || D>ATRASO_MAXIMO)
+    {
+      id_in.clear();
+      return false;
+    }
+    atraso = D;
+  }
+  return true;
+}
 
-    ArqI >> Nin;
-    if (!ArqI.good() || !validNumInputs(Nin)) throw 1;
+// Leh uma porta de um bloco de texto em memoria, com o mesmo formato e os mesmos
+// testes do metodo ler a partir de uma stream
+// Em caso de erro, pos fica no inicio do trecho invalido e, se D!=nullptr,
+// D->codigo e D->esperado descrevem o problema
+bool Port::ler(const char*& pos, const char* fim, Diagnostico* D)
+{
+  long long Nin=0, id=0;
+  const char* ini;
+  std::string esperado;
+
+  pularEspacos(pos, fim);
+  ini = pos;
+  // Cada id ocupa pelo menos 1 caractere: um numero de entradas maior do que o
+  // restante do texto so pode ser um erro, e nao deve provocar uma alocacao enorme
+  if (!lerInteiro(pos, fim, Nin) || Nin<0 || Nin>fim-pos || !validNumInputs(unsigned(Nin)))
+  {
+    esperado = (validNumInputs(1) ? "numero de entradas da porta (1)" :
+                                    "numero de entradas da porta (2 ou mais)");
+  }
+  else
+  {
+    pularEspacos(pos, fim);
+    ini = pos;
+    if (!lerCaractere(pos, fim, ':')) esperado = "':'";
+  }
+  if (esperado.empty())
+  {
     id_in.resize(Nin);
-    ArqI >> c;
-    if (!ArqI.good() || c != ':') throw 2;
     for (unsigned i=0; i<getNumInputs(); i++)
     {
-      ArqI >> id_in.at(i);
-      if (!ArqI.good() || id_in.at(i) == 0) throw 3;
+      pularEspacos(pos, fim);
+      ini = pos;
+      if (!lerInteiro(pos, fim, id) || id==0 || id>INT_MAX || id<-INT_MAX)
+      {
+        esperado = "id da entrada "+std::to_string(i+1)+" da porta (diferente de 0)";
+        break;
+      }
+      id_in.at(i) = int(id);
     }
   }
-  catch (int erro)
+  // O atraso opcional
+  atraso = ATRASO_PADRAO;
+  if (esperado.empty())
   {
-    id_in.clear();
-    return false;
+    const char* aposIds = pos;
+    pularEspacos(pos, fim);
+    ini = pos;
+    if (lerCaractere(pos, fim, '@'))
+    {
+      if (!lerInteiro(pos, fim, id) || id<1 || id>ATRASO_MAXIMO)
+      {
+        esperado = "atraso da porta (de 1 a "+std::to_string(ATRASO_MAXIMO)+")";
+      }
+      else atraso = unsigned(id);
+    }
+    else pos = aposIds;
   }
-  return true;
+  if (esperado.empty()) return true;
+
+  id_in.clear();
+  pos = ini;
+  if (D!=nullptr)
+  {
+    D->codigo = ErroLeitura::PORTA;
+    D->esperado = esperado;
+  }
+  return false;
 }
 
 // Imprime a porta na ostrem ArqO (cout ou uma stream de arquivo, tanto faz)
@@ -210,6 +312,7 @@ std::ostream& Port::imprimir(std::ostream& ArqO) const
   {
     ArqO << ' ' << id_in.at(j);
   }
+  if (atraso!=ATRASO_PADRAO) ArqO << " @" << atraso;
   return ArqO;
 }
 
@@ -416,3 +519,31 @@ void Port_NXOR::simular(const std::vector<bool3S>& in_port)
     }
     out_port =~ out_port;
 }
+/////////////// FLIP-FLOP D ///////////////
+Port_DFF::Port_DFF():Port(1)
+{
+}
+ptr_Port Port_DFF::clone()const
+{
+    return new Port_DFF(*this);
+}
+std::string Port_DFF::getName()const
+{
+    return "DF";
+}
+bool Port_DFF::validNumInputs(unsigned NI)const
+{
+    return (NI==1);
+}
+void Port_DFF::digitar()
+{
+    do
+    {
+        std::cout << "Digite a entrada D do flip-flop: ";
+        std::cin >> id_in[0];
+    }while(!valid());
+}
+void Port_DFF::simular(const std::vector<bool3S>&)
+{
+    out_port = bool3S::UNDEF;
+}
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include "bool3S.h"
+#include "leitura.h"
 
 /// ###########################################################################
 /// ATENCAO PARA A CONVENCAO DOS NOMES E TIPOS PARA OS PARAMETROS DAS FUNCOES:
@@ -19,6 +20,11 @@ class Port;
 typedef Port *ptr_Port;
 
 class Port {
+public:
+  // O atraso de uma porta que nao informa o seu atraso e o maior atraso aceito
+  static const unsigned ATRASO_PADRAO = 1;
+  static const unsigned ATRASO_MAXIMO = 1000000;
+
 protected:
   /// ***********************
   /// Dados
@@ -34,6 +40,9 @@ protected:
   std::vector<int> id_in;
   // O valor logico (bool3S) da saida da porta (?, F ou T)
   bool3S out_port;
+  // O atraso da porta (em unidades de tempo), usado apenas pela simulacao com atrasos
+  // (ver SimuladorTemporizado); nao altera o resultado das demais simulacoes
+  unsigned atraso;
 
 public:
   /// ***********************
@@ -90,6 +99,9 @@ public:
   // ou 0 se indice invalido
   int getId_in(unsigned I) const;
 
+  // Atraso da porta (de 1 a ATRASO_MAXIMO)
+  unsigned getAtraso() const;
+
   /// ***********************
   /// Funcoes de modificacao
   /// ***********************
@@ -107,6 +119,9 @@ public:
   // Depois de testar os parametros (validIndex, Id!=0), faz: id_in[I] <- Id
   void setId_in(unsigned I, int Id);
 
+  // Fixa o atraso da porta (nao faz nada se D nao estiver entre 1 e ATRASO_MAXIMO)
+  void setAtraso(unsigned D);
+
   /// ***********************
   /// E/S de dados
   /// ***********************
@@ -121,29 +136,42 @@ public:
   // O metodo virtual digitar tem que ser refeito para a NOT.
   // Nao precisa ser reimplementado nas demais ports
   // ATENCAO: o metodo NAO vai solicitar que o usuario digite o tipo de porta
-  // (NT,AN,NA,OR,NO,XO,NX). Esse valor jah deve ter sido digitado previamente e a porta
+  // (NT,AN,NA,OR,NO,XO,NX,DF). Esse valor jah deve ter sido digitado previamente e a porta
   // criada dinamicamente (new) do tipo certo, para que seja chamado o metodo virtual
   // digitar apropriado para o tipo de porta.
   virtual void digitar();
 
   // Leh uma porta da stream ArqI. Deve ler:
   // - o numero de entradas da porta; e
-  // - a id de cada uma das entradas da porta
+  // - a id de cada uma das entradas da porta; e
+  // - opcionalmente, o atraso da porta, precedido de '@' (por exemplo, "AN 2: 1 -2 @3");
+  //   se nao houver, o atraso eh ATRASO_PADRAO
   // Retorna true se tudo OK (usa valid), false se houve erro
   // Este metodo nao eh virtual, pois pode ser feito generico de forma a servir para
   // todas as ports.
   // Basta que o metodo teste o numero de entradas com a funcao virtual validNumInputs()
   // ATENCAO: o metodo NAO vai ler do arquivo o tipo de porta
-  // (NT,AN,NA,OR,NO,XO,NX). Esse valor jah deve ter sido lido previamente e a porta
+  // (NT,AN,NA,OR,NO,XO,NX,DF). Esse valor jah deve ter sido lido previamente e a porta
   // criada dinamicamente do tipo certo, para que seja chamado o metodo virtual ler
   // apropriado para o tipo de porta.
   bool ler(std::istream& ArqI);
 
+  // Versao do metodo ler que leh a porta diretamente de um bloco de texto em memoria
+  // (ver leitura.h), a partir da posicao pos e sem ultrapassar fim
+  // Ao final, pos aponta para o primeiro caractere apos a ultima id lida
+  // Permite que varias portas sejam lidas ao mesmo tempo, em threads diferentes,
+  // de partes diferentes do mesmo arquivo
+  // Em caso de erro, pos fica no inicio do trecho invalido e, se D!=nullptr, preenche
+  // o codigo e o texto esperado do diagnostico (a linha e a coluna sao calculadas
+  // depois por quem chamou, a partir de pos)
+  bool ler(const char*& pos, const char* fim, Diagnostico* D=nullptr);
+
   // Imprime a porta na ostrem ArqO (cout ou uma stream de arquivo, tanto faz)
   // Imprime:
   // - a string com o nome da porta + ESPACO
   // - o numero de entradas colado com ':'; e
-  // - ESPACO + as ids de cada uma das entradas
+  // - ESPACO + as ids de cada uma das entradas; e
+  // - ESPACO + '@' + o atraso, se for diferente de ATRASO_PADRAO
   // Este metodo nao eh virtual, pois pode ser feito generico de forma a servir para
   // todas as ports.
   // Basta que o metodo imprima o resultado da chamada aa funcao virtual getName() para o nome
@@ -287,4 +315,27 @@ public:
   void simular(const std::vector<bool3S>& in_port);
 };
 
+// Flip-flop D (sensivel aa borda do clock): uma entrada, o sinal D
+// A saida eh o estado guardado pelo flip-flop, que soh muda na borda do clock, quando
+// passa a ser o valor de D. Na simulacao combinacional (Circuito::simular e demais
+// simuladores sem clock) o estado eh desconhecido e a saida eh sempre UNDEF; a
+// simulacao por ciclos de clock, que guarda o estado dos flip-flops, eh feita pela
+// classe SimuladorSequencial (simuladorsequencial.h)
+class Port_DFF: public Port {
+public:
+  Port_DFF();
+  // Retorna new Port_DFF(*this)
+  ptr_Port clone() const;
+  // Retorna "DF"
+  std::string getName() const;
+
+  bool validNumInputs(unsigned NI) const;
+
+  // Leh um flip-flop do teclado: soh a id da entrada D, como na porta NOT
+  void digitar();
+
+  // Sem clock, o estado do flip-flop eh desconhecido: faz out_port <- UNDEF
+  void simular(const std::vector<bool3S>& in_port);
+};
+
 #endif // _PORT_H_
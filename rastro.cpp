@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "rastro.h"
+
+std::atomic<bool> rastroLigado(false);
+
+// Um evento gravado (tempos em ns desde iniciarRastro)
+struct EventoGravado {
+  const char* nome;
+  int64_t valor;
+  int64_t inicio;
+  int64_t duracao;
+};
+
+// Os eventos gravados por uma thread
+struct BufferRastro {
+  unsigned thread;
+  std::vector<EventoGravado> eventos;
+};
+
+// Os buffers de todas as threads que jah gravaram algum evento: nunca sao liberados
+// (uma thread pode terminar antes de salvarRastro), apenas esvaziados por iniciarRastro
+static std::mutex mutexBuffers;
+static std::vector<std::unique_ptr<BufferRastro> > buffers;
+// O buffer da thread atual (nullptr ateh o primeiro evento)
+static thread_local BufferRastro* bufferThread = nullptr;
+// O instante de iniciarRastro
+static std::chrono::steady_clock::time_point inicioRastro = std::chrono::steady_clock::now();
+
+void iniciarRastro()
+{
+  std::lock_guard<std::mutex> trava(mutexBuffers);
+  for (unsigned k=0; k<buffers.size(); k++) buffers[k]->eventos.clear();
+  inicioRastro = std::chrono::steady_clock::now();
+  rastroLigado = true;
+}
+
+bool salvarRastro(const std::string& arq)
+{
+  rastroLigado = false;
+  std::lock_guard<std::mutex> trava(mutexBuffers);
+  FILE* F = fopen(arq.c_str(), "w");
+  if (F==nullptr) return false;
+  // Eventos completos ("ph":"X"), com os tempos em microssegundos
+  fprintf(F, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+             "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"circuito\"}}");
+  for (unsigned k=0; k<buffers.size(); k++)
+  {
+    const BufferRastro& B = *buffers[k];
+    fprintf(F, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+               "\"args\":{\"name\":\"thread %u\"}}", B.thread, B.thread);
+    for (unsigned e=0; e<B.eventos.size(); e++)
+    {
+      const EventoGravado& E = B.eventos[e];
+      fprintf(F, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+              E.nome, B.thread, E.inicio/1000.0, E.duracao/1000.0);
+      if (E.valor>=0) fprintf(F, ",\"args\":{\"n\":%lld}", (long long)E.valor);
+      fputc('}', F);
+    }
+  }
+  fprintf(F, "\n]}\n");
+  bool ok = !ferror(F);
+  return (fclose(F)==0) && ok;
+}
+
+int64_t EventoRastro::agora()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now()-inicioRastro).count();
+}
+
+EventoRastro::~EventoRastro()
+{
+  // O rastro pode ter sido desligado durante o trecho: o evento eh descartado
+  if (inicio<0 || !rastroAtivo()) return;
+  if (bufferThread==nullptr)
+  {
+    std::lock_guard<std::mutex> trava(mutexBuffers);
+    buffers.push_back(std::unique_ptr<BufferRastro>(new BufferRastro));
+    bufferThread = buffers.back().get();
+    bufferThread->thread = unsigned(buffers.size());
+  }
+  if (bufferThread->eventos.size()>=MAX_EVENTOS_RASTRO) return;
+  EventoGravado E;
+  E.nome = nome;
+  E.valor = valor;
+  E.inicio = inicio;
+  E.duracao = agora()-inicio;
+  bufferThread->eventos.push_back(E);
+}
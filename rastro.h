@@ -0,0 +1,65 @@
+#ifndef _RASTRO_H_
+#define _RASTRO_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// ###########################################################################
+/// RASTRO DE EXECUCAO (linha do tempo das fases da leitura e da simulacao)
+/// Os trechos marcados com RASTRO (leitura do arquivo, validacao, calculo dos niveis,
+/// cada bloco simulado, escrita dos resultados) sao gravados, com o inicio, a duracao
+/// e a thread, e depois salvos no formato JSON de eventos do Chrome (chrome://tracing,
+/// ui.perfetto.dev), que exibe a ocupacao de cada thread e as esperas.
+/// Cada thread grava os seus eventos em um buffer proprio, sem travas (soh o primeiro
+/// evento de cada thread registra o buffer, com um mutex).
+/// Com o rastro desligado (o padrao), cada trecho marcado custa apenas a leitura de
+/// uma variavel atomica: os trechos marcados sao grandes (fases e blocos, nunca portas).
+/// ###########################################################################
+
+// Numero maximo de eventos gravados por thread (os seguintes sao descartados)
+const unsigned MAX_EVENTOS_RASTRO = 1u<<20;
+
+// Liga a gravacao, descartando os eventos anteriores
+// Nao deve ser chamada enquanto outras threads estiverem gravando eventos
+void iniciarRastro();
+
+// Desliga a gravacao e salva os eventos gravados em arq
+// Deve ser chamada depois que as threads que gravaram eventos terminaram o trabalho
+// Retorna true se deu tudo OK; false se deu erro de escrita
+bool salvarRastro(const std::string& arq);
+
+// Retorna true se a gravacao estah ligada
+extern std::atomic<bool> rastroLigado;
+inline bool rastroAtivo()
+{
+  return rastroLigado.load(std::memory_order_relaxed);
+}
+
+// Um trecho marcado: gravado do construtor ao destrutor, se o rastro estiver ligado
+// O nome deve ser uma constante (o ponteiro eh guardado, e nao o texto); o valor
+// (opcional, por exemplo o numero de linhas de um bloco) aparece nos detalhes do evento
+class EventoRastro {
+private:
+  const char* nome;
+  int64_t valor;
+  // Inicio, em ns desde iniciarRastro (negativo se o rastro estava desligado)
+  int64_t inicio;
+
+  static int64_t agora();
+
+public:
+  explicit EventoRastro(const char* Nome, int64_t Valor=-1):
+    nome(Nome), valor(Valor), inicio(rastroAtivo() ? agora() : -1) {}
+  ~EventoRastro();
+
+  EventoRastro(const EventoRastro&) = delete;
+  void operator=(const EventoRastro&) = delete;
+};
+
+// Marca o restante do bloco atual como um trecho com o nome dado (e um valor)
+#define RASTRO_CONCATENAR2(a, b) a##b
+#define RASTRO_CONCATENAR(a, b) RASTRO_CONCATENAR2(a, b)
+#define RASTRO(...) EventoRastro RASTRO_CONCATENAR(rastro_, __LINE__)(__VA_ARGS__)
+
+#endif // _RASTRO_H_
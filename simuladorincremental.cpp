@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <climits>
+#include "simuladorincremental.h"
+#include "circuito.h"
+#include "rastro.h"
+
+///
+/// CLASSE SIMULADORINCREMENTAL
+///
+
+SimuladorIncremental::SimuladorIncremental():
+  plano(), inicioDestinos(1,0), destinos(), todas(), valores(), pendentes(), marcada(),
+  estatisticas()
+{
+}
+
+bool SimuladorIncremental::montar(const Circuito& C)
+{
+  RASTRO("montar simulador");
+  // As entradas atuais sao mantidas se o numero de entradas nao mudou
+  std::vector<bool3S> in_circ(valores.begin(), valores.begin()+plano.Nin);
+  if (!plano.montar(C))
+  {
+    clear();
+    return false;
+  }
+  if (in_circ.size()!=plano.Nin) in_circ.assign(plano.Nin, bool3S::UNDEF);
+  plano.calcularDestinos(inicioDestinos, destinos);
+  todas.resize(plano.Nports);
+  for (unsigned k=0; k<plano.Nports; k++) todas[k] = k;
+
+  pendentes.assign(plano.maxNivel+1, std::vector<unsigned>());
+  marcada.assign(plano.Nports, false);
+  simular(in_circ);
+  return true;
+}
+
+void SimuladorIncremental::clear()
+{
+  plano.clear();
+  inicioDestinos.assign(1, 0);
+  destinos.clear();
+  todas.clear();
+  valores.clear();
+  pendentes.clear();
+  marcada.clear();
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+bool SimuladorIncremental::montado() const
+{
+  return plano.Nin>0;
+}
+
+unsigned SimuladorIncremental::getNumInputs() const
+{
+  return plano.Nin;
+}
+
+unsigned SimuladorIncremental::getNumPorts() const
+{
+  return plano.Nports;
+}
+
+unsigned SimuladorIncremental::getNumOutputs() const
+{
+  return unsigned(plano.saidas.size());
+}
+
+bool SimuladorIncremental::getSemLacos() const
+{
+  return plano.semLacos;
+}
+
+const SimStats& SimuladorIncremental::getEstatisticas() const
+{
+  return estatisticas;
+}
+
+void SimuladorIncremental::zerarEstatisticas()
+{
+  estatisticas.zerar();
+}
+
+bool3S SimuladorIncremental::getInput(int IdInput) const
+{
+  if (IdInput>=0 || IdInput<-int(plano.Nin)) return bool3S::UNDEF;
+  return valores[plano.sinal(IdInput)];
+}
+
+bool3S SimuladorIncremental::getOutputPort(int IdPort) const
+{
+  if (IdPort<=0 || IdPort>int(plano.Nports)) return bool3S::UNDEF;
+  return valores[plano.sinal(IdPort)];
+}
+
+bool3S SimuladorIncremental::getOutput(int IdOutput) const
+{
+  if (IdOutput<=0 || IdOutput>int(plano.saidas.size())) return bool3S::UNDEF;
+  return valores[plano.saidas[IdOutput-1]];
+}
+
+/// ***********************
+/// Funcoes de simulacao
+/// ***********************
+
+bool3S SimuladorIncremental::avaliar(unsigned k) const
+{
+  const unsigned* O = plano.origens.data()+plano.inicioOrigens[k];
+  const bool3S* V = valores.data();
+  OperacoesBool3S Op;
+  return avaliarPorta<bool3S>(plano.tipos[k], plano.inicioOrigens[k+1]-plano.inicioOrigens[k],
+                              [O, V](unsigned j) {return V[O[j]];}, Op);
+}
+
+unsigned SimuladorIncremental::iterar(const std::vector<unsigned>& lista)
+{
+  bool tudo_def, alguma_def;
+  unsigned passada = 0;
+  for (unsigned k=0; k<lista.size(); k++) valores[plano.sinais[lista[k]]] = bool3S::UNDEF;
+  // Em ordem de nivel, um circuito sem lacos fica pronto na primeira passada: as
+  // demais passadas soh sao necessarias com lacos
+  do
+  {
+    tudo_def = true;
+    alguma_def = false;
+    passada++;
+    for (unsigned k=0; k<lista.size(); k++)
+    {
+      unsigned i = lista[k];
+      bool3S& S = valores[plano.sinais[i]];
+      if (S==bool3S::UNDEF)
+      {
+        S = avaliar(i);
+        ESTATISTICA(estatisticas.contarAvaliacao(plano.tipos[i], S!=bool3S::UNDEF, passada));
+        if (S==bool3S::UNDEF) tudo_def = false;
+        else alguma_def = true;
+      }
+    }
+  }
+  while(!plano.semLacos && !tudo_def && alguma_def);
+  return passada;
+}
+
+unsigned SimuladorIncremental::propagar(unsigned s)
+{
+  // Sem lacos, os destinos de uma porta tem sempre nivel maior que o dela: as portas
+  // pendentes de cada nivel sao avaliadas depois de todas as dos niveis anteriores
+  // Os flip-flops sao a excecao (nivel 1, lidos de qualquer nivel), mas valem sempre
+  // UNDEF: nunca sao agendados (agendado por uma porta de nivel maior, um flip-flop
+  // ficaria pendente e marcado depois da passada pelo nivel 1)
+  const std::vector<unsigned>& nivel = plano.niveis;
+  unsigned nMin = UINT_MAX, nMax = 0, avaliadas = 0;
+  auto agendar = [&](unsigned sinal)
+  {
+    for (unsigned m=inicioDestinos[sinal]; m<inicioDestinos[sinal+1]; m++)
+    {
+      unsigned i = destinos[m];
+      if (marcada[i] || plano.tipos[i]==TIPO_DF) continue;
+      marcada[i] = true;
+      pendentes[nivel[i]].push_back(i);
+      nMin = std::min(nMin, nivel[i]);
+      nMax = std::max(nMax, nivel[i]);
+    }
+  };
+  agendar(s);
+  for (unsigned n=nMin; n<=nMax && n<pendentes.size(); n++)
+  {
+    std::vector<unsigned>& P = pendentes[n];
+    for (unsigned k=0; k<P.size(); k++)
+    {
+      unsigned i = P[k];
+      marcada[i] = false;
+      avaliadas++;
+      bool3S S = avaliar(i);
+      ESTATISTICA(estatisticas.contarAvaliacao(plano.tipos[i], S!=bool3S::UNDEF, 1));
+      // Se o valor nao mudou, os destinos nao precisam ser avaliados
+      if (S==valores[plano.sinais[i]]) continue;
+      valores[plano.sinais[i]] = S;
+      agendar(plano.sinais[i]);
+    }
+    P.clear();
+  }
+  return avaliadas;
+}
+
+unsigned SimuladorIncremental::recalcularCone(unsigned s)
+{
+  // Com lacos, um valor antigo do cone poderia se sustentar sozinho (um laco que
+  // continua definido sem depender da entrada): o cone inteiro volta a UNDEF
+  std::vector<unsigned> cone;
+  std::vector<unsigned> pilha(1, s);
+  while (!pilha.empty())
+  {
+    unsigned sinal = pilha.back();
+    pilha.pop_back();
+    for (unsigned m=inicioDestinos[sinal]; m<inicioDestinos[sinal+1]; m++)
+    {
+      unsigned i = destinos[m];
+      if (marcada[i]) continue;
+      marcada[i] = true;
+      cone.push_back(i);
+      pilha.push_back(plano.sinais[i]);
+    }
+  }
+  for (unsigned k=0; k<cone.size(); k++) marcada[cone[k]] = false;
+  // As posicoes jah estao em ordem de nivel
+  std::sort(cone.begin(), cone.end());
+  unsigned passadas = iterar(cone);
+  ESTATISTICA(estatisticas.contarVetor(passadas, 0));
+  (void)passadas;
+  return unsigned(cone.size());
+}
+
+unsigned SimuladorIncremental::setInput(int IdInput, bool3S B)
+{
+  if (IdInput>=0 || IdInput<-int(plano.Nin)) return 0;
+  unsigned J = plano.sinal(IdInput);
+  if (valores[J]==B) return 0;
+  valores[J] = B;
+  ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+  unsigned avaliadas = (plano.semLacos ? propagar(J) : recalcularCone(J));
+  ESTATISTICA(if (plano.semLacos) estatisticas.contarVetor(1, 0));
+  ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+  return avaliadas;
+}
+
+void SimuladorIncremental::simular(const std::vector<bool3S>& in_circ)
+{
+  if (in_circ.size()!=plano.Nin) return;
+  ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+  valores.assign(plano.Nin+plano.Nports, bool3S::UNDEF);
+  std::copy(in_circ.begin(), in_circ.end(), valores.begin());
+  ESTATISTICA(estatisticas.marcarFase(SimStats::INICIALIZACAO, inicio));
+  unsigned passadas = iterar(todas);
+  ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+  ESTATISTICA(estatisticas.contarVetor(passadas, std::count(valores.begin()+plano.Nin, valores.end(), bool3S::UNDEF)));
+  (void)passadas;
+}
@@ -0,0 +1,117 @@
+#ifndef _SIMULADORINCREMENTAL_H_
+#define _SIMULADORINCREMENTAL_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+#include "circuitoplano.h"
+#include "estatisticas.h"
+
+class Circuito;
+
+/// ###########################################################################
+/// ATENCAO PARA A CONVENCAO DOS NOMES E TIPOS PARA OS PARAMETROS DAS FUNCOES:
+/// as mesmas da classe Circuito:
+/// int IdInput: id de entrada do circuito: de -1 a -NInputs
+/// int IdPort: id de porta do circuito: de 1 a NPortas
+/// int IdOrig: id de origem de um sinal (entrada do circuito ou porta)
+/// int IdOutput: id de saida do circuito: de 1 a NOutputs
+/// ###########################################################################
+
+///
+/// CLASSE SIMULADORINCREMENTAL
+///
+
+// Simulacao interativa do circuito: as entradas sao alteradas uma a uma e, a cada
+// alteracao, soh eh recalculado o cone de saida da entrada alterada, em vez do
+// circuito inteiro.
+// O simulador guarda uma copia "plana" da estrutura do circuito (CircuitoPlano, mais
+// as listas compactas de destinos de cada sinal), montada uma vez, e os valores de
+// todos os sinais. Depois de montado, nao depende mais do Circuito, que pode ser
+// alterado (mas entao o simulador deve ser montado de novo).
+// Os valores calculados sao sempre os mesmos de Circuito::simular com as mesmas
+// entradas:
+// - sem lacos: as portas alcancadas pela alteracao sao avaliadas em ordem de nivel
+//   logico (Circuito::calcularNiveis), e a propagacao para onde o valor nao muda
+// - com lacos: o cone de saida da entrada volta a UNDEF e eh recalculado com a mesma
+//   iteracao de Circuito::simular, restrita ao cone
+class SimuladorIncremental {
+private:
+  // A estrutura do circuito (ver circuitoplano.h): as portas sao indicadas pela
+  // posicao na ordem de nivel
+  CircuitoPlano plano;
+  // Destinos de cada sinal (posicoes das portas que o usam)
+  std::vector<unsigned> inicioDestinos;
+  std::vector<unsigned> destinos;
+  // Todas as portas, na ordem (a lista de iterar para o circuito inteiro)
+  std::vector<unsigned> todas;
+
+  // Valores atuais de todos os sinais: entradas do circuito e portas
+  std::vector<bool3S> valores;
+
+  // Areas de trabalho da propagacao: as portas a avaliar, separadas por nivel
+  std::vector<std::vector<unsigned> > pendentes;
+  std::vector<bool> marcada;
+
+  // Os contadores das simulacoes (soh atualizados com CIRCUITO_ESTATISTICAS)
+  SimStats estatisticas;
+
+  // Calcula a saida da porta k a partir dos valores atuais das suas origens
+  bool3S avaliar(unsigned k) const;
+  // Iteracao de Circuito::simular sobre as portas de lista (em ordem de nivel),
+  // a partir de UNDEF
+  // Retorna o numero de passadas
+  unsigned iterar(const std::vector<unsigned>& lista);
+  // Recalcula as portas afetadas pela alteracao do sinal s
+  // Retorna o numero de portas avaliadas
+  unsigned propagar(unsigned s);
+  unsigned recalcularCone(unsigned s);
+
+public:
+  SimuladorIncremental();
+
+  // Monta o simulador para o circuito C e simula com as entradas atuais (as que
+  // ja estavam definidas, se o numero de entradas nao mudou; todas UNDEF, se mudou)
+  // Retorna false (e fica vazio) se o circuito nao for valido
+  bool montar(const Circuito& C);
+
+  // Esvazia o simulador
+  void clear();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  // Retorna true se o simulador foi montado para algum circuito
+  bool montado() const;
+  unsigned getNumInputs() const;
+  unsigned getNumPorts() const;
+  unsigned getNumOutputs() const;
+  // Retorna true se o circuito montado nao tem lacos
+  bool getSemLacos() const;
+
+  // Os contadores de desempenho das simulacoes (ver estatisticas.h): cada simular e
+  // cada setInput conta como um vetor; as portas que terminam em UNDEF soh sao contadas
+  // em simular. Ficam em zero se o nucleo nao foi compilado com CIRCUITO_ESTATISTICAS
+  const SimStats& getEstatisticas() const;
+  void zerarEstatisticas();
+
+  // Valor atual de uma entrada do circuito, de uma porta ou de uma saida
+  // (UNDEF se parametro invalido)
+  bool3S getInput(int IdInput) const;
+  bool3S getOutputPort(int IdPort) const;
+  bool3S getOutput(int IdOutput) const;
+
+  /// ***********************
+  /// Funcoes de simulacao
+  /// ***********************
+
+  // Altera o valor de uma entrada do circuito e recalcula o que depende dela
+  // Retorna o numero de portas avaliadas (0 se o valor nao mudou ou parametro invalido)
+  unsigned setInput(int IdInput, bool3S B);
+
+  // Altera todas as entradas e simula o circuito inteiro
+  void simular(const std::vector<bool3S>& in_circ);
+};
+
+#endif // _SIMULADORINCREMENTAL_H_
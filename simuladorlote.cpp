@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cstring>
+#include "simuladorlote.h"
+#include "circuito.h"
+#include "rastro.h"
+#include "tabelaverdade.h"
+
+// Numero de vetores simulados de uma vez (os bits de uma palavra)
+static const unsigned VETORES_PALAVRA = 64;
+
+// Numero de bits ligados de x (usado apenas nos contadores)
+static inline uint64_t contarBits(uint64_t x)
+{
+  x = x - ((x>>1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x>>2) & 0x3333333333333333ULL);
+  x = (x + (x>>4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (x*0x0101010101010101ULL)>>56;
+}
+
+///
+/// CLASSE SIMULADORLOTE
+///
+
+struct SimuladorLote::OperacoesTrilhos {
+  // O mesmo calculo dos operadores de bool3S, bit a bit:
+  // - AND: T se todas T, F se alguma F
+  // - OR: T se alguma T, F se todas F
+  // - XOR: definido soh se as duas entradas estao definidas
+  // - NOT: troca os trilhos
+  static Trilhos nao(const Trilhos& A) {return Trilhos{A.f, A.t};}
+  static Trilhos e(const Trilhos& A, const Trilhos& B) {return Trilhos{A.t & B.t, A.f | B.f};}
+  static Trilhos ou(const Trilhos& A, const Trilhos& B) {return Trilhos{A.t | B.t, A.f & B.f};}
+  static Trilhos xou(const Trilhos& A, const Trilhos& B)
+  {
+    return Trilhos{(A.t & B.f) | (A.f & B.t), (A.t & B.t) | (A.f & B.f)};
+  }
+  static Trilhos indefinido() {return Trilhos();}
+};
+
+SimuladorLote::SimuladorLote():
+  plano(), valores(), estatisticas()
+{
+}
+
+bool SimuladorLote::montar(const Circuito& C)
+{
+  RASTRO("montar simulador em lote");
+  if (!plano.montar(C))
+  {
+    clear();
+    return false;
+  }
+  valores.assign(plano.Nin+plano.Nports, Trilhos());
+  return true;
+}
+
+void SimuladorLote::clear()
+{
+  plano.clear();
+  valores.clear();
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+bool SimuladorLote::montado() const
+{
+  return plano.Nin>0;
+}
+
+unsigned SimuladorLote::getNumInputs() const
+{
+  return plano.Nin;
+}
+
+unsigned SimuladorLote::getNumPorts() const
+{
+  return plano.Nports;
+}
+
+unsigned SimuladorLote::getNumOutputs() const
+{
+  return unsigned(plano.saidas.size());
+}
+
+bool SimuladorLote::getSemLacos() const
+{
+  return plano.semLacos;
+}
+
+const SimStats& SimuladorLote::getEstatisticas() const
+{
+  return estatisticas;
+}
+
+void SimuladorLote::zerarEstatisticas()
+{
+  estatisticas.zerar();
+}
+
+/// ***********************
+/// Funcoes de simulacao
+/// ***********************
+
+SimuladorLote::Trilhos SimuladorLote::avaliar(unsigned k) const
+{
+  const unsigned* O = plano.origens.data()+plano.inicioOrigens[k];
+  const Trilhos* V = valores.data();
+  OperacoesTrilhos Op;
+  return avaliarPorta<Trilhos>(plano.tipos[k], plano.inicioOrigens[k+1]-plano.inicioOrigens[k],
+                               [O, V](unsigned j) {return V[O[j]];}, Op);
+}
+
+void SimuladorLote::contarAvaliacoes(unsigned k, uint64_t avaliados, const Trilhos& S,
+                                     uint64_t passada)
+{
+  uint64_t n = contarBits(avaliados), d = contarBits((S.t|S.f) & avaliados);
+  estatisticas.avaliacoes += n;
+  estatisticas.avaliacoesTipo[plano.tipos[k]] += n;
+  estatisticas.definidas += d;
+  if (passada>1) estatisticas.resolucoes += d;
+}
+
+void SimuladorLote::contarVetores(uint64_t mascara, uint64_t passadas)
+{
+  uint64_t indefinidas = 0;
+  for (unsigned k=0; k<plano.Nports; k++)
+  {
+    const Trilhos& S = valores[plano.sinais[k]];
+    indefinidas += contarBits(mascara & ~(S.t|S.f));
+  }
+  for (uint64_t b=contarBits(mascara); b>0; b--) estatisticas.contarVetor(passadas, 0);
+  estatisticas.indefinidas += indefinidas;
+}
+
+void SimuladorLote::avaliarPortas(uint64_t mascara)
+{
+  uint64_t passadas = 1;
+  // Nos contadores, como em Circuito::simular, uma porta soh eh avaliada em um vetor
+  // enquanto estiver em UNDEF nele: as avaliacoes de cada porta sao contadas nos bits
+  // de mascara em que ela estava em UNDEF antes da avaliacao
+  if (plano.semLacos)
+  {
+    // Em ordem de nivel, todas as origens de uma porta jah foram calculadas
+    for (unsigned k=0; k<plano.Nports; k++) valores[plano.sinais[k]] = avaliar(k);
+    ESTATISTICA(for (unsigned k=0; k<plano.Nports; k++) contarAvaliacoes(k, mascara, valores[plano.sinais[k]], 1));
+  }
+  else
+  {
+    // A partir de UNDEF, os valores soh passam de UNDEF para F ou T (as operacoes sao
+    // monotonas): quando uma passada nao muda nada, eh o resultado de Circuito::simular
+    for (unsigned k=0; k<plano.Nports; k++) valores[plano.sinais[k]] = Trilhos();
+    bool mudou;
+    passadas = 0;
+    do
+    {
+      mudou = false;
+      passadas++;
+      for (unsigned k=0; k<plano.Nports; k++)
+      {
+        Trilhos S = avaliar(k);
+        Trilhos& D = valores[plano.sinais[k]];
+        ESTATISTICA(contarAvaliacoes(k, mascara & ~(D.t|D.f), S, passadas));
+        if (S.t!=D.t || S.f!=D.f)
+        {
+          D = S;
+          mudou = true;
+        }
+      }
+    }
+    while (mudou);
+  }
+  ESTATISTICA(contarVetores(mascara, passadas));
+  (void)mascara;
+  (void)passadas;
+}
+
+void SimuladorLote::simularBloco(const bool3S* entradas, unsigned N, uint8_t* saidasBloco)
+{
+  ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+  // As entradas: o vetor b no bit b (os bits alem de N ficam UNDEF)
+  for (unsigned j=0; j<plano.Nin; j++) valores[j] = Trilhos();
+  for (unsigned b=0; b<N; b++)
+  {
+    const bool3S* v = entradas + size_t(b)*plano.Nin;
+    for (unsigned j=0; j<plano.Nin; j++)
+    {
+      if (v[j]==bool3S::TRUE) valores[j].t |= uint64_t(1)<<b;
+      else if (v[j]==bool3S::FALSE) valores[j].f |= uint64_t(1)<<b;
+    }
+  }
+  ESTATISTICA(estatisticas.marcarFase(SimStats::INICIALIZACAO, inicio));
+
+  avaliarPortas(N<VETORES_PALAVRA ? (uint64_t(1)<<N)-1 : ~uint64_t(0));
+  ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+
+  // As saidas, empacotadas por vetor (o valor numerico do bool3S: F=1, T=2)
+  unsigned bl = bytesPorLinha(unsigned(plano.saidas.size()));
+  memset(saidasBloco, 0, size_t(N)*bl);
+  for (unsigned i=0; i<plano.saidas.size(); i++)
+  {
+    const Trilhos& S = valores[plano.saidas[i]];
+    uint8_t* byte = saidasBloco + (i>>2);
+    unsigned desloc = 2*(i&3);
+    for (unsigned b=0; b<N; b++, byte+=bl)
+    {
+      unsigned valor = unsigned((S.f>>b)&1) | (unsigned((S.t>>b)&1)<<1);
+      *byte = uint8_t(*byte | (valor<<desloc));
+    }
+  }
+  ESTATISTICA(estatisticas.marcarFase(SimStats::SAIDAS, inicio));
+}
+
+void SimuladorLote::simularLote(const bool3S* entradas, uint64_t N, uint8_t* saidasLote)
+{
+  if (!montado()) return;
+  unsigned bl = bytesPorLinha(unsigned(plano.saidas.size()));
+  for (uint64_t k=0; k<N; k+=VETORES_PALAVRA)
+  {
+    unsigned n = unsigned(std::min<uint64_t>(VETORES_PALAVRA, N-k));
+    simularBloco(entradas+k*plano.Nin, n, saidasLote+k*bl);
+  }
+}
+
+void SimuladorLote::simularPalavras(const uint64_t* entradasT, const uint64_t* entradasF,
+                                    uint64_t* saidasT, uint64_t* saidasF)
+{
+  if (!montado()) return;
+  ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+  for (unsigned j=0; j<plano.Nin; j++)
+  {
+    valores[j].t = entradasT[j];
+    valores[j].f = entradasF[j];
+  }
+  avaliarPortas(~uint64_t(0));
+  ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+  for (unsigned i=0; i<plano.saidas.size(); i++)
+  {
+    saidasT[i] = valores[plano.saidas[i]].t;
+    saidasF[i] = valores[plano.saidas[i]].f;
+  }
+}
@@ -0,0 +1,112 @@
+#ifndef _SIMULADORLOTE_H_
+#define _SIMULADORLOTE_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+#include "circuitoplano.h"
+#include "estatisticas.h"
+
+class Circuito;
+
+///
+/// CLASSE SIMULADORLOTE
+///
+
+// Simulacao de muitos vetores de entrada de uma vez: recebe um bloco contiguo de
+// vetores e escreve um bloco contiguo de saidas empacotadas (o layout da tabela
+// verdade, ver tabelaverdade.h), sem nenhuma alocacao nem chamada virtual por vetor.
+// Os vetores sao simulados 64 de cada vez, um por bit de uma palavra de 64 bits: cada
+// sinal eh representado por duas palavras ("dois trilhos"), a dos vetores em que ele
+// vale T e a dos vetores em que vale F (UNDEF = nenhuma das duas), e cada porta eh
+// avaliada para os 64 vetores com algumas operacoes logicas sobre palavras.
+// Como a avaliacao de um bloco custa o mesmo que a de um unico vetor na estrutura
+// plana, o mesmo caminho serve para qualquer numero de vetores.
+// Os valores sao sempre os mesmos de Circuito::simular com as mesmas entradas:
+// - sem lacos: uma passada pelas portas em ordem de nivel logico
+// - com lacos: as portas comecam em UNDEF e as passadas se repetem ateh que nenhum
+//   valor mude (o mesmo ponto fixo da iteracao de Circuito::simular)
+// Depois de montado, nao depende mais do Circuito. Pode ser copiado (um por thread).
+class SimuladorLote {
+private:
+  // Os dois trilhos de um sinal: bit k ligado = o vetor k do bloco tem o valor T (ou F)
+  struct Trilhos {
+    uint64_t t;
+    uint64_t f;
+  };
+
+  // Os operadores de bool3S nos dois trilhos, para avaliarPorta
+  struct OperacoesTrilhos;
+
+  // A estrutura do circuito (ver circuitoplano.h)
+  CircuitoPlano plano;
+
+  // Area de trabalho: os valores de todos os sinais no bloco atual
+  std::vector<Trilhos> valores;
+
+  // Os contadores das simulacoes (soh atualizados com CIRCUITO_ESTATISTICAS)
+  SimStats estatisticas;
+
+  // Avalia a k-esima porta da ordem a partir dos valores atuais das suas origens
+  Trilhos avaliar(unsigned k) const;
+  // Avalia todas as portas a partir dos valores atuais das entradas
+  // mascara: os vetores do bloco (bits) que sao contados nas estatisticas
+  void avaliarPortas(uint64_t mascara);
+  // Contadores: as avaliacoes da k-esima porta da ordem nos vetores avaliados, com
+  // resultado S, e o fim da simulacao dos vetores de mascara
+  void contarAvaliacoes(unsigned k, uint64_t avaliados, const Trilhos& S, uint64_t passada);
+  void contarVetores(uint64_t mascara, uint64_t passadas);
+  // Simula um bloco de ateh 64 vetores
+  void simularBloco(const bool3S* entradas, unsigned N, uint8_t* saidas);
+
+public:
+  SimuladorLote();
+
+  // Monta o simulador para o circuito C
+  // Retorna false (e fica vazio) se o circuito nao for valido
+  bool montar(const Circuito& C);
+
+  // Esvazia o simulador
+  void clear();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  // Retorna true se o simulador foi montado para algum circuito
+  bool montado() const;
+  unsigned getNumInputs() const;
+  unsigned getNumPorts() const;
+  unsigned getNumOutputs() const;
+  // Retorna true se o circuito montado nao tem lacos
+  bool getSemLacos() const;
+
+  // Os contadores de desempenho das simulacoes (ver estatisticas.h), por vetor, com o
+  // mesmo significado dos de Circuito::simular: uma porta conta como avaliada em um
+  // vetor enquanto estava em UNDEF nele, e o numero de passadas de cada vetor eh o do
+  // seu bloco de 64. Ficam em zero se o nucleo nao foi compilado com
+  // CIRCUITO_ESTATISTICAS
+  const SimStats& getEstatisticas() const;
+  void zerarEstatisticas();
+
+  /// ***********************
+  /// Funcoes de simulacao
+  /// ***********************
+
+  // Simula N vetores de entrada
+  // entradas: N*getNumInputs() valores, o vetor k em entradas[k*NumInputs] ...
+  // saidas: recebe N*bytesPorLinha(NumOutputs) bytes, as saidas do vetor k no layout
+  // de uma linha da tabela verdade empacotada (ver tabelaverdade.h), a partir de
+  // saidas[k*bytesPorLinha(NumOutputs)]
+  void simularLote(const bool3S* entradas, uint64_t N, uint8_t* saidas);
+
+  // Simula 64 vetores dados diretamente nos dois trilhos, sem conversao: o bit b de
+  // entradasT[j] (entradasF[j]) ligado = a entrada j do vetor b vale T (F); nenhum
+  // dos dois = UNDEF (um bit nao pode estar ligado nos dois)
+  // Escreve da mesma forma os valores das saidas em saidasT e saidasF
+  // (getNumOutputs() palavras cada)
+  void simularPalavras(const uint64_t* entradasT, const uint64_t* entradasF,
+                       uint64_t* saidasT, uint64_t* saidasF);
+};
+
+#endif // _SIMULADORLOTE_H_
@@ -0,0 +1,237 @@
+#include <cstring>
+#include <string>
+#include "simuladorsequencial.h"
+#include "circuito.h"
+#include "rastro.h"
+#include "tabelaverdade.h"
+
+// Os operadores de bool3S em tabelas, indexadas pelos valores numericos
+// (UNDEF=0, FALSE=1, TRUE=2): os mesmos resultados de bool3S.cpp, sem desvios
+static const uint8_t TAB_NOT[3] = {0, 2, 1};
+static const uint8_t TAB_AND[3][3] = {{0, 1, 0}, {1, 1, 1}, {0, 1, 2}};
+static const uint8_t TAB_OR[3][3] = {{0, 0, 2}, {0, 1, 2}, {2, 2, 2}};
+static const uint8_t TAB_XOR[3][3] = {{0, 0, 0}, {0, 1, 2}, {0, 2, 1}};
+
+// Os operadores das tabelas, para avaliarPorta
+struct OperacoesTabela {
+  static uint8_t nao(uint8_t A) {return TAB_NOT[A];}
+  static uint8_t e(uint8_t A, uint8_t B) {return TAB_AND[A][B];}
+  static uint8_t ou(uint8_t A, uint8_t B) {return TAB_OR[A][B];}
+  static uint8_t xou(uint8_t A, uint8_t B) {return TAB_XOR[A][B];}
+  static uint8_t indefinido() {return uint8_t(bool3S::UNDEF);}
+};
+
+///
+/// CLASSE SIMULADORSEQUENCIAL
+///
+
+SimuladorSequencial::SimuladorSequencial():
+  plano(), sinalQ(), sinalD(), estado(), valores(), ciclos(0), estatisticas()
+{
+}
+
+bool SimuladorSequencial::montar(const Circuito& C)
+{
+  RASTRO("montar simulador sequencial");
+  // Os flip-flops tem nivel 1 e os lacos que passam por eles nao contam
+  // (Circuito::calcularNiveis)
+  if (!plano.montar(C))
+  {
+    clear();
+    return false;
+  }
+  sinalQ.clear();
+  sinalD.clear();
+  for (unsigned i=0; i<plano.Nports; i++)
+  {
+    if (C.getNamePort(int(i+1))!="DF") continue;
+    sinalQ.push_back(plano.sinal(int(i+1)));
+    sinalD.push_back(plano.sinal(C.getId_inPort(int(i+1), 0)));
+  }
+
+  valores.assign(plano.Nin+plano.Nports, uint8_t(bool3S::UNDEF));
+  reiniciar();
+  return true;
+}
+
+void SimuladorSequencial::clear()
+{
+  plano.clear();
+  sinalQ.clear();
+  sinalD.clear();
+  estado.clear();
+  valores.clear();
+  ciclos = 0;
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+bool SimuladorSequencial::montado() const
+{
+  return plano.Nin>0;
+}
+
+unsigned SimuladorSequencial::getNumInputs() const
+{
+  return plano.Nin;
+}
+
+unsigned SimuladorSequencial::getNumPorts() const
+{
+  return plano.Nports;
+}
+
+unsigned SimuladorSequencial::getNumOutputs() const
+{
+  return unsigned(plano.saidas.size());
+}
+
+unsigned SimuladorSequencial::getNumFlipFlops() const
+{
+  return unsigned(sinalQ.size());
+}
+
+bool SimuladorSequencial::getSemLacos() const
+{
+  return plano.semLacos;
+}
+
+uint64_t SimuladorSequencial::getCiclos() const
+{
+  return ciclos;
+}
+
+int SimuladorSequencial::getIdFlipFlop(unsigned K) const
+{
+  return (K<sinalQ.size() ? int(sinalQ[K]-plano.Nin+1) : 0);
+}
+
+bool3S SimuladorSequencial::getEstado(unsigned K) const
+{
+  return (K<estado.size() ? bool3S(estado[K]) : bool3S::UNDEF);
+}
+
+const SimStats& SimuladorSequencial::getEstatisticas() const
+{
+  return estatisticas;
+}
+
+void SimuladorSequencial::zerarEstatisticas()
+{
+  estatisticas.zerar();
+}
+
+bool3S SimuladorSequencial::getOutputPort(int IdPort) const
+{
+  if (IdPort<=0 || IdPort>int(plano.Nports)) return bool3S::UNDEF;
+  return bool3S(valores[plano.sinal(IdPort)]);
+}
+
+bool3S SimuladorSequencial::getOutput(int IdOutput) const
+{
+  if (IdOutput<=0 || IdOutput>int(plano.saidas.size())) return bool3S::UNDEF;
+  return bool3S(valores[plano.saidas[IdOutput-1]]);
+}
+
+/// ***********************
+/// Funcoes de simulacao
+/// ***********************
+
+void SimuladorSequencial::reiniciar(bool3S B)
+{
+  estado.assign(sinalQ.size(), uint8_t(B));
+  ciclos = 0;
+}
+
+void SimuladorSequencial::setEstado(unsigned K, bool3S B)
+{
+  if (K<estado.size()) estado[K] = uint8_t(B);
+}
+
+uint8_t SimuladorSequencial::avaliar(unsigned k) const
+{
+  const unsigned* O = plano.origens.data()+plano.inicioOrigens[k];
+  const uint8_t* V = valores.data();
+  OperacoesTabela Op;
+  return avaliarPorta<uint8_t>(plano.tipos[k], plano.inicioOrigens[k+1]-plano.inicioOrigens[k],
+                               [O, V](unsigned j) {return V[O[j]];}, Op);
+}
+
+void SimuladorSequencial::ciclo(const bool3S* in_circ)
+{
+  if (!montado()) return;
+  ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+  const std::vector<uint8_t>& tipos = plano.tipos;
+  const std::vector<unsigned>& sinais = plano.sinais;
+  // As entradas do ciclo e o estado dos flip-flops
+  for (unsigned j=0; j<plano.Nin; j++) valores[j] = uint8_t(in_circ[j]);
+  for (unsigned k=0; k<sinalQ.size(); k++) valores[sinalQ[k]] = estado[k];
+  ESTATISTICA(estatisticas.marcarFase(SimStats::INICIALIZACAO, inicio));
+
+  // Os flip-flops nao sao avaliados: a sua saida eh o estado
+  ESTATISTICA(uint64_t passadas = 1);
+  if (plano.semLacos)
+  {
+    // Em ordem de nivel, todas as origens de uma porta jah foram calculadas
+    for (unsigned k=0; k<plano.Nports; k++)
+    {
+      if (tipos[k]!=TIPO_DF) valores[sinais[k]] = avaliar(k);
+    }
+    ESTATISTICA(for (unsigned k=0; k<plano.Nports; k++) if (tipos[k]!=TIPO_DF) estatisticas.contarAvaliacao(tipos[k], valores[sinais[k]]!=0, 1));
+  }
+  else
+  {
+    // Lacos combinacionais: passadas a partir de UNDEF ateh que nada mude (os valores
+    // soh passam de UNDEF para F ou T), o mesmo ponto fixo de Circuito::simular
+    for (unsigned k=0; k<plano.Nports; k++)
+    {
+      if (tipos[k]!=TIPO_DF) valores[sinais[k]] = uint8_t(bool3S::UNDEF);
+    }
+    bool mudou;
+    ESTATISTICA(passadas = 0);
+    do
+    {
+      mudou = false;
+      ESTATISTICA(passadas++);
+      for (unsigned k=0; k<plano.Nports; k++)
+      {
+        if (tipos[k]==TIPO_DF) continue;
+        uint8_t S = avaliar(k);
+        ESTATISTICA(estatisticas.contarAvaliacao(tipos[k], S!=0, passadas));
+        if (S!=valores[sinais[k]])
+        {
+          valores[sinais[k]] = S;
+          mudou = true;
+        }
+      }
+    }
+    while (mudou);
+  }
+  ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+
+  // A borda do clock: todos os flip-flops ao mesmo tempo (os valores de D jah estao
+  // calculados, e os sinais Q soh mudam no proximo ciclo)
+  for (unsigned k=0; k<sinalD.size(); k++) estado[k] = valores[sinalD[k]];
+  ciclos++;
+  ESTATISTICA(estatisticas.contarVetor(passadas, 0));
+  ESTATISTICA(estatisticas.marcarFase(SimStats::SAIDAS, inicio));
+}
+
+void SimuladorSequencial::simularCiclos(const bool3S* entradas, uint64_t N, uint8_t* saidasCiclos)
+{
+  if (!montado()) return;
+  RASTRO("simular ciclos", int64_t(N));
+  unsigned bl = bytesPorLinha(unsigned(plano.saidas.size()));
+  memset(saidasCiclos, 0, size_t(N)*bl);
+  for (uint64_t c=0; c<N; c++)
+  {
+    ciclo(entradas + c*plano.Nin);
+    uint8_t* linha = saidasCiclos + c*bl;
+    for (unsigned i=0; i<plano.saidas.size(); i++)
+    {
+      linha[i>>2] = uint8_t(linha[i>>2] | (valores[plano.saidas[i]]<<(2*(i&3))));
+    }
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef _SIMULADORSEQUENCIAL_H_
+#define _SIMULADORSEQUENCIAL_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+#include "circuitoplano.h"
+#include "estatisticas.h"
+
+class Circuito;
+
+/// ###########################################################################
+/// ATENCAO PARA A CONVENCAO DOS NOMES E TIPOS PARA OS PARAMETROS DAS FUNCOES:
+/// as mesmas da classe Circuito:
+/// int IdInput: id de entrada do circuito: de -1 a -NInputs
+/// int IdPort: id de porta do circuito: de 1 a NPortas
+/// int IdOutput: id de saida do circuito: de 1 a NOutputs
+/// unsigned K: indice de flip-flop: de 0 a NFlipFlops-1 (na ordem das ids das portas)
+/// ###########################################################################
+
+///
+/// CLASSE SIMULADORSEQUENCIAL
+///
+
+// Simulacao por ciclos de clock de um circuito com flip-flops (portas DF).
+// A cada ciclo:
+// 1) a logica combinacional eh avaliada uma vez, em ordem de nivel, a partir das
+//    entradas do ciclo e do estado atual dos flip-flops (a saida de cada DF);
+// 2) as saidas do circuito sao as desse momento (antes da borda do clock);
+// 3) na borda do clock, todos os flip-flops passam a guardar o valor da sua entrada D
+//    (todos ao mesmo tempo: os valores de D sao os calculados em 1).
+// O estado dos flip-flops fica em um vetor compacto, um byte por flip-flop, e os
+// valores dos sinais em outro, um byte por sinal; a estrutura do circuito eh a mesma
+// copia plana dos outros simuladores, montada uma vez.
+// Sem flip-flops, cada ciclo eh uma simulacao combinacional, com os mesmos valores de
+// Circuito::simular. Lacos que nao passam por flip-flops (lacos combinacionais) sao
+// resolvidos como em Circuito::simular, com passadas repetidas a partir de UNDEF.
+class SimuladorSequencial {
+private:
+  // A estrutura do circuito (ver circuitoplano.h); os flip-flops ficam na ordem, mas
+  // nao sao avaliados: a saida de cada um eh o seu estado
+  CircuitoPlano plano;
+  // Os flip-flops, na ordem das ids: o sinal da saida (Q) e o da entrada D de cada um
+  std::vector<unsigned> sinalQ;
+  std::vector<unsigned> sinalD;
+
+  // O estado de cada flip-flop e o valor de cada sinal no ultimo ciclo (bool3S)
+  std::vector<uint8_t> estado;
+  std::vector<uint8_t> valores;
+  // Numero de ciclos simulados desde montar ou reiniciar
+  uint64_t ciclos;
+
+  // Os contadores das simulacoes (soh atualizados com CIRCUITO_ESTATISTICAS)
+  SimStats estatisticas;
+
+  // Calcula a saida da k-esima porta da ordem (nao flip-flop) a partir dos valores atuais
+  uint8_t avaliar(unsigned k) const;
+
+public:
+  SimuladorSequencial();
+
+  // Monta o simulador para o circuito C, com todos os flip-flops em UNDEF
+  // Retorna false (e fica vazio) se o circuito nao for valido
+  bool montar(const Circuito& C);
+
+  // Esvazia o simulador
+  void clear();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  // Retorna true se o simulador foi montado para algum circuito
+  bool montado() const;
+  unsigned getNumInputs() const;
+  unsigned getNumPorts() const;
+  unsigned getNumOutputs() const;
+  unsigned getNumFlipFlops() const;
+  // Retorna true se o circuito montado nao tem lacos combinacionais
+  bool getSemLacos() const;
+  // Numero de ciclos simulados desde montar ou reiniciar
+  uint64_t getCiclos() const;
+
+  // Id da porta do K-esimo flip-flop e o seu estado atual (UNDEF se parametro invalido)
+  int getIdFlipFlop(unsigned K) const;
+  bool3S getEstado(unsigned K) const;
+
+  // Os contadores de desempenho (ver estatisticas.h): cada ciclo conta como um vetor
+  const SimStats& getEstatisticas() const;
+  void zerarEstatisticas();
+
+  // Valor de uma porta ou de uma saida no ultimo ciclo simulado, antes da borda do
+  // clock (UNDEF se parametro invalido ou se nenhum ciclo foi simulado)
+  bool3S getOutputPort(int IdPort) const;
+  bool3S getOutput(int IdOutput) const;
+
+  /// ***********************
+  /// Funcoes de simulacao
+  /// ***********************
+
+  // Coloca todos os flip-flops no estado B (por exemplo, F para comecar do zero) e
+  // zera o numero de ciclos
+  void reiniciar(bool3S B=bool3S::UNDEF);
+  // Altera o estado do K-esimo flip-flop
+  void setEstado(unsigned K, bool3S B);
+
+  // Simula um ciclo de clock com as entradas in_circ (getNumInputs() valores)
+  void ciclo(const bool3S* in_circ);
+
+  // Simula N ciclos seguidos
+  // entradas: N*getNumInputs() valores, as entradas do ciclo k em entradas[k*NumInputs] ...
+  // saidas: recebe N*bytesPorLinha(NumOutputs) bytes, as saidas de cada ciclo (antes da
+  // borda do clock) no layout de uma linha da tabela verdade empacotada (tabelaverdade.h)
+  void simularCiclos(const bool3S* entradas, uint64_t N, uint8_t* saidas);
+};
+
+#endif // _SIMULADORSEQUENCIAL_H_
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include "simuladortemporizado.h"
+#include "circuito.h"
+#include "rastro.h"
+
+///
+/// CLASSE SIMULADORTEMPORIZADO
+///
+
+SimuladorTemporizado::SimuladorTemporizado():
+  plano(), atrasos(), inicioLeitoras(), leitoras(), inicioSaidas(), saidasSinal(), valores(),
+  projetados(), fila(), marca(), roda(), ocupados(), mascara(0), pendentes(0), agora(0), eventos(0),
+  registro(), estatisticas()
+{
+}
+
+bool SimuladorTemporizado::montar(const Circuito& C)
+{
+  RASTRO("montar simulador temporizado");
+  if (!plano.montar(C))
+  {
+    clear();
+    return false;
+  }
+  unsigned Nsinais = plano.Nin+plano.Nports;
+
+  // O atraso de cada porta e o maior atraso
+  atrasos.resize(plano.Nports);
+  unsigned maxAtraso = 1;
+  for (unsigned k=0; k<plano.Nports; k++)
+  {
+    atrasos[k] = C.getAtrasoPort(int(plano.sinais[k]-plano.Nin+1));
+    maxAtraso = std::max(maxAtraso, atrasos[k]);
+  }
+
+  // As leitoras de cada sinal (uma porta que usa o mesmo sinal em duas entradas
+  // aparece duas vezes, o que nao muda nada)
+  plano.calcularDestinos(inicioLeitoras, leitoras);
+
+  // As saidas ligadas a cada sinal
+  const std::vector<unsigned>& saidas = plano.saidas;
+  inicioSaidas.assign(Nsinais+1, 0);
+  for (unsigned j=0; j<saidas.size(); j++) inicioSaidas[saidas[j]+1]++;
+  for (unsigned s=0; s<Nsinais; s++) inicioSaidas[s+1] += inicioSaidas[s];
+  saidasSinal.resize(saidas.size());
+  std::vector<unsigned> proxima(inicioSaidas.begin(), inicioSaidas.end()-1);
+  for (unsigned j=0; j<saidas.size(); j++) saidasSinal[proxima[saidas[j]]++] = int(j+1);
+
+  // A roda: uma potencia de 2 maior que o maior atraso
+  uint64_t tamRoda = 1;
+  while (tamRoda<=maxAtraso) tamRoda <<= 1;
+  roda.assign(tamRoda, std::vector<Evento>());
+  ocupados.assign((tamRoda+63)/64, 0);
+  mascara = tamRoda-1;
+
+  reiniciar();
+  return true;
+}
+
+void SimuladorTemporizado::clear()
+{
+  plano.clear();
+  atrasos.clear();
+  inicioLeitoras.clear();
+  leitoras.clear();
+  inicioSaidas.clear();
+  saidasSinal.clear();
+  valores.clear();
+  projetados.clear();
+  fila.clear();
+  marca.clear();
+  roda.clear();
+  ocupados.clear();
+  mascara = pendentes = agora = eventos = 0;
+  registro.clear();
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+bool SimuladorTemporizado::montado() const
+{
+  return plano.Nin>0;
+}
+
+unsigned SimuladorTemporizado::getNumInputs() const
+{
+  return plano.Nin;
+}
+
+unsigned SimuladorTemporizado::getNumPorts() const
+{
+  return plano.Nports;
+}
+
+unsigned SimuladorTemporizado::getNumOutputs() const
+{
+  return unsigned(plano.saidas.size());
+}
+
+uint64_t SimuladorTemporizado::getTempo() const
+{
+  return agora;
+}
+
+uint64_t SimuladorTemporizado::getEventos() const
+{
+  return eventos;
+}
+
+bool SimuladorTemporizado::estavel() const
+{
+  return pendentes==0 && fila.empty();
+}
+
+bool3S SimuladorTemporizado::getOutputPort(int IdPort) const
+{
+  if (IdPort<=0 || IdPort>int(plano.Nports)) return bool3S::UNDEF;
+  return valores[plano.sinal(IdPort)];
+}
+
+bool3S SimuladorTemporizado::getOutput(int IdOutput) const
+{
+  if (IdOutput<=0 || IdOutput>int(plano.saidas.size())) return bool3S::UNDEF;
+  return valores[plano.saidas[IdOutput-1]];
+}
+
+const std::vector<SimuladorTemporizado::Mudanca>& SimuladorTemporizado::getRegistro() const
+{
+  return registro;
+}
+
+void SimuladorTemporizado::limparRegistro()
+{
+  registro.clear();
+}
+
+const SimStats& SimuladorTemporizado::getEstatisticas() const
+{
+  return estatisticas;
+}
+
+void SimuladorTemporizado::zerarEstatisticas()
+{
+  estatisticas.zerar();
+}
+
+/// ***********************
+/// Funcoes de simulacao
+/// ***********************
+
+void SimuladorTemporizado::reiniciar()
+{
+  // Com todos os sinais em UNDEF, todas as portas jah estao estaveis (qualquer
+  // operacao de bool3S soh com UNDEF resulta em UNDEF)
+  valores.assign(plano.Nin+plano.Nports, bool3S::UNDEF);
+  projetados.assign(plano.Nports, bool3S::UNDEF);
+  fila.clear();
+  marca.assign(plano.Nports, 0);
+  for (unsigned b=0; b<roda.size(); b++) roda[b].clear();
+  ocupados.assign(ocupados.size(), 0);
+  pendentes = agora = eventos = 0;
+  registro.clear();
+}
+
+bool3S SimuladorTemporizado::avaliar(unsigned k) const
+{
+  const unsigned* O = plano.origens.data()+plano.inicioOrigens[k];
+  const bool3S* V = valores.data();
+  OperacoesBool3S Op;
+  return avaliarPorta<bool3S>(plano.tipos[k], plano.inicioOrigens[k+1]-plano.inicioOrigens[k],
+                              [O, V](unsigned j) {return V[O[j]];}, Op);
+}
+
+void SimuladorTemporizado::mudou(unsigned s)
+{
+  for (unsigned m=inicioLeitoras[s]; m<inicioLeitoras[s+1]; m++)
+  {
+    unsigned i = leitoras[m];
+    if (marca[i]!=agora+1)
+    {
+      marca[i] = agora+1;
+      fila.push_back(i);
+    }
+  }
+  for (unsigned m=inicioSaidas[s]; m<inicioSaidas[s+1]; m++)
+  {
+    registro.push_back(Mudanca{agora, saidasSinal[m], valores[s]});
+  }
+}
+
+void SimuladorTemporizado::processarInstante()
+{
+  ESTATISTICA(std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now());
+  // Os eventos do instante (um evento que nao muda o valor do sinal nao tem efeito)
+  std::vector<Evento>& balde = roda[agora & mascara];
+  for (unsigned k=0; k<balde.size(); k++)
+  {
+    const Evento& E = balde[k];
+    if (valores[E.sinal]==E.valor) continue;
+    valores[E.sinal] = E.valor;
+    mudou(E.sinal);
+  }
+  eventos += balde.size();
+  pendentes -= balde.size();
+  balde.clear();
+  ocupados[(agora & mascara)>>6] &= ~(uint64_t(1)<<(agora & 63));
+  ESTATISTICA(estatisticas.marcarFase(SimStats::INICIALIZACAO, inicio));
+
+  // As portas afetadas, com todos os valores do instante jah aplicados
+  for (unsigned k=0; k<fila.size(); k++)
+  {
+    unsigned i = fila[k];
+    bool3S S = avaliar(i);
+    ESTATISTICA(estatisticas.contarAvaliacao(plano.tipos[i], S!=bool3S::UNDEF, 1));
+    if (S!=projetados[i])
+    {
+      projetados[i] = S;
+      uint64_t b = (agora+atrasos[i]) & mascara;
+      roda[b].push_back(Evento{plano.sinais[i], S});
+      ocupados[b>>6] |= uint64_t(1)<<(b & 63);
+      pendentes++;
+    }
+  }
+  fila.clear();
+  ESTATISTICA(estatisticas.contarVetor(1, 0));
+  ESTATISTICA(estatisticas.marcarFase(SimStats::AVALIACAO, inicio));
+}
+
+void SimuladorTemporizado::aplicar(const bool3S* in_circ)
+{
+  if (!montado()) return;
+  for (unsigned j=0; j<plano.Nin; j++)
+  {
+    if (valores[j]==in_circ[j]) continue;
+    valores[j] = in_circ[j];
+    mudou(j);
+  }
+}
+
+uint64_t SimuladorTemporizado::proximoEvento() const
+{
+  // Dando a volta na roda a partir do balde do instante atual, uma palavra do mapa de
+  // cada vez (com menos de 64 baldes, a palavra acaba no fim da roda)
+  uint64_t tam = mascara+1;
+  for (uint64_t d=0; d<tam; )
+  {
+    uint64_t b = (agora+d) & mascara;
+    uint64_t palavra = ocupados[b>>6]>>(b & 63);
+    if (palavra!=0)
+    {
+      while (!(palavra & 1))
+      {
+        palavra >>= 1;
+        d++;
+      }
+      return agora+d;
+    }
+    d += std::min<uint64_t>(64-(b & 63), tam-b);
+  }
+  return agora;
+}
+
+bool SimuladorTemporizado::pularInstantesVazios(uint64_t T)
+{
+  if (agora>=T) return false;
+  // Sem nada pendente, nao ha o que processar ateh T
+  if (estavel())
+  {
+    agora = T;
+    return false;
+  }
+  if (fila.empty())
+  {
+    uint64_t t = proximoEvento();
+    if (t>=T)
+    {
+      agora = T;
+      return false;
+    }
+    agora = t;
+  }
+  return true;
+}
+
+void SimuladorTemporizado::avancar(uint64_t T)
+{
+  while (pularInstantesVazios(T))
+  {
+    processarInstante();
+    agora++;
+  }
+}
+
+bool SimuladorTemporizado::estabilizar(uint64_t limite)
+{
+  uint64_t fim = agora+limite;
+  while (!estavel() && pularInstantesVazios(fim))
+  {
+    processarInstante();
+    agora++;
+  }
+  return estavel();
+}
+
+void SimuladorTemporizado::simular(const bool3S* entradas, uint64_t N, uint64_t periodo)
+{
+  if (!montado()) return;
+  RASTRO("simular com atrasos", int64_t(N));
+  for (uint64_t k=0; k<N; k++)
+  {
+    aplicar(entradas + k*plano.Nin);
+    avancar(agora+periodo);
+  }
+}
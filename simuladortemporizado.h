@@ -0,0 +1,169 @@
+#ifndef _SIMULADORTEMPORIZADO_H_
+#define _SIMULADORTEMPORIZADO_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+#include "circuitoplano.h"
+#include "estatisticas.h"
+
+class Circuito;
+
+/// ###########################################################################
+/// ATENCAO PARA A CONVENCAO DOS NOMES E TIPOS PARA OS PARAMETROS DAS FUNCOES:
+/// as mesmas da classe Circuito:
+/// int IdInput: id de entrada do circuito: de -1 a -NInputs
+/// int IdPort: id de porta do circuito: de 1 a NPortas
+/// int IdOutput: id de saida do circuito: de 1 a NOutputs
+/// ###########################################################################
+
+///
+/// CLASSE SIMULADORTEMPORIZADO
+///
+
+// Simulacao dirigida por eventos com o atraso de cada porta (Port::getAtraso, o "@d"
+// do arquivo): ao contrario das simulacoes sem atraso, mostra os pulsos espurios
+// (glitches) e as corridas entre caminhos de atrasos diferentes.
+// O tempo eh inteiro (unidades de atraso). Quando uma porta eh avaliada no instante t
+// e o valor calculado eh diferente do ultimo valor agendado para ela, um evento (a
+// saida da porta passa a valer o novo valor) eh agendado para t+atraso (atraso de
+// transporte: todo pulso se propaga, por mais curto que seja). Em cada instante, todos
+// os eventos do instante sao aplicados e depois cada porta afetada eh avaliada uma vez,
+// com os operadores de bool3S (as mesmas regras de UNDEF das outras simulacoes).
+// Os eventos ficam em uma roda de tempo: um vetor circular de baldes, um por instante,
+// com mais baldes que o maior atraso do circuito; como todo evento cai no maximo
+// "maior atraso" instantes a frente, agendar um evento custa O(1). Os instantes sem
+// eventos nao sao processados: um mapa de bits dos baldes ocupados leva direto ao
+// proximo instante com eventos, examinando 64 baldes por palavra.
+// As mudancas das saidas do circuito sao registradas com o instante (getRegistro).
+// Os lacos sao simulados como estao (um laco pode oscilar ou guardar estado). Os
+// flip-flops (DF) ficam sempre em UNDEF, como nas simulacoes combinacionais.
+class SimuladorTemporizado {
+public:
+  // Uma mudanca do valor de uma saida do circuito
+  struct Mudanca {
+    uint64_t tempo;
+    int IdOutput;
+    bool3S valor;
+  };
+
+private:
+  // Um evento agendado: o sinal de saida de uma porta passa a valer valor
+  struct Evento {
+    unsigned sinal;
+    bool3S valor;
+  };
+
+  // A estrutura do circuito (ver circuitoplano.h) e o atraso de cada porta, na mesma
+  // ordem; as portas sao indicadas pela posicao nessa ordem
+  CircuitoPlano plano;
+  std::vector<unsigned> atrasos;
+  // As portas que leem cada sinal s: leitoras[inicioLeitoras[s]] ... e as saidas do
+  // circuito (IdOutput) ligadas a cada sinal: saidasSinal[inicioSaidas[s]] ...
+  std::vector<unsigned> inicioLeitoras;
+  std::vector<unsigned> leitoras;
+  std::vector<unsigned> inicioSaidas;
+  std::vector<int> saidasSinal;
+
+  // O valor atual de cada sinal e o ultimo valor agendado para cada porta (o atual, se
+  // nao houver evento pendente para ela)
+  std::vector<bool3S> valores;
+  std::vector<bool3S> projetados;
+  // As portas a avaliar no instante atual; marca[i]==agora+1 se a porta i jah estah la
+  std::vector<unsigned> fila;
+  std::vector<uint64_t> marca;
+  // A roda de tempo: os eventos do instante t ficam em roda[t & mascara]
+  std::vector<std::vector<Evento> > roda;
+  // Os baldes nao vazios da roda: o bit b de ocupados[b/64] ligado se roda[b] tem eventos
+  std::vector<uint64_t> ocupados;
+  uint64_t mascara;
+  uint64_t pendentes;
+  uint64_t agora;
+  // Numero de eventos processados desde montar ou reiniciar
+  uint64_t eventos;
+  std::vector<Mudanca> registro;
+
+  // Os contadores das simulacoes (soh atualizados com CIRCUITO_ESTATISTICAS)
+  SimStats estatisticas;
+
+  // Calcula a saida da porta k a partir dos valores atuais das suas origens
+  bool3S avaliar(unsigned k) const;
+  // O sinal s mudou no instante atual: registra as saidas e poe as leitoras na fila
+  void mudou(unsigned s);
+  // Processa o instante atual: aplica os eventos do instante e avalia as portas afetadas
+  void processarInstante();
+  // O primeiro instante, a partir do atual, com eventos na roda (deve haver algum)
+  uint64_t proximoEvento() const;
+  // Passa para o proximo instante a processar, sem passar de T: o atual, se houver
+  // portas na fila, ou o proximo com eventos
+  // Retorna false (e o instante atual fica T) se nao houver nada a processar antes de T
+  bool pularInstantesVazios(uint64_t T);
+
+public:
+  SimuladorTemporizado();
+
+  // Monta o simulador para o circuito C, com todos os sinais em UNDEF no instante 0
+  // Retorna false (e fica vazio) se o circuito nao for valido
+  bool montar(const Circuito& C);
+
+  // Esvazia o simulador
+  void clear();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  // Retorna true se o simulador foi montado para algum circuito
+  bool montado() const;
+  unsigned getNumInputs() const;
+  unsigned getNumPorts() const;
+  unsigned getNumOutputs() const;
+
+  // O instante atual
+  uint64_t getTempo() const;
+  // Numero de eventos processados desde montar ou reiniciar
+  uint64_t getEventos() const;
+  // Retorna true se nao ha eventos pendentes (os valores estao estaveis)
+  bool estavel() const;
+
+  // Valor atual de uma porta ou de uma saida (UNDEF se parametro invalido)
+  bool3S getOutputPort(int IdPort) const;
+  bool3S getOutput(int IdOutput) const;
+
+  // As mudancas das saidas do circuito, em ordem de tempo, desde montar, reiniciar ou
+  // limparRegistro
+  const std::vector<Mudanca>& getRegistro() const;
+  void limparRegistro();
+
+  // Os contadores de desempenho (ver estatisticas.h): cada instante processado (com
+  // eventos ou portas a avaliar) conta como uma passada
+  const SimStats& getEstatisticas() const;
+  void zerarEstatisticas();
+
+  /// ***********************
+  /// Funcoes de simulacao
+  /// ***********************
+
+  // Volta ao instante 0, com todos os sinais em UNDEF e nenhum evento pendente
+  void reiniciar();
+
+  // Aplica as entradas in_circ (getNumInputs() valores) no instante atual
+  void aplicar(const bool3S* in_circ);
+
+  // Processa os instantes de agora ateh T-1 e passa para o instante T
+  // (nao faz nada se T nao for maior que o instante atual)
+  void avancar(uint64_t T);
+
+  // Processa os eventos ateh que nao haja mais nenhum pendente, por no maximo
+  // "limite" instantes (um laco pode oscilar para sempre)
+  // Retorna true se os valores ficaram estaveis
+  bool estabilizar(uint64_t limite);
+
+  // Simula N vetores de entrada, um a cada "periodo" instantes: aplica o vetor k no
+  // instante inicial+k*periodo, onde inicial eh o instante atual
+  // entradas: N*getNumInputs() valores, o vetor k em entradas[k*NumInputs] ...
+  // Ao final, o instante atual eh inicial+N*periodo
+  void simular(const bool3S* entradas, uint64_t N, uint64_t periodo);
+};
+
+#endif // _SIMULADORTEMPORIZADO_H_
@@ -0,0 +1,559 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include "tabelaverdade.h"
+#include "circuito.h"
+#include "simuladorlote.h"
+#include "rastro.h"
+
+// Cabecalho do arquivo de tabela verdade (32 bytes, inteiros little-endian):
+//  0: "TVD3"      identificacao do formato
+//  4: uint32      versao do formato (1)
+//  8: uint32      numero de entradas
+// 12: uint32      numero de saidas
+// 16: uint64      numero de linhas (3^entradas)
+// 24: uint32      bytes por linha
+// 28: uint32      reservado (0)
+static const char ASSINATURA[4] = {'T','V','D','3'};
+static const uint32_t VERSAO = 1;
+static const unsigned TAM_CABECALHO = 32;
+// Numero maximo de entradas de uma tabela em arquivo: 3^40 jah passa de 2^63 (o mesmo
+// limite de TabelaVerdade::cabeEmMemoria)
+static const unsigned MAX_ENTRADAS_ARQUIVO = 40;
+
+// Funcoes auxiliares de leitura/escrita de inteiros little-endian
+static void escrever32(uint8_t* p, uint32_t v)
+{
+  for (int i=0; i<4; i++) p[i] = uint8_t(v>>(8*i));
+}
+static void escrever64(uint8_t* p, uint64_t v)
+{
+  for (int i=0; i<8; i++) p[i] = uint8_t(v>>(8*i));
+}
+static uint32_t ler32(const uint8_t* p)
+{
+  uint32_t v=0;
+  for (int i=0; i<4; i++) v |= uint32_t(p[i])<<(8*i);
+  return v;
+}
+static uint64_t ler64(const uint8_t* p)
+{
+  uint64_t v=0;
+  for (int i=0; i<8; i++) v |= uint64_t(p[i])<<(8*i);
+  return v;
+}
+
+uint64_t numLinhasTabela(unsigned NI)
+{
+  uint64_t n=1;
+  for (unsigned i=0; i<NI; i++) n *= 3;
+  return n;
+}
+
+bool3S entradaLinha(uint64_t L, unsigned NI, unsigned J)
+{
+  // A entrada J eh o digito de peso 3^(NI-1-J)
+  for (unsigned k=J+1; k<NI; k++) L /= 3;
+  return bool3S(L%3);
+}
+
+void entradasLinha(uint64_t L, unsigned NI, std::vector<bool3S>& in_circ)
+{
+  in_circ.resize(NI);
+  for (unsigned j=NI; j>0; j--)
+  {
+    in_circ[j-1] = bool3S(L%3);
+    L /= 3;
+  }
+}
+
+// Gera a proxima combinacao de entrada (mesma ordem da tabela exibida na interface)
+static void proximaLinha(bool3S* in_circ, unsigned NI)
+{
+  int j = int(NI)-1;
+  while (j>=0 && in_circ[j]==bool3S::TRUE)
+  {
+    in_circ[j] = bool3S::UNDEF;
+    j--;
+  }
+  if (j>=0) in_circ[j]++;
+}
+
+bool simularLinhas(SimuladorLote& S, uint64_t L0, uint64_t N, uint8_t* valores)
+{
+  if (!S.montado()) return false;
+  RASTRO("simular linhas", int64_t(N));
+  // As entradas das linhas sao geradas em blocos de ateh LINHAS_BLOCO vetores
+  // consecutivos, cada um simulado de uma vez
+  const uint64_t LINHAS_BLOCO = 1024;
+  unsigned numInputs = S.getNumInputs();
+  unsigned bl = bytesPorLinha(S.getNumOutputs());
+  std::vector<bool3S> in_circ;
+  std::vector<bool3S> entradas(size_t(std::min(N, LINHAS_BLOCO))*numInputs);
+
+  entradasLinha(L0, numInputs, in_circ);
+  for (uint64_t k=0; k<N; k+=LINHAS_BLOCO)
+  {
+    uint64_t n = std::min(N-k, LINHAS_BLOCO);
+    for (uint64_t b=0; b<n; b++)
+    {
+      std::copy(in_circ.begin(), in_circ.end(), entradas.begin()+b*numInputs);
+      proximaLinha(in_circ.data(), numInputs);
+    }
+    S.simularLote(entradas.data(), n, valores + k*bl);
+  }
+  return true;
+}
+
+bool simularLinhas(Circuito& C, uint64_t L0, uint64_t N, uint8_t* valores,
+                   const std::vector<int>& IdPorts)
+{
+  if (!C.valid()) return false;
+  RASTRO("simular linhas", int64_t(N));
+  unsigned numInputs = C.getNumInputs();
+  unsigned numOutputs = C.getNumOutputs();
+  unsigned bl = bytesPorLinha(numOutputs);
+  std::vector<bool3S> in_circ;
+
+  entradasLinha(L0, numInputs, in_circ);
+  memset(valores, 0, N*bl);
+  for (uint64_t k=0; k<N; k++)
+  {
+    if (!C.simular(in_circ, IdPorts)) return false;
+    uint8_t* linha = valores + k*bl;
+    for (unsigned i=0; i<numOutputs; i++) escreverValor(linha, i, C.getOutput(i+1));
+    proximaLinha(in_circ.data(), numInputs);
+  }
+  return true;
+}
+
+///
+/// CLASSE TABELAVERDADE
+///
+
+const uint64_t TabelaVerdade::MAX_BYTES = uint64_t(1)<<30;
+
+TabelaVerdade::TabelaVerdade():Nin(0),Nout(0),bytesLinha(0),Nlinhas(0),dados()
+{
+}
+
+bool TabelaVerdade::cabeEmMemoria(unsigned NI, unsigned NO)
+{
+  // 3^40 jah ultrapassa 2^63: evita o estouro no calculo do numero de linhas
+  if (NI>=40) return false;
+  uint64_t nl = numLinhasTabela(NI);
+  return (nl<=uint64_t(INT_MAX) && nl*bytesPorLinha(NO)<=MAX_BYTES);
+}
+
+bool TabelaVerdade::redimensionar(unsigned NI, unsigned NO)
+{
+  clear();
+  Nin = NI;
+  Nout = NO;
+  bytesLinha = bytesPorLinha(NO);
+  // A memoria nao eh reservada aqui: a tabela pode nunca ser gerada (ou ser substituida
+  // pela do cache), e ela cresce aa medida que as linhas chegam (acrescentarLinhas)
+  return cabeEmMemoria(NI, NO);
+}
+
+void TabelaVerdade::clear()
+{
+  Nin = Nout = bytesLinha = 0;
+  Nlinhas = 0;
+  // Libera a memoria (clear apenas nao liberaria)
+  std::vector<uint8_t>().swap(dados);
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+unsigned TabelaVerdade::getNumInputs() const
+{
+  return Nin;
+}
+
+unsigned TabelaVerdade::getNumOutputs() const
+{
+  return Nout;
+}
+
+uint64_t TabelaVerdade::getNumLinhas() const
+{
+  return Nlinhas;
+}
+
+uint64_t TabelaVerdade::getNumLinhasTotal() const
+{
+  return (Nin>0 ? numLinhasTabela(Nin) : 0);
+}
+
+bool TabelaVerdade::completa() const
+{
+  return (Nin>0 && Nlinhas==getNumLinhasTotal());
+}
+
+bool3S TabelaVerdade::getEntrada(uint64_t L, unsigned J) const
+{
+  if (L>=Nlinhas || J>=Nin) return bool3S::UNDEF;
+  return entradaLinha(L, Nin, J);
+}
+
+bool3S TabelaVerdade::getSaida(uint64_t L, unsigned I) const
+{
+  if (L>=Nlinhas || I>=Nout) return bool3S::UNDEF;
+  return lerValor(dados.data() + L*bytesLinha, I);
+}
+
+const uint8_t* TabelaVerdade::linha(uint64_t L) const
+{
+  if (L>=Nlinhas) return nullptr;
+  return dados.data() + L*bytesLinha;
+}
+
+/// ***********************
+/// Funcoes de modificacao
+/// ***********************
+
+void TabelaVerdade::acrescentarLinhas(const uint8_t* valores, uint64_t N)
+{
+  uint64_t total = getNumLinhasTotal();
+  if (Nlinhas+N > total) N = total-Nlinhas;
+  if (N==0) return;
+  // O buffer cresce em blocos que dobram de tamanho (no minimo BYTES_BLOCO), mas nunca
+  // alem do tamanho da tabela completa
+  const uint64_t BYTES_BLOCO = uint64_t(1)<<20;
+  uint64_t necessario = (Nlinhas+N)*bytesLinha;
+  if (necessario>dados.capacity())
+  {
+    uint64_t novo = std::max(std::max(necessario, BYTES_BLOCO), uint64_t(2*dados.capacity()));
+    dados.reserve(size_t(std::min(novo, total*bytesLinha)));
+  }
+  dados.insert(dados.end(), valores, valores + N*bytesLinha);
+  Nlinhas += N;
+}
+
+void TabelaVerdade::setSaida(uint64_t L, unsigned I, bool3S B)
+{
+  if (L>=Nlinhas || I>=Nout) return;
+  escreverValor(dados.data() + L*bytesLinha, I, B);
+}
+
+void TabelaVerdade::atualizarColunas(uint64_t L0, uint64_t N, const std::vector<bool>& colunas,
+                                     const uint8_t* valores)
+{
+  if (L0>=Nlinhas) return;
+  if (N>Nlinhas-L0) N = Nlinhas-L0;
+  // Mascara dos bits de cada byte da linha que pertencem as colunas atualizadas:
+  // os bytes sao combinados inteiros, em vez de uma saida por vez
+  std::vector<uint8_t> mascara(bytesLinha, 0);
+  for (unsigned i=0; i<Nout && i<colunas.size(); i++)
+  {
+    if (colunas[i]) mascara[i>>2] |= uint8_t(3<<(2*(i&3)));
+  }
+  for (uint64_t k=0; k<N; k++)
+  {
+    uint8_t* linha = dados.data() + (L0+k)*bytesLinha;
+    const uint8_t* novo = valores + k*bytesLinha;
+    for (unsigned b=0; b<bytesLinha; b++)
+    {
+      linha[b] = uint8_t((linha[b] & ~mascara[b]) | (novo[b] & mascara[b]));
+    }
+  }
+}
+
+void TabelaVerdade::copiarColuna(unsigned Orig, unsigned Dest)
+{
+  if (Orig>=Nout || Dest>=Nout || Orig==Dest) return;
+  for (uint64_t L=0; L<Nlinhas; L++)
+  {
+    uint8_t* linha = dados.data() + L*bytesLinha;
+    escreverValor(linha, Dest, lerValor(linha, Orig));
+  }
+}
+
+void TabelaVerdade::copiarEntrada(unsigned J, unsigned Dest)
+{
+  if (J>=Nin || Dest>=Nout) return;
+  // A entrada J vale ?, F, T, ?, F, T, ... trocando de valor a cada 3^(Nin-1-J) linhas
+  uint64_t periodo = numLinhasTabela(Nin-1-J);
+  uint64_t cont = 0;
+  unsigned v = 0;
+  for (uint64_t L=0; L<Nlinhas; L++)
+  {
+    escreverValor(dados.data() + L*bytesLinha, Dest, bool3S(v));
+    if (++cont==periodo)
+    {
+      cont = 0;
+      v = (v+1)%3;
+    }
+  }
+}
+
+bool gerarTabela(Circuito& C, TabelaVerdade& T)
+{
+  if (!C.valid()) return false;
+  if (!T.redimensionar(C.getNumInputs(), C.getNumOutputs())) return false;
+  SimuladorLote S;
+  if (!S.montar(C)) return false;
+  // Simula em blocos, para nao precisar de um segundo buffer do tamanho da tabela
+  const uint64_t LINHAS_BLOCO = 4096;
+  std::vector<uint8_t> valores(LINHAS_BLOCO*bytesPorLinha(C.getNumOutputs()));
+  uint64_t total = T.getNumLinhasTotal();
+  for (uint64_t L=0; L<total; L+=LINHAS_BLOCO)
+  {
+    uint64_t n = (total-L<LINHAS_BLOCO ? total-L : LINHAS_BLOCO);
+    if (!simularLinhas(S, L, n, valores.data())) return false;
+    RASTRO("guardar linhas", int64_t(n));
+    T.acrescentarLinhas(valores.data(), n);
+  }
+  return true;
+}
+
+///
+/// CLASSE TABELAMAPEADA
+///
+
+TabelaMapeada::TabelaMapeada():arq(),Nin(0),Nout(0),Nlinhas(0),bytesLinha(0)
+{
+}
+
+bool TabelaMapeada::lerCabecalho()
+{
+  const uint8_t* p = arq.dados();
+  if (arq.tamanho()<TAM_CABECALHO || p==nullptr) return false;
+  if (memcmp(p, ASSINATURA, 4)!=0 || ler32(p+4)!=VERSAO) return false;
+  Nin = ler32(p+8);
+  Nout = ler32(p+12);
+  Nlinhas = ler64(p+16);
+  bytesLinha = ler32(p+24);
+  // O numero de entradas vem do arquivo (que pode estar corrompido): eh limitado antes
+  // de calcular o numero de linhas
+  if (Nin==0 || Nin>MAX_ENTRADAS_ARQUIVO || Nout==0 || Nout>(UINT_MAX-7)/2 ||
+      Nlinhas!=numLinhasTabela(Nin) || bytesLinha!=bytesPorLinha(Nout)) return false;
+  // O arquivo tem que conter todas as linhas
+  uint64_t tam = tamanhoArquivoTabela(Nin, Nout);
+  return (tam!=UINT64_MAX && arq.tamanho()>=tam);
+}
+
+bool TabelaMapeada::criar(const std::string& nome, unsigned NI, unsigned NO)
+{
+  fechar();
+  uint64_t tam = tamanhoArquivoTabela(NI, NO);
+  if (NI==0 || NO==0 || tam==UINT64_MAX) return false;
+  uint64_t nl = numLinhasTabela(NI);
+  unsigned bl = bytesPorLinha(NO);
+  // Os bytes nulos do arquivo recem-criado correspondem a saidas UNDEF
+  if (!arq.criar(nome, tam)) return false;
+  uint8_t* p = arq.dadosEscrita();
+  memcpy(p, ASSINATURA, 4);
+  escrever32(p+4, VERSAO);
+  escrever32(p+8, NI);
+  escrever32(p+12, NO);
+  escrever64(p+16, nl);
+  escrever32(p+24, bl);
+  escrever32(p+28, 0);
+  Nin = NI;
+  Nout = NO;
+  Nlinhas = nl;
+  bytesLinha = bl;
+  return true;
+}
+
+bool TabelaMapeada::abrir(const std::string& nome, bool escrita)
+{
+  fechar();
+  if (!arq.abrir(nome, escrita)) return false;
+  if (!lerCabecalho())
+  {
+    fechar();
+    return false;
+  }
+  return true;
+}
+
+void TabelaMapeada::fechar()
+{
+  arq.fechar();
+  Nin = Nout = bytesLinha = 0;
+  Nlinhas = 0;
+}
+
+bool TabelaMapeada::sincronizar()
+{
+  return arq.sincronizar();
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+bool TabelaMapeada::aberta() const
+{
+  return (Nlinhas>0);
+}
+
+unsigned TabelaMapeada::getNumInputs() const
+{
+  return Nin;
+}
+
+unsigned TabelaMapeada::getNumOutputs() const
+{
+  return Nout;
+}
+
+uint64_t TabelaMapeada::getNumLinhas() const
+{
+  return Nlinhas;
+}
+
+bool3S TabelaMapeada::getEntrada(uint64_t L, unsigned J) const
+{
+  if (L>=Nlinhas || J>=Nin) return bool3S::UNDEF;
+  return entradaLinha(L, Nin, J);
+}
+
+const uint8_t* TabelaMapeada::linha(uint64_t L) const
+{
+  if (L>=Nlinhas) return nullptr;
+  return arq.dados() + TAM_CABECALHO + L*bytesLinha;
+}
+
+bool3S TabelaMapeada::getSaida(uint64_t L, unsigned I) const
+{
+  if (L>=Nlinhas || I>=Nout) return bool3S::UNDEF;
+  return lerValor(linha(L), I);
+}
+
+void TabelaMapeada::getLinha(uint64_t L, std::vector<bool3S>& saidas) const
+{
+  saidas.resize(Nout);
+  const uint8_t* p = linha(L);
+  for (unsigned i=0; i<Nout; i++) saidas[i] = (p!=nullptr ? lerValor(p,i) : bool3S::UNDEF);
+}
+
+void TabelaMapeada::getColuna(unsigned I, uint64_t L0, uint64_t N, std::vector<bool3S>& coluna) const
+{
+  coluna.resize(N);
+  for (uint64_t k=0; k<N; k++) coluna[k] = getSaida(L0+k, I);
+}
+
+/// ***********************
+/// Funcoes de modificacao
+/// ***********************
+
+void TabelaMapeada::setSaida(uint64_t L, unsigned I, bool3S B)
+{
+  uint8_t* p = arq.dadosEscrita();
+  if (p==nullptr || L>=Nlinhas || I>=Nout) return;
+  escreverValor(p + TAM_CABECALHO + L*bytesLinha, I, B);
+}
+
+void TabelaMapeada::setLinha(uint64_t L, const uint8_t* valores)
+{
+  uint8_t* p = arq.dadosEscrita();
+  if (p==nullptr || L>=Nlinhas) return;
+  memcpy(p + TAM_CABECALHO + L*bytesLinha, valores, bytesLinha);
+}
+
+///
+/// Geracao e comparacao de tabelas
+///
+
+uint64_t tamanhoArquivoTabela(unsigned NI, unsigned NO)
+{
+  if (NI>MAX_ENTRADAS_ARQUIVO) return UINT64_MAX;
+  uint64_t nl = numLinhasTabela(NI);
+  uint64_t bl = bytesPorLinha(NO);
+  if (bl>0 && nl>(UINT64_MAX-TAM_CABECALHO)/bl) return UINT64_MAX;
+  return TAM_CABECALHO + nl*bl;
+}
+
+bool gerarTabelaArquivo(Circuito& C, const std::string& nome, ProgressoTabela* P)
+{
+  if (!C.valid()) return false;
+  unsigned numOutputs = C.getNumOutputs();
+  SimuladorLote S;
+  if (!S.montar(C)) return false;
+  TabelaMapeada T;
+  if (!T.criar(nome, C.getNumInputs(), numOutputs)) return false;
+
+  // Simula em blocos de linhas, copiados para o arquivo
+  const uint64_t LINHAS_BLOCO = 4096;
+  unsigned bl = bytesPorLinha(numOutputs);
+  std::vector<uint8_t> valores(LINHAS_BLOCO*bl);
+  uint64_t total = T.getNumLinhas();
+  if (P!=nullptr) P->total = total;
+  bool ok = true;
+  for (uint64_t L=0; ok && L<total; L+=LINHAS_BLOCO)
+  {
+    if (P!=nullptr && P->cancelado)
+    {
+      ok = false;
+      break;
+    }
+    uint64_t n = (total-L<LINHAS_BLOCO ? total-L : LINHAS_BLOCO);
+    ok = simularLinhas(S, L, n, valores.data());
+    RASTRO("escrever linhas", int64_t(n));
+    for (uint64_t k=0; ok && k<n; k++) T.setLinha(L+k, valores.data() + k*bl);
+    if (P!=nullptr) P->linhas = L+n;
+  }
+  ok = ok && T.sincronizar();
+  T.fechar();
+  // Um arquivo incompleto nao deve ficar parecendo uma tabela valida
+  if (!ok) std::remove(nome.c_str());
+  return ok;
+}
+
+bool salvarTabela(const TabelaVerdade& T, const std::string& nome,
+                  const std::atomic<bool>* cancelado)
+{
+  if (!T.completa() || T.getNumOutputs()==0) return false;
+  TabelaMapeada M;
+  if (!M.criar(nome, T.getNumInputs(), T.getNumOutputs())) return false;
+  // O cancelamento eh consultado a cada bloco de linhas
+  const uint64_t LINHAS_BLOCO = 65536;
+  bool ok = true;
+  for (uint64_t L=0; ok && L<T.getNumLinhas(); L++)
+  {
+    if (cancelado!=nullptr && L%LINHAS_BLOCO==0 && *cancelado) ok = false;
+    else M.setLinha(L, T.linha(L));
+  }
+  ok = ok && M.sincronizar();
+  M.fechar();
+  if (!ok) std::remove(nome.c_str());
+  return ok;
+}
+
+bool lerTabela(const std::string& nome, TabelaVerdade& T)
+{
+  TabelaMapeada M;
+  if (!M.abrir(nome)) return false;
+  if (!T.redimensionar(M.getNumInputs(), M.getNumOutputs())) return false;
+  // As linhas ficam em sequencia no arquivo: sao copiadas de uma vez
+  T.acrescentarLinhas(M.linha(0), M.getNumLinhas());
+  return true;
+}
+
+int64_t primeiraDiferenca(const TabelaMapeada& A, const TabelaMapeada& B, uint64_t L0)
+{
+  if (A.getNumInputs()!=B.getNumInputs() || A.getNumOutputs()!=B.getNumOutputs()) return -1;
+  uint64_t N = A.getNumLinhas();
+  if (L0>=N) return int64_t(N);
+  unsigned bl = bytesPorLinha(A.getNumOutputs());
+  // As linhas sao contiguas: compara blocos grandes e soh desce ao nivel
+  // da linha quando encontra um bloco diferente
+  const uint64_t LINHAS_BLOCO = (uint64_t(1)<<20)/bl + 1;
+  for (uint64_t L=L0; L<N; L+=LINHAS_BLOCO)
+  {
+    uint64_t n = (N-L<LINHAS_BLOCO ? N-L : LINHAS_BLOCO);
+    if (memcmp(A.linha(L), B.linha(L), n*bl)==0) continue;
+    for (uint64_t k=L; k<L+n; k++)
+    {
+      if (memcmp(A.linha(k), B.linha(k), bl)!=0) return int64_t(k);
+    }
+  }
+  return int64_t(N);
+}
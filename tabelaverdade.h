@@ -0,0 +1,263 @@
+#ifndef _TABELAVERDADE_H_
+#define _TABELAVERDADE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "arquivomapeado.h"
+
+class Circuito;
+class SimuladorLote;
+
+/// ###########################################################################
+/// LAYOUT DA TABELA VERDADE EMPACOTADA
+/// A linha L da tabela corresponde aa combinacao de entradas cujo numero em base 3
+/// eh L, com a entrada 1 como digito mais significativo e ? = 0, F = 1, T = 2
+/// (a mesma ordem em que on_actionGerar_tabela_triggered gera as linhas).
+/// As entradas nao sao armazenadas: sao calculadas a partir do numero da linha.
+/// Cada saida ocupa 2 bits (o valor numerico do bool3S: UNDEF=0, FALSE=1, TRUE=2)
+/// e cada linha ocupa bytesPorLinha(NumOutputs) bytes; a saida de indice I fica nos
+/// bits 2*(I%4) e 2*(I%4)+1 do byte I/4 da linha.
+/// unsigned I: indice de saida (coluna), de 0 a NumOutputs-1
+/// uint64_t L: numero da linha, de 0 a NumLinhas-1
+/// ###########################################################################
+
+// Numero de linhas da tabela verdade de um circuito com NI entradas (3^NI)
+uint64_t numLinhasTabela(unsigned NI);
+
+// Numero de bytes ocupados por uma linha com NO saidas
+inline unsigned bytesPorLinha(unsigned NO)
+{
+  return (2*NO+7)/8;
+}
+
+// Le/escreve o valor da I-esima saida de uma linha empacotada
+inline bool3S lerValor(const uint8_t* linha, unsigned I)
+{
+  return bool3S((linha[I>>2] >> (2*(I&3))) & 3);
+}
+
+inline void escreverValor(uint8_t* linha, unsigned I, bool3S B)
+{
+  uint8_t& b = linha[I>>2];
+  b = uint8_t((b & ~(3<<(2*(I&3)))) | (uint8_t(B)<<(2*(I&3))));
+}
+
+// Calcula o valor da entrada de indice J (de 0 a NI-1) na linha L de uma tabela com NI entradas
+bool3S entradaLinha(uint64_t L, unsigned NI, unsigned J);
+
+// Preenche in_circ (redimensionado para NI) com as entradas da linha L
+void entradasLinha(uint64_t L, unsigned NI, std::vector<bool3S>& in_circ);
+
+// Simula as N linhas da tabela verdade a partir da linha L0 com o simulador S (montado
+// para o circuito, ver simuladorlote.h), 64 linhas de cada vez, escrevendo-as
+// empacotadas em valores (N*bytesPorLinha(NumOutputs) bytes)
+// Retorna true se deu tudo OK; false se deu erro (inclusive simulador nao montado)
+bool simularLinhas(SimuladorLote& S, uint64_t L0, uint64_t N, uint8_t* valores);
+
+// Simula as N linhas da tabela verdade do circuito C a partir da linha L0, uma a uma,
+// com apenas as portas IdPorts (o cone de entrada de algumas saidas, ver
+// Circuito::portasNecessarias): soh as saidas que dependem apenas dessas portas (e das
+// entradas) sao escritas com valores corretos
+// Retorna true se deu tudo OK; false se deu erro (inclusive circuito invalido)
+bool simularLinhas(Circuito& C, uint64_t L0, uint64_t N, uint8_t* valores,
+                   const std::vector<int>& IdPorts);
+
+///
+/// CLASSE TABELAVERDADE
+///
+
+// Uma tabela verdade (ou apenas as suas primeiras linhas) mantida em memoria, no
+// layout empacotado descrito acima: ocupa bytesPorLinha(NumOutputs) bytes por linha,
+// em vez de um objeto por celula. Eh a tabela exibida pela interface.
+// As linhas sao sempre acrescentadas em ordem (0, 1, 2, ...), de modo que uma tabela
+// parcialmente calculada contem as primeiras getNumLinhas() linhas da tabela completa.
+class TabelaVerdade {
+private:
+  unsigned Nin;
+  unsigned Nout;
+  unsigned bytesLinha;
+  // Numero de linhas jah armazenadas
+  uint64_t Nlinhas;
+  std::vector<uint8_t> dados;
+
+public:
+  TabelaVerdade();
+
+  // Maior tamanho (em bytes) de uma tabela mantida em memoria
+  // Tabelas maiores devem ser geradas em arquivo (ver gerarTabelaArquivo)
+  static const uint64_t MAX_BYTES;
+
+  // Retorna true se a tabela completa de um circuito com NI entradas e NO saidas
+  // cabe em memoria (MAX_BYTES) e pode ser exibida (no maximo INT_MAX linhas)
+  static bool cabeEmMemoria(unsigned NI, unsigned NO);
+
+  // Prepara uma tabela vazia (sem nenhuma linha) para NI entradas e NO saidas
+  // Retorna false se a tabela completa nao couber em memoria (cabeEmMemoria)
+  bool redimensionar(unsigned NI, unsigned NO);
+
+  // Apaga todas as linhas e zera as dimensoes
+  void clear();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  unsigned getNumInputs() const;
+  unsigned getNumOutputs() const;
+  // Numero de linhas jah armazenadas
+  uint64_t getNumLinhas() const;
+  // Numero de linhas da tabela completa (3^NumInputs)
+  uint64_t getNumLinhasTotal() const;
+  // Retorna true se todas as linhas jah foram armazenadas
+  bool completa() const;
+
+  // Valor da entrada J (de 0 a NumInputs-1) na linha L, ou UNDEF se parametros invalidos
+  bool3S getEntrada(uint64_t L, unsigned J) const;
+  // Valor da saida I (de 0 a NumOutputs-1) na linha L, ou UNDEF se parametros invalidos
+  bool3S getSaida(uint64_t L, unsigned I) const;
+  // Acesso direto aos bytes de uma linha empacotada (nullptr se parametro invalido)
+  const uint8_t* linha(uint64_t L) const;
+
+  /// ***********************
+  /// Funcoes de modificacao
+  /// ***********************
+
+  // Acrescenta ao final da tabela N linhas empacotadas (sem ultrapassar o total)
+  void acrescentarLinhas(const uint8_t* valores, uint64_t N);
+
+  // Funcoes para atualizar colunas de saida jah armazenadas (depois que o circuito foi
+  // alterado), sem recalcular a tabela inteira. So alteram as linhas jah armazenadas.
+
+  // Altera o valor da saida I na linha L
+  void setSaida(uint64_t L, unsigned I, bool3S B);
+  // Copia as colunas marcadas em colunas (indices de saida) das N linhas empacotadas
+  // valores para as linhas L0 ateh L0+N-1; as demais colunas nao sao alteradas
+  void atualizarColunas(uint64_t L0, uint64_t N, const std::vector<bool>& colunas,
+                        const uint8_t* valores);
+  // A saida Dest passa a ter os mesmos valores que a saida Orig
+  void copiarColuna(unsigned Orig, unsigned Dest);
+  // A saida Dest passa a ter os valores da entrada J (uma saida ligada direto a uma entrada)
+  void copiarEntrada(unsigned J, unsigned Dest);
+};
+
+// Gera a tabela verdade completa do circuito C em T
+// Retorna true se deu tudo OK; false se deu erro (circuito invalido ou tabela
+// grande demais para a memoria, ver TabelaVerdade::cabeEmMemoria)
+bool gerarTabela(Circuito& C, TabelaVerdade& T);
+
+///
+/// CLASSE TABELAMAPEADA
+///
+
+// Uma tabela verdade armazenada em arquivo, acessada atraves de mmap.
+// Qualquer linha, ou qualquer valor de uma coluna de saida, eh lido em O(1) sem
+// carregar a tabela inteira, o que permite consultar e comparar tabelas de varios
+// gigabytes (circuitos com 18 a 20 entradas) sem precisar gera-las novamente.
+// Formato do arquivo: um cabecalho de 32 bytes (ver tabelaverdade.cpp) seguido
+// das linhas no layout empacotado descrito acima.
+class TabelaMapeada {
+private:
+  ArquivoMapeado arq;
+  unsigned Nin;
+  unsigned Nout;
+  uint64_t Nlinhas;
+  unsigned bytesLinha;
+
+  // Verifica o cabecalho do arquivo aberto e preenche as dimensoes
+  bool lerCabecalho();
+
+public:
+  TabelaMapeada();
+
+  // Cria o arquivo de uma tabela com NI entradas e NO saidas, com todas as saidas
+  // valendo UNDEF, e o deixa aberto para escrita
+  // Retorna true se deu tudo OK; false se deu erro
+  bool criar(const std::string& nome, unsigned NI, unsigned NO);
+
+  // Abre uma tabela existente (por padrao, apenas para leitura)
+  // Retorna true se deu tudo OK; false se o arquivo nao existe ou nao eh uma tabela valida
+  bool abrir(const std::string& nome, bool escrita=false);
+
+  // Fecha o arquivo
+  void fechar();
+
+  // Grava no disco as linhas alteradas (ver ArquivoMapeado::sincronizar)
+  // Retorna true se deu tudo OK; false se deu erro de escrita
+  bool sincronizar();
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  bool aberta() const;
+  unsigned getNumInputs() const;
+  unsigned getNumOutputs() const;
+  uint64_t getNumLinhas() const;
+
+  // Valor da entrada J (de 0 a NumInputs-1) na linha L (calculado, nao lido do arquivo)
+  bool3S getEntrada(uint64_t L, unsigned J) const;
+
+  // Valor da saida I na linha L, ou UNDEF se parametros invalidos
+  bool3S getSaida(uint64_t L, unsigned I) const;
+
+  // Preenche saidas (redimensionado para NumOutputs) com os valores da linha L
+  void getLinha(uint64_t L, std::vector<bool3S>& saidas) const;
+
+  // Preenche coluna (redimensionado para N) com os valores da saida I
+  // nas linhas L0 ate L0+N-1
+  void getColuna(unsigned I, uint64_t L0, uint64_t N, std::vector<bool3S>& coluna) const;
+
+  // Acesso direto aos bytes de uma linha empacotada (nullptr se parametro invalido)
+  const uint8_t* linha(uint64_t L) const;
+
+  /// ***********************
+  /// Funcoes de modificacao
+  /// ***********************
+
+  // Soh tem efeito se a tabela foi criada ou aberta para escrita
+  void setSaida(uint64_t L, unsigned I, bool3S B);
+  // Copia a linha empacotada inteira
+  void setLinha(uint64_t L, const uint8_t* valores);
+};
+
+// Tamanho em bytes do arquivo de uma tabela com NI entradas e NO saidas
+// (UINT64_MAX se NI passar de 40 ou se o tamanho nao couber em 64 bits)
+uint64_t tamanhoArquivoTabela(unsigned NI, unsigned NO);
+
+// O andamento da geracao de uma tabela em arquivo, que pode ser acompanhada e
+// interrompida de outra thread (como ProgressoLeitura)
+struct ProgressoTabela {
+  std::atomic<uint64_t> linhas;  // linhas jah gravadas
+  std::atomic<uint64_t> total;   // numero de linhas da tabela (0 enquanto nao for conhecido)
+  std::atomic<bool> cancelado;   // se true, a geracao eh interrompida no proximo bloco
+
+  ProgressoTabela(): linhas(0), total(0), cancelado(false) {}
+};
+
+// Gera a tabela verdade completa do circuito C no arquivo "nome", no formato da
+// TabelaMapeada. Retorna true se deu tudo OK; false se deu erro (inclusive circuito
+// invalido ou disco cheio) ou se foi cancelada, e nesse caso o arquivo eh apagado
+// Se P nao for nullptr, eh atualizado a cada bloco de linhas (e consultado para cancelar)
+bool gerarTabelaArquivo(Circuito& C, const std::string& nome, ProgressoTabela* P=nullptr);
+
+// Grava a tabela em memoria T, que deve estar completa, no arquivo "nome" (formato da
+// TabelaMapeada). Retorna true se deu tudo OK; false se deu erro (e apaga o arquivo)
+// Se cancelado nao for nullptr e ficar true (de outra thread), a gravacao eh
+// interrompida e tambem retorna false
+bool salvarTabela(const TabelaVerdade& T, const std::string& nome,
+                  const std::atomic<bool>* cancelado=nullptr);
+
+// Leh para a memoria (T) a tabela do arquivo "nome" (formato da TabelaMapeada)
+// Retorna true se deu tudo OK; false se deu erro (arquivo invalido ou tabela grande
+// demais para a memoria, ver TabelaVerdade::cabeEmMemoria)
+bool lerTabela(const std::string& nome, TabelaVerdade& T);
+
+// Compara duas tabelas com as mesmas dimensoes a partir da linha L0
+// Retorna o numero da primeira linha em que alguma saida difere,
+// A.getNumLinhas() se forem iguais ou -1 se as dimensoes forem diferentes
+int64_t primeiraDiferenca(const TabelaMapeada& A, const TabelaMapeada& B, uint64_t L0=0);
+
+#endif // _TABELAVERDADE_H_